@@ -1,22 +1,217 @@
-#include "../include/RiftNet/RiftClient.hpp" // The only RiftNet header the user needs for the server.
+#include "../include/RiftNet/RiftClient.hpp" // The only RiftNet header the user needs for the client.
 #include "../utilities/logger/Logger.hpp"     // Assuming the logger is available for the test app.
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
 #include <string>
-#include <chrono>
 #include <thread>
 #include <vector>
-#include <numeric> 
 
-// =====================================================================================
-// Shared State for the Client
-// =====================================================================================
+// Usage: BenchClient [--host=127.0.0.1] [--port=8888] [--clients=1] [--threads=0] [--rate=100]
+//                    [--size=64 | --size=MIN-MAX] [--reliable=1.0] [--seconds=10] [--warmup=1]
+//                    [--saturate] [--step=1.5] [--loss-threshold=1.0]
+//                    [--csv=bench_results.csv] [--json=FILE] [--label=NAME]
+//
+// Runs --clients connections against BenchServer's echo, each sending --rate messages/sec whose size
+// is drawn uniformly from --size. A --reliable fraction goes on a reliable unordered channel, the rest
+// on an unreliable sequenced one (late echoes older than the newest count as lost). Every message
+// carries its send time, so the round trip of each echo lands in a histogram with ~1% resolution.
+// --saturate repeats the run, multiplying the rate by --step each time, until more than
+// --loss-threshold percent of messages are lost or sends are refused; the last clean step is the
+// sustainable rate. Each run or step appends a row to --csv, and --json writes all of them.
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Channels, in the order BenchServer configures them.
+    constexpr uint8_t kReliableChannel = 0;
+    constexpr uint8_t kUnreliableChannel = 1;
+    const RiftChannelType kChannels[] = { RIFT_CHANNEL_RELIABLE_UNORDERED, RIFT_CHANNEL_UNRELIABLE_SEQUENCED };
+
+    // =====================================================================================
+    // Latency histogram
+    // =====================================================================================
+
+    // HDR-style log-linear buckets: exact below 128 us, then 64 buckets per power of two,
+    // so any recorded value is reported within 1/64 of itself up to ~19 hours.
+    constexpr uint32_t kSubBucketBits = 6;
+    constexpr uint64_t kLinearLimit = 2ull << kSubBucketBits;
+    constexpr uint64_t kMaxTrackableUs = (1ull << 36) - 1;
+    constexpr size_t kBucketCount = (37 - kSubBucketBits) << kSubBucketBits;
+
+    size_t BucketIndex(uint64_t us) {
+        us = (std::min)(us, kMaxTrackableUs);
+        if (us < kLinearLimit) return static_cast<size_t>(us);
+        const uint32_t shift = static_cast<uint32_t>(std::bit_width(us)) - (kSubBucketBits + 1);
+        return (static_cast<size_t>(shift) << kSubBucketBits) + static_cast<size_t>(us >> shift);
+    }
+
+    // Midpoint of the values that share the bucket.
+    uint64_t BucketValue(size_t index) {
+        if (index < kLinearLimit) return index;
+        const uint32_t shift = static_cast<uint32_t>(index >> kSubBucketBits) - 1;
+        const uint64_t top = index - (static_cast<uint64_t>(shift) << kSubBucketBits);
+        return (top << shift) + ((1ull << shift) >> 1);
+    }
+
+    struct LatencySummary {
+        uint64_t count = 0;
+        double   meanUs = 0.0;
+        uint64_t p50Us = 0, p90Us = 0, p99Us = 0, p999Us = 0, maxUs = 0;
+    };
+
+    // Written from the client's network threads with relaxed atomics; read once the phase has drained.
+    class LatencyRecorder {
+    public:
+        void Record(uint64_t us) {
+            m_counts[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+            m_sumUs.fetch_add(us, std::memory_order_relaxed);
+            uint64_t max = m_maxUs.load(std::memory_order_relaxed);
+            while (us > max && !m_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+        }
+
+        void AddTo(std::vector<uint64_t>& counts, uint64_t& sumUs, uint64_t& maxUs) const {
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                counts[i] += m_counts[i].load(std::memory_order_relaxed);
+            }
+            sumUs += m_sumUs.load(std::memory_order_relaxed);
+            maxUs = (std::max)(maxUs, m_maxUs.load(std::memory_order_relaxed));
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, kBucketCount> m_counts{};
+        std::atomic<uint64_t> m_sumUs{ 0 };
+        std::atomic<uint64_t> m_maxUs{ 0 };
+    };
+
+    LatencySummary Summarize(const std::vector<uint64_t>& counts, uint64_t sumUs, uint64_t maxUs) {
+        LatencySummary summary;
+        for (uint64_t c : counts) summary.count += c;
+        if (summary.count == 0) return summary;
+
+        summary.meanUs = static_cast<double>(sumUs) / static_cast<double>(summary.count);
+        summary.maxUs = maxUs;
+        const std::pair<double, uint64_t*> quantiles[] = {
+            { 0.50, &summary.p50Us }, { 0.90, &summary.p90Us }, { 0.99, &summary.p99Us }, { 0.999, &summary.p999Us } };
+        for (const auto& [q, out] : quantiles) {
+            const uint64_t rank = (std::max<uint64_t>)(1, static_cast<uint64_t>(q * static_cast<double>(summary.count) + 0.5));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                seen += counts[i];
+                if (seen >= rank) { *out = (std::min)(BucketValue(i), maxUs); break; }
+            }
+        }
+        return summary;
+    }
+
+    // =====================================================================================
+    // Load state
+    // =====================================================================================
+
+    struct Options {
+        std::string host = "127.0.0.1";
+        uint16_t    port = 8888;
+        uint32_t    clients = 1;
+        uint32_t    threads = 0;          // 0 = one sender thread per core, at most one per client
+        double      rate = 100.0;         // messages/sec per client
+        uint32_t    minSize = 64;
+        uint32_t    maxSize = 64;
+        double      reliableFraction = 1.0;
+        double      seconds = 10.0;
+        double      warmupSeconds = 1.0;
+        bool        saturate = false;
+        double      step = 1.5;
+        double      lossThresholdPct = 1.0;
+        std::string csvPath = "bench_results.csv";
+        std::string jsonPath;
+        std::string label = "bench";
+    };
+
+    // Every message starts with this header; the echo brings it back unchanged.
+    struct MessageHeader {
+        uint64_t sentNs;    // steady_clock time of the send
+        uint32_t phase;
+        uint32_t client;
+        uint8_t  reliable;
+    };
+    constexpr size_t kHeaderSize = 8 + 4 + 4 + 1;
+
+    struct ClassCounters {
+        std::atomic<uint64_t> sent{ 0 };
+        std::atomic<uint64_t> received{ 0 };
+        std::atomic<uint64_t> sendFailures{ 0 };
+        std::atomic<uint64_t> bytesSent{ 0 };
+        LatencyRecorder       latency;
+    };
+
+    // One per client per phase, so receive callbacks of different clients never share counters.
+    struct ClientPhaseStats {
+        ClassCounters reliable;
+        ClassCounters unreliable;
+    };
+
+    struct PhaseStats {
+        uint32_t id = 0;          // 0 = warmup
+        double   rate = 0.0;      // messages/sec per client
+        double   sendSeconds = 0.0;
+        std::vector<std::unique_ptr<ClientPhaseStats>> clients;
+    };
+
+    struct ClassResult {
+        uint64_t       sent = 0, received = 0, sendFailures = 0, bytesSent = 0;
+        LatencySummary latency;
+
+        double LossPct() const {
+            return sent == 0 ? 0.0 : 100.0 * static_cast<double>(sent - (std::min)(received, sent)) / static_cast<double>(sent);
+        }
+    };
+
+    struct PhaseResult {
+        uint32_t    step = 0;
+        double      ratePerClient = 0.0;
+        double      seconds = 0.0;
+        ClassResult total, reliable, unreliable;
+        double      sendPps = 0.0, receivePps = 0.0, sendMbps = 0.0;
+    };
+
+    struct ClientState {
+        RiftClientHandle  handle = nullptr;
+        uint32_t          index = 0;
+        std::atomic<bool> connected{ false };
+        std::atomic<bool> disconnected{ false };
+    };
+
+    std::atomic<PhaseStats*> g_phase{ nullptr };
+
+    uint64_t NowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+    }
+
+    void WriteHeader(uint8_t* out, const MessageHeader& header) {
+        std::memcpy(out, &header.sentNs, 8);
+        std::memcpy(out + 8, &header.phase, 4);
+        std::memcpy(out + 12, &header.client, 4);
+        out[16] = header.reliable;
+    }
 
-struct ClientState {
-    RiftClientHandle handle = nullptr;
-    std::chrono::steady_clock::time_point last_ping_sent_time;
-    bool connected = false;
-    std::vector<double> rtt_samples_us; // Store RTT samples in microseconds
-};
+    MessageHeader ReadHeader(const uint8_t* in) {
+        MessageHeader header{};
+        std::memcpy(&header.sentNs, in, 8);
+        std::memcpy(&header.phase, in + 8, 4);
+        std::memcpy(&header.client, in + 12, 4);
+        header.reliable = in[16];
+        return header;
+    }
+}
 
 // =====================================================================================
 // Event Callback Implementation
@@ -29,20 +224,30 @@ void ClientEventCallback(const RiftEvent* event, void* user_data)
     switch (event->type)
     {
     case RIFT_EVENT_CLIENT_CONNECTED:
-        RF_NETWORK_INFO("Client: Successfully connected to server.");
-        state->connected = true;
+        RF_NETWORK_DEBUG("Client {}: connected to server.", state->index);
+        state->connected.store(true, std::memory_order_release);
         break;
 
     case RIFT_EVENT_CLIENT_DISCONNECTED:
-        RF_NETWORK_INFO("Client: Disconnected from server.");
-        state->connected = false;
+        RF_NETWORK_WARN("Client {}: disconnected from server.", state->index);
+        state->connected.store(false, std::memory_order_release);
+        state->disconnected.store(true, std::memory_order_release);
         break;
 
     case RIFT_EVENT_PACKET_RECEIVED:
     {
-        auto now = std::chrono::steady_clock::now();
-        auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(now - state->last_ping_sent_time);
-        state->rtt_samples_us.push_back(static_cast<double>(rtt.count()));
+        const uint64_t now = NowNs();
+        if (event->data.packet.size < kHeaderSize) break;
+        const MessageHeader header = ReadHeader(event->data.packet.data);
+
+        // Echoes of an earlier phase arriving late are not counted against the current one.
+        PhaseStats* phase = g_phase.load(std::memory_order_acquire);
+        if (!phase || header.phase != phase->id || header.client != state->index) break;
+
+        ClientPhaseStats& stats = *phase->clients[state->index];
+        ClassCounters& counters = header.reliable ? stats.reliable : stats.unreliable;
+        counters.received.fetch_add(1, std::memory_order_relaxed);
+        counters.latency.Record(now > header.sentNs ? (now - header.sentNs) / 1000 : 0);
         break;
     }
 
@@ -51,101 +256,394 @@ void ClientEventCallback(const RiftEvent* event, void* user_data)
     }
 }
 
-// =====================================================================================
-// Main Application Entry Point
-// =====================================================================================
+namespace {
 
-int main()
-{
-    // 1. Initialize Logger
-    RiftNet::Logging::Logger::Init();
-    RF_NETWORK_INFO("--- RiftNet Latency Benchmark Client ---");
+    // =====================================================================================
+    // Sending
+    // =====================================================================================
 
-    // 2. Setup Client State and Configuration
-    ClientState state;
+    // Sends to clients[first, first + count) as one evenly spaced stream: message k goes to client
+    // first + k % count at start + k / (count * rate). A thread that falls behind sends at once, so the
+    // achieved rate shows in the results rather than the schedule slipping silently.
+    void SendLoop(const Options& options, std::vector<std::unique_ptr<ClientState>>& clients, size_t first, size_t count,
+        PhaseStats& phase, Clock::time_point start, Clock::time_point end, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<uint32_t> sizeDist(options.minSize, options.maxSize);
+        std::bernoulli_distribution reliableDist(options.reliableFraction);
 
-    RiftClientConfig config = {};
-    config.event_callback = ClientEventCallback;
-    config.user_data = &state;
+        // Random filler, so compression does not shrink the load below what was asked for.
+        std::vector<uint8_t> buffer(options.maxSize);
+        for (auto& b : buffer) b = static_cast<uint8_t>(rng());
 
-    // 3. Create and Connect the Client
-    state.handle = rift_client_create(&config);
-    if (!state.handle) {
-        RF_NETWORK_CRITICAL("Failed to create RiftNet client.");
-        return 1;
+        const double interval = 1.0 / (phase.rate * static_cast<double>(count));
+        for (uint64_t k = 0;; ++k) {
+            const auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval * static_cast<double>(k)));
+            if (due >= end) break;
+            if (Clock::now() < due) std::this_thread::sleep_until(due);
+
+            ClientState& client = *clients[first + k % count];
+            if (!client.connected.load(std::memory_order_acquire)) continue;
+
+            const bool reliable = reliableDist(rng);
+            const uint32_t size = sizeDist(rng);
+            WriteHeader(buffer.data(), { NowNs(), phase.id, client.index, static_cast<uint8_t>(reliable) });
+
+            ClientPhaseStats& stats = *phase.clients[client.index];
+            ClassCounters& counters = reliable ? stats.reliable : stats.unreliable;
+            const RiftResult rc = rift_client_send_channel(client.handle, reliable ? kReliableChannel : kUnreliableChannel, buffer.data(), size);
+            if (rc == RIFT_SUCCESS) {
+                counters.sent.fetch_add(1, std::memory_order_relaxed);
+                counters.bytesSent.fetch_add(size, std::memory_order_relaxed);
+            }
+            else {
+                counters.sendFailures.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
     }
 
-    RiftResult result = rift_client_connect(state.handle, "127.0.0.1", 8888);
-    if (result != RIFT_SUCCESS) {
-        RF_NETWORK_CRITICAL("Failed to connect to server. Error code: {}", static_cast<int>(result));
-        rift_client_destroy(state.handle);
-        return 1;
+    uint64_t TotalSent(const PhaseStats& phase) {
+        uint64_t sent = 0;
+        for (const auto& c : phase.clients) sent += c->reliable.sent.load() + c->unreliable.sent.load();
+        return sent;
     }
 
-    // Wait for connection to be established
-    RF_NETWORK_INFO("Connecting...");
-    while (!state.connected) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    uint64_t TotalReceived(const PhaseStats& phase) {
+        uint64_t received = 0;
+        for (const auto& c : phase.clients) received += c->reliable.received.load() + c->unreliable.received.load();
+        return received;
     }
 
-    // 4. Run the Latency Test Loop
-    RF_NETWORK_INFO("Connection established. Starting latency test...");
-    const int pings_to_send = 1000;
-    state.rtt_samples_us.reserve(pings_to_send);
+    // Runs one phase at phase.rate messages/sec per client, then waits up to two seconds for its echoes.
+    void RunPhase(const Options& options, std::vector<std::unique_ptr<ClientState>>& clients, PhaseStats& phase, double seconds)
+    {
+        for (size_t i = 0; i < clients.size(); ++i) phase.clients.push_back(std::make_unique<ClientPhaseStats>());
+        g_phase.store(&phase, std::memory_order_release);
 
-    for (int i = 0; i < pings_to_send; ++i) {
-        if (!state.connected) {
-            RF_NETWORK_WARN("Disconnected during test.");
-            break;
+        const size_t threadCount = options.threads != 0
+            ? (std::min<size_t>)(options.threads, clients.size())
+            : (std::min<size_t>)((std::max)(1u, std::thread::hardware_concurrency()), clients.size());
+        const auto start = Clock::now() + std::chrono::milliseconds(10);
+        const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+
+        std::vector<std::jthread> senders;
+        size_t first = 0;
+        for (size_t t = 0; t < threadCount; ++t) {
+            const size_t count = clients.size() / threadCount + (t < clients.size() % threadCount ? 1 : 0);
+            const uint32_t seed = 0x5eed + phase.id * 977 + static_cast<uint32_t>(t);
+            senders.emplace_back([&, first, count, seed] { SendLoop(options, clients, first, count, phase, start, end, seed); });
+            first += count;
         }
 
-        uint8_t payload[8]; // Payload will contain the send time
-        auto now = std::chrono::steady_clock::now();
-        state.last_ping_sent_time = now;
+        // Progress once a second while the phase runs.
+        uint64_t lastReceived = 0;
+        auto lastReport = Clock::now();
+        while (Clock::now() < end) {
+            std::this_thread::sleep_until((std::min)(end, lastReport + std::chrono::seconds(1)));
+            const auto now = Clock::now();
+            const uint64_t received = TotalReceived(phase);
+            const double dt = std::chrono::duration<double>(now - lastReport).count();
+            RF_NETWORK_INFO("  {:.0f} echoes/sec ({} sent so far)", dt > 0.0 ? static_cast<double>(received - lastReceived) / dt : 0.0, TotalSent(phase));
+            lastReceived = received;
+            lastReport = now;
+        }
+        senders.clear(); // joins
+        phase.sendSeconds = std::chrono::duration<double>(Clock::now() - start).count();
 
-        // We don't need to send the actual time for an echo test, just trigger a response.
-        rift_client_send(state.handle, payload, sizeof(payload));
+        const auto drainUntil = Clock::now() + std::chrono::seconds(2);
+        while (Clock::now() < drainUntil && TotalReceived(phase) < TotalSent(phase)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        g_phase.store(nullptr, std::memory_order_release);
+    }
 
-        // Send pings at a regular interval
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ClassResult Collect(const PhaseStats& phase, bool reliable) {
+        ClassResult result;
+        std::vector<uint64_t> counts(kBucketCount);
+        uint64_t sumUs = 0, maxUs = 0;
+        for (const auto& c : phase.clients) {
+            const ClassCounters& counters = reliable ? c->reliable : c->unreliable;
+            result.sent += counters.sent.load();
+            result.received += counters.received.load();
+            result.sendFailures += counters.sendFailures.load();
+            result.bytesSent += counters.bytesSent.load();
+            counters.latency.AddTo(counts, sumUs, maxUs);
+        }
+        result.latency = Summarize(counts, sumUs, maxUs);
+        return result;
     }
 
-    // Give last packets time to arrive
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    PhaseResult Analyze(const PhaseStats& phase) {
+        PhaseResult result;
+        result.step = phase.id;
+        result.ratePerClient = phase.rate;
+        result.seconds = phase.sendSeconds;
+        result.reliable = Collect(phase, true);
+        result.unreliable = Collect(phase, false);
 
-    // 5. Stop and Destroy the Client
-    RF_NETWORK_INFO("Latency test finished. Disconnecting...");
-    rift_client_disconnect(state.handle);
-    rift_client_destroy(state.handle);
+        // The combined histogram is the merge of both classes'.
+        std::vector<uint64_t> counts(kBucketCount);
+        uint64_t sumUs = 0, maxUs = 0;
+        for (const auto& c : phase.clients) {
+            c->reliable.latency.AddTo(counts, sumUs, maxUs);
+            c->unreliable.latency.AddTo(counts, sumUs, maxUs);
+        }
+        result.total.sent = result.reliable.sent + result.unreliable.sent;
+        result.total.received = result.reliable.received + result.unreliable.received;
+        result.total.sendFailures = result.reliable.sendFailures + result.unreliable.sendFailures;
+        result.total.bytesSent = result.reliable.bytesSent + result.unreliable.bytesSent;
+        result.total.latency = Summarize(counts, sumUs, maxUs);
 
-    // 6. Analyze and Save Results to CSV
-    if (state.rtt_samples_us.empty()) {
-        RF_NETWORK_ERROR("No RTT samples were collected. Cannot generate report.");
-        return 1;
+        if (result.seconds > 0.0) {
+            result.sendPps = static_cast<double>(result.total.sent) / result.seconds;
+            result.receivePps = static_cast<double>(result.total.received) / result.seconds;
+            result.sendMbps = static_cast<double>(result.total.bytesSent) * 8.0 / 1e6 / result.seconds;
+        }
+        return result;
     }
 
-    std::ofstream csv_file("latency_results.csv");
-    if (!csv_file.is_open()) {
-        RF_NETWORK_ERROR("Failed to open latency_results.csv for writing.");
+    void Report(const PhaseResult& r) {
+        RF_NETWORK_INFO("-----------------------------------------");
+        RF_NETWORK_INFO("Step {}: {:.0f} msgs/sec per client for {:.1f}s", r.step, r.ratePerClient, r.seconds);
+        RF_NETWORK_INFO("Sent {} ({:.0f} pps, {:.2f} Mbit/s payload), echoed {} ({:.0f} pps), lost {:.3f}%, refused {}",
+            r.total.sent, r.sendPps, r.sendMbps, r.total.received, r.receivePps, r.total.LossPct(), r.total.sendFailures);
+        const std::pair<const char*, const ClassResult*> classes[] = { { "all", &r.total }, { "reliable", &r.reliable }, { "unreliable", &r.unreliable } };
+        for (const auto& [name, c] : classes) {
+            if (c->sent == 0) continue;
+            RF_NETWORK_INFO("  {:<10} RTT us: p50={} p90={} p99={} p99.9={} max={} mean={:.1f} (n={}, lost {:.3f}%)", name,
+                c->latency.p50Us, c->latency.p90Us, c->latency.p99Us, c->latency.p999Us, c->latency.maxUs, c->latency.meanUs,
+                c->latency.count, c->LossPct());
+        }
+    }
+
+    // =====================================================================================
+    // Output
+    // =====================================================================================
+
+    void AppendCsv(const Options& options, const std::vector<PhaseResult>& results) {
+        const bool exists = std::ifstream(options.csvPath).good();
+        std::ofstream csv(options.csvPath, std::ios::app);
+        if (!csv.is_open()) {
+            RF_NETWORK_ERROR("Failed to open {} for writing.", options.csvPath);
+            return;
+        }
+        if (!exists) {
+            csv << "label,timestamp,clients,step,rate_per_client,min_size,max_size,reliable_fraction,seconds,"
+                   "sent,received,refused,loss_pct,send_pps,receive_pps,send_mbps,"
+                   "p50_us,p90_us,p99_us,p999_us,max_us,mean_us,"
+                   "reliable_p99_us,reliable_loss_pct,unreliable_p99_us,unreliable_loss_pct\n";
+        }
+        const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        for (const auto& r : results) {
+            csv << options.label << ',' << timestamp << ',' << options.clients << ',' << r.step << ',' << r.ratePerClient << ','
+                << options.minSize << ',' << options.maxSize << ',' << options.reliableFraction << ',' << r.seconds << ','
+                << r.total.sent << ',' << r.total.received << ',' << r.total.sendFailures << ',' << r.total.LossPct() << ','
+                << r.sendPps << ',' << r.receivePps << ',' << r.sendMbps << ','
+                << r.total.latency.p50Us << ',' << r.total.latency.p90Us << ',' << r.total.latency.p99Us << ','
+                << r.total.latency.p999Us << ',' << r.total.latency.maxUs << ',' << r.total.latency.meanUs << ','
+                << r.reliable.latency.p99Us << ',' << r.reliable.LossPct() << ','
+                << r.unreliable.latency.p99Us << ',' << r.unreliable.LossPct() << '\n';
+        }
+        RF_NETWORK_INFO("Results appended to {}", options.csvPath);
+    }
+
+    void WriteJsonClass(std::ofstream& json, const char* name, const ClassResult& c, bool last) {
+        json << "      \"" << name << "\": { \"sent\": " << c.sent << ", \"received\": " << c.received
+             << ", \"refused\": " << c.sendFailures << ", \"loss_pct\": " << c.LossPct()
+             << ", \"latency_us\": { \"p50\": " << c.latency.p50Us << ", \"p90\": " << c.latency.p90Us
+             << ", \"p99\": " << c.latency.p99Us << ", \"p999\": " << c.latency.p999Us << ", \"max\": " << c.latency.maxUs
+             << ", \"mean\": " << c.latency.meanUs << " } }" << (last ? "\n" : ",\n");
+    }
+
+    void WriteJson(const Options& options, const std::vector<PhaseResult>& results, double sustainedRate) {
+        std::ofstream json(options.jsonPath, std::ios::trunc);
+        if (!json.is_open()) {
+            RF_NETWORK_ERROR("Failed to open {} for writing.", options.jsonPath);
+            return;
+        }
+        // Labels are plain names given on the command line; quotes and backslashes are not escaped.
+        json << "{\n  \"label\": \"" << options.label << "\",\n"
+             << "  \"clients\": " << options.clients << ",\n"
+             << "  \"min_size\": " << options.minSize << ",\n  \"max_size\": " << options.maxSize << ",\n"
+             << "  \"reliable_fraction\": " << options.reliableFraction << ",\n"
+             << "  \"saturate\": " << (options.saturate ? "true" : "false") << ",\n"
+             << "  \"sustained_rate_per_client\": " << sustainedRate << ",\n"
+             << "  \"steps\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            json << "    {\n      \"step\": " << r.step << ", \"rate_per_client\": " << r.ratePerClient
+                 << ", \"seconds\": " << r.seconds << ",\n      \"send_pps\": " << r.sendPps
+                 << ", \"receive_pps\": " << r.receivePps << ", \"send_mbps\": " << r.sendMbps << ",\n";
+            WriteJsonClass(json, "all", r.total, false);
+            WriteJsonClass(json, "reliable", r.reliable, false);
+            WriteJsonClass(json, "unreliable", r.unreliable, true);
+            json << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        json << "  ]\n}\n";
+        RF_NETWORK_INFO("Results written to {}", options.jsonPath);
+    }
+
+    // =====================================================================================
+    // Command line
+    // =====================================================================================
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const size_t eq = arg.find('=');
+            const std::string key = arg.substr(0, eq);
+            const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+            try {
+                if (key == "--host") options.host = value;
+                else if (key == "--port") options.port = static_cast<uint16_t>(std::stoul(value));
+                else if (key == "--clients") options.clients = static_cast<uint32_t>(std::stoul(value));
+                else if (key == "--threads") options.threads = static_cast<uint32_t>(std::stoul(value));
+                else if (key == "--rate") options.rate = std::stod(value);
+                else if (key == "--size") {
+                    const size_t dash = value.find('-');
+                    options.minSize = static_cast<uint32_t>(std::stoul(value.substr(0, dash)));
+                    options.maxSize = dash == std::string::npos ? options.minSize : static_cast<uint32_t>(std::stoul(value.substr(dash + 1)));
+                }
+                else if (key == "--reliable") options.reliableFraction = std::stod(value);
+                else if (key == "--seconds") options.seconds = std::stod(value);
+                else if (key == "--warmup") options.warmupSeconds = std::stod(value);
+                else if (key == "--saturate") options.saturate = true;
+                else if (key == "--step") options.step = std::stod(value);
+                else if (key == "--loss-threshold") options.lossThresholdPct = std::stod(value);
+                else if (key == "--csv") options.csvPath = value;
+                else if (key == "--json") options.jsonPath = value;
+                else if (key == "--label") options.label = value;
+                else {
+                    RF_NETWORK_ERROR("Unknown option {}", arg);
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                RF_NETWORK_ERROR("Invalid value in {}", arg);
+                return false;
+            }
+        }
+
+        options.minSize = (std::max)(options.minSize, static_cast<uint32_t>(kHeaderSize));
+        options.maxSize = (std::max)(options.maxSize, options.minSize);
+        options.reliableFraction = (std::clamp)(options.reliableFraction, 0.0, 1.0);
+        if (options.clients == 0 || options.rate <= 0.0 || options.seconds <= 0.0 || options.step <= 1.0) {
+            RF_NETWORK_ERROR("--clients, --rate and --seconds must be positive and --step above 1");
+            return false;
+        }
+        return true;
+    }
+}
+
+// =====================================================================================
+// Main Application Entry Point
+// =====================================================================================
+
+int main(int argc, char** argv)
+{
+    // 1. Initialize Logger
+    RiftNet::Logging::Logger::Init();
+    RF_NETWORK_INFO("--- RiftNet Load Benchmark Client ---");
+
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        RiftNet::Logging::Logger::Shutdown();
         return 1;
     }
 
-    // Write header
-    csv_file << "PingNumber,RTT_us\n";
-    // Write data
-    for (size_t i = 0; i < state.rtt_samples_us.size(); ++i) {
-        csv_file << i + 1 << "," << state.rtt_samples_us[i] << "\n";
+    // 2. Create and connect the clients
+    RiftClientConfig config = {};
+    config.event_callback = ClientEventCallback;
+    config.channel_types = kChannels;
+    config.channel_count = static_cast<uint32_t>(std::size(kChannels));
+
+    std::vector<std::unique_ptr<ClientState>> clients;
+    for (uint32_t i = 0; i < options.clients; ++i) {
+        auto state = std::make_unique<ClientState>();
+        state->index = i;
+        config.user_data = state.get();
+        state->handle = rift_client_create(&config);
+        if (!state->handle) {
+            RF_NETWORK_CRITICAL("Failed to create RiftNet client {}.", i);
+            break;
+        }
+        const RiftResult result = rift_client_connect(state->handle, options.host.c_str(), options.port);
+        if (result != RIFT_SUCCESS) {
+            RF_NETWORK_CRITICAL("Client {} failed to connect. Error code: {}", i, static_cast<int>(result));
+            rift_client_destroy(state->handle);
+            break;
+        }
+        clients.push_back(std::move(state));
+    }
+
+    RF_NETWORK_INFO("Connecting {} client(s) to {}:{}...", clients.size(), options.host, options.port);
+    auto allConnected = [&] {
+        return std::all_of(clients.begin(), clients.end(), [](const auto& c) { return c->connected.load(std::memory_order_acquire); });
+    };
+    const auto connectDeadline = Clock::now() + std::chrono::seconds(10);
+    while (!allConnected() && Clock::now() < connectDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // The phase stats outlive the clients, whose callbacks write to them.
+    std::vector<std::unique_ptr<PhaseStats>> phases;
+    int exitCode = 0;
+
+    if (clients.size() != options.clients || !allConnected()) {
+        RF_NETWORK_CRITICAL("Not every client connected; is BenchServer running?");
+        exitCode = 1;
     }
-    csv_file.close();
+    else {
+        // 3. Run the load: a warmup, then one measured phase or a rising series of them
+        RF_NETWORK_INFO("Sending {} to {} byte messages, {:.0f}% reliable, from {} client(s).",
+            options.minSize, options.maxSize, options.reliableFraction * 100.0, options.clients);
+
+        std::vector<PhaseResult> results;
+        double rate = options.rate;
+        double sustainedRate = 0.0;
+
+        if (options.warmupSeconds > 0.0) {
+            RF_NETWORK_INFO("Warming up for {:.1f}s...", options.warmupSeconds);
+            auto& warmup = *phases.emplace_back(std::make_unique<PhaseStats>());
+            warmup.rate = rate;
+            RunPhase(options, clients, warmup, options.warmupSeconds);
+        }
 
-    double sum = std::accumulate(state.rtt_samples_us.begin(), state.rtt_samples_us.end(), 0.0);
-    double avg_rtt_us = sum / state.rtt_samples_us.size();
+        for (uint32_t step = 1;; ++step) {
+            auto& phase = *phases.emplace_back(std::make_unique<PhaseStats>());
+            phase.id = step;
+            phase.rate = rate;
+            RF_NETWORK_INFO("Step {}: {:.0f} msgs/sec per client ({:.0f} total) for {:.1f}s...",
+                step, rate, rate * options.clients, options.seconds);
+            RunPhase(options, clients, phase, options.seconds);
+
+            const PhaseResult& result = results.emplace_back(Analyze(phase));
+            Report(result);
+
+            const bool clean = result.total.LossPct() <= options.lossThresholdPct && result.total.sendFailures == 0;
+            const bool anyDisconnected = std::any_of(clients.begin(), clients.end(), [](const auto& c) { return c->disconnected.load(); });
+            if (clean) sustainedRate = rate;
+            if (!options.saturate || !clean || anyDisconnected) break;
+            rate *= options.step;
+        }
+
+        if (options.saturate) {
+            RF_NETWORK_INFO("-----------------------------------------");
+            RF_NETWORK_INFO("Saturated after {} step(s); sustained {:.0f} msgs/sec per client ({:.0f} total) within {:.2f}% loss.",
+                results.size(), sustainedRate, sustainedRate * options.clients, options.lossThresholdPct);
+        }
+
+        // 4. Save the results
+        if (!options.csvPath.empty()) AppendCsv(options, results);
+        if (!options.jsonPath.empty()) WriteJson(options, results, sustainedRate);
+        RF_NETWORK_INFO("Load test finished. Disconnecting...");
+    }
 
-    RF_NETWORK_INFO("-----------------------------------------");
-    RF_NETWORK_INFO("Test Complete. Results saved to latency_results.csv");
-    RF_NETWORK_INFO("Samples Collected: {}", state.rtt_samples_us.size());
-    RF_NETWORK_INFO("Average Latency: {:.3f} ms", avg_rtt_us / 1000.0);
-    RF_NETWORK_INFO("-----------------------------------------");
+    // 5. Stop and destroy the clients
+    for (auto& c : clients) rift_client_disconnect(c->handle);
+    for (auto& c : clients) rift_client_destroy(c->handle);
+    clients.clear();
+    RiftNet::Logging::Logger::Shutdown();
 
-    return 0;
+    return exitCode;
 }
@@ -2,11 +2,18 @@
 #include "../utilities/logger/Logger.hpp"        // Your logger
 #include <atomic>
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <mutex>
 #include <thread>
 #include <unordered_set>
-#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h> // GetProcessTimes
 
 // ===============================
 // Connected client tracking
@@ -14,6 +21,27 @@
 namespace {
     std::mutex g_clients_mtx;
     std::unordered_set<RiftClientId> g_clients;
+
+    // Throughput counter for the packets/sec + CPU/packet report
+    std::atomic<uint64_t> g_packets_received{ 0 };
+    std::atomic<uint64_t> g_echo_failures{ 0 };
+
+    // Total user + kernel CPU time consumed by this process, in seconds.
+    double ProcessCpuSeconds() {
+        FILETIME creation{}, exit{}, kernel{}, user{};
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+        auto to100ns = [](const FILETIME& ft) {
+            return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+        };
+        return static_cast<double>(to100ns(kernel) + to100ns(user)) / 1e7;
+    }
+
+    const char* BackendName(RiftIoBackend backend) {
+        return backend == RIFT_IO_BACKEND_RIO ? "RIO" : "IOCP";
+    }
+
+    // Channels BenchClient's load mode sends on; messages are echoed on the channel they came in on.
+    const RiftChannelType kEchoChannels[] = { RIFT_CHANNEL_RELIABLE_UNORDERED, RIFT_CHANNEL_UNRELIABLE_SEQUENCED };
 }
 
 // ===============================
@@ -37,21 +65,22 @@ void ServerEventCallback(const RiftEvent* event, void* user_data)
         break;
     }
     case RIFT_EVENT_PACKET_RECEIVED: {
+        g_packets_received.fetch_add(1, std::memory_order_relaxed);
+
         // Echo back immediately  **reliable** to ensure ACK piggyback and RTT samples.
         const auto size = static_cast<size_t>(event->data.packet.size);
         RF_NETWORK_TRACE("Server: Echoing {} bytes back to client ID {}.",
             size, event->data.packet.sender_id);
 
-        // If your library exposes rift_server_send_reliable, prefer that here.
-        // Otherwise, rift_server_send defaults to reliable in the refactor.
-        RiftResult rc = rift_server_send(
-            serverHandle,
-            event->data.packet.sender_id,
-            event->data.packet.data,
-            size
-        );
+        // Default-channel messages go back reliably; channel messages go back on their own channel,
+        // so BenchClient's unreliable load stays unreliable both ways.
+        const uint8_t channel = event->data.packet.channel;
+        RiftResult rc = channel == RIFT_DEFAULT_CHANNEL
+            ? rift_server_send(serverHandle, event->data.packet.sender_id, event->data.packet.data, size)
+            : rift_server_send_channel(serverHandle, event->data.packet.sender_id, channel, event->data.packet.data, size);
         if (rc != RIFT_SUCCESS) {
-            RF_NETWORK_ERROR("Server: echo send failed for client {} (rc={})",
+            g_echo_failures.fetch_add(1, std::memory_order_relaxed);
+            RF_NETWORK_ERROR_EVERY(1000, "Server: echo send failed for client {} (rc={})",
                 event->data.packet.sender_id, static_cast<int>(rc));
         }
         break;
@@ -70,13 +99,22 @@ void ServerEventCallback(const RiftEvent* event, void* user_data)
 // ===============================
 // Main
 // ===============================
-int main()
+// Usage: BenchServer [--io=iocp|rio]
+// Run once per backend under the same BenchClient load to compare packets/sec and CPU per packet.
+int main(int argc, char** argv)
 {
     using namespace std::chrono_literals;
 
+    RiftIoBackend backend = RIFT_IO_BACKEND_IOCP;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--io=rio") == 0) backend = RIFT_IO_BACKEND_RIO;
+        else if (std::strcmp(argv[i], "--io=iocp") == 0) backend = RIFT_IO_BACKEND_IOCP;
+    }
+
     // 1) Logger
     RiftNet::Logging::Logger::Init();
     RF_NETWORK_INFO("--- RiftNet Latency Benchmark Server ---");
+    RF_NETWORK_INFO("I/O backend: {}", BackendName(backend));
 
     // 2) Config
     RiftServerHandle serverHandle = nullptr;
@@ -86,6 +124,9 @@ int main()
     config.port = 8888;
     config.event_callback = ServerEventCallback;
     config.user_data = &serverHandle; // callback can call API via this
+    config.io_backend = backend;
+    config.channel_types = kEchoChannels;
+    config.channel_count = static_cast<uint32_t>(std::size(kEchoChannels));
 
     // 3) Create + start
     serverHandle = rift_server_create(&config);
@@ -102,30 +143,32 @@ int main()
         return 1;
     }
 
-    // 4) Heartbeat thread: force periodic server->client reliable packets
-    //    so any pending ACKs get piggybacked (feeds client RTT sampler).
-    std::jthread heartbeat([&](std::stop_token st) {
-        static const uint8_t hb[1] = { 0xF0 };
+    // 4) Throughput report: received packets/sec, process CPU time per packet and failed echoes
+    std::jthread stats([&](std::stop_token st) {
+        constexpr auto kInterval = 5s;
+        uint64_t lastPackets = g_packets_received.load(std::memory_order_relaxed);
+        double lastCpu = ProcessCpuSeconds();
+        auto lastTime = std::chrono::steady_clock::now();
+
         while (!st.stop_requested()) {
-            std::this_thread::sleep_for(500ms);
-
-            std::vector<RiftClientId> snapshot;
-            {
-                std::lock_guard<std::mutex> lock(g_clients_mtx);
-                snapshot.reserve(g_clients.size());
-                for (auto id : g_clients) snapshot.push_back(id);
-            }
-
-            if (snapshot.empty()) continue;
-
-            for (auto id : snapshot) {
-                const RiftResult rc = rift_server_send(serverHandle, id, hb, sizeof(hb)); // reliable
-                if (rc != RIFT_SUCCESS) {
-                    RF_NETWORK_WARN("Heartbeat send failed to client {} (rc={})",
-                        id, static_cast<int>(rc));
-                }
-            }
-            RF_NETWORK_TRACE("Heartbeat sent to {} clients", snapshot.size());
+            std::this_thread::sleep_for(kInterval);
+
+            const uint64_t packets = g_packets_received.load(std::memory_order_relaxed);
+            const double cpu = ProcessCpuSeconds();
+            const auto now = std::chrono::steady_clock::now();
+
+            const uint64_t deltaPackets = packets - lastPackets;
+            const double seconds = std::chrono::duration<double>(now - lastTime).count();
+            const double pps = seconds > 0.0 ? static_cast<double>(deltaPackets) / seconds : 0.0;
+            const double cpuPerPacketUs = deltaPackets > 0 ? (cpu - lastCpu) * 1e6 / static_cast<double>(deltaPackets) : 0.0;
+
+            RF_NETWORK_INFO("[{}] {:.0f} packets/sec, {:.2f} us CPU/packet ({} packets in {:.1f}s, {} failed echoes)",
+                BackendName(backend), pps, cpuPerPacketUs, deltaPackets, seconds,
+                g_echo_failures.load(std::memory_order_relaxed));
+
+            lastPackets = packets;
+            lastCpu = cpu;
+            lastTime = now;
         }
         });
 
@@ -135,10 +178,11 @@ int main()
 
     // 6) Shutdown
     RF_NETWORK_INFO("Shutdown signal received. Stopping server...");
-    heartbeat.request_stop();
+    stats.request_stop();
     rift_server_stop(serverHandle);
     rift_server_destroy(serverHandle);
     RF_NETWORK_INFO("Server shut down cleanly.");
+    RiftNet::Logging::Logger::Shutdown();
 
     return 0;
 }
@@ -0,0 +1,414 @@
+#include "../include/RiftNet/RiftServer.hpp"                  // RiftNet server C API
+#include "../include/RiftNet/RiftClient.hpp"                  // RiftNet client C API
+#include "../src/core/captureio/PacketCapture.hpp"            // reads what capture_path recorded
+#include "../utilities/logger/Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h> // GetProcessTimes
+
+// Usage: CaptureReplay --capture=FILE [--speed=1.0] [--port=8890] [--io=iocp|rio]
+//                      [--host=HOST] [--channels=ordered|unordered|sequenced]
+//                      [--csv=replay_results.csv] [--label=NAME]
+//
+// Replays the messages a server recorded with capture_path. Every client in the capture gets its own
+// RiftClient, which sends that client's messages on the channel they arrived on, at the recorded times
+// divided by --speed (0 = as fast as the clients can send). By default the messages go to a server
+// started in this process on --port, whose receive rate, CPU per message and stats are reported; with
+// --host they go to a server running elsewhere and only the send side is reported. The capture does
+// not record channel types, so every channel is opened as --channels. Each run appends a row to --csv.
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using RiftNet::Networking::CaptureReader;
+    using RiftNet::Networking::CaptureRecord;
+    using RiftNet::Networking::CaptureRecordKind;
+
+    struct Options {
+        std::string capturePath;
+        double speed = 1.0;
+        uint16_t port = 8890;
+        RiftIoBackend backend = RIFT_IO_BACKEND_IOCP;
+        std::string host;             // empty: replay into a server started here
+        RiftChannelType channelType = RIFT_CHANNEL_RELIABLE_ORDERED;
+        std::string csvPath = "replay_results.csv";
+        std::string label = "replay";
+    };
+
+    // One message to replay, pointing into the capture's mapping
+    struct Message {
+        std::chrono::microseconds time;
+        size_t client;                // index into the replay clients
+        uint8_t channel;
+        const uint8_t* data;
+        uint32_t size;
+    };
+
+    // What the capture holds, besides the messages
+    struct CaptureSummary {
+        uint64_t datagramsReceived = 0;
+        uint64_t bytesReceived = 0;
+        uint64_t datagramsSent = 0;
+        uint64_t bytesSent = 0;
+        uint64_t payloadBytes = 0;
+        uint32_t minPayload = UINT32_MAX;
+        uint32_t maxPayload = 0;
+        std::chrono::microseconds duration{ 0 };
+    };
+
+    struct ReplayClient {
+        RiftClientHandle handle = nullptr;
+        uint64_t recordedId = 0;
+        std::atomic<bool> connected{ false };
+    };
+
+    std::atomic<uint64_t> g_server_received{ 0 };
+    std::atomic<uint64_t> g_server_bytes{ 0 };
+
+    // Total user + kernel CPU time consumed by this process, in seconds.
+    double ProcessCpuSeconds() {
+        FILETIME creation{}, exit{}, kernel{}, user{};
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+        auto to100ns = [](const FILETIME& ft) {
+            return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+        };
+        return static_cast<double>(to100ns(kernel) + to100ns(user)) / 1e7;
+    }
+
+    void ServerEventCallback(const RiftEvent* event, void*) {
+        if (event->type == RIFT_EVENT_PACKET_RECEIVED) {
+            g_server_received.fetch_add(1, std::memory_order_relaxed);
+            g_server_bytes.fetch_add(event->data.packet.size, std::memory_order_relaxed);
+        }
+    }
+
+    void ClientEventCallback(const RiftEvent* event, void* user_data) {
+        auto* client = static_cast<ReplayClient*>(user_data);
+        if (event->type == RIFT_EVENT_CLIENT_CONNECTED) {
+            client->connected.store(true, std::memory_order_release);
+        }
+        else if (event->type == RIFT_EVENT_CLIENT_DISCONNECTED) {
+            RF_NETWORK_WARN("Replay client for recorded client {} disconnected.", client->recordedId);
+            client->connected.store(false, std::memory_order_release);
+        }
+    }
+
+    // =====================================================================================
+    // Capture
+    // =====================================================================================
+
+    // Collects the messages in record order, and one replay client slot per recorded client.
+    void LoadCapture(CaptureReader& reader, std::vector<Message>& messages, std::vector<uint64_t>& clientIds,
+        CaptureSummary& summary) {
+        std::map<uint64_t, size_t> clientIndex;
+        CaptureRecord record;
+        while (reader.Next(record)) {
+            summary.duration = (std::max)(summary.duration, record.time);
+            const auto size = static_cast<uint32_t>(record.data.size());
+            switch (record.kind) {
+            case CaptureRecordKind::Received:
+                ++summary.datagramsReceived;
+                summary.bytesReceived += size;
+                break;
+            case CaptureRecordKind::Sent:
+                ++summary.datagramsSent;
+                summary.bytesSent += size;
+                break;
+            case CaptureRecordKind::Payload: {
+                auto [it, added] = clientIndex.try_emplace(record.clientId, clientIds.size());
+                if (added) clientIds.push_back(record.clientId);
+                messages.push_back({ record.time, it->second, record.channel, record.data.data(), size });
+                summary.payloadBytes += size;
+                summary.minPayload = (std::min)(summary.minPayload, size);
+                summary.maxPayload = (std::max)(summary.maxPayload, size);
+                break;
+            }
+            }
+        }
+        // Records are appended as their threads reserve them, so neighbours can be a few us out of order
+        std::stable_sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) { return a.time < b.time; });
+    }
+
+    void ReportCapture(const CaptureReader& reader, const CaptureSummary& s, size_t messages, size_t clients) {
+        const auto& header = reader.GetHeader();
+        RF_NETWORK_INFO("Capture: {:.1f}s, {} records ({} dropped when full)",
+            std::chrono::duration<double>(s.duration).count(), header.recordCount, header.droppedRecords);
+        RF_NETWORK_INFO("  datagrams in {} ({} bytes), out {} ({} bytes)", s.datagramsReceived, s.bytesReceived,
+            s.datagramsSent, s.bytesSent);
+        RF_NETWORK_INFO("  messages {} from {} client(s), {} to {} bytes, mean {:.1f}", messages, clients,
+            messages ? s.minPayload : 0, s.maxPayload,
+            messages ? static_cast<double>(s.payloadBytes) / static_cast<double>(messages) : 0.0);
+    }
+
+    // =====================================================================================
+    // Replay
+    // =====================================================================================
+
+    RiftResult SendRecorded(const ReplayClient& client, const Message& message) {
+        if (message.channel == RIFT_SNAPSHOT_CHANNEL) {
+            return rift_client_send_snapshot(client.handle, message.data, message.size);
+        }
+        if (message.channel == RIFT_DEFAULT_CHANNEL) {
+            return rift_client_send(client.handle, message.data, message.size);
+        }
+        return rift_client_send_channel(client.handle, message.channel, message.data, message.size);
+    }
+
+    struct ReplayResult {
+        uint64_t sent = 0;
+        uint64_t refused = 0;
+        uint64_t skipped = 0;   // channels the clients do not have
+        double seconds = 0.0;   // first send to last send
+        double lateUsMax = 0.0; // furthest a send fell behind its schedule
+    };
+
+    ReplayResult Replay(const Options& options, const std::vector<Message>& messages,
+        std::vector<std::unique_ptr<ReplayClient>>& clients) {
+        ReplayResult result;
+        if (messages.empty()) return result;
+
+        const auto origin = messages.front().time;
+        const auto start = Clock::now();
+        for (const Message& message : messages) {
+            if (options.speed > 0.0) {
+                const auto offset = std::chrono::duration<double, std::micro>(message.time - origin) / options.speed;
+                const auto due = start + std::chrono::duration_cast<Clock::duration>(offset);
+                const auto now = Clock::now();
+                if (due > now) std::this_thread::sleep_until(due);
+                else result.lateUsMax = (std::max)(result.lateUsMax, std::chrono::duration<double, std::micro>(now - due).count());
+            }
+            if (message.channel >= RIFT_MAX_CHANNELS && message.channel != RIFT_DEFAULT_CHANNEL &&
+                message.channel != RIFT_SNAPSHOT_CHANNEL) {
+                ++result.skipped;
+                continue;
+            }
+            if (SendRecorded(*clients[message.client], message) == RIFT_SUCCESS) ++result.sent;
+            else ++result.refused;
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return result;
+    }
+
+    // Waits until the server has raised every message sent, or no more arrive for 2 s.
+    void Drain(uint64_t expected) {
+        uint64_t last = g_server_received.load(std::memory_order_relaxed);
+        auto lastChange = Clock::now();
+        while (last < expected && Clock::now() - lastChange < std::chrono::seconds(2)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            const uint64_t now = g_server_received.load(std::memory_order_relaxed);
+            if (now != last) {
+                last = now;
+                lastChange = Clock::now();
+            }
+        }
+    }
+
+    void AppendCsv(const Options& options, const CaptureSummary& capture, const ReplayResult& r, size_t clients,
+        uint64_t received, double seconds, double cpuPerMessageUs) {
+        const bool exists = std::ifstream(options.csvPath).good();
+        std::ofstream csv(options.csvPath, std::ios::app);
+        if (!csv.is_open()) {
+            RF_NETWORK_ERROR("Failed to open {} for writing.", options.csvPath);
+            return;
+        }
+        if (!exists) {
+            csv << "label,timestamp,capture,speed,clients,recorded_seconds,replay_seconds,"
+                   "sent,refused,skipped,received,receive_pps,cpu_us_per_message,late_us_max\n";
+        }
+        const auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        csv << options.label << ',' << timestamp << ',' << options.capturePath << ',' << options.speed << ',' << clients << ','
+            << std::chrono::duration<double>(capture.duration).count() << ',' << seconds << ','
+            << r.sent << ',' << r.refused << ',' << r.skipped << ',' << received << ','
+            << (seconds > 0.0 ? static_cast<double>(received) / seconds : 0.0) << ','
+            << cpuPerMessageUs << ',' << r.lateUsMax << '\n';
+        RF_NETWORK_INFO("Results appended to {}", options.csvPath);
+    }
+
+    // =====================================================================================
+    // Command line
+    // =====================================================================================
+
+    bool ParseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            const size_t eq = arg.find('=');
+            const std::string key = arg.substr(0, eq);
+            const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+            try {
+                if (key == "--capture") options.capturePath = value;
+                else if (key == "--speed") options.speed = std::stod(value);
+                else if (key == "--port") options.port = static_cast<uint16_t>(std::stoul(value));
+                else if (key == "--io") options.backend = value == "rio" ? RIFT_IO_BACKEND_RIO : RIFT_IO_BACKEND_IOCP;
+                else if (key == "--host") options.host = value;
+                else if (key == "--channels") {
+                    if (value == "ordered") options.channelType = RIFT_CHANNEL_RELIABLE_ORDERED;
+                    else if (value == "unordered") options.channelType = RIFT_CHANNEL_RELIABLE_UNORDERED;
+                    else if (value == "sequenced") options.channelType = RIFT_CHANNEL_UNRELIABLE_SEQUENCED;
+                    else throw std::invalid_argument(value);
+                }
+                else if (key == "--csv") options.csvPath = value;
+                else if (key == "--label") options.label = value;
+                else {
+                    RF_NETWORK_ERROR("Unknown option {}", arg);
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                RF_NETWORK_ERROR("Invalid value in {}", arg);
+                return false;
+            }
+        }
+        if (options.capturePath.empty() || options.speed < 0.0) {
+            RF_NETWORK_ERROR("--capture is required and --speed cannot be negative");
+            return false;
+        }
+        return true;
+    }
+}
+
+// =====================================================================================
+// Main Application Entry Point
+// =====================================================================================
+
+int main(int argc, char** argv)
+{
+    // 1. Initialize Logger
+    RiftNet::Logging::Logger::Init();
+    RF_NETWORK_INFO("--- RiftNet Capture Replay ---");
+
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        RiftNet::Logging::Logger::Shutdown();
+        return 1;
+    }
+
+    // 2. Load the capture; the messages point into its mapping, so it stays open until the end
+    auto reader = CaptureReader::Open(options.capturePath);
+    if (!reader) {
+        RiftNet::Logging::Logger::Shutdown();
+        return 1;
+    }
+    std::vector<Message> messages;
+    std::vector<uint64_t> clientIds;
+    CaptureSummary capture;
+    LoadCapture(*reader, messages, clientIds, capture);
+    ReportCapture(*reader, capture, messages.size(), clientIds.size());
+    if (messages.empty()) {
+        RF_NETWORK_ERROR("The capture holds no messages to replay.");
+        RiftNet::Logging::Logger::Shutdown();
+        return 1;
+    }
+
+    // 3. Start the server under test, unless the replay goes elsewhere
+    RiftServerHandle server = nullptr;
+    const bool local = options.host.empty();
+    if (local) {
+        RiftServerConfig serverConfig{};
+        serverConfig.host_address = "127.0.0.1";
+        serverConfig.port = options.port;
+        serverConfig.event_callback = ServerEventCallback;
+        serverConfig.io_backend = options.backend;
+        server = rift_server_create(&serverConfig);
+        if (!server || rift_server_start(server) != RIFT_SUCCESS) {
+            RF_NETWORK_CRITICAL("Failed to start the RiftNet server on port {}.", options.port);
+            if (server) rift_server_destroy(server);
+            RiftNet::Logging::Logger::Shutdown();
+            return 1;
+        }
+    }
+    const std::string host = local ? "127.0.0.1" : options.host;
+
+    // 4. One client per recorded client, with every channel a recorded message may name
+    std::vector<RiftChannelType> channels(RIFT_MAX_CHANNELS, options.channelType);
+    RiftClientConfig clientConfig{};
+    clientConfig.event_callback = ClientEventCallback;
+    clientConfig.channel_types = channels.data();
+    clientConfig.channel_count = RIFT_MAX_CHANNELS;
+
+    std::vector<std::unique_ptr<ReplayClient>> clients;
+    for (uint64_t id : clientIds) {
+        auto client = std::make_unique<ReplayClient>();
+        client->recordedId = id;
+        clientConfig.user_data = client.get();
+        client->handle = rift_client_create(&clientConfig);
+        if (!client->handle || rift_client_connect(client->handle, host.c_str(), options.port) != RIFT_SUCCESS) {
+            RF_NETWORK_CRITICAL("Failed to connect a replay client for recorded client {}.", id);
+            if (client->handle) rift_client_destroy(client->handle);
+            break;
+        }
+        clients.push_back(std::move(client));
+    }
+
+    auto allConnected = [&] {
+        return std::all_of(clients.begin(), clients.end(), [](const auto& c) { return c->connected.load(std::memory_order_acquire); });
+    };
+    const auto connectDeadline = Clock::now() + std::chrono::seconds(10);
+    while (!allConnected() && Clock::now() < connectDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    int exitCode = 0;
+    if (clients.size() != clientIds.size() || !allConnected()) {
+        RF_NETWORK_CRITICAL("Not every replay client connected to {}:{}.", host, options.port);
+        exitCode = 1;
+    }
+    else {
+        // 5. Replay, then let the server catch up before measuring
+        RF_NETWORK_INFO("Replaying {} messages from {} client(s) at {}...", messages.size(), clients.size(),
+            options.speed > 0.0 ? std::to_string(options.speed) + "x" : std::string("full speed"));
+        const uint64_t receivedBefore = g_server_received.load(std::memory_order_relaxed);
+        const double cpuBefore = ProcessCpuSeconds();
+        const auto start = Clock::now();
+
+        const ReplayResult result = Replay(options, messages, clients);
+        if (local) Drain(receivedBefore + result.sent);
+
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        const double cpu = ProcessCpuSeconds() - cpuBefore;
+        const uint64_t received = g_server_received.load(std::memory_order_relaxed) - receivedBefore;
+
+        // 6. Report; the clients run in this process too, so CPU per message covers both ends
+        RF_NETWORK_INFO("-----------------------------------------");
+        RF_NETWORK_INFO("Sent {} messages in {:.2f}s ({:.0f}/s), refused {}, skipped {}, at most {:.0f} us behind schedule",
+            result.sent, result.seconds, result.seconds > 0.0 ? static_cast<double>(result.sent) / result.seconds : 0.0,
+            result.refused, result.skipped, result.lateUsMax);
+        double cpuPerMessageUs = 0.0;
+        if (local) {
+            cpuPerMessageUs = received > 0 ? cpu * 1e6 / static_cast<double>(received) : 0.0;
+            RiftStats stats{};
+            rift_server_get_stats(server, &stats);
+            RF_NETWORK_INFO("Server raised {} messages ({} bytes) in {:.2f}s ({:.0f}/s), {:.2f} us CPU/message",
+                received, g_server_bytes.load(std::memory_order_relaxed), seconds,
+                seconds > 0.0 ? static_cast<double>(received) / seconds : 0.0, cpuPerMessageUs);
+            RF_NETWORK_INFO("Server datagrams in {} ({} bytes), out {} ({} bytes), retransmits {}, receive pool growths {}",
+                stats.packets_received, stats.bytes_received, stats.packets_sent, stats.bytes_sent,
+                stats.retransmits, stats.receive_pool_exhausted);
+        }
+        if (!options.csvPath.empty()) AppendCsv(options, capture, result, clients.size(), received, seconds, cpuPerMessageUs);
+    }
+
+    // 7. Tear down
+    for (auto& c : clients) rift_client_disconnect(c->handle);
+    for (auto& c : clients) rift_client_destroy(c->handle);
+    clients.clear();
+    if (server) {
+        rift_server_stop(server);
+        rift_server_destroy(server);
+    }
+    RiftNet::Logging::Logger::Shutdown();
+
+    return exitCode;
+}
@@ -0,0 +1,580 @@
+// MicroBench: Google Benchmark timings of each stage a packet goes through, without sockets.
+// Every benchmark reports ns/op and allocs/op (global operator new calls per iteration), so a
+// change to one stage can be checked in isolation before it is measured end to end with
+// BenchServer / BenchClient.
+//
+// Usage: MicroBench [--benchmark_filter=<regex>] [--benchmark_repetitions=N]
+//                   [--benchmark_format=console|json|csv] [--benchmark_out=<file>]
+//
+// Stages:
+//   PacketFactory     ParsePacket, CreateReliableDataPacket, CreateUnreliableDataPacket (by payload bytes)
+//   Reliability       ProcessIncomingHeader with N reliable packets in flight (each op also sends one,
+//                     so the count stays at N; N > 31 runs with the extended header)
+//   Compressor        CompressInto / Decompress of game-state-like and random payloads (by bytes)
+//   Encryptor         EncryptInto / Decrypt (by bytes)
+//   NetworkEndpoint   std::hash, a lookup in a 1024-client map, parsing and formatting
+//   Connection        a secure client -> server message through both Connections, frames copied
+//                     in memory instead of sent; reliable runs carry the server's acks back
+
+#include "../src/core/connection/Connection.hpp"
+#include "../src/core/buffer/PacketBuffer.hpp"
+#include "../src/core/networkio/NetworkEndpoint.hpp"
+#include "../src/protocol/PacketFactory/PacketFactory.hpp"
+#include "../src/protocol/UDPReliabilityProtocol/UDPReliabilityProtocol.hpp"
+#include "../src/compression/Compressor/Compressor.hpp"
+#include "../src/security/Crypto/Encryptor.hpp"
+#include "../src/security/Handshake/Handshake.hpp"
+#include "../src/security/HandshakeCookie/HandshakeCookie.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace RiftNet;
+using Clock = std::chrono::steady_clock;
+
+// =====================================================================================
+// Allocation counting
+// =====================================================================================
+
+namespace {
+    std::atomic<uint64_t> g_allocations{ 0 };
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+#ifdef _MSC_VER
+    if (void* p = _aligned_malloc(size != 0 ? size : 1, static_cast<size_t>(alignment))) return p;
+#else
+    if (void* p = std::aligned_alloc(static_cast<size_t>(alignment),
+        (size + static_cast<size_t>(alignment) - 1) & ~(static_cast<size_t>(alignment) - 1))) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#ifdef _MSC_VER
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+namespace {
+
+    // Counts the allocations made while the benchmark loop runs; construct it right before the loop.
+    class AllocationCounter {
+    public:
+        AllocationCounter() : m_start(g_allocations.load(std::memory_order_relaxed)) {}
+
+        void Report(benchmark::State& state) const {
+            const uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - m_start;
+            state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations),
+                benchmark::Counter::kAvgIterations);
+        }
+
+    private:
+        uint64_t m_start;
+    };
+
+    // =====================================================================================
+    // Payloads
+    // =====================================================================================
+
+    // A JSON-ish entity snapshot, like the state updates games send: compresses well.
+    std::vector<uint8_t> MakeGameState(size_t size, uint32_t seed = 1) {
+        std::mt19937 rng(seed);
+        std::string text;
+        for (uint32_t entity = 0; text.size() < size; ++entity) {
+            text += "{\"id\":" + std::to_string(entity) +
+                ",\"x\":" + std::to_string(rng() % 4096) +
+                ",\"y\":" + std::to_string(rng() % 4096) +
+                ",\"hp\":" + std::to_string(rng() % 100) + ",\"state\":\"idle\"},";
+        }
+        return std::vector<uint8_t>(text.begin(), text.begin() + size);
+    }
+
+    // Incompressible bytes, e.g. already compressed or encrypted data.
+    std::vector<uint8_t> MakeRandom(size_t size, uint32_t seed = 1) {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> bytes(size);
+        for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+        return bytes;
+    }
+
+    Networking::PacketBufferPtr MakePayloadBuffer(size_t size) {
+        auto packet = Networking::PacketBuffer::Create(size);
+        std::memset(packet->Append(size), 0x5A, size);
+        return packet;
+    }
+
+    // =====================================================================================
+    // PacketFactory
+    // =====================================================================================
+
+    void BM_ParsePacket(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        Protocol::ReliableConnectionState reliability;
+        auto packet = MakePayloadBuffer(size);
+        Protocol::PacketFactory::CreateReliableDataPacket(reliability, packet);
+        const std::vector<uint8_t> wire(packet->Data(), packet->Data() + packet->Size());
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            Protocol::GeneralPacketHeader general{};
+            Protocol::ExtendedReliabilityPacketHeader header{};
+            const uint8_t* payload = nullptr;
+            uint32_t payloadSize = 0;
+            const bool ok = Protocol::PacketFactory::ParsePacket(wire.data(), static_cast<uint32_t>(wire.size()),
+                general, header, payload, payloadSize);
+            benchmark::DoNotOptimize(ok);
+            benchmark::DoNotOptimize(payload);
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * wire.size()));
+    }
+    BENCHMARK(BM_ParsePacket)->Arg(16)->Arg(256)->Arg(1100);
+
+    // Includes allocating the PacketBuffer, as Connection does for every send.
+    void BM_CreateReliableDataPacket(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        const std::vector<uint8_t> payload = MakeGameState(size);
+        auto reliability = std::make_unique<Protocol::ReliableConnectionState>();
+        uint32_t inFlight = 0;
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            if (inFlight == Protocol::UDPReliabilityProtocol::GetSendWindowSize(*reliability)) {
+                // The window is full: start over with a fresh connection, off the clock.
+                state.PauseTiming();
+                reliability = std::make_unique<Protocol::ReliableConnectionState>();
+                inFlight = 0;
+                state.ResumeTiming();
+            }
+            auto packet = Networking::PacketBuffer::Create(size);
+            std::memcpy(packet->Append(size), payload.data(), size);
+            const bool ok = Protocol::PacketFactory::CreateReliableDataPacket(*reliability, packet);
+            benchmark::DoNotOptimize(ok);
+            ++inFlight;
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_CreateReliableDataPacket)->Arg(16)->Arg(256)->Arg(1100);
+
+    void BM_CreateUnreliableDataPacket(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        const std::vector<uint8_t> payload = MakeGameState(size);
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            auto packet = Networking::PacketBuffer::Create(size);
+            std::memcpy(packet->Append(size), payload.data(), size);
+            const bool ok = Protocol::PacketFactory::CreateUnreliableDataPacket(*packet);
+            benchmark::DoNotOptimize(ok);
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_CreateUnreliableDataPacket)->Arg(16)->Arg(256)->Arg(1100);
+
+    // =====================================================================================
+    // UDPReliabilityProtocol
+    // =====================================================================================
+
+    // Each op sends one reliable packet and processes a peer header that acks the packet sent
+    // range(0) ops earlier, so the unacked list holds range(0) packets throughout.
+    void BM_ProcessIncomingHeader(benchmark::State& state) {
+        const uint32_t inFlight = static_cast<uint32_t>(state.range(0));
+        auto reliability = std::make_unique<Protocol::ReliableConnectionState>();
+        if (inFlight >= Protocol::AckWindowSize(Protocol::ReliabilityHeaderFormat::Compact)) {
+            Protocol::UDPReliabilityProtocol::SetHeaderFormat(*reliability, Protocol::ReliabilityHeaderFormat::Extended);
+        }
+        if (inFlight >= Protocol::UDPReliabilityProtocol::GetSendWindowSize(*reliability)) {
+            state.SkipWithError("more packets in flight than the send window holds");
+            return;
+        }
+
+        Clock::time_point now = Clock::now();
+        for (uint32_t i = 0; i < inFlight; ++i) {
+            Protocol::UDPReliabilityProtocol::PrepareOutgoingPacket(*reliability, MakePayloadBuffer(64),
+                Protocol::PacketType::Data_Reliable, now);
+        }
+
+        Protocol::ExtendedReliabilityPacketHeader header{};
+        header.ack_bitfield[0] = ~0ull;
+        header.ack_bitfield[1] = ~0ull;
+        uint32_t peerSequence = 1;
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            now += std::chrono::microseconds(100);
+            Protocol::UDPReliabilityProtocol::PrepareOutgoingPacket(*reliability, MakePayloadBuffer(64),
+                Protocol::PacketType::Data_Reliable, now);
+
+            header.sequence = peerSequence++;
+            header.ack = reliability->nextOutgoingSequence.load(std::memory_order_relaxed) - 1 - inFlight;
+            const bool isNew = Protocol::UDPReliabilityProtocol::ProcessIncomingHeader(*reliability, header, now);
+            benchmark::DoNotOptimize(isNew);
+        }
+        allocations.Report(state);
+        state.counters["unacked"] = static_cast<double>(reliability->unackedCount.load(std::memory_order_relaxed));
+    }
+    BENCHMARK(BM_ProcessIncomingHeader)->Arg(0)->Arg(8)->Arg(30)->Arg(64)->Arg(126);
+
+    // The retransmit pass of a connection update with range(0) packets in flight, none of them due:
+    // the sweep and the next deadline read only the dense due times, never a SentPacket.
+    void BM_RetransmitSweep(benchmark::State& state) {
+        const uint32_t inFlight = static_cast<uint32_t>(state.range(0));
+        auto reliability = std::make_unique<Protocol::ReliableConnectionState>();
+        Protocol::UDPReliabilityProtocol::SetHeaderFormat(*reliability, Protocol::ReliabilityHeaderFormat::Extended);
+
+        const Clock::time_point now = Clock::now();
+        for (uint32_t i = 0; i < inFlight; ++i) {
+            Protocol::UDPReliabilityProtocol::PrepareOutgoingPacket(*reliability, MakePayloadBuffer(64),
+                Protocol::PacketType::Data_Reliable, now);
+        }
+
+        uint64_t resent = 0;
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            Protocol::UDPReliabilityProtocol::ProcessRetransmissions(*reliability, now,
+                [&resent](const Networking::PacketBufferPtr&) { ++resent; });
+            benchmark::DoNotOptimize(Protocol::UDPReliabilityProtocol::GetNextRetransmitTime(*reliability));
+        }
+        allocations.Report(state);
+        state.counters["resent"] = static_cast<double>(resent);
+    }
+    BENCHMARK(BM_RetransmitSweep)->Arg(8)->Arg(32)->Arg(128);
+
+    // =====================================================================================
+    // Compressor
+    // =====================================================================================
+
+    template <std::vector<uint8_t> (*MakePayload)(size_t, uint32_t)>
+    void BM_Compress(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        const std::vector<uint8_t> payload = MakePayload(size, 1);
+        std::vector<uint8_t> frame(Compression::Compressor::CompressBound(size));
+        Compression::Compressor compressor;
+
+        size_t frameSize = 0;
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            frameSize = compressor.CompressInto(payload, frame);
+            benchmark::DoNotOptimize(frameSize);
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+        state.counters["ratio"] = frameSize > 0 ? static_cast<double>(size) / static_cast<double>(frameSize) : 0.0;
+    }
+    BENCHMARK_TEMPLATE(BM_Compress, MakeGameState)->Arg(64)->Arg(256)->Arg(1024)->Arg(16384);
+    BENCHMARK_TEMPLATE(BM_Compress, MakeRandom)->Arg(64)->Arg(1024);
+
+    template <std::vector<uint8_t> (*MakePayload)(size_t, uint32_t)>
+    void BM_Decompress(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        const std::vector<uint8_t> payload = MakePayload(size, 1);
+        std::vector<uint8_t> frame(Compression::Compressor::CompressBound(size));
+        Compression::Compressor compressor;
+        frame.resize(compressor.CompressInto(payload, frame));
+        std::vector<uint8_t> out(size);
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            size_t outSize = 0;
+            const bool ok = compressor.Decompress(frame, out, outSize);
+            benchmark::DoNotOptimize(ok);
+            benchmark::DoNotOptimize(out.data());
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK_TEMPLATE(BM_Decompress, MakeGameState)->Arg(64)->Arg(256)->Arg(1024)->Arg(16384);
+    BENCHMARK_TEMPLATE(BM_Decompress, MakeRandom)->Arg(64)->Arg(1024);
+
+    // =====================================================================================
+    // Encryptor
+    // =====================================================================================
+
+    struct SessionPair {
+        Security::Encryptor client{ false };
+        Security::Encryptor server{ true };
+
+        SessionPair() {
+            client.InitializeSession(server.GetPublicKey());
+            server.InitializeSession(client.GetPublicKey());
+        }
+    };
+
+    void BM_Encrypt(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        SessionPair session;
+        std::vector<uint8_t> buffer(size + Security::Encryptor::kTagSize);
+        const std::vector<uint8_t> payload = MakeRandom(size);
+        uint64_t nonce = 0;
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            std::memcpy(buffer.data(), payload.data(), size);
+            const size_t sealed = session.client.EncryptInto({ buffer.data(), size }, buffer, ++nonce);
+            benchmark::DoNotOptimize(sealed);
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_Encrypt)->Arg(16)->Arg(256)->Arg(1200);
+
+    void BM_Decrypt(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        SessionPair session;
+        const std::vector<uint8_t> payload = MakeRandom(size);
+        std::vector<uint8_t> sealed(size + Security::Encryptor::kTagSize);
+        constexpr uint64_t kNonce = 1;
+        sealed.resize(session.client.EncryptInto(payload, sealed, kNonce));
+        std::vector<uint8_t> out(size);
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            size_t outSize = 0;
+            const bool ok = session.server.Decrypt(sealed, out, kNonce, outSize);
+            benchmark::DoNotOptimize(ok);
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    }
+    BENCHMARK(BM_Decrypt)->Arg(16)->Arg(256)->Arg(1200);
+
+    // =====================================================================================
+    // NetworkEndpoint
+    // =====================================================================================
+
+    std::vector<Networking::NetworkEndpoint> MakeEndpoints(size_t count) {
+        std::vector<Networking::NetworkEndpoint> endpoints;
+        for (size_t i = 0; i < count; ++i) {
+            endpoints.emplace_back("10.0." + std::to_string((i / 250) % 256) + "." + std::to_string(i % 250 + 1),
+                static_cast<uint16_t>(50000 + i % 1000));
+        }
+        return endpoints;
+    }
+
+    void BM_EndpointHash(benchmark::State& state) {
+        const auto endpoints = MakeEndpoints(1024);
+        const std::hash<Networking::NetworkEndpoint> hasher;
+        size_t i = 0;
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(hasher(endpoints[i++ & 1023]));
+        }
+        allocations.Report(state);
+    }
+    BENCHMARK(BM_EndpointHash);
+
+    // What the receive path does for every datagram to find its connection.
+    void BM_EndpointLookup(benchmark::State& state) {
+        const auto endpoints = MakeEndpoints(1024);
+        std::unordered_map<Networking::NetworkEndpoint, uint32_t> clients;
+        for (uint32_t i = 0; i < endpoints.size(); ++i) clients.emplace(endpoints[i], i);
+        size_t i = 0;
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            auto it = clients.find(endpoints[(i++ * 7) & 1023]);
+            benchmark::DoNotOptimize(it);
+        }
+        allocations.Report(state);
+    }
+    BENCHMARK(BM_EndpointLookup);
+
+    void BM_EndpointParse(benchmark::State& state) {
+        const std::string address = "192.168.100.200";
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            Networking::NetworkEndpoint endpoint(address, 7777);
+            benchmark::DoNotOptimize(endpoint);
+        }
+        allocations.Report(state);
+    }
+    BENCHMARK(BM_EndpointParse);
+
+    void BM_EndpointFormat(benchmark::State& state) {
+        const Networking::NetworkEndpoint endpoint("192.168.100.200", 7777);
+        char text[64];
+
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(endpoint.FormatTo(text, sizeof(text)));
+        }
+        allocations.Report(state);
+    }
+    BENCHMARK(BM_EndpointFormat);
+
+    // =====================================================================================
+    // Connection loopback
+    // =====================================================================================
+
+    // Datagrams one side sent and the other has not processed yet. Slots keep their capacity, so
+    // after the first few sends moving a datagram does not allocate.
+    class Wire {
+    public:
+        void Push(const Networking::PacketBufferPtr& datagram) {
+            if (m_count == m_slots.size()) m_slots.emplace_back();
+            m_slots[m_count++].assign(datagram->Data(), datagram->Data() + datagram->Size());
+        }
+
+        template <typename Fn>
+        bool Drain(Fn&& deliver) {
+            const size_t count = m_count;
+            m_count = 0;
+            for (size_t i = 0; i < count; ++i) {
+                deliver(m_slots[i]);
+            }
+            return count > 0;
+        }
+
+    private:
+        std::vector<std::vector<uint8_t>> m_slots;
+        size_t m_count = 0;
+    };
+
+    // A client and server Connection joined in memory, admitted the way RiftServer admits a HELLO.
+    class Loopback {
+    public:
+        Loopback()
+            : m_client(m_serverEndpoint, false)
+            , m_server(m_clientEndpoint, true) {
+            m_client.SetSendCallback([this](const Networking::NetworkEndpoint&, const Networking::PacketBufferPtr& p) { m_toServer.Push(p); });
+            m_server.SetSendCallback([this](const Networking::NetworkEndpoint&, const Networking::PacketBufferPtr& p) { m_toClient.Push(p); });
+            m_client.SetAppDataCallback([](const uint8_t*, uint32_t, uint8_t) {});
+            m_server.SetAppDataCallback([this](const uint8_t*, uint32_t size, uint8_t) { ++m_delivered; m_deliveredBytes += size; });
+
+            m_client.BeginHandshake();
+            Pump();
+        }
+
+        bool IsSecure() const { return m_client.IsSecure() && m_server.IsSecure(); }
+        Protocol::Connection& Client() { return m_client; }
+        Protocol::Connection& Server() { return m_server; }
+        uint64_t Delivered() const { return m_delivered; }
+
+        void Pump() {
+            for (int round = 0; round < 8; ++round) {
+                const bool toServer = m_toServer.Drain([this](std::vector<uint8_t>& d) { ToServer(d); });
+                const bool toClient = m_toClient.Drain([this](std::vector<uint8_t>& d) {
+                    m_client.ProcessIncomingRawPacket(d.data(), static_cast<uint32_t>(d.size()));
+                });
+                if (!toServer && !toClient) break;
+            }
+        }
+
+    private:
+        void ToServer(std::vector<uint8_t>& datagram) {
+            uint8_t* data = datagram.data();
+            const uint32_t size = static_cast<uint32_t>(datagram.size());
+            if (m_server.IsSecure()) {
+                m_server.ProcessIncomingRawPacket(data, size);
+                return;
+            }
+            byte_vec peerKey;
+            uint8_t caps = 0;
+            uint32_t dictionaryId = 0, routingId = 0;
+            Security::Cookie cookie{};
+            if (Protocol::Handshake::TryParseHello(data, size, peerKey, caps, dictionaryId, routingId)) {
+                const auto challenge = Protocol::Handshake::BuildChallenge(m_cookies.Issue(m_clientEndpoint, peerKey, Clock::now()));
+                m_toClient.Push(Networking::PacketBuffer::FromBytes(challenge.data(), challenge.size()));
+            }
+            else if (Protocol::Handshake::TryParseResponse(data, size, peerKey, caps, dictionaryId, routingId, cookie) &&
+                m_cookies.Verify(m_clientEndpoint, peerKey, cookie, Clock::now())) {
+                m_server.ProcessIncomingRawPacket(data, size);
+            }
+        }
+
+        const Networking::NetworkEndpoint m_clientEndpoint{ "127.0.0.1", 50001 };
+        const Networking::NetworkEndpoint m_serverEndpoint{ "127.0.0.1", 7777 };
+        Security::HandshakeCookie m_cookies;
+        Protocol::Connection m_client;
+        Protocol::Connection m_server;
+        Wire m_toServer;
+        Wire m_toClient;
+        uint64_t m_delivered = 0;
+        uint64_t m_deliveredBytes = 0;
+    };
+
+    // range(0): payload bytes; range(1): 1 = reliable. One op is a send through compression,
+    // packetizing and encryption, and the server's decrypt, parse, decompress and delivery.
+    // Reliable ops also include the server's Update, which sends the standalone ack, and the
+    // client processing that ack, so the send window never fills.
+    void BM_ConnectionLoopback(benchmark::State& state) {
+        const size_t size = static_cast<size_t>(state.range(0));
+        const bool reliable = state.range(1) != 0;
+        const std::vector<uint8_t> payload = MakeGameState(size);
+        Loopback loopback;
+        if (!loopback.IsSecure()) {
+            state.SkipWithError("loopback handshake did not complete");
+            return;
+        }
+
+        uint64_t failedSends = 0;
+        Clock::time_point now = Clock::now();
+        AllocationCounter allocations;
+        for (auto _ : state) {
+            if (!loopback.Client().SendApplicationData(payload.data(), static_cast<uint32_t>(size), reliable)) {
+                ++failedSends;
+            }
+            if (reliable) {
+                loopback.Pump();
+                now += std::chrono::milliseconds(50); // past the delayed-ack deadline
+                loopback.Server().Update(now);
+            }
+            loopback.Pump();
+        }
+        allocations.Report(state);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+        state.counters["delivered/op"] = benchmark::Counter(static_cast<double>(loopback.Delivered()),
+            benchmark::Counter::kAvgIterations);
+        if (failedSends > 0) {
+            state.counters["failed sends"] = static_cast<double>(failedSends);
+        }
+    }
+    BENCHMARK(BM_ConnectionLoopback)
+        ->ArgNames({ "bytes", "reliable" })
+        ->Args({ 64, 0 })->Args({ 64, 1 })
+        ->Args({ 1000, 0 })->Args({ 1000, 1 });
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,362 @@
+// ReliabilitySim: a deterministic, in-process loss/latency simulation of UDPReliabilityProtocol.
+// Two peers exchange reliable messages at a fixed rate over a simulated link with bursty
+// (Gilbert-Elliott) loss and jittered one-way latency, on a virtual 1 ms clock. It reports the
+// delivery-time distribution of the A->B stream, so retransmission policy changes can be
+// compared on identical loss patterns.
+//
+// Usage: ReliabilitySim [--loss=0.05] [--burst=3] [--latency=40] [--jitter=10]
+//                       [--rate=60] [--reply-rate=60] [--standalone-acks=1]
+//                       [--extended-acks=0] [--seconds=120] [--seed=1]
+//                       [--congestion=none|fixed|aimd|bbr] [--pacing-rate=0]
+//                       [--bandwidth=0] [--queue=65536] [--size=4]
+//
+// --reply-rate sets the B->A message rate (0 = B only acks); --standalone-acks=0 makes B's
+// acks ride on its own messages only, as before delayed Heartbeat_Ack packets existed.
+// --extended-acks=1 runs both peers with the 32-bit sequence / 128-packet ack header.
+// --bandwidth (bytes/s, 0 = unlimited) adds a bottleneck with a --queue byte drop-tail buffer.
+// --congestion installs a controller on both peers: messages then wait for the window and the
+// pacer (at --pacing-rate bytes/s for fixed) instead of being rejected when the window is full.
+// --size sets the message payload in bytes.
+
+#include "../src/protocol/UDPReliabilityProtocol/UDPReliabilityProtocol.hpp"
+#include "../src/protocol/PacketFactory/PacketFactory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace RiftNet;
+using Clock = std::chrono::steady_clock;
+
+// =====================================================================================
+// Simulation Parameters
+// =====================================================================================
+
+struct SimOptions {
+    double   loss = 0.05;      // long-run fraction of datagrams dropped, per direction
+    double   burst = 3.0;      // mean length of a loss burst, in datagrams
+    int      latencyMs = 40;   // one-way base latency
+    int      jitterMs = 10;    // uniform extra one-way delay in [0, jitter]
+    int      rate = 60;        // reliable messages per second, A->B
+    int      replyRate = -1;   // reliable messages per second, B->A (-1 = same as rate)
+    bool     standaloneAcks = true; // send Heartbeat_Ack when the delayed-ack timer fires
+    bool     extendedAcks = false;  // ReliabilityHeaderFormat::Extended on both peers
+    Protocol::CongestionAlgorithm congestion = Protocol::CongestionAlgorithm::None;
+    double   pacingRate = 0.0; // bytes/s, for CongestionAlgorithm::FixedRate
+    double   bandwidth = 0.0;  // bottleneck bytes/s per direction, 0 = unlimited
+    double   queueBytes = 65536.0; // bottleneck buffer
+    int      size = 4;         // message payload bytes (at least the 4-byte message id)
+    int      seconds = 120;    // sending period; the run then drains for up to 30 s
+    uint32_t seed = 1;
+};
+
+bool ParseOption(const std::string& arg, const char* name, double& out) {
+    const std::string prefix = std::string("--") + name + "=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    out = std::atof(arg.c_str() + prefix.size());
+    return true;
+}
+
+bool ParseCongestion(const std::string& arg, Protocol::CongestionAlgorithm& out) {
+    const std::string prefix = "--congestion=";
+    if (arg.rfind(prefix, 0) != 0) return false;
+    const std::string name = arg.substr(prefix.size());
+    if (name == "fixed") out = Protocol::CongestionAlgorithm::FixedRate;
+    else if (name == "aimd") out = Protocol::CongestionAlgorithm::AIMD;
+    else if (name == "bbr") out = Protocol::CongestionAlgorithm::BBRLike;
+    else out = Protocol::CongestionAlgorithm::None;
+    return true;
+}
+
+SimOptions ParseOptions(int argc, char** argv) {
+    SimOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        double value = 0.0;
+        if (ParseOption(arg, "loss", value)) options.loss = value;
+        else if (ParseOption(arg, "burst", value)) options.burst = (std::max)(1.0, value);
+        else if (ParseOption(arg, "latency", value)) options.latencyMs = static_cast<int>(value);
+        else if (ParseOption(arg, "jitter", value)) options.jitterMs = static_cast<int>(value);
+        else if (ParseOption(arg, "rate", value)) options.rate = (std::max)(1, static_cast<int>(value));
+        else if (ParseOption(arg, "reply-rate", value)) options.replyRate = (std::max)(0, static_cast<int>(value));
+        else if (ParseOption(arg, "standalone-acks", value)) options.standaloneAcks = value != 0.0;
+        else if (ParseOption(arg, "extended-acks", value)) options.extendedAcks = value != 0.0;
+        else if (ParseOption(arg, "seconds", value)) options.seconds = static_cast<int>(value);
+        else if (ParseOption(arg, "seed", value)) options.seed = static_cast<uint32_t>(value);
+        else if (ParseCongestion(arg, options.congestion)) {}
+        else if (ParseOption(arg, "pacing-rate", value)) options.pacingRate = value;
+        else if (ParseOption(arg, "bandwidth", value)) options.bandwidth = (std::max)(0.0, value);
+        else if (ParseOption(arg, "queue", value)) options.queueBytes = (std::max)(0.0, value);
+        else if (ParseOption(arg, "size", value)) options.size = (std::max)(4, static_cast<int>(value));
+        else std::cerr << "Ignoring unknown argument: " << arg << std::endl;
+    }
+    if (options.replyRate < 0) options.replyRate = options.rate;
+    return options;
+}
+
+// =====================================================================================
+// Simulated Link
+// =====================================================================================
+
+// One direction of the link: Gilbert-Elliott loss (a "bad" state drops everything) plus jitter,
+// behind an optional bottleneck that serializes datagrams through a drop-tail queue.
+class SimLink {
+public:
+    SimLink(const SimOptions& options, uint32_t seed)
+        : m_options(options), m_rng(seed) {
+        const double loss = (std::min)(options.loss, 0.99);
+        m_leaveBad = 1.0 / options.burst;
+        m_enterBad = (loss <= 0.0) ? 0.0 : loss * m_leaveBad / (1.0 - loss);
+    }
+
+    // Returns false if the datagram is lost, otherwise its delay in ms.
+    bool Transmit(int64_t nowMs, uint32_t bytes, int& delayMs) {
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        m_bad = m_bad ? (unit(m_rng) >= m_leaveBad) : (unit(m_rng) < m_enterBad);
+        if (m_bad) {
+            ++m_dropped;
+            return false;
+        }
+
+        double queuedMs = 0.0;
+        if (m_options.bandwidth > 0.0) {
+            const double now = static_cast<double>(nowMs);
+            const double backlogMs = (std::max)(0.0, m_busyUntilMs - now);
+            if (backlogMs * m_options.bandwidth / 1000.0 + bytes > m_options.queueBytes) {
+                ++m_overflowed;
+                return false;
+            }
+            m_busyUntilMs = (std::max)(m_busyUntilMs, now) + bytes * 1000.0 / m_options.bandwidth;
+            queuedMs = m_busyUntilMs - now;
+        }
+
+        std::uniform_int_distribution<int> jitter(0, (std::max)(0, m_options.jitterMs));
+        delayMs = m_options.latencyMs + jitter(m_rng) + static_cast<int>(queuedMs);
+        return true;
+    }
+
+    uint64_t Dropped() const { return m_dropped; }
+    uint64_t Overflowed() const { return m_overflowed; }
+
+private:
+    const SimOptions& m_options;
+    std::mt19937 m_rng;
+    double m_enterBad = 0.0;
+    double m_leaveBad = 1.0;
+    bool m_bad = false;
+    uint64_t m_dropped = 0;
+    uint64_t m_overflowed = 0; // bottleneck queue full
+    double m_busyUntilMs = 0.0;
+};
+
+struct InFlight {
+    int64_t arrivalMs;
+    uint64_t order; // keeps equal arrival times FIFO
+    int toPeer;
+    std::vector<uint8_t> bytes;
+
+    bool operator>(const InFlight& other) const {
+        return arrivalMs != other.arrivalMs ? arrivalMs > other.arrivalMs : order > other.order;
+    }
+};
+
+struct SimPeer {
+    Protocol::ReliableConnectionState state;
+    uint32_t nextMessageId = 0;
+    uint64_t originals = 0;
+    uint64_t resends = 0;
+    uint64_t windowFull = 0;
+    uint64_t acks = 0; // standalone Heartbeat_Ack packets sent
+
+    // With congestion control, messages wait here for the window and pacer, as in Connection's paced queue
+    Protocol::Pacer pacer;
+    std::vector<uint32_t> backlog;
+    size_t backlogHead = 0;
+    size_t maxBacklog = 0;
+};
+
+// =====================================================================================
+// Main Simulation
+// =====================================================================================
+
+int main(int argc, char** argv) {
+    const SimOptions options = ParseOptions(argc, argv);
+    const Clock::time_point epoch = Clock::now();
+    auto at = [&](int64_t ms) { return epoch + std::chrono::milliseconds(ms); };
+
+    SimPeer peers[2];
+    const auto format = options.extendedAcks ? Protocol::ReliabilityHeaderFormat::Extended : Protocol::ReliabilityHeaderFormat::Compact;
+    for (SimPeer& peer : peers) {
+        Protocol::UDPReliabilityProtocol::SetHeaderFormat(peer.state, format);
+        Protocol::UDPReliabilityProtocol::SetCongestionController(peer.state,
+            Protocol::CreateCongestionController(options.congestion, static_cast<uint64_t>(options.pacingRate)));
+    }
+    const bool congestionControlled = options.congestion != Protocol::CongestionAlgorithm::None;
+    SimLink links[2] = { SimLink(options, options.seed), SimLink(options, options.seed * 7919u + 1u) };
+    std::priority_queue<InFlight, std::vector<InFlight>, std::greater<InFlight>> network;
+    uint64_t sendOrder = 0;
+
+    // Delivery accounting for the A (0) -> B (1) stream
+    std::unordered_map<uint32_t, int64_t> firstSentMs;
+    std::unordered_map<uint32_t, bool> delivered;
+    std::vector<double> latencies;
+
+    auto transmit = [&](int from, int64_t nowMs, const Networking::PacketBufferPtr& packet) {
+        int delayMs = 0;
+        if (!links[from].Transmit(nowMs, packet->Size(), delayMs)) return;
+        network.push(InFlight{ nowMs + delayMs, sendOrder++, 1 - from,
+            std::vector<uint8_t>(packet->Data(), packet->Data() + packet->Size()) });
+    };
+
+    auto resendFrom = [&](int from, int64_t nowMs) {
+        Protocol::UDPReliabilityProtocol::ProcessRetransmissions(peers[from].state, at(nowMs),
+            [&](const Networking::PacketBufferPtr& packet) {
+                ++peers[from].resends;
+                transmit(from, nowMs, packet);
+            });
+    };
+
+    const int64_t sendPeriodMs = static_cast<int64_t>(options.seconds) * 1000;
+    const int64_t endMs = sendPeriodMs + 30000;
+    const int rates[2] = { options.rate, options.replyRate };
+    double intervalMs[2] = { 1000.0 / options.rate, 0.0 };
+    double nextSendMs[2] = { 0.0, 0.0 };
+    if (options.replyRate > 0) {
+        intervalMs[1] = 1000.0 / options.replyRate;
+        nextSendMs[1] = intervalMs[1] / 2.0; // offset the two streams
+    }
+
+    for (int64_t nowMs = 0; nowMs <= endMs; ++nowMs) {
+        // 1. Deliver datagrams, as Connection::HandleDecryptedPacket does
+        while (!network.empty() && network.top().arrivalMs <= nowMs) {
+            InFlight datagram = network.top();
+            network.pop();
+            SimPeer& receiver = peers[datagram.toPeer];
+
+            Protocol::GeneralPacketHeader general{};
+            Protocol::ExtendedReliabilityPacketHeader reliability{};
+            const uint8_t* payload = nullptr;
+            uint32_t payloadSize = 0;
+            if (!Protocol::PacketFactory::ParsePacket(datagram.bytes.data(), static_cast<uint32_t>(datagram.bytes.size()),
+                general, reliability, payload, payloadSize, format)) {
+                continue;
+            }
+
+            if (general.Type == Protocol::PacketType::Heartbeat_Ack) {
+                Protocol::UDPReliabilityProtocol::ProcessIncomingAck(receiver.state, reliability, at(nowMs));
+                if (Protocol::UDPReliabilityProtocol::HasFastRetransmitPending(receiver.state)) {
+                    resendFrom(datagram.toPeer, nowMs);
+                }
+                continue;
+            }
+
+            const bool isNew = Protocol::UDPReliabilityProtocol::ProcessIncomingHeader(receiver.state, reliability, at(nowMs));
+            if (isNew && datagram.toPeer == 1 && payloadSize >= sizeof(uint32_t)) {
+                uint32_t id = 0;
+                std::memcpy(&id, payload, sizeof(id));
+                bool& seen = delivered[id];
+                if (!seen) {
+                    seen = true;
+                    latencies.push_back(static_cast<double>(nowMs - firstSentMs[id]));
+                }
+            }
+            if (Protocol::UDPReliabilityProtocol::HasFastRetransmitPending(receiver.state)) {
+                resendFrom(datagram.toPeer, nowMs);
+            }
+        }
+
+        // 2. New messages in both directions during the sending period
+        auto sendMessage = [&](int p, uint32_t id) {
+            SimPeer& peer = peers[p];
+            auto packet = Networking::PacketBuffer::Create(options.size);
+            uint8_t* payload = packet->Append(options.size);
+            std::memset(payload, 0, options.size);
+            std::memcpy(payload, &id, sizeof(id));
+
+            if (!Protocol::UDPReliabilityProtocol::PrepareOutgoingPacket(peer.state, packet,
+                Protocol::PacketType::Data_Reliable, at(nowMs))) {
+                return false;
+            }
+            ++peer.originals;
+            peer.pacer.OnSent(packet->Size());
+            transmit(p, nowMs, packet);
+            return true;
+        };
+
+        for (int p = 0; p < 2; ++p) {
+            SimPeer& peer = peers[p];
+            while (rates[p] > 0 && nowMs < sendPeriodMs && nextSendMs[p] <= static_cast<double>(nowMs)) {
+                nextSendMs[p] += intervalMs[p];
+
+                const uint32_t id = peer.nextMessageId++;
+                if (p == 0) firstSentMs[id] = nowMs; // delivery time includes any wait in the backlog
+                if (congestionControlled) {
+                    peer.backlog.push_back(id);
+                }
+                else if (!sendMessage(p, id)) {
+                    ++peer.windowFull; // backpressure: the message is not sent
+                    if (p == 0) firstSentMs.erase(id);
+                }
+            }
+
+            peer.pacer.SetRate(Protocol::UDPReliabilityProtocol::GetPacingRate(peer.state));
+            while (peer.backlogHead < peer.backlog.size() &&
+                Protocol::UDPReliabilityProtocol::HasCongestionWindowSpace(peer.state, options.size) &&
+                peer.pacer.CanSend(at(nowMs)) &&
+                sendMessage(p, peer.backlog[peer.backlogHead])) {
+                ++peer.backlogHead;
+            }
+            peer.maxBacklog = (std::max)(peer.maxBacklog, peer.backlog.size() - peer.backlogHead);
+        }
+
+        // 3. Timer-driven retransmissions at 1 ms resolution (the server's timer wheel)
+        resendFrom(0, nowMs);
+        resendFrom(1, nowMs);
+
+        // 4. Standalone acks for whatever outgoing data did not carry in time
+        for (int p = 0; p < 2 && options.standaloneAcks; ++p) {
+            if (Protocol::UDPReliabilityProtocol::GetAckDeadline(peers[p].state) > at(nowMs)) continue;
+            auto ack = Networking::PacketBuffer::Create(0);
+            if (Protocol::UDPReliabilityProtocol::PrepareAckPacket(peers[p].state, ack)) {
+                ++peers[p].acks;
+                transmit(p, nowMs, ack);
+            }
+        }
+
+        if (nowMs >= sendPeriodMs && latencies.size() == firstSentMs.size()) break;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) {
+        if (latencies.empty()) return 0.0;
+        const size_t index = (std::min)(latencies.size() - 1, static_cast<size_t>(q * static_cast<double>(latencies.size() - 1) + 0.5));
+        return latencies[index];
+    };
+
+    std::cout << "--- ReliabilitySim ---" << std::endl;
+    std::cout << "Link: loss=" << options.loss * 100.0 << "% burst=" << options.burst
+        << " latency=" << options.latencyMs << "ms jitter=" << options.jitterMs << "ms rate=" << options.rate
+        << "/s reply-rate=" << options.replyRate << "/s standalone-acks=" << (options.standaloneAcks ? "on" : "off")
+        << " acks=" << (options.extendedAcks ? "extended" : "compact") << std::endl;
+    const Protocol::CongestionStats congestion = Protocol::UDPReliabilityProtocol::GetCongestionStats(peers[0].state);
+    std::cout << "Congestion: algorithm=" << static_cast<int>(options.congestion) << " bandwidth=" << options.bandwidth
+        << "B/s final cwnd=" << congestion.congestionWindow << "B pacing=" << congestion.pacingRate
+        << "B/s srtt=" << congestion.smoothedRTT_ms << "ms max backlog=" << peers[0].maxBacklog
+        << " bottleneck drops=" << links[0].Overflowed() << std::endl;
+    std::cout << "A->B sent " << peers[0].originals << ", delivered " << latencies.size()
+        << ", resends " << peers[0].resends << ", window-full rejections " << peers[0].windowFull
+        << ", datagrams dropped " << links[0].Dropped() << std::endl;
+    std::cout << "B->A standalone acks " << peers[1].acks << ", messages " << peers[1].originals << std::endl;
+    std::cout << "Delivery time (ms): p50=" << percentile(0.50) << " p90=" << percentile(0.90)
+        << " p99=" << percentile(0.99) << " p99.9=" << percentile(0.999)
+        << " max=" << (latencies.empty() ? 0.0 : latencies.back()) << std::endl;
+    return 0;
+}
@@ -29,6 +29,46 @@ extern "C" {
 	 */
 	RiftResult rift_client_connect(RiftClientHandle client, const char* host_address, uint16_t port);
 
+	/**
+	 * @brief Connects like rift_client_connect and sends data reliably. With a session ticket set,
+	 * data travels in the first datagram as 0-RTT data and reaches the server before the
+	 * handshake completes; otherwise it is sent once it completes, like rift_client_send.
+	 * 0-RTT data is not forward secret: protect it like the ticket it is sealed with.
+	 * @param client The client handle.
+	 * @param host_address The IP address or hostname of the server.
+	 * @param port The port of the server.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return RIFT_SUCCESS if the connection process is initiated successfully.
+	 */
+	RiftResult rift_client_connect_with_data(RiftClientHandle client, const char* host_address, uint16_t port,
+		const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sets the session ticket the next connect presents to resume a session: it skips the
+	 * server's cookie round trip and can carry 0-RTT data. A server that cannot redeem it (expired,
+	 * already used, or restarted since) falls back to a full handshake. Each ticket works once.
+	 * @param client The client handle, not connected.
+	 * @param ticket RIFT_SESSION_TICKET_SIZE bytes from rift_client_get_session_ticket.
+	 * @param size The size of the ticket buffer.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for a malformed ticket,
+	 *         RIFT_ERROR_GENERIC while connected.
+	 */
+	RiftResult rift_client_set_session_ticket(RiftClientHandle client, const uint8_t* ticket, size_t size);
+
+	/**
+	 * @brief Reads the newest session ticket the server issued (servers with session_tickets on
+	 * send one after each handshake). It holds key material: store it as securely as a password.
+	 * A disconnected client keeps it, and its next connect presents it automatically.
+	 * @param client The client handle.
+	 * @param out_ticket Receives the ticket.
+	 * @param capacity The size of out_ticket, at least RIFT_SESSION_TICKET_SIZE.
+	 * @param out_size Receives the bytes written.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_GENERIC if no unused ticket is held,
+	 *         RIFT_ERROR_INVALID_PARAMETER if the buffer is too small.
+	 */
+	RiftResult rift_client_get_session_ticket(RiftClientHandle client, uint8_t* out_ticket, size_t capacity, size_t* out_size);
+
 	/**
 	 * @brief Disconnects the client from the server.
 	 * @param client The client handle.
@@ -40,10 +80,69 @@ extern "C" {
 	 * @param client The client handle.
 	 * @param data The buffer of data to send.
 	 * @param size The size of the data buffer.
-	 * @return RIFT_SUCCESS on success, or an error code on failure.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_SEND_FAILED if the reliable send window
+	 *         (32 unacknowledged packets, 128 with extended_acks) is full, or another error code on failure.
 	 */
 	RiftResult rift_client_send(RiftClientHandle client, const uint8_t* data, size_t size);
 
+	/**
+	 * @brief Sends a message to the server on one of the channels in RiftClientConfig::channel_types.
+	 * @param client The client handle.
+	 * @param channel The channel index, below channel_count.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for an unconfigured channel,
+	 *         RIFT_ERROR_SEND_FAILED if the reliable send window is full, or another error code on failure.
+	 */
+	RiftResult rift_client_send_channel(RiftClientHandle client, uint8_t channel, const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends the server a message with a priority and latest-only key, like rift_server_send_ex.
+	 * @param client The client handle.
+	 * @param channel A channel index below channel_count, or RIFT_DEFAULT_CHANNEL to send like rift_client_send.
+	 * @param options NULL for the defaults.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return As rift_client_send_channel; RIFT_ERROR_INVALID_PARAMETER also for an unknown priority.
+	 */
+	RiftResult rift_client_send_ex(RiftClientHandle client, uint8_t channel, const RiftSendOptions* options,
+		const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends the server a snapshot of replicated state, delta-encoded like rift_server_send_snapshot.
+	 * @param client The client handle.
+	 * @param data The snapshot.
+	 * @param size 1 .. RIFT_MAX_SNAPSHOT_SIZE bytes.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for a bad size,
+	 *         RIFT_ERROR_SEND_FAILED if the handshake has not completed or the send failed.
+	 */
+	RiftResult rift_client_send_snapshot(RiftClientHandle client, const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends any coalesced messages now instead of at the next client tick.
+	 * Only has an effect when the client was created with a non-zero coalesce_budget.
+	 * @param client The client handle.
+	 * @return RIFT_SUCCESS on success, or an error code on failure.
+	 */
+	RiftResult rift_client_flush(RiftClientHandle client);
+
+	/**
+	 * @brief Reads the server connection's RTT estimate and congestion window.
+	 * @param client The client handle.
+	 * @param out_stats Receives the snapshot.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_CONNECTION_FAILED if not connected.
+	 */
+	RiftResult rift_client_get_connection_stats(RiftClientHandle client, RiftConnectionStats* out_stats);
+
+	/**
+	 * @brief Reads the connection's counters and gauges and the client socket's counters.
+	 * Counters start again from zero on each connect.
+	 * @param client The client handle.
+	 * @param out_stats Receives the snapshot.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_CONNECTION_FAILED if not connected.
+	 */
+	RiftResult rift_client_get_stats(RiftClientHandle client, RiftStats* out_stats);
+
 
 #ifdef __cplusplus
 } // extern "C"
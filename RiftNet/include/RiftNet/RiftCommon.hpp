@@ -47,6 +47,7 @@ extern "C" {
         const uint8_t* data;
         size_t         size;
         RiftClientId   sender_id; // On server, identifies the client. On client, is 0.
+        uint8_t        channel;   // Channel it was sent on, or RIFT_DEFAULT_CHANNEL
     } RiftPacket;
 
     // The main event structure passed to the user's callback
@@ -67,16 +68,216 @@ extern "C" {
 
     // --- Configuration ---
 
+    // Delivery guarantees of a logical channel (see RiftServerConfig::channel_types).
+    typedef enum RiftChannelType {
+        RIFT_CHANNEL_RELIABLE_ORDERED = 0,   // Every message arrives, in send order; only this channel waits on a loss
+        RIFT_CHANNEL_RELIABLE_UNORDERED,     // Every message arrives, as soon as it arrives
+        RIFT_CHANNEL_UNRELIABLE_SEQUENCED,   // Messages may be lost; late ones older than the newest are dropped
+    } RiftChannelType;
+
+    // Most channels per connection, and the channel reported for data sent with rift_*_send.
+#define RIFT_MAX_CHANNELS    32
+#define RIFT_DEFAULT_CHANNEL 0xFF
+
+    // How urgently a message goes out while its connection queues sends (send_budget_bytes or congestion_control set).
+    typedef enum RiftSendPriority {
+        RIFT_PRIORITY_NORMAL = 0, // Everything sent without options (default)
+        RIFT_PRIORITY_CRITICAL,   // Inputs, hit confirmations: ahead of everything else queued
+        RIFT_PRIORITY_HIGH,
+        RIFT_PRIORITY_LOW,        // Bulk state: only once nothing more urgent waits
+    } RiftSendPriority;
+
+    // Options for rift_server_send_ex / rift_client_send_ex. Zero-initialized: normal priority, no key.
+    typedef struct RiftSendOptions {
+        RiftSendPriority priority;
+        uint32_t         latest_key; // 0 = none; else an unreliable message drops any queued one with the same key
+    } RiftSendOptions;
+
+    // The channel reported for snapshots sent with rift_*_send_snapshot, and their largest size.
+#define RIFT_SNAPSHOT_CHANNEL  0xFE
+#define RIFT_MAX_SNAPSHOT_SIZE 32768
+
+    // Bytes of a session ticket as rift_client_get_session_ticket writes it (ticket and its secret).
+#define RIFT_SESSION_TICKET_SIZE 96
+
+    // Congestion control applied to each connection's data packets.
+    typedef enum RiftCongestionControl {
+        RIFT_CONGESTION_NONE = 0,    // Send as soon as asked (default)
+        RIFT_CONGESTION_FIXED_RATE,  // Pace at pacing_rate bytes/s, no window
+        RIFT_CONGESTION_AIMD,        // Reno-style window, halved on loss, paced at window / RTT
+        RIFT_CONGESTION_BBR,         // Window and pacing from measured bottleneck bandwidth and min RTT
+    } RiftCongestionControl;
+
+    // What a send made before the connection's handshake completes does when its queue is full.
+    typedef enum RiftPendingSendPolicy {
+        RIFT_PENDING_DROP_OLDEST = 0, // Evict the oldest queued messages to make room (default)
+        RIFT_PENDING_DROP_NEWEST,     // Drop the new message; the send still returns RIFT_SUCCESS
+        RIFT_PENDING_REJECT,          // Drop the new message; the send returns RIFT_ERROR_SEND_FAILED
+    } RiftPendingSendPolicy;
+
+    // Snapshot of one connection's RTT estimate and congestion state.
+    typedef struct RiftConnectionStats {
+        float    rtt_ms;            // Smoothed round-trip time
+        float    rtt_variance_ms;
+        float    rto_ms;            // Current retransmission timeout
+        uint32_t congestion_window; // Bytes of reliable data allowed in flight; UINT32_MAX when unlimited
+        uint32_t bytes_in_flight;   // Bytes of reliable data sent and not yet acknowledged
+        uint64_t pacing_rate;       // Bytes/s; 0 when sends are not paced
+    } RiftConnectionStats;
+
+#define RIFT_LATENCY_BUCKETS 24
+
+    // Durations in power-of-two buckets: buckets[0] counts samples under 1 us, buckets[i] those from
+    // 2^(i-1) up to 2^i us, and the last bucket everything longer (about 4 s and up).
+    typedef struct RiftLatencyHistogram {
+        uint64_t count;
+        uint64_t sum_us;
+        uint64_t buckets[RIFT_LATENCY_BUCKETS];
+    } RiftLatencyHistogram;
+
+    // Traffic counters and gauges of a connection, a client or a whole server. Counters only grow
+    // (server totals keep those of disconnected clients), so they export as Prometheus counters as they are.
+    typedef struct RiftStats {
+        uint64_t packets_sent;          // Datagrams, handshake ones included
+        uint64_t bytes_sent;            // UDP payload bytes
+        uint64_t packets_received;      // Datagrams handed to a connection, including the ones dropped below
+        uint64_t bytes_received;
+        uint64_t retransmits;           // Reliable packets sent again after a timeout or fast retransmit
+        uint64_t duplicates_dropped;    // Reliable packets that arrived again after being delivered
+        uint64_t replays_dropped;       // Datagrams the anti-replay window refused before decrypting them
+        uint64_t decrypt_failures;      // Datagrams that did not authenticate
+        uint64_t compress_input_bytes;  // Payload bytes given to compression...
+        uint64_t compress_output_bytes; // ...and the bytes sent for them; the ratio is input / output
+        RiftLatencyHistogram rtt;       // Every RTT sample
+
+        // Gauges. In server totals the RTT fields are the mean over connected clients, the rest their sum
+        float    rtt_ms;
+        float    rtt_variance_ms;
+        float    rto_ms;
+        uint32_t unacked_packets;    // Reliable packets sent and not yet acknowledged
+        uint64_t pending_send_bytes; // Sends queued until the handshake completes
+        uint32_t connections;        // Connected clients; 1 for a client or a single connection
+
+        // The server's or client's socket; zero from rift_server_get_client_stats
+        uint64_t receive_pool_exhausted; // Times posted receives ran low with the pool already at receive_pool_max (IOCP)
+        uint64_t send_pool_exhausted;    // Sends that found no pooled send context (IOCP), free send slot (RIO) or socket buffer space (epoll)
+        RiftLatencyHistogram send_completion_latency; // From posting a send to dequeuing its completion
+    } RiftStats;
+
+    // Receives rift_server_get_stats / rift_client_get_stats every stats_interval_ms, on the update thread.
+    typedef void (*RiftStatsCallback)(const RiftStats* stats, void* user_data);
+
+    // Socket I/O backend used by the server. Linux builds always use RIFT_IO_BACKEND_EPOLL,
+    // and Windows builds asked for it use RIFT_IO_BACKEND_IOCP.
+    typedef enum RiftIoBackend {
+        RIFT_IO_BACKEND_IOCP = 0, // Overlapped WSARecvFrom/WSASendTo on an I/O completion port (default)
+        RIFT_IO_BACKEND_RIO,      // Winsock Registered I/O with batched completion dequeue
+        RIFT_IO_BACKEND_EPOLL,    // Linux: per-worker SO_REUSEPORT sockets, recvmmsg/sendmmsg with UDP GRO/GSO
+    } RiftIoBackend;
+
+    // Placement of a pool of worker threads. Zero-initialized: one unpinned, normal-priority thread per core.
+    typedef struct RiftThreadConfig {
+        uint32_t    thread_count; // 0 = one per allowed core
+        uint64_t    core_mask;    // 0 = any core; else worker i is pinned to the i-th set bit (wrapping)
+        uint32_t    numa_node;    // 0 = any node; else workers and their buffers stay on node (numa_node - 1)
+        int32_t     priority;     // 0 = normal; else a Windows THREAD_PRIORITY_* value
+        const char* name;         // Workers are named "<name> <i>"; NULL = "RiftNet IO"; copied at create
+    } RiftThreadConfig;
+
+    // Simulated bad network on a server's or client's socket, for testing; all zeros = off.
+    // Applies to both directions on the side that sets it: latency is added once to each send and to each receive.
+    typedef struct RiftImpairmentConfig {
+        float    loss_percent;      // 0 .. 100
+        float    duplicate_percent; // 0 .. 100
+        float    reorder_percent;   // 0 .. 100; a reordered datagram is held reorder_delay_ms behind the ones after it
+        uint32_t latency_ms;
+        uint32_t jitter_ms;         // uniform extra delay in [0, jitter_ms]
+        uint32_t reorder_delay_ms;  // 0 = 10
+        uint64_t bandwidth;         // 0 = unlimited; else bytes/s per direction, tail-dropping past 200 ms of queue
+        uint64_t seed;              // same seed and traffic, same impairments
+    } RiftImpairmentConfig;
+
+    // The RiftTuningConfig layout this header declares. Later versions only append fields, and a
+    // library reads no further than the version a caller set, so older callers keep working.
+#define RIFT_TUNING_VERSION 1
+
+    // Performance knobs for a server or client, for tuning a deployment without rebuilding.
+    // Each zero field keeps its default; a NULL tuning pointer keeps them all.
+    typedef struct RiftTuningConfig {
+        uint32_t version;               // RIFT_TUNING_VERSION; create fails for 0 or a newer version than the library's
+        uint32_t receive_pool_size;     // IOCP: 0 = 128 receives posted at start, and the step the pool grows by when posted receives run low
+        uint32_t receive_pool_max;      // IOCP: 0 = 8 x receive_pool_size; the pool stops growing here
+        uint32_t buffer_size;           // 0 = 4096; bytes per IOCP receive/send context and epoll receive slot without GRO (1500 .. 65536)
+        uint32_t socket_receive_buffer; // 0 = the OS default (epoll: 4 MB); else SO_RCVBUF bytes
+        uint32_t socket_send_buffer;    // 0 = the OS default (epoll: 4 MB); else SO_SNDBUF bytes
+        uint32_t max_update_interval_ms; // Server: 0 = 1000; longest the update thread sleeps with no deadline due
+        uint32_t idle_timeout_ms;       // 0 = 30000; a connection that receives nothing for this long is dropped
+        uint32_t min_rto_ms;            // 0 = 100; lower bound of the retransmission timeout
+        uint32_t max_rto_ms;            // 0 = 3000; upper bound of the retransmission timeout and its backoff
+    } RiftTuningConfig;
+
     typedef struct RiftServerConfig {
         const char* host_address;
         uint16_t          port;
         RiftEventCallback event_callback;
         void* user_data; // Optional pointer passed back in every callback
+        RiftIoBackend     io_backend; // Zero-initialized configs get RIFT_IO_BACKEND_IOCP
+        uint32_t          coalesce_budget; // 0 = one datagram per send; else bytes of messages packed per datagram (max 1400)
+        uint32_t          extended_acks;   // Non-zero: offer 32-bit sequences and 128-packet acks; used if the peer offers them too
+        const RiftChannelType* channel_types; // Channel i sends with channel_types[i]; copied at create
+        uint32_t          channel_count;   // 0 .. RIFT_MAX_CHANNELS
+        RiftCongestionControl congestion_control; // Per connection; zero-initialized configs get RIFT_CONGESTION_NONE
+        uint64_t          pacing_rate;     // Bytes/s per connection for RIFT_CONGESTION_FIXED_RATE
+        uint32_t          send_budget_bytes; // 0 = unlimited; else data bytes each connection sends per tick, most urgent first
+        uint32_t          send_budget_tick_ms; // 0 = 16; the tick send_budget_bytes applies to
+        uint32_t          max_datagram_size; // 0 = 1200; else UDP payload bytes per datagram (576 .. 1472); larger messages are fragmented
+        uint32_t          mtu_probing;     // Non-zero: once connected, probe for larger datagrams the path carries
+        uint32_t          compression_threshold; // 0 = 64 bytes (16 with a dictionary); smaller payloads are sent uncompressed
+        const uint8_t*    compression_dictionary; // Optional shared LZ4 dictionary, used when the peer loaded the same one; copied at create
+        uint32_t          compression_dictionary_size; // Bytes; only the last 64 KB are used
+        uint32_t          stream_compression_window; // 0 = off; else bytes of history (1 KB .. 32 KB) reliable ordered channels compress against
+        uint32_t          receive_shards;  // IOCP backend: 0 = receives run on any I/O worker; else threads each owning the clients that hash to it (max 64)
+        RiftThreadConfig  io_threads;      // IOCP workers and receive shards, or epoll workers (one socket each); the RIO completion thread is placed like worker 0
+        uint32_t          event_queue_size; // 0 = event_callback runs on the network threads; else events queue for rift_server_poll_events
+        RiftThreadConfig  send_threads;    // thread_count 0 = batch sends run on the calling thread; else that many threads share large ones (name NULL = "RiftNet Send")
+        RiftThreadConfig  handshake_threads; // thread_count 0 = key agreement runs on the receiving I/O thread; else on that many threads (name NULL = "RiftNet Handshake")
+        uint32_t          handshake_queue_size; // 0 = 256; handshakes waiting for handshake_threads beyond this run on the receiving thread
+        uint32_t          pending_send_bytes; // 0 = 512 KB; else bytes (4 KB .. 16 MB) of sends a connection holds until its handshake completes
+        RiftPendingSendPolicy pending_send_policy; // When that queue is full; zero-initialized configs get RIFT_PENDING_DROP_OLDEST
+        uint32_t          session_tickets; // Non-zero: issue resumption tickets, and let clients that present one skip the cookie round trip and send 0-RTT data
+        uint32_t          connection_migration; // Non-zero: give clients that ask a connection ID, so their connection survives an address change
+        RiftStatsCallback stats_callback;   // Optional; called with the server totals every stats_interval_ms
+        uint32_t          stats_interval_ms; // 0 = 1000
+        RiftImpairmentConfig impairment;   // Zero = off; wraps whichever io_backend is chosen
+        const RiftTuningConfig* tuning;    // Optional; copied at create
+        const char*       capture_path;    // Optional; records every datagram and received message to this file until destroy
+        uint32_t          capture_size_mb; // 0 = 256; the capture file's size, after which records are dropped
     } RiftServerConfig;
 
     typedef struct RiftClientConfig {
         RiftEventCallback event_callback;
         void* user_data;
+        uint32_t          coalesce_budget; // Same as RiftServerConfig::coalesce_budget
+        uint32_t          extended_acks;   // Same as RiftServerConfig::extended_acks
+        const RiftChannelType* channel_types; // Same as RiftServerConfig::channel_types
+        uint32_t          channel_count;
+        RiftCongestionControl congestion_control; // Same as RiftServerConfig::congestion_control
+        uint64_t          pacing_rate;
+        uint32_t          send_budget_bytes; // Same as RiftServerConfig::send_budget_bytes
+        uint32_t          send_budget_tick_ms;
+        uint32_t          max_datagram_size; // Same as RiftServerConfig::max_datagram_size
+        uint32_t          mtu_probing;
+        uint32_t          compression_threshold; // Same as RiftServerConfig::compression_threshold
+        const uint8_t*    compression_dictionary; // Same as RiftServerConfig::compression_dictionary
+        uint32_t          compression_dictionary_size;
+        uint32_t          stream_compression_window; // Same as RiftServerConfig::stream_compression_window
+        uint32_t          pending_send_bytes; // Same as RiftServerConfig::pending_send_bytes
+        RiftPendingSendPolicy pending_send_policy; // Same as RiftServerConfig::pending_send_policy
+        uint32_t          connection_migration; // Non-zero: ask for a connection ID (used if the server has connection_migration on)
+        RiftStatsCallback stats_callback;   // Same as RiftServerConfig::stats_callback, while connected
+        uint32_t          stats_interval_ms;
+        RiftImpairmentConfig impairment;   // Same as RiftServerConfig::impairment
+        const RiftTuningConfig* tuning;    // Same as RiftServerConfig::tuning; max_update_interval_ms does not apply
     } RiftClientConfig;
 
 
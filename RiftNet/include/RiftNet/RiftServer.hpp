@@ -39,10 +39,68 @@ extern "C" {
 	 * @param client_id The ID of the client to send the data to.
 	 * @param data The buffer of data to send.
 	 * @param size The size of the data buffer.
-	 * @return RIFT_SUCCESS on success, or an error code on failure.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_SEND_FAILED if the client's reliable send window
+	 *         (32 unacknowledged packets, 128 with extended_acks) is full, or another error code on failure.
 	 */
 	RiftResult rift_server_send(RiftServerHandle server, RiftClientId client_id, const uint8_t* data, size_t size);
 
+	/**
+	 * @brief Sends a message to a client on one of the channels in RiftServerConfig::channel_types.
+	 * Ordered channels are delivered in send order, each independently of the others.
+	 * @param server The server handle.
+	 * @param client_id The ID of the client to send the data to.
+	 * @param channel The channel index, below channel_count.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for an unconfigured channel,
+	 *         RIFT_ERROR_SEND_FAILED if the reliable send window is full, or another error code on failure.
+	 */
+	RiftResult rift_server_send_channel(RiftServerHandle server, RiftClientId client_id, uint8_t channel,
+		const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends a message with a priority and, for unreliable messages, a latest-only key.
+	 * While the connection queues sends (send_budget_bytes or congestion_control set), queued
+	 * messages go out most urgent first, and a message with latest_key drops the queued ones with
+	 * the same key that have not gone out yet. Otherwise it is sent at once like rift_server_send_channel.
+	 * @param server The server handle.
+	 * @param client_id The ID of the client to send the data to.
+	 * @param channel A channel index below channel_count, or RIFT_DEFAULT_CHANNEL to send like rift_server_send.
+	 * @param options NULL for the defaults.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return As rift_server_send_channel; RIFT_ERROR_INVALID_PARAMETER also for an unknown priority.
+	 */
+	RiftResult rift_server_send_ex(RiftServerHandle server, RiftClientId client_id, uint8_t channel,
+		const RiftSendOptions* options, const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends a client this tick's snapshot of replicated state, unreliably.
+	 * Only the bytes that changed since the newest snapshot the client acknowledged go on the wire;
+	 * the client receives the whole snapshot as a packet event on RIFT_SNAPSHOT_CHANNEL, and never
+	 * one older than a snapshot it already received. Keep the layout stable between ticks (entities
+	 * in the same place) so unchanged state lines up with the baseline.
+	 * @param server The server handle.
+	 * @param client_id The ID of the client to send the snapshot to.
+	 * @param data The snapshot.
+	 * @param size 1 .. RIFT_MAX_SNAPSHOT_SIZE bytes.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for a bad size or unknown client,
+	 *         RIFT_ERROR_SEND_FAILED if the client is still handshaking or the send failed.
+	 */
+	RiftResult rift_server_send_snapshot(RiftServerHandle server, RiftClientId client_id, const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Takes queued events when the server was created with a non-zero event_queue_size.
+	 * Call it from one application thread, e.g. once per tick, until it returns fewer than max_events.
+	 * Packet data in the returned events stays valid until the next call (or until the server is destroyed).
+	 * While the queue is full, network threads wait for this call rather than drop events.
+	 * @param server The server handle.
+	 * @param events Receives up to max_events events, in the order they were raised.
+	 * @param max_events Capacity of events.
+	 * @return The number of events written; 0 when none are queued or the server does not queue events.
+	 */
+	size_t rift_server_poll_events(RiftServerHandle server, RiftEvent* events, size_t max_events);
+
 	/**
 	 * @brief Sends a packet to all connected clients.
 	 * @param server The server handle.
@@ -52,6 +110,65 @@ extern "C" {
 	 */
 	RiftResult rift_server_broadcast(RiftServerHandle server, const uint8_t* data, size_t size);
 
+	/**
+	 * @brief Sends one reliable message to a list of clients, e.g. those interested in an entity.
+	 * The payload is compressed once for all of them; each connection only adds its headers and
+	 * encryption, spread over the send_threads pool when one is configured.
+	 * @param server The server handle.
+	 * @param client_ids The clients to send to; unknown ids are skipped.
+	 * @param client_count Number of ids in client_ids.
+	 * @param data The buffer of data to send.
+	 * @param size The size of the data buffer.
+	 * @return RIFT_SUCCESS if every known client accepted the message, RIFT_ERROR_SEND_FAILED if any
+	 *         did not (e.g. a full reliable send window), or another error code on failure.
+	 */
+	RiftResult rift_server_send_batch(RiftServerHandle server, const RiftClientId* client_ids, size_t client_count,
+		const uint8_t* data, size_t size);
+
+	/**
+	 * @brief rift_server_send_batch for an unreliable message.
+	 */
+	RiftResult rift_server_send_batch_unreliable(RiftServerHandle server, const RiftClientId* client_ids, size_t client_count,
+		const uint8_t* data, size_t size);
+
+	/**
+	 * @brief Sends any messages coalesced for a client now instead of at the next server tick.
+	 * Only has an effect when the server was created with a non-zero coalesce_budget.
+	 * @param server The server handle.
+	 * @param client_id The ID of the client whose pending messages should be sent.
+	 * @return RIFT_SUCCESS on success, or an error code on failure.
+	 */
+	RiftResult rift_server_flush(RiftServerHandle server, RiftClientId client_id);
+
+	/**
+	 * @brief Reads a client connection's RTT estimate and congestion window.
+	 * @param server The server handle.
+	 * @param client_id The client to query.
+	 * @param out_stats Receives the snapshot.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for an unknown client.
+	 */
+	RiftResult rift_server_get_connection_stats(RiftServerHandle server, RiftClientId client_id,
+		RiftConnectionStats* out_stats);
+
+	/**
+	 * @brief Reads the server totals: every connection's counters so far (disconnected clients
+	 * included), the gauges summed or averaged over connected clients, and the socket's counters.
+	 * Lock-free for the network threads; safe from any thread.
+	 * @param server The server handle.
+	 * @param out_stats Receives the snapshot.
+	 * @return RIFT_SUCCESS on success, or an error code on failure.
+	 */
+	RiftResult rift_server_get_stats(RiftServerHandle server, RiftStats* out_stats);
+
+	/**
+	 * @brief Reads one client connection's counters and gauges; the socket fields are zero.
+	 * @param server The server handle.
+	 * @param client_id The client to query.
+	 * @param out_stats Receives the snapshot.
+	 * @return RIFT_SUCCESS on success, RIFT_ERROR_INVALID_PARAMETER for an unknown client.
+	 */
+	RiftResult rift_server_get_client_stats(RiftServerHandle server, RiftClientId client_id, RiftStats* out_stats);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -1,27 +1,67 @@
 #include "pch.h"
 #include "../../include/RiftNet/RiftClient.hpp"
 #include "../core/riftnetio/RiftNetIO.hpp"
+#include "../core/epollio/EpollSocketIO.hpp"
 #include "../core/networkio/INetworkIOEvents.hpp"
-#include "../protocol/packet/Packet.hpp"
-#include "../protocol/packetfactory/PacketFactory.hpp"
+#include "../core/impairedio/ImpairedNetworkIO.hpp"
+#include "../core/tuning/TuningConfig.hpp"
+#include "../core/apiconfig/ApiConfig.hpp"
+#include "../protocol/Packet/Packet.hpp"
+#include "../protocol/PacketFactory/PacketFactory.hpp"
 #include "../core/connection/Connection.hpp"
+#include "../security/SessionTicket/SessionTicket.hpp"
+#include "../../utilities/metrics/Metrics.hpp"
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <stop_token>
 #include <thread>
 #include <vector>
 #include <cassert>
+#include <cstring>
+
+#include <sodium.h>
+
+namespace {
+    // A client talks to one server, so one socket and one receive thread are enough
+    std::unique_ptr<RiftNet::Networking::INetworkIO> CreateSocketIO(const RiftTuningConfig& tuning) {
+#if defined(_WIN32)
+        return std::make_unique<RiftNet::Networking::WinSocketIO>(0, RiftNet::Threading::ThreadConfig{}, RiftNet::Tuning::CopySocketTuning(tuning));
+#else
+        RiftNet::Threading::ThreadConfig threads;
+        threads.threadCount = 1;
+        threads.name = "RiftNet Client";
+        return std::make_unique<RiftNet::Networking::EpollSocketIO>(threads, RiftNet::Tuning::CopySocketTuning(tuning));
+#endif
+    }
+
+    static_assert(RIFT_SESSION_TICKET_SIZE == RiftNet::Security::SESSION_TICKET_SIZE + sizeof(RiftNet::Security::KeyBuffer),
+        "RIFT_SESSION_TICKET_SIZE must match the ticket and secret rift_client_get_session_ticket writes");
+}
 
 // The internal C++ implementation of the client.
 class RiftClient_Internal : public RiftNet::Networking::INetworkIOEvents {
+    static constexpr uint32_t kDefaultStatsIntervalMs = 1000;
+
 public:
     explicit RiftClient_Internal(const RiftClientConfig* config)
         : m_config(*config)
-        , m_networkIO(std::make_unique<RiftNet::Networking::WinSocketIO>())
+        , m_tuning(RiftNet::Tuning::CopyTuning(config->tuning))
+        , m_channelTypes(RiftNet::Api::CopyChannelTypes(config->channel_types, config->channel_count))
+        , m_dictionary(RiftNet::Compression::CompressionDictionary::Create(
+            { config->compression_dictionary, config->compression_dictionary_size }))
+        , m_networkIO(RiftNet::Networking::ImpairedNetworkIO::Wrap(
+            CreateSocketIO(m_tuning), RiftNet::Api::CopyImpairment(config->impairment)))
+        , m_statsInterval(config->stats_interval_ms != 0 ? config->stats_interval_ms : kDefaultStatsIntervalMs)
+        , m_idleTimeout(RiftNet::Tuning::ResolveIdleTimeout(m_tuning))
         , m_running(false) {
+        m_config.channel_types = nullptr; // the caller's array need not outlive create
+        m_config.compression_dictionary = nullptr;
+        m_config.tuning = nullptr; // copied into m_tuning
     }
 
     ~RiftClient_Internal() {
@@ -31,8 +71,9 @@ public:
 #endif
     }
 
-    RiftResult Connect(const char* host_address, uint16_t port) {
+    RiftResult Connect(const char* host_address, uint16_t port, const uint8_t* earlyData = nullptr, size_t earlySize = 0) {
         if (!host_address) return RIFT_ERROR_INVALID_PARAMETER;
+        if (earlySize > UINT32_MAX || (earlySize != 0 && !earlyData)) return RIFT_ERROR_INVALID_PARAMETER;
 
         if (m_running.load(std::memory_order_acquire) || m_updateThread.joinable())
             return RIFT_ERROR_GENERIC;
@@ -47,23 +88,53 @@ public:
             /*isServer=*/false
         );
 
-        // Wire sends through WinSocketIO
+        m_serverConnection->SetCoalescing(m_config.coalesce_budget);
+        m_serverConnection->SetExtendedAcks(m_config.extended_acks != 0);
+        m_serverConnection->SetChannels(m_channelTypes);
+        m_serverConnection->SetCongestionController(RiftNet::Api::MakeCongestionController(m_config.congestion_control, m_config.pacing_rate));
+        m_serverConnection->SetRetransmitTimeoutBounds(
+            RiftNet::Tuning::ResolveMinRto(m_tuning), RiftNet::Tuning::ResolveMaxRto(m_tuning));
+        m_serverConnection->SetSendBudget(m_config.send_budget_bytes, std::chrono::milliseconds(m_config.send_budget_tick_ms));
+        m_serverConnection->SetMaxDatagramSize(m_config.max_datagram_size != 0 ? m_config.max_datagram_size
+            : RiftNet::Protocol::DEFAULT_MAX_DATAGRAM_SIZE, m_config.mtu_probing != 0);
+        m_serverConnection->SetCompression(m_dictionary, m_config.compression_threshold);
+        m_serverConnection->SetStreamCompression(m_config.stream_compression_window);
+        m_serverConnection->SetPendingSendLimit(m_config.pending_send_bytes, RiftNet::Api::ToOverflowPolicy(m_config.pending_send_policy));
+        m_serverConnection->SetConnectionMigration(m_config.connection_migration != 0);
+        {
+            std::lock_guard<std::mutex> lock(m_ticketMtx);
+            if (!m_sessionTicket.ticket.empty()) {
+                m_serverConnection->SetSessionTicket(std::move(m_sessionTicket));
+                m_sessionTicket = {};
+            }
+        }
+
+        // Wire sends through the socket layer
         m_serverConnection->SetSendCallback([this](const RiftNet::Networking::NetworkEndpoint& ep,
-            const std::vector<uint8_t>& data) {
-                m_networkIO->SendData(ep, data.data(), static_cast<uint32_t>(data.size()));
+            const RiftNet::Networking::PacketBufferPtr& packet) {
+                m_networkIO->SendData(ep, packet);
+            });
+
+        // Wake the update thread early for retransmit, flush and delayed-ack deadlines
+        m_serverConnection->SetTimerCallback([this](std::chrono::steady_clock::time_point /*deadline*/) {
+            std::lock_guard<std::mutex> lock(m_wakeMutex);
+            m_wakePending = true;
+            m_wake.notify_one();
             });
 
         // Deliver application payloads to the user's callback
-        m_serverConnection->SetAppDataCallback([this](const uint8_t* data, uint32_t size) {
+        m_serverConnection->SetAppDataCallback([this](const uint8_t* data, uint32_t size, uint8_t channel) {
             RiftEvent appEvent{};
             appEvent.type = RIFT_EVENT_PACKET_RECEIVED;
             appEvent.data.packet.sender_id = 0;
             appEvent.data.packet.data = data;
             appEvent.data.packet.size = size;
+            appEvent.data.packet.channel = channel;
             m_config.event_callback(&appEvent, m_config.user_data);
             });
 
         if (!m_networkIO->Start()) {
+            KeepSessionTicket(); // not presented yet
             m_serverConnection.reset();
             return RIFT_ERROR_GENERIC;
         }
@@ -80,6 +151,11 @@ public:
             m_config.event_callback(&connectedEvent, m_config.user_data);
         }
 
+        // Queued first, so a resuming handshake carries it as 0-RTT data
+        if (earlySize != 0) {
+            m_serverConnection->SendApplicationData(earlyData, static_cast<uint32_t>(earlySize), /*reliable=*/true);
+        }
+
         // Prime the reliability path with a tiny reliable "HELLO".
         // Produces an early ACK pair so RTT sampling has data immediately.
         static const uint8_t hello[5] = { 'R','F','N','T', 0x01 }; // magic + version byte
@@ -101,6 +177,7 @@ public:
             if (m_networkIO) m_networkIO->Stop();
         }
 
+        KeepSessionTicket();
         m_serverConnection.reset();
 
         // Emit a disconnect event so callers can clean up UI/state.
@@ -114,7 +191,106 @@ public:
         if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
             return RIFT_ERROR_CONNECTION_FAILED;
 
-        m_serverConnection->SendApplicationData(data, static_cast<uint32_t>(size), reliable);
+        return m_serverConnection->SendApplicationData(data, static_cast<uint32_t>(size), reliable)
+            ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+    }
+
+    RiftResult SendChannel(uint8_t channel, const uint8_t* data, size_t size) {
+        if (!data || size == 0 || channel >= m_channelTypes.size()) return RIFT_ERROR_INVALID_PARAMETER;
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        return m_serverConnection->SendChannelData(channel, data, static_cast<uint32_t>(size))
+            ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+    }
+
+    RiftResult SendEx(uint8_t channel, const RiftSendOptions* options, const uint8_t* data, size_t size) {
+        RiftNet::Protocol::SendOptions sendOptions;
+        if (!data || size == 0 || !RiftNet::Api::ToSendOptions(options, sendOptions)) return RIFT_ERROR_INVALID_PARAMETER;
+        if (channel != RIFT_DEFAULT_CHANNEL && channel >= m_channelTypes.size()) return RIFT_ERROR_INVALID_PARAMETER;
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        const bool sent = channel == RIFT_DEFAULT_CHANNEL
+            ? m_serverConnection->SendApplicationData(data, static_cast<uint32_t>(size), /*isReliable=*/true, sendOptions)
+            : m_serverConnection->SendChannelData(channel, data, static_cast<uint32_t>(size), sendOptions);
+        return sent ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+    }
+
+    RiftResult SendSnapshot(const uint8_t* data, size_t size) {
+        if (!data || size == 0 || size > RIFT_MAX_SNAPSHOT_SIZE) return RIFT_ERROR_INVALID_PARAMETER;
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        return m_serverConnection->SendSnapshot(data, static_cast<uint32_t>(size)) ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+    }
+
+    RiftResult GetConnectionStats(RiftConnectionStats& out) {
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        RiftNet::Api::CopyConnectionStats(m_serverConnection->GetCongestionStats(), out);
+        return RIFT_SUCCESS;
+    }
+
+    RiftResult GetStats(RiftStats& out) {
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        out = RiftStats{};
+        RiftNet::Api::CopyMetrics(m_serverConnection->GetMetrics(), out);
+        const auto congestion = m_serverConnection->GetCongestionStats();
+        out.rtt_ms = congestion.smoothedRTT_ms;
+        out.rtt_variance_ms = congestion.rttVariance_ms;
+        out.rto_ms = congestion.retransmissionTimeout_ms;
+        out.unacked_packets = m_serverConnection->GetUnackedCount();
+        out.pending_send_bytes = m_serverConnection->GetPendingSendBytes();
+        out.connections = 1;
+
+        RiftNet::Api::CopyIOStats(m_networkIO->GetStats(), out);
+        return RIFT_SUCCESS;
+    }
+
+    RiftResult SetSessionTicket(const uint8_t* data, size_t size) {
+        if (!data || size != RIFT_SESSION_TICKET_SIZE) return RIFT_ERROR_INVALID_PARAMETER;
+        if (m_running.load(std::memory_order_acquire)) return RIFT_ERROR_GENERIC;
+
+        RiftNet::Security::ResumptionTicket ticket;
+        ticket.ticket.assign(data, data + RiftNet::Security::SESSION_TICKET_SIZE);
+        std::memcpy(ticket.secret.data(), data + RiftNet::Security::SESSION_TICKET_SIZE, ticket.secret.size());
+
+        std::lock_guard<std::mutex> lock(m_ticketMtx);
+        sodium_memzero(m_sessionTicket.secret.data(), m_sessionTicket.secret.size());
+        m_sessionTicket = std::move(ticket);
+        return RIFT_SUCCESS;
+    }
+
+    RiftResult GetSessionTicket(uint8_t* out, size_t capacity, size_t& outSize) {
+        RiftNet::Security::ResumptionTicket ticket;
+        const bool connected = m_running.load(std::memory_order_acquire) && m_serverConnection;
+        if (!connected || !m_serverConnection->GetSessionTicket(ticket)) {
+            std::lock_guard<std::mutex> lock(m_ticketMtx);
+            ticket = m_sessionTicket;
+        }
+        if (ticket.ticket.empty()) return RIFT_ERROR_GENERIC;
+
+        const size_t size = ticket.ticket.size() + ticket.secret.size();
+        RiftResult result = RIFT_ERROR_INVALID_PARAMETER;
+        if (capacity >= size) {
+            std::memcpy(out, ticket.ticket.data(), ticket.ticket.size());
+            std::memcpy(out + ticket.ticket.size(), ticket.secret.data(), ticket.secret.size());
+            outSize = size;
+            result = RIFT_SUCCESS;
+        }
+        sodium_memzero(ticket.secret.data(), ticket.secret.size());
+        return result;
+    }
+
+    RiftResult Flush() {
+        if (!m_running.load(std::memory_order_acquire) || !m_serverConnection)
+            return RIFT_ERROR_CONNECTION_FAILED;
+
+        m_serverConnection->Flush();
         return RIFT_SUCCESS;
     }
 
@@ -122,7 +298,7 @@ public:
     // INetworkIOEvents
     // =========================
     void OnRawDataReceived(const RiftNet::Networking::NetworkEndpoint& /*sender*/,
-        const uint8_t* data,
+        uint8_t* data,
         uint32_t size,
         RiftNet::Networking::OverlappedIOContext* /*context*/) override
     {
@@ -142,32 +318,66 @@ public:
     }
 
 private:
+    // Holds on to the connection's unused ticket, so the next connect can present it
+    void KeepSessionTicket() {
+        RiftNet::Security::ResumptionTicket ticket;
+        if (!m_serverConnection || !m_serverConnection->GetSessionTicket(ticket)) return;
+
+        std::lock_guard<std::mutex> lock(m_ticketMtx);
+        sodium_memzero(m_sessionTicket.secret.data(), m_sessionTicket.secret.size());
+        m_sessionTicket = std::move(ticket);
+    }
+
+    // Sleeps until the connection's next deadline (retransmit, flush, delayed ack, idle timeout)
+    // or the next keepalive, whichever is first; the timer callback cuts the sleep short.
     void Update(std::stop_token st) {
         using namespace std::chrono_literals;
 
-        const auto kIdleTimeout = std::chrono::seconds(30);  // was 10s; give RTT time to form
-        const auto kTick = 100ms;
         const auto kKeepalive = 1000ms;                    // send a small reliable noop each second
 
         auto lastKeepalive = std::chrono::steady_clock::now();
+        auto nextStats = lastKeepalive + m_statsInterval;
 
         while (!st.stop_requested()) {
-            std::this_thread::sleep_for(kTick);
+            // Query the deadline before taking m_wakeMutex: the timer callback takes it while
+            // the connection holds its own locks.
+            auto wakeAt = lastKeepalive + kKeepalive;
+            if (m_config.stats_callback && nextStats < wakeAt) wakeAt = nextStats;
+            if (m_serverConnection) {
+                const auto deadline = m_serverConnection->GetNextDeadline(m_idleTimeout);
+                if (deadline < wakeAt) wakeAt = deadline;
+            }
+            {
+                // time_point::min() (a fast retransmit is pending) must not reach wait_until
+                const auto now = std::chrono::steady_clock::now();
+                if (wakeAt < now) wakeAt = now;
+
+                std::unique_lock<std::mutex> lock(m_wakeMutex);
+                m_wake.wait_until(lock, st, wakeAt, [this] { return m_wakePending; });
+                m_wakePending = false;
+            }
             if (!m_running.load(std::memory_order_acquire)) break;
 
             if (m_serverConnection) {
                 const auto now = std::chrono::steady_clock::now();
                 m_serverConnection->Update(now);
 
-                // Lightweight reliable keepalive so ACKs keep flowing (feeds RTT sampler).
+                // Lightweight reliable keepalive so the server's idle timeout sees traffic while
+                // the app is quiet (acks for received data now go out on their own).
                 if (now - lastKeepalive >= kKeepalive) {
                     static const uint8_t noop[1] = { 0x00 };
                     m_serverConnection->SendApplicationData(noop, 1u, /*reliable=*/true);
                     lastKeepalive = now;
                 }
 
+                RiftStats stats;
+                if (m_config.stats_callback && now >= nextStats && GetStats(stats) == RIFT_SUCCESS) {
+                    m_config.stats_callback(&stats, m_config.user_data);
+                    nextStats = now + m_statsInterval;
+                }
+
                 // Idle timeout based on lack of inbound/ACK activity.
-                if (m_serverConnection->IsTimedOut(now, kIdleTimeout)) {
+                if (m_serverConnection->IsTimedOut(now, m_idleTimeout)) {
                     RiftEvent e{};
                     e.type = RIFT_EVENT_CLIENT_DISCONNECTED;
                     m_config.event_callback(&e, m_config.user_data);
@@ -180,10 +390,25 @@ private:
 
 private:
     RiftClientConfig m_config;
+    RiftTuningConfig m_tuning; // zero fields keep their defaults
+    std::vector<RiftNet::Protocol::ChannelType> m_channelTypes;
+    std::shared_ptr<const RiftNet::Compression::CompressionDictionary> m_dictionary;
 
     std::unique_ptr<RiftNet::Networking::INetworkIO> m_networkIO;
     std::unique_ptr<RiftNet::Protocol::Connection>  m_serverConnection;
 
+    // Session ticket for the next connect, while no connection holds it
+    std::mutex                          m_ticketMtx;
+    RiftNet::Security::ResumptionTicket m_sessionTicket;
+
+    // Early wake-ups for the update thread, signalled by the connection's timer callback
+    std::mutex                  m_wakeMutex;
+    std::condition_variable_any m_wake;
+    bool                        m_wakePending{ false };
+
+    std::chrono::milliseconds m_statsInterval;
+    std::chrono::milliseconds m_idleTimeout;
+
     std::atomic<bool> m_running;
     std::jthread      m_updateThread; // keep last
 };
@@ -199,6 +424,21 @@ extern "C" {
         if (!config || !config->event_callback) {
             return nullptr;
         }
+        if (!RiftNet::Api::IsValidChannelConfig(config->channel_types, config->channel_count)) {
+            return nullptr;
+        }
+        if (!RiftNet::Api::IsValidCongestionConfig(config->congestion_control, config->pacing_rate)) {
+            return nullptr;
+        }
+        if (config->compression_dictionary_size != 0 && !config->compression_dictionary) {
+            return nullptr;
+        }
+        if (config->pending_send_policy < RIFT_PENDING_DROP_OLDEST || config->pending_send_policy > RIFT_PENDING_REJECT) {
+            return nullptr;
+        }
+        if (!RiftNet::Tuning::IsValidTuning(config->tuning)) {
+            return nullptr;
+        }
         try {
             return reinterpret_cast<RiftClientHandle>(new RiftClient_Internal(config));
         }
@@ -218,6 +458,24 @@ extern "C" {
         return reinterpret_cast<RiftClient_Internal*>(client)->Connect(host_address, port);
     }
 
+    RiftResult rift_client_connect_with_data(RiftClientHandle client, const char* host_address, uint16_t port,
+        const uint8_t* data, size_t size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        if (!data || size == 0) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftClient_Internal*>(client)->Connect(host_address, port, data, size);
+    }
+
+    RiftResult rift_client_set_session_ticket(RiftClientHandle client, const uint8_t* ticket, size_t size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftClient_Internal*>(client)->SetSessionTicket(ticket, size);
+    }
+
+    RiftResult rift_client_get_session_ticket(RiftClientHandle client, uint8_t* out_ticket, size_t capacity, size_t* out_size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_ticket || !out_size) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftClient_Internal*>(client)->GetSessionTicket(out_ticket, capacity, *out_size);
+    }
+
     void rift_client_disconnect(RiftClientHandle client) {
         if (client) {
             reinterpret_cast<RiftClient_Internal*>(client)->Disconnect();
@@ -230,6 +488,39 @@ extern "C" {
         return reinterpret_cast<RiftClient_Internal*>(client)->Send(data, size, /*reliable=*/true);
     }
 
+    RiftResult rift_client_send_channel(RiftClientHandle client, uint8_t channel, const uint8_t* data, size_t size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftClient_Internal*>(client)->SendChannel(channel, data, size);
+    }
+
+    RiftResult rift_client_send_ex(RiftClientHandle client, uint8_t channel, const RiftSendOptions* options,
+        const uint8_t* data, size_t size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftClient_Internal*>(client)->SendEx(channel, options, data, size);
+    }
+
+    RiftResult rift_client_send_snapshot(RiftClientHandle client, const uint8_t* data, size_t size) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftClient_Internal*>(client)->SendSnapshot(data, size);
+    }
+
+    RiftResult rift_client_get_connection_stats(RiftClientHandle client, RiftConnectionStats* out_stats) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_stats) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftClient_Internal*>(client)->GetConnectionStats(*out_stats);
+    }
+
+    RiftResult rift_client_get_stats(RiftClientHandle client, RiftStats* out_stats) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_stats) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftClient_Internal*>(client)->GetStats(*out_stats);
+    }
+
+    RiftResult rift_client_flush(RiftClientHandle client) {
+        if (!client) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftClient_Internal*>(client)->Flush();
+    }
+
     // Explicit variants for clarity/bench control.
     RiftResult rift_client_send_reliable(RiftClientHandle client, const uint8_t* data, size_t size) {
         if (!client) return RIFT_ERROR_INVALID_HANDLE;
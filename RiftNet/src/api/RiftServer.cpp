@@ -1,40 +1,179 @@
 #include "pch.h"
 #include "../../include/RiftNet/RiftServer.hpp"
 #include "../core/riftnetio/RiftNetIO.hpp"
+#include "../core/rioio/RioSocketIO.hpp"
+#include "../core/epollio/EpollSocketIO.hpp"
+#include "../core/impairedio/ImpairedNetworkIO.hpp"
+#include "../core/captureio/CaptureNetworkIO.hpp"
+#include "../core/tuning/TuningConfig.hpp"
+#include "../core/apiconfig/ApiConfig.hpp"
 #include "../core/networkio/INetworkIOEvents.hpp"
 #include "../core/connection/Connection.hpp"
+#include "../core/connection/ConnectionPool.hpp"
+#include "../core/connection/ConnectionTable.hpp"
+#include "../core/timer/TimerWheel.hpp"
+#include "../core/eventqueue/EventQueue.hpp"
+#include "../core/threading/Threading.hpp"
+#include "../compression/Compressor/Compressor.hpp"
+#include "../security/Handshake/Handshake.hpp"
+#include "../security/HandshakeCookie/HandshakeCookie.hpp"
+#include "../security/KeyPool/KeyPool.hpp"
+#include "../security/SessionTicket/SessionTicket.hpp"
+#include "../../utilities/logger/Logger.hpp"
+#include "../../utilities/metrics/Metrics.hpp"
 
 #include <unordered_map>
 #include <mutex>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <latch>
 #include <memory>
+#include <span>
 #include <vector>
 #include <stop_token>
 #include <cassert>
 
-// Provide a hash for NetworkEndpoint so it can be used in std::unordered_map.
-namespace std {
-    template <>
-    struct hash<RiftNet::Networking::NetworkEndpoint> {
-        size_t operator()(const RiftNet::Networking::NetworkEndpoint& ep) const noexcept {
-            return hash<string>()(ep.ipAddress) ^ (hash<uint16_t>()(ep.port) << 1);
-        }
+#include <sodium.h>
+
+namespace {
+    constexpr uint32_t kMaxReceiveShards = 64;
+
+    RiftNet::Threading::ThreadConfig CopyThreadConfig(const RiftThreadConfig& config, const char* defaultName = "RiftNet IO") {
+        RiftNet::Threading::ThreadConfig out;
+        out.threadCount = config.thread_count;
+        out.coreMask = config.core_mask;
+        out.numaNode = (config.numa_node != 0) ? static_cast<int32_t>(config.numa_node - 1) : -1;
+        out.priority = config.priority;
+        out.name = config.name ? config.name : defaultName;
+        return out;
+    }
+
+    // Hands the sends made in its scope to the socket layer as one batch
+    class SendBatchScope {
+    public:
+        explicit SendBatchScope(RiftNet::Networking::INetworkIO& io) : m_io(io) { m_io.BeginSendBatch(); }
+        ~SendBatchScope() { m_io.EndSendBatch(); }
+
+        SendBatchScope(const SendBatchScope&) = delete;
+        SendBatchScope& operator=(const SendBatchScope&) = delete;
+
+    private:
+        RiftNet::Networking::INetworkIO& m_io;
     };
+
+    // RIO already completes every receive on its one completion thread, so shards only apply to IOCP.
+    // Epoll workers each own a SO_REUSEPORT socket, which already keeps a client on one thread.
+    std::unique_ptr<RiftNet::Networking::INetworkIO> CreateSocketIO(const RiftServerConfig& config) {
+        const auto tuning = RiftNet::Tuning::CopySocketTuning(RiftNet::Tuning::CopyTuning(config.tuning));
+#if defined(_WIN32)
+        switch (config.io_backend) {
+        case RIFT_IO_BACKEND_RIO:
+            return std::make_unique<RiftNet::Networking::RioSocketIO>(CopyThreadConfig(config.io_threads), tuning);
+        case RIFT_IO_BACKEND_EPOLL:
+            RF_NETWORK_WARN("RiftServer: the epoll backend is Linux-only; using IOCP.");
+            [[fallthrough]];
+        case RIFT_IO_BACKEND_IOCP:
+        default:
+            return std::make_unique<RiftNet::Networking::WinSocketIO>(config.receive_shards,
+                CopyThreadConfig(config.io_threads), tuning);
+        }
+#else
+        if (config.io_backend != RIFT_IO_BACKEND_EPOLL && config.io_backend != RIFT_IO_BACKEND_IOCP) {
+            RF_NETWORK_WARN("RiftServer: io_backend {} is Windows-only; using epoll.", static_cast<int>(config.io_backend));
+        }
+        return std::make_unique<RiftNet::Networking::EpollSocketIO>(CopyThreadConfig(config.io_threads), tuning);
+#endif
+    }
+
+    // The capture sits above the impairment, so it records what the protocol actually sent and saw
+    std::unique_ptr<RiftNet::Networking::INetworkIO> CreateNetworkIO(const RiftServerConfig& config,
+        std::shared_ptr<RiftNet::Networking::CaptureWriter> capture) {
+        return RiftNet::Networking::CaptureNetworkIO::Wrap(
+            RiftNet::Networking::ImpairedNetworkIO::Wrap(CreateSocketIO(config), RiftNet::Api::CopyImpairment(config.impairment)),
+            std::move(capture));
+    }
+
+    std::shared_ptr<RiftNet::Networking::CaptureWriter> OpenCapture(const RiftServerConfig& config) {
+        constexpr uint64_t kDefaultCaptureSizeMb = 256;
+        if (!config.capture_path) return nullptr;
+        const uint64_t sizeMb = config.capture_size_mb != 0 ? config.capture_size_mb : kDefaultCaptureSizeMb;
+        std::shared_ptr<RiftNet::Networking::CaptureWriter> capture =
+            RiftNet::Networking::CaptureWriter::Open(config.capture_path, sizeMb << 20);
+        if (!capture) throw std::runtime_error("RiftServer: cannot open the capture file");
+        return capture;
+    }
+
+    static_assert(RIFT_SNAPSHOT_CHANNEL == RiftNet::Protocol::SNAPSHOT_CHANNEL &&
+        RIFT_MAX_SNAPSHOT_SIZE == RiftNet::Compression::MAX_SNAPSHOT_SIZE, "snapshot constants differ");
 }
 
 // The internal C++ implementation of the server.
 class RiftServer_Internal : public RiftNet::Networking::INetworkIOEvents {
 private:
-    using ConnectionPtr = std::shared_ptr<RiftNet::Protocol::Connection>;
+    using ConnectionPtr = RiftNet::Protocol::ConnectionPtr;
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kKeyPoolSize = 64;        // server keypairs generated ahead of accepts
+    static constexpr size_t kKeyPoolRefillBatch = 16; // topped up per timer wake, off the receive path
+    static constexpr size_t kMinSendChunk = 32;        // fewest batch targets worth handing to a send thread
+    static constexpr uint32_t kDefaultHandshakeQueueSize = 256;
+    static constexpr uint32_t kDefaultStatsIntervalMs = 1000;
+
+    // One batch payload, compressed once per compression mode the targets use
+    struct BatchFrames {
+        const uint8_t* data;
+        uint32_t size;
+        bool reliable;
+        std::vector<uint8_t> plain;      // empty when no target needs it
+        std::vector<uint8_t> dictionary; // for connections compressing against m_dictionary
+    };
+
+    // An accepted handshake datagram waiting for a handshake thread; the receive buffer is reused meanwhile
+    struct PendingHandshake {
+        RiftClientId id;
+        ConnectionPtr connection;
+        std::vector<uint8_t> datagram;
+    };
 
 public:
     explicit RiftServer_Internal(const RiftServerConfig* config)
         : m_config(*config)
-        , m_networkIO(std::make_unique<RiftNet::Networking::WinSocketIO>())
+        , m_tuning(RiftNet::Tuning::CopyTuning(config->tuning))
+        , m_capture(OpenCapture(*config))
+        , m_networkIO(CreateNetworkIO(*config, m_capture))
+        , m_channelTypes(RiftNet::Api::CopyChannelTypes(config->channel_types, config->channel_count))
+        , m_dictionary(RiftNet::Compression::CompressionDictionary::Create(
+            { config->compression_dictionary, config->compression_dictionary_size }))
+        , m_events(config->event_queue_size != 0
+            ? std::make_unique<RiftNet::Networking::EventQueue>(config->event_queue_size) : nullptr)
+        , m_statsInterval(config->stats_interval_ms != 0 ? config->stats_interval_ms : kDefaultStatsIntervalMs)
+        , m_idleTimeout(RiftNet::Tuning::ResolveIdleTimeout(m_tuning))
+        , m_maxTimerSleep(RiftNet::Tuning::ResolveMaxUpdateInterval(m_tuning))
+        , m_sendPool(config->send_threads.thread_count != 0
+            ? std::make_unique<RiftNet::Threading::TaskThreadPool>(CopyThreadConfig(config->send_threads, "RiftNet Send"))
+            : nullptr)
+        , m_handshakeQueueLimit(config->handshake_queue_size != 0 ? config->handshake_queue_size : kDefaultHandshakeQueueSize)
         , m_isRunning(false)
-        , m_nextClientId(1) {
+        , m_handshakePool(config->handshake_threads.thread_count != 0
+            ? std::make_unique<RiftNet::Threading::TaskThreadPool>(CopyThreadConfig(config->handshake_threads, "RiftNet Handshake"))
+            : nullptr) {
+        m_config.channel_types = nullptr; // the caller's array need not outlive create
+        m_config.compression_dictionary = nullptr;
+        m_config.io_threads.name = nullptr;
+        m_config.send_threads.name = nullptr;
+        m_config.handshake_threads.name = nullptr;
+        m_config.tuning = nullptr; // copied into m_tuning
+        m_config.capture_path = nullptr;
+
+        // Set up like each connection's compressor, in both of the modes a handshake can settle on
+        m_batchCompressor.SetThreshold(m_config.compression_threshold);
+        if (m_dictionary) {
+            m_batchDictionaryCompressor.SetDictionary(m_dictionary);
+            m_batchDictionaryCompressor.SetDictionaryCompression(true);
+            m_batchDictionaryCompressor.SetThreshold(m_config.compression_threshold);
+        }
     }
 
     ~RiftServer_Internal() {
@@ -48,6 +187,8 @@ public:
         if (m_isRunning.load(std::memory_order_acquire) || m_updateThread.joinable())
             return RIFT_ERROR_GENERIC;
 
+        m_keyPool.Refill(kKeyPoolSize);
+
         if (!m_networkIO->Init(m_config.host_address, m_config.port, this)) {
             return RIFT_ERROR_SOCKET_BIND_FAILED;
         }
@@ -55,6 +196,7 @@ public:
             return RIFT_ERROR_GENERIC;
         }
 
+        if (m_events) m_events->Open();
         m_isRunning.store(true, std::memory_order_release);
         m_updateThread = std::jthread([this](std::stop_token st) { Update(st); });
         return RIFT_SUCCESS;
@@ -63,6 +205,7 @@ public:
     void Stop() {
         // Always take the same path; no early return that could skip joining.
         m_isRunning.store(false, std::memory_order_release);
+        if (m_events) m_events->Close(); // network threads waiting on a full queue give up
 
         if (m_updateThread.joinable()) {
             const bool self_call = (m_updateThread.get_id() == std::this_thread::get_id());
@@ -74,47 +217,189 @@ public:
             if (m_networkIO) m_networkIO->Stop();
         }
 
-        // Drop connections after IO/threads are quiesced
-        {
-            std::lock_guard<std::mutex> lock(m_clientMutex);
-            m_clientsByEndpoint.clear();
-            m_clientsById.clear();
-        }
+        // Drop connections after IO/threads are quiesced; their counters stay in the totals
+        std::lock_guard<std::mutex> lock(m_statsMtx);
+        m_clients.ForEach([this](RiftClientId, const ConnectionPtr& connection) { m_retiredMetrics += connection->GetMetrics(); });
+        m_clients.Clear();
     }
 
     RiftResult Send(RiftClientId client_id, const uint8_t* data, size_t size, bool reliable) {
         if (!data || size == 0) return RIFT_ERROR_INVALID_PARAMETER;
-        std::lock_guard<std::mutex> lock(m_clientMutex);
-        auto it = m_clientsById.find(client_id);
-        if (it != m_clientsById.end()) {
-            it->second->SendApplicationData(data, static_cast<uint32_t>(size), reliable);
+        if (auto connection = m_clients.FindById(client_id)) {
+            return connection->SendApplicationData(data, static_cast<uint32_t>(size), reliable)
+                ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+        }
+        return RIFT_ERROR_INVALID_PARAMETER;
+    }
+
+    RiftResult SendChannel(RiftClientId client_id, uint8_t channel, const uint8_t* data, size_t size) {
+        if (!data || size == 0 || channel >= m_channelTypes.size()) return RIFT_ERROR_INVALID_PARAMETER;
+        if (auto connection = m_clients.FindById(client_id)) {
+            return connection->SendChannelData(channel, data, static_cast<uint32_t>(size))
+                ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+        }
+        return RIFT_ERROR_INVALID_PARAMETER;
+    }
+
+    RiftResult SendEx(RiftClientId client_id, uint8_t channel, const RiftSendOptions* options, const uint8_t* data, size_t size) {
+        RiftNet::Protocol::SendOptions sendOptions;
+        if (!data || size == 0 || !RiftNet::Api::ToSendOptions(options, sendOptions)) return RIFT_ERROR_INVALID_PARAMETER;
+        if (channel != RIFT_DEFAULT_CHANNEL && channel >= m_channelTypes.size()) return RIFT_ERROR_INVALID_PARAMETER;
+        if (auto connection = m_clients.FindById(client_id)) {
+            const bool sent = channel == RIFT_DEFAULT_CHANNEL
+                ? connection->SendApplicationData(data, static_cast<uint32_t>(size), /*isReliable=*/true, sendOptions)
+                : connection->SendChannelData(channel, data, static_cast<uint32_t>(size), sendOptions);
+            return sent ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+        }
+        return RIFT_ERROR_INVALID_PARAMETER;
+    }
+
+    RiftResult SendSnapshot(RiftClientId client_id, const uint8_t* data, size_t size) {
+        if (!data || size == 0 || size > RIFT_MAX_SNAPSHOT_SIZE) return RIFT_ERROR_INVALID_PARAMETER;
+        if (auto connection = m_clients.FindById(client_id)) {
+            return connection->SendSnapshot(data, static_cast<uint32_t>(size)) ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
+        }
+        return RIFT_ERROR_INVALID_PARAMETER;
+    }
+
+    RiftResult Flush(RiftClientId client_id) {
+        if (auto connection = m_clients.FindById(client_id)) {
+            connection->Flush();
             return RIFT_SUCCESS;
         }
         return RIFT_ERROR_INVALID_PARAMETER;
     }
 
+    RiftResult GetConnectionStats(RiftClientId client_id, RiftConnectionStats& out) {
+        if (auto connection = m_clients.FindById(client_id)) {
+            RiftNet::Api::CopyConnectionStats(connection->GetCongestionStats(), out);
+            return RIFT_SUCCESS;
+        }
+        return RIFT_ERROR_INVALID_PARAMETER;
+    }
+
+    RiftResult GetClientStats(RiftClientId client_id, RiftStats& out) {
+        ConnectionPtr connection = m_clients.FindById(client_id);
+        if (!connection) return RIFT_ERROR_INVALID_PARAMETER;
+
+        out = RiftStats{};
+        RiftNet::Api::CopyMetrics(connection->GetMetrics(), out);
+        const auto congestion = connection->GetCongestionStats();
+        out.rtt_ms = congestion.smoothedRTT_ms;
+        out.rtt_variance_ms = congestion.rttVariance_ms;
+        out.rto_ms = congestion.retransmissionTimeout_ms;
+        out.unacked_packets = connection->GetUnackedCount();
+        out.pending_send_bytes = connection->GetPendingSendBytes();
+        out.connections = 1;
+        return RIFT_SUCCESS;
+    }
+
+    // Connected clients' counters plus those of every client removed so far, so totals never go back
+    void GetStats(RiftStats& out) {
+        out = RiftStats{};
+        RiftNet::Metrics::ConnectionMetricsSnapshot totals;
+        double rtt = 0.0, rttVariance = 0.0, rto = 0.0;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMtx);
+            totals = m_retiredMetrics;
+            m_clients.ForEach([&](RiftClientId, const ConnectionPtr& connection) {
+                totals += connection->GetMetrics();
+                const auto congestion = connection->GetCongestionStats();
+                rtt += congestion.smoothedRTT_ms;
+                rttVariance += congestion.rttVariance_ms;
+                rto += congestion.retransmissionTimeout_ms;
+                out.unacked_packets += connection->GetUnackedCount();
+                out.pending_send_bytes += connection->GetPendingSendBytes();
+                ++out.connections;
+                });
+        }
+        RiftNet::Api::CopyMetrics(totals, out);
+        if (out.connections != 0) {
+            out.rtt_ms = static_cast<float>(rtt / out.connections);
+            out.rtt_variance_ms = static_cast<float>(rttVariance / out.connections);
+            out.rto_ms = static_cast<float>(rto / out.connections);
+        }
+        RiftNet::Api::CopyIOStats(m_networkIO->GetStats(), out);
+    }
+
+    size_t PollEvents(RiftEvent* events, size_t maxEvents) {
+        return m_events ? m_events->Poll(events, maxEvents) : 0;
+    }
+
     void Broadcast(const uint8_t* data, size_t size, bool reliable) {
-        if (!data || size == 0) return;
-        std::lock_guard<std::mutex> lock(m_clientMutex);
-        for (const auto& pair : m_clientsById) {
-            pair.second->SendApplicationData(data, static_cast<uint32_t>(size), reliable);
+        SendBatch(nullptr, 0, data, size, reliable);
+    }
+
+    // Compresses the payload once per compression mode in use, then has each target add its own
+    // headers and encryption, on the send threads when there are enough targets to share out.
+    // clientIds == nullptr sends to every connection; unknown ids are skipped.
+    RiftResult SendBatch(const RiftClientId* clientIds, size_t clientCount, const uint8_t* data, size_t size, bool reliable) {
+        if (!data || size == 0 || size > UINT32_MAX) return RIFT_ERROR_INVALID_PARAMETER;
+
+        std::vector<ConnectionPtr> targets;
+        if (clientIds) {
+            targets.reserve(clientCount);
+            for (size_t i = 0; i < clientCount; ++i) {
+                if (auto connection = m_clients.FindById(clientIds[i])) {
+                    targets.push_back(std::move(connection));
+                }
+            }
+        }
+        else {
+            m_clients.ForEach([&](RiftClientId, const ConnectionPtr& connection) { targets.push_back(connection); });
+        }
+        if (targets.empty()) return RIFT_SUCCESS;
+
+        BatchFrames frames{ data, static_cast<uint32_t>(size), reliable, {}, {} };
+        bool needPlain = false;
+        bool needDictionary = false;
+        for (const ConnectionPtr& connection : targets) {
+            if (!connection->CanSendCompressed()) continue;
+            (connection->UsesDictionaryCompression() ? needDictionary : needPlain) = true;
+        }
+        if (needPlain) frames.plain = CompressFrame(m_batchCompressor, data, frames.size);
+        if (needDictionary) frames.dictionary = CompressFrame(m_batchDictionaryCompressor, data, frames.size);
+
+        const std::span<const ConnectionPtr> all(targets);
+        const size_t threads = m_sendPool ? m_sendPool->getThreadCount() + 1 : 1; // the caller takes a share too
+        const size_t chunkSize = (std::max)(kMinSendChunk, (all.size() + threads - 1) / threads);
+        const size_t chunkCount = (all.size() + chunkSize - 1) / chunkSize;
+
+        std::atomic<bool> ok{ true };
+        std::latch done(static_cast<std::ptrdiff_t>(chunkCount - 1));
+        for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+            const auto part = all.subspan(chunk * chunkSize, (std::min)(chunkSize, all.size() - chunk * chunkSize));
+            auto task = [this, part, &frames, &ok, &done] {
+                if (!SendFrames(part, frames)) ok.store(false, std::memory_order_relaxed);
+                done.count_down();
+                };
+            if (!m_sendPool->post(task)) task(); // pool stopping
         }
+        bool sent = SendFrames(all.first((std::min)(chunkSize, all.size())), frames);
+        done.wait();
+        sent = ok.load(std::memory_order_relaxed) && sent;
+        return sent ? RIFT_SUCCESS : RIFT_ERROR_SEND_FAILED;
     }
 
     // =========================
     // INetworkIOEvents
     // =========================
     void OnRawDataReceived(const RiftNet::Networking::NetworkEndpoint& sender,
-        const uint8_t* data,
+        uint8_t* data,
         uint32_t size,
         RiftNet::Networking::OverlappedIOContext* /*context*/) override
     {
         if (!m_isRunning.load(std::memory_order_acquire)) return;
 
-        auto connection = FindOrCreateConnection(sender);
-        if (connection) {
+        if (auto connection = m_clients.FindByEndpoint(sender)) {
             connection->ProcessIncomingRawPacket(data, size);
+            return;
+        }
+        if (m_config.connection_migration != 0 && !RiftNet::Protocol::Handshake::IsHandshakeFrame(data, size)) {
+            MigrateConnection(sender, data, size);
+            return;
         }
+        AcceptHandshake(sender, data, size);
     }
 
     void OnSendCompleted(RiftNet::Networking::OverlappedIOContext* /*context*/,
@@ -127,99 +412,323 @@ public:
     }
 
 private:
+    // Sleeps until the earliest connection deadline in the timer wheel (or an earlier one is
+    // armed), then services only the connections whose timers expired.
     void Update(std::stop_token st) {
-        using namespace std::chrono_literals;
-        const auto kTick = 100ms;
-        const auto kIdleTimeout = std::chrono::seconds(30); // give clients time; client sends keepalives
+        std::vector<RiftClientId> expired;
+        auto nextStats = Clock::now() + m_statsInterval;
 
         while (!st.stop_requested()) {
-            std::this_thread::sleep_for(kTick);
+            {
+                std::unique_lock<std::mutex> lock(m_timerWakeMutex);
+                auto latest = Clock::now() + m_maxTimerSleep;
+                if (m_config.stats_callback && nextStats < latest) latest = nextStats;
+                const auto next = m_timers.NextDeadline();
+                m_nextWake = (next < latest) ? next : latest;
+                m_timerWake.wait_until(lock, st, m_nextWake, [this] { return m_timerWakePending; });
+                m_timerWakePending = false;
+            }
             if (!m_isRunning.load(std::memory_order_acquire)) break;
 
-            const auto now = std::chrono::steady_clock::now();
-            std::vector<RiftClientId> toDisconnect;
+            const auto now = Clock::now();
+            expired.clear();
+            m_timers.Advance(now, expired);
 
-            {
-                std::lock_guard<std::mutex> lock(m_clientMutex);
-                for (auto& pair : m_clientsById) {
-                    pair.second->Update(now);
-                    if (pair.second->IsTimedOut(now, kIdleTimeout)) {
-                        toDisconnect.push_back(pair.first);
-                    }
-                }
+            for (RiftClientId id : expired) {
+                ServiceConnection(id, now);
+            }
+            m_keyPool.Refill(kKeyPoolRefillBatch);
+
+            if (m_config.stats_callback && now >= nextStats) {
+                RiftStats stats;
+                GetStats(stats);
+                m_config.stats_callback(&stats, m_config.user_data);
+                nextStats = now + m_statsInterval;
             }
+        }
+    }
+
+    void ServiceConnection(RiftClientId id, Clock::time_point now) {
+        ConnectionPtr connection = m_clients.FindById(id);
+        if (!connection) return;
+
+        connection->Update(now);
+        if (connection->IsTimedOut(now, m_idleTimeout)) {
+            DisconnectClient(id);
+            return;
+        }
+        ScheduleTimer(id, connection->GetNextDeadline(m_idleTimeout));
+    }
+
+    // Safe from any thread; wakes the timer thread only if this deadline is earlier than its sleep.
+    void ScheduleTimer(RiftClientId id, Clock::time_point deadline) {
+        if (!m_timers.ScheduleNoLaterThan(id, deadline)) return;
+
+        std::lock_guard<std::mutex> lock(m_timerWakeMutex);
+        if (deadline < m_nextWake) {
+            m_timerWakePending = true;
+            m_timerWake.notify_one();
+        }
+    }
+
+    // A sealed datagram from an unknown endpoint may be a known client whose address changed:
+    // its routing id names the connection, which moves only if the datagram authenticates and
+    // no other connection holds the new address.
+    void MigrateConnection(const RiftNet::Networking::NetworkEndpoint& sender, uint8_t* data, uint32_t size) {
+        if (size < RiftNet::Protocol::ROUTING_ID_SIZE) return;
+        const uint32_t routingId = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+            (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+
+        RiftClientId id = 0;
+        ConnectionPtr connection = m_clients.FindByRoutingId(routingId, id);
+        if (!connection) return;
+
+        connection->ProcessMigratedPacket(sender, data, size,
+            [&](const RiftNet::Networking::NetworkEndpoint& previous) { return m_clients.Rebind(id, previous, sender); });
+    }
 
-            for (RiftClientId id : toDisconnect) {
-                DisconnectClient(id);
+    // Unknown endpoints get no state until they echo a cookie: a HELLO is answered with a
+    // stateless challenge, and only a RESPONSE carrying a valid cookie creates the connection.
+    // A RESUME whose session ticket redeems needs no cookie (the ticket comes from a secure
+    // session, and each works once); one that does not is challenged like a HELLO. A RESUME
+    // whose endpoint has gained a connection since the receive path looked (a duplicate racing the
+    // copy that created it) goes to that connection without spending the ticket.
+    // Anything else from an unknown endpoint is dropped.
+    void AcceptHandshake(const RiftNet::Networking::NetworkEndpoint& sender, uint8_t* data, uint32_t size) {
+        namespace Handshake = RiftNet::Protocol::Handshake;
+
+        byte_vec peerPub;
+        uint8_t peerCaps = 0;
+        uint32_t peerDictionaryId = 0;
+        uint32_t peerRoutingId = 0;
+        std::span<const uint8_t> ticket;
+        std::span<const uint8_t> sealedEarlyData;
+        const bool resume = Handshake::TryParseResume(data, size, peerPub, peerCaps, peerDictionaryId, peerRoutingId,
+            ticket, sealedEarlyData);
+        if (resume) {
+            if (auto existing = m_clients.FindByEndpoint(sender)) {
+                existing->ProcessIncomingRawPacket(data, size);
+                return;
             }
         }
+
+        RiftNet::Security::KeyBuffer resumptionSecret{};
+        const bool resumed = resume && m_config.session_tickets != 0 && m_tickets.Redeem(ticket, Clock::now(), resumptionSecret);
+        if (!resumed && (resume || Handshake::TryParseHello(data, size, peerPub, peerCaps, peerDictionaryId, peerRoutingId))) {
+            const auto challenge = Handshake::BuildChallenge(m_cookies.Issue(sender, peerPub, Clock::now()));
+            m_networkIO->SendData(sender, challenge.data(), static_cast<uint32_t>(challenge.size()));
+            return;
+        }
+
+        RiftNet::Security::Cookie cookie{};
+        if (!resumed && (!Handshake::TryParseResponse(data, size, peerPub, peerCaps, peerDictionaryId, peerRoutingId, cookie) ||
+            !m_cookies.Verify(sender, peerPub, cookie, Clock::now()))) {
+            return;
+        }
+
+        RiftClientId id = 0;
+        bool created = false;
+        ConnectionPtr connection = m_clients.FindOrCreate(sender,
+            [&](RiftClientId newId) { return CreateConnection(sender, newId); }, id, created);
+        if (!connection) return;
+
+        if (!created) {
+            sodium_memzero(resumptionSecret.data(), resumptionSecret.size());
+            connection->ProcessIncomingRawPacket(data, size);
+            return;
+        }
+
+        if (resumed) {
+            connection->SetResumptionSecret(resumptionSecret);
+        }
+        sodium_memzero(resumptionSecret.data(), resumptionSecret.size());
+        if (!PostHandshake(id, connection, data, size)) {
+            CompleteHandshake(id, connection, data, size);
+        }
+    }
+
+    // Hands the key agreement of a new connection to the handshake threads, if configured and
+    // their queue has room, so the receiving I/O thread goes back to established clients' packets.
+    bool PostHandshake(RiftClientId id, const ConnectionPtr& connection, const uint8_t* data, uint32_t size) {
+        if (!m_handshakePool) return false;
+        if (m_handshakesQueued.fetch_add(1, std::memory_order_acq_rel) >= m_handshakeQueueLimit) {
+            m_handshakesQueued.fetch_sub(1, std::memory_order_acq_rel);
+            RF_NETWORK_WARN_LIMITED("Handshake queue full ({} waiting); handshaking with {} on the receive thread",
+                m_handshakeQueueLimit, connection->GetEndpoint());
+            return false;
+        }
+
+        auto job = std::make_unique<PendingHandshake>(PendingHandshake{ id, connection, std::vector<uint8_t>(data, data + size) });
+        const bool posted = m_handshakePool->post([this, job = std::move(job)]() mutable {
+            m_handshakesQueued.fetch_sub(1, std::memory_order_acq_rel);
+            if (!m_isRunning.load(std::memory_order_acquire)) return;
+            CompleteHandshake(job->id, job->connection, job->datagram.data(), static_cast<uint32_t>(job->datagram.size()));
+            m_keyPool.Refill(1); // replace the keypair this accept took, off the receive path
+            });
+        if (!posted) {
+            m_handshakesQueued.fetch_sub(1, std::memory_order_acq_rel); // pool stopping
+        }
+        return posted;
     }
 
-    ConnectionPtr FindOrCreateConnection(const RiftNet::Networking::NetworkEndpoint& endpoint) {
-        std::lock_guard<std::mutex> lock(m_clientMutex);
+    // Derives the session keys from the client's handshake datagram (replying with our HELLO and
+    // flushing anything queued meanwhile), then announces the client.
+    void CompleteHandshake(RiftClientId id, const ConnectionPtr& connection, uint8_t* data, uint32_t size) {
+        connection->ProcessIncomingRawPacket(data, size);
+
+        // The cookie proved the address, not the key; a handshake that fails leaves nothing behind
+        if (!connection->IsSecure()) {
+            RemoveClient(id);
+            return;
+        }
+
+        ScheduleTimer(id, connection->GetNextDeadline(m_idleTimeout));
 
-        if (auto it = m_clientsByEndpoint.find(endpoint); it != m_clientsByEndpoint.end()) {
-            return it->second;
+        RiftEvent connectedEvent{};
+        connectedEvent.type = RIFT_EVENT_CLIENT_CONNECTED;
+        connectedEvent.data.client_id = id;
+        RaiseEvent(connectedEvent);
+
+        connection->DeliverEarlyData();
+        if (m_config.session_tickets != 0) {
+            connection->SendSessionTicket(m_tickets.Issue(Clock::now()));
         }
+    }
 
-        RiftClientId newId = m_nextClientId.fetch_add(1, std::memory_order_relaxed);
-        auto newConnection = std::make_shared<RiftNet::Protocol::Connection>(endpoint, /*isServer=*/true);
+    ConnectionPtr CreateConnection(const RiftNet::Networking::NetworkEndpoint& endpoint, RiftClientId newId) {
+        auto newConnection = m_connectionPool.Acquire(endpoint, /*isServer=*/true, m_keyPool.Take());
+        newConnection->SetCoalescing(m_config.coalesce_budget);
+        newConnection->SetExtendedAcks(m_config.extended_acks != 0);
+        newConnection->SetChannels(m_channelTypes);
+        newConnection->SetCongestionController(RiftNet::Api::MakeCongestionController(m_config.congestion_control, m_config.pacing_rate));
+        newConnection->SetRetransmitTimeoutBounds(
+            RiftNet::Tuning::ResolveMinRto(m_tuning), RiftNet::Tuning::ResolveMaxRto(m_tuning));
+        newConnection->SetSendBudget(m_config.send_budget_bytes, std::chrono::milliseconds(m_config.send_budget_tick_ms));
+        newConnection->SetMaxDatagramSize(m_config.max_datagram_size != 0 ? m_config.max_datagram_size
+            : RiftNet::Protocol::DEFAULT_MAX_DATAGRAM_SIZE, m_config.mtu_probing != 0);
+        newConnection->SetCompression(m_dictionary, m_config.compression_threshold);
+        newConnection->SetStreamCompression(m_config.stream_compression_window);
+        newConnection->SetPendingSendLimit(m_config.pending_send_bytes, RiftNet::Api::ToOverflowPolicy(m_config.pending_send_policy));
+        if (m_config.connection_migration != 0) {
+            newConnection->SetRoutingId(m_clients.ReserveRoutingId(newId));
+        }
 
         newConnection->SetSendCallback([this](const RiftNet::Networking::NetworkEndpoint& ep,
-            const std::vector<uint8_t>& data) {
-                m_networkIO->SendData(ep, data.data(), static_cast<uint32_t>(data.size()));
+            const RiftNet::Networking::PacketBufferPtr& packet) {
+                m_networkIO->SendData(ep, packet);
             });
 
-        newConnection->SetAppDataCallback([this, newId](const uint8_t* data, uint32_t size) {
+        newConnection->SetTimerCallback([this, newId](Clock::time_point deadline) {
+            ScheduleTimer(newId, deadline);
+            });
+
+        newConnection->SetAppDataCallback([this, newId](const uint8_t* data, uint32_t size, uint8_t channel) {
+            if (m_capture) m_capture->RecordPayload(newId, channel, data, size);
             RiftEvent appEvent{};
             appEvent.type = RIFT_EVENT_PACKET_RECEIVED;
             appEvent.data.packet.sender_id = newId;
             appEvent.data.packet.data = data;
             appEvent.data.packet.size = size;
-            m_config.event_callback(&appEvent, m_config.user_data);
+            appEvent.data.packet.channel = channel;
+            RaiseEvent(appEvent);
             });
 
-        m_clientsById[newId] = newConnection;
-        m_clientsByEndpoint[endpoint] = newConnection;
+        return newConnection;
+    }
 
-        RiftEvent connectedEvent{};
-        connectedEvent.type = RIFT_EVENT_CLIENT_CONNECTED;
-        connectedEvent.data.client_id = newId;
-        m_config.event_callback(&connectedEvent, m_config.user_data);
+    static std::vector<uint8_t> CompressFrame(RiftNet::Compression::Compressor& compressor, const uint8_t* data, uint32_t size) {
+        std::vector<uint8_t> frame(RiftNet::Compression::Compressor::CompressBound(size));
+        frame.resize(compressor.CompressInto({ data, size }, frame));
+        return frame;
+    }
 
-        return newConnection;
+    // Connections that cannot take the shared frame (not secure yet, coalescing, or a compression
+    // mode that changed since the frames were built) compress the payload themselves.
+    bool SendFrames(std::span<const ConnectionPtr> targets, const BatchFrames& frames) {
+        SendBatchScope batch(*m_networkIO);
+        bool ok = true;
+        for (const ConnectionPtr& connection : targets) {
+            const auto& frame = connection->UsesDictionaryCompression() ? frames.dictionary : frames.plain;
+            const bool sent = (!frame.empty() && connection->CanSendCompressed())
+                ? connection->SendCompressedApplicationData(frame, frames.size, frames.reliable)
+                : connection->SendApplicationData(frames.data, frames.size, frames.reliable);
+            ok = sent && ok;
+        }
+        return ok;
     }
 
-    void DisconnectClient(RiftClientId id) {
-        ConnectionPtr connection = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(m_clientMutex);
-            auto it = m_clientsById.find(id);
-            if (it != m_clientsById.end()) {
-                connection = it->second;
-                m_clientsByEndpoint.erase(connection->GetEndpoint());
-                m_clientsById.erase(it);
-            }
+    // On the calling network, handshake or timer thread, unless the application polls for events instead
+    void RaiseEvent(const RiftEvent& event) {
+        if (m_events) {
+            m_events->Push(event);
+            return;
+        }
+        m_config.event_callback(&event, m_config.user_data);
+    }
+
+    // Removes a client, keeping its counters in the server totals
+    ConnectionPtr RemoveClient(RiftClientId id) {
+        std::lock_guard<std::mutex> lock(m_statsMtx);
+        ConnectionPtr connection = m_clients.Remove(id);
+        if (connection) {
+            m_retiredMetrics += connection->GetMetrics();
         }
+        return connection;
+    }
+
+    void DisconnectClient(RiftClientId id) {
+        ConnectionPtr connection = RemoveClient(id);
+        m_timers.Cancel(id);
 
         if (connection) {
             RiftEvent disconnectedEvent{};
             disconnectedEvent.type = RIFT_EVENT_CLIENT_DISCONNECTED;
             disconnectedEvent.data.client_id = id;
-            m_config.event_callback(&disconnectedEvent, m_config.user_data);
+            RaiseEvent(disconnectedEvent);
         }
     }
 
 private:
     RiftServerConfig m_config;
+    RiftTuningConfig m_tuning; // zero fields keep their defaults
+    std::shared_ptr<RiftNet::Networking::CaptureWriter> m_capture; // null unless capture_path is set; closed after m_networkIO
     std::unique_ptr<RiftNet::Networking::INetworkIO> m_networkIO;
-
-    std::mutex m_clientMutex;
-    std::unordered_map<RiftClientId, ConnectionPtr> m_clientsById;
-    std::unordered_map<RiftNet::Networking::NetworkEndpoint, ConnectionPtr> m_clientsByEndpoint;
-    std::atomic<RiftClientId> m_nextClientId;
+    std::vector<RiftNet::Protocol::ChannelType> m_channelTypes; // applied to every new connection
+    std::shared_ptr<const RiftNet::Compression::CompressionDictionary> m_dictionary; // shared by every connection
+
+    RiftNet::Protocol::ConnectionTable m_clients;
+    std::unique_ptr<RiftNet::Networking::EventQueue> m_events; // null: events go straight to event_callback
+
+    // Counters of removed clients; held while removing one, so a snapshot counts each client exactly once
+    std::mutex                                  m_statsMtx;
+    RiftNet::Metrics::ConnectionMetricsSnapshot m_retiredMetrics;
+    std::chrono::milliseconds                   m_statsInterval;
+    std::chrono::milliseconds                   m_idleTimeout;
+    std::chrono::milliseconds                   m_maxTimerSleep; // longest the update thread sleeps
+
+    // Batch sends: payloads are compressed here once, and fanned out on m_sendPool if configured
+    RiftNet::Compression::Compressor m_batchCompressor;
+    RiftNet::Compression::Compressor m_batchDictionaryCompressor;
+    std::unique_ptr<RiftNet::Threading::TaskThreadPool> m_sendPool;
+
+    RiftNet::Security::HandshakeCookie m_cookies;              // admits only peers that echo a challenge
+    RiftNet::Security::KeyPool         m_keyPool{ kKeyPoolSize }; // ephemeral keys for new connections
+    RiftNet::Protocol::ConnectionPool  m_connectionPool;       // recycles connections dropped on disconnect
+    RiftNet::Security::SessionTicketIssuer m_tickets;          // resumption tickets; a restart invalidates them
+
+    // Per-connection retransmit / flush / idle deadlines, keyed by client id
+    RiftNet::Networking::TimerWheel m_timers;
+    std::mutex                      m_timerWakeMutex;
+    std::condition_variable_any     m_timerWake;
+    Clock::time_point               m_nextWake{ Clock::time_point::max() };
+    bool                            m_timerWakePending{ false };
+
+    uint32_t              m_handshakeQueueLimit;
+    std::atomic<uint32_t> m_handshakesQueued{ 0 }; // posted to m_handshakePool and not yet started
 
     std::atomic<bool> m_isRunning;
+    // Runs CompleteHandshake if handshake_threads is set; joined before the state its tasks use is destroyed
+    std::unique_ptr<RiftNet::Threading::TaskThreadPool> m_handshakePool;
     std::jthread m_updateThread; // auto-joins in dtor; keep last
 };
 
@@ -231,7 +740,14 @@ extern "C" {
 #endif
 
     RiftServerHandle rift_server_create(const RiftServerConfig* config) {
-        if (!config || !config->event_callback) return nullptr;
+        if (!config || (!config->event_callback && config->event_queue_size == 0)) return nullptr;
+        if (config->event_queue_size > RiftNet::Networking::MAX_EVENT_QUEUE_SIZE) return nullptr;
+        if (!RiftNet::Api::IsValidChannelConfig(config->channel_types, config->channel_count)) return nullptr;
+        if (!RiftNet::Api::IsValidCongestionConfig(config->congestion_control, config->pacing_rate)) return nullptr;
+        if (config->compression_dictionary_size != 0 && !config->compression_dictionary) return nullptr;
+        if (config->receive_shards > kMaxReceiveShards) return nullptr;
+        if (config->pending_send_policy < RIFT_PENDING_DROP_OLDEST || config->pending_send_policy > RIFT_PENDING_REJECT) return nullptr;
+        if (!RiftNet::Tuning::IsValidTuning(config->tuning)) return nullptr;
         try {
             return reinterpret_cast<RiftServerHandle>(new RiftServer_Internal(config));
         }
@@ -263,12 +779,75 @@ extern "C" {
         return reinterpret_cast<RiftServer_Internal*>(server)->Send(client_id, data, size, /*reliable=*/true);
     }
 
+    RiftResult rift_server_send_channel(RiftServerHandle server, RiftClientId client_id, uint8_t channel,
+        const uint8_t* data, size_t size) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftServer_Internal*>(server)->SendChannel(client_id, channel, data, size);
+    }
+
+    RiftResult rift_server_send_ex(RiftServerHandle server, RiftClientId client_id, uint8_t channel,
+        const RiftSendOptions* options, const uint8_t* data, size_t size) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftServer_Internal*>(server)->SendEx(client_id, channel, options, data, size);
+    }
+
+    RiftResult rift_server_send_snapshot(RiftServerHandle server, RiftClientId client_id, const uint8_t* data, size_t size) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftServer_Internal*>(server)->SendSnapshot(client_id, data, size);
+    }
+
+    RiftResult rift_server_get_connection_stats(RiftServerHandle server, RiftClientId client_id,
+        RiftConnectionStats* out_stats) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_stats) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftServer_Internal*>(server)->GetConnectionStats(client_id, *out_stats);
+    }
+
+    RiftResult rift_server_get_stats(RiftServerHandle server, RiftStats* out_stats) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_stats) return RIFT_ERROR_INVALID_PARAMETER;
+        reinterpret_cast<RiftServer_Internal*>(server)->GetStats(*out_stats);
+        return RIFT_SUCCESS;
+    }
+
+    RiftResult rift_server_get_client_stats(RiftServerHandle server, RiftClientId client_id, RiftStats* out_stats) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        if (!out_stats) return RIFT_ERROR_INVALID_PARAMETER;
+        return reinterpret_cast<RiftServer_Internal*>(server)->GetClientStats(client_id, *out_stats);
+    }
+
+    size_t rift_server_poll_events(RiftServerHandle server, RiftEvent* events, size_t max_events) {
+        if (!server || !events) return 0;
+        return reinterpret_cast<RiftServer_Internal*>(server)->PollEvents(events, max_events);
+    }
+
     RiftResult rift_server_broadcast(RiftServerHandle server, const uint8_t* data, size_t size) {
         if (!server) return RIFT_ERROR_INVALID_HANDLE;
         reinterpret_cast<RiftServer_Internal*>(server)->Broadcast(data, size, /*reliable=*/true);
         return RIFT_SUCCESS;
     }
 
+    RiftResult rift_server_send_batch(RiftServerHandle server, const RiftClientId* client_ids, size_t client_count,
+        const uint8_t* data, size_t size) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        if (!client_ids && client_count != 0) return RIFT_ERROR_INVALID_PARAMETER;
+        if (client_count == 0) return RIFT_SUCCESS;
+        return reinterpret_cast<RiftServer_Internal*>(server)->SendBatch(client_ids, client_count, data, size, /*reliable=*/true);
+    }
+
+    RiftResult rift_server_send_batch_unreliable(RiftServerHandle server, const RiftClientId* client_ids, size_t client_count,
+        const uint8_t* data, size_t size) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        if (!client_ids && client_count != 0) return RIFT_ERROR_INVALID_PARAMETER;
+        if (client_count == 0) return RIFT_SUCCESS;
+        return reinterpret_cast<RiftServer_Internal*>(server)->SendBatch(client_ids, client_count, data, size, /*reliable=*/false);
+    }
+
+    RiftResult rift_server_flush(RiftServerHandle server, RiftClientId client_id) {
+        if (!server) return RIFT_ERROR_INVALID_HANDLE;
+        return reinterpret_cast<RiftServer_Internal*>(server)->Flush(client_id);
+    }
+
     // Explicit variants for benchmark/control:
     RiftResult rift_server_send_reliable(RiftServerHandle server, RiftClientId client_id, const uint8_t* data, size_t size) {
         if (!server) return RIFT_ERROR_INVALID_HANDLE;
@@ -2,69 +2,332 @@
 #include "Compressor.hpp"
 #include "../../../utilities/logger/Logger.hpp"
 
-#include <exception>
-#include <string>
+#include <lz4.h>
+
+#include <algorithm> // For std::min
+#include <cstring>
 #include <vector>
 
 namespace RiftNet::Compression {
 
-    Compressor::Compressor() {
-        try {
-            // Default to LZ4 for real-time-friendly speed.
-            auto lz4_algo = std::make_unique<LZ4Algorithm>();
-            m_compressor = std::make_unique<::Compressor>(std::move(lz4_algo));
-            RF_NETWORK_DEBUG("Compressor initialized with LZ4Algorithm");
+    namespace {
+        constexpr size_t kFlagsSize = 1;
+        constexpr size_t kMaxVarintSize = 3; // enough for kMaxDecompressedSize
+        static_assert(Compressor::kMaxDecompressedSize < (size_t{ 1 } << (7 * kMaxVarintSize)));
+
+        // Running-ratio bypass: above this ratio (in 1/1024ths) compression is not worth its CPU,
+        // so the next BYPASS_PAYLOADS eligible payloads are stored before trying again.
+        constexpr uint32_t BYPASS_RATIO = 990;   // ~3% saving
+        constexpr uint32_t RATIO_EWMA_SHIFT = 4; // each sample moves the average 1/16 of the way
+        constexpr uint32_t BYPASS_PAYLOADS = 64;
+
+        // Validates a frame's flags and size header; headerSize is where its payload starts.
+        bool ParseFrameHeader(std::span<const uint8_t> frame, uint8_t& flags, size_t& rawSize, size_t& headerSize) {
+            if (frame.size() < kFlagsSize) {
+                RF_NETWORK_WARN_LIMITED("Compressor::Decompress: empty frame");
+                return false;
+            }
+
+            flags = frame[0];
+            if ((flags & Compressor::kFlagStream) != 0) {
+                RF_NETWORK_WARN_LIMITED("Compressor::Decompress: stream frame outside a compression stream");
+                return false;
+            }
+            const uint8_t known = Compressor::kFlagCompressed | Compressor::kFlagDictionary;
+            if ((flags & ~known) != 0 ||
+                ((flags & Compressor::kFlagDictionary) != 0 && (flags & Compressor::kFlagCompressed) == 0)) {
+                RF_NETWORK_WARN_LIMITED("Compressor::Decompress: unknown frame flags 0x{:02x}", flags);
+                return false;
+            }
+            if ((flags & Compressor::kFlagCompressed) == 0) {
+                rawSize = frame.size() - kFlagsSize;
+                headerSize = kFlagsSize;
+                return true;
+            }
+
+            const size_t varintSize = Compressor::ReadSizeHeader(frame.subspan(kFlagsSize), rawSize);
+            if (varintSize == 0) {
+                return false;
+            }
+            headerSize = kFlagsSize + varintSize;
+            return true;
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_CRITICAL("Compressor::Compressor init failed: {}", e.what());
-            m_compressor = nullptr;
+
+        uint32_t Fnv1a(std::span<const uint8_t> bytes) {
+            uint32_t hash = 2166136261u;
+            for (uint8_t b : bytes) {
+                hash = (hash ^ b) * 16777619u;
+            }
+            return hash;
         }
-        catch (...) {
-            RF_NETWORK_CRITICAL("Compressor::Compressor init failed: unknown exception");
-            m_compressor = nullptr;
+
+        // Per-thread working stream for dictionary compression, so concurrent sends never share one
+        LZ4_stream_t* ThreadStream() {
+            thread_local LZ4_stream_t stream;
+            return &stream;
         }
     }
 
+    // =========================
+    // CompressionDictionary
+    // =========================
+
+    struct CompressionDictionary::State {
+        LZ4_stream_t stream; // references m_bytes in place
+    };
+
+    CompressionDictionary::~CompressionDictionary() = default;
+
+    std::shared_ptr<const CompressionDictionary> CompressionDictionary::Create(std::span<const uint8_t> bytes) {
+        if (bytes.empty()) {
+            return nullptr;
+        }
+        if (bytes.size() > kMaxSize) {
+            RF_NETWORK_WARN("Compression dictionary of {} bytes; using its last {}", bytes.size(), kMaxSize);
+            bytes = bytes.last(kMaxSize);
+        }
+
+        std::shared_ptr<CompressionDictionary> dictionary(new CompressionDictionary());
+        dictionary->m_bytes.assign(bytes.begin(), bytes.end());
+        dictionary->m_id = Fnv1a(dictionary->m_bytes);
+        dictionary->m_state = std::make_unique<State>();
+        LZ4_initStream(&dictionary->m_state->stream, sizeof(dictionary->m_state->stream));
+        LZ4_loadDict(&dictionary->m_state->stream,
+            reinterpret_cast<const char*>(dictionary->m_bytes.data()), static_cast<int>(dictionary->m_bytes.size()));
+
+        RF_NETWORK_INFO("Compression dictionary loaded: {} bytes, id={:08x}", dictionary->m_bytes.size(), dictionary->m_id);
+        return dictionary;
+    }
+
+    // =========================
+    // Compressor
+    // =========================
+
+    Compressor::Compressor() {
+        RF_NETWORK_DEBUG("Compressor initialized with LZ4 block format");
+    }
+
     Compressor::~Compressor() = default;
 
-    std::vector<uint8_t> Compressor::Compress(const std::vector<uint8_t>& plainData) {
-        if (!m_compressor) {
-            RF_NETWORK_WARN("Compressor::Compress called but compressor not initialized ({} bytes input)", plainData.size());
-            return {};
+    void Compressor::Reset() {
+        m_dictionary.reset();
+        m_useDictionary.store(false, std::memory_order_relaxed);
+        m_threshold.store(0, std::memory_order_relaxed);
+        m_ratio.store(kInitialRatio, std::memory_order_relaxed);
+        m_bypassRemaining.store(0, std::memory_order_relaxed);
+    }
+
+    size_t Compressor::SizeHeaderLength(size_t rawSize) {
+        size_t size = 1;
+        while (rawSize >= 0x80) {
+            rawSize >>= 7;
+            ++size;
         }
-        try {
-            auto out = m_compressor->compress(plainData);
-            RF_NETWORK_TRACE("Compress ok: in={} bytes, out={} bytes", plainData.size(), out.size());
-            return out;
+        return size;
+    }
+
+    void Compressor::WriteSizeHeader(uint8_t* out, size_t rawSize) {
+        while (rawSize >= 0x80) {
+            *out++ = static_cast<uint8_t>(rawSize | 0x80);
+            rawSize >>= 7;
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Compressor::Compress threw: {}", e.what());
-            return {};
+        *out = static_cast<uint8_t>(rawSize);
+    }
+
+    size_t Compressor::ReadSizeHeader(std::span<const uint8_t> in, size_t& rawSize) {
+        rawSize = 0;
+        for (size_t i = 0; i < (std::min)(in.size(), kMaxVarintSize); ++i) {
+            rawSize |= static_cast<size_t>(in[i] & 0x7F) << (7 * i);
+            if ((in[i] & 0x80) != 0) continue;
+            if (rawSize > kMaxDecompressedSize) {
+                RF_NETWORK_WARN_LIMITED("Compressor: declared size {} exceeds limit {}", rawSize, kMaxDecompressedSize);
+                return 0;
+            }
+            return i + 1;
         }
-        catch (...) {
-            RF_NETWORK_ERROR("Compressor::Compress threw: unknown exception");
-            return {};
+        RF_NETWORK_WARN_LIMITED("Compressor: malformed size header");
+        return 0;
+    }
+
+    size_t Compressor::CompressBound(size_t plainSize) {
+        if (plainSize > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) return 0;
+        return kFlagsSize + plainSize;
+    }
+
+    void Compressor::SetThreshold(size_t bytes) {
+        m_threshold.store(bytes, std::memory_order_relaxed);
+    }
+
+    void Compressor::SetDictionary(std::shared_ptr<const CompressionDictionary> dictionary) {
+        m_dictionary = std::move(dictionary);
+        if (!m_dictionary) {
+            m_useDictionary.store(false, std::memory_order_relaxed);
         }
     }
 
-    std::vector<uint8_t> Compressor::Decompress(const std::vector<uint8_t>& compressedData) {
-        if (!m_compressor) {
-            RF_NETWORK_WARN("Compressor::Decompress called but compressor not initialized ({} bytes input)", compressedData.size());
-            return {};
+    void Compressor::SetDictionaryCompression(bool enabled) {
+        m_useDictionary.store(enabled && m_dictionary != nullptr, std::memory_order_relaxed);
+    }
+
+    bool Compressor::IsDictionaryCompressionEnabled() const {
+        return m_useDictionary.load(std::memory_order_relaxed);
+    }
+
+    bool Compressor::ShouldAttempt() {
+        // Relaxed and unsynchronized on purpose: a racing send at worst compresses or stores one extra payload
+        const uint32_t remaining = m_bypassRemaining.load(std::memory_order_relaxed);
+        if (remaining == 0) return true;
+        m_bypassRemaining.store(remaining - 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void Compressor::RecordRatio(size_t plainSize, size_t compressedSize) {
+        const uint32_t sample = static_cast<uint32_t>((std::min)(compressedSize * 1024 / plainSize, size_t{ 1024 }));
+        const uint32_t ratio = m_ratio.load(std::memory_order_relaxed);
+        const int32_t delta = (static_cast<int32_t>(sample) - static_cast<int32_t>(ratio)) >> RATIO_EWMA_SHIFT;
+        const uint32_t updated = static_cast<uint32_t>(static_cast<int32_t>(ratio) + delta);
+
+        if (updated > BYPASS_RATIO) {
+            RF_NETWORK_DEBUG("Compressor: ratio {}/1024 shows no gain; storing the next {} payloads", updated, BYPASS_PAYLOADS);
+            m_bypassRemaining.store(BYPASS_PAYLOADS, std::memory_order_relaxed);
+            m_ratio.store(BYPASS_RATIO, std::memory_order_relaxed); // the next attempt alone decides
         }
-        try {
-            auto out = m_compressor->decompress(compressedData);
-            RF_NETWORK_TRACE("Decompress ok: in={} bytes, out={} bytes", compressedData.size(), out.size());
-            return out;
+        else {
+            m_ratio.store(updated, std::memory_order_relaxed);
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Compressor::Decompress threw: {}", e.what());
+    }
+
+    size_t Compressor::CompressInto(std::span<const uint8_t> plainData, std::span<uint8_t> out) {
+        const size_t plainSize = plainData.size();
+        if (plainSize > static_cast<size_t>(LZ4_MAX_INPUT_SIZE) || out.size() < CompressBound(plainSize)) {
+            RF_NETWORK_WARN_LIMITED("Compressor::CompressInto: invalid sizes (in={} bytes, out capacity={} bytes)",
+                plainSize, out.size());
+            return 0;
+        }
+
+        const bool useDictionary = m_useDictionary.load(std::memory_order_relaxed);
+        size_t threshold = m_threshold.load(std::memory_order_relaxed);
+        if (threshold == 0) {
+            threshold = useDictionary ? kDefaultDictionaryThreshold : kDefaultThreshold;
+        }
+
+        const size_t headerSize = kFlagsSize + SizeHeaderLength(plainSize);
+        if (plainSize >= threshold && plainSize > headerSize && ShouldAttempt()) {
+            // Capped so LZ4 gives up rather than produce a frame no smaller than storing it
+            const int capacity = static_cast<int>(plainSize - headerSize);
+            const char* src = reinterpret_cast<const char*>(plainData.data());
+            char* dst = reinterpret_cast<char*>(out.data() + headerSize);
+
+            int written = 0;
+            if (useDictionary) {
+                // A copy of the preloaded stream starts every payload from the dictionary alone
+                // (LZ4_attach_dictionary would avoid the copy, but is not exported by shared LZ4 builds)
+                LZ4_stream_t* stream = ThreadStream();
+                std::memcpy(stream, &m_dictionary->m_state->stream, sizeof(LZ4_stream_t));
+                written = LZ4_compress_fast_continue(stream, src, dst, static_cast<int>(plainSize), capacity, 1);
+            }
+            else {
+                written = LZ4_compress_default(src, dst, static_cast<int>(plainSize), capacity);
+            }
+
+            RecordRatio(plainSize, written > 0 ? headerSize + static_cast<size_t>(written) : plainSize);
+            if (written > 0) {
+                out[0] = kFlagCompressed | (useDictionary ? kFlagDictionary : 0);
+                WriteSizeHeader(out.data() + kFlagsSize, plainSize);
+                RF_NETWORK_TRACE("Compress ok: in={} bytes, out={} bytes", plainSize, headerSize + written);
+                return headerSize + static_cast<size_t>(written);
+            }
+        }
+
+        out[0] = 0; // stored
+        if (plainSize != 0) {
+            std::memcpy(out.data() + kFlagsSize, plainData.data(), plainSize);
+        }
+        return kFlagsSize + plainSize;
+    }
+
+    std::vector<uint8_t> Compressor::Compress(const std::vector<uint8_t>& plainData) {
+        std::vector<uint8_t> out(CompressBound(plainData.size()));
+        const size_t written = CompressInto(plainData, out);
+        out.resize(written);
+        return out;
+    }
+
+    bool Compressor::GetDecompressedSize(std::span<const uint8_t> compressedData, size_t& outSize) {
+        uint8_t flags = 0;
+        size_t headerSize = 0;
+        return ParseFrameHeader(compressedData, flags, outSize, headerSize);
+    }
+
+    bool Compressor::TryGetStored(std::span<const uint8_t> compressedData, std::span<const uint8_t>& outPayload) {
+        if (compressedData.empty() || compressedData[0] != 0) {
+            return false;
+        }
+        outPayload = compressedData.subspan(kFlagsSize);
+        return true;
+    }
+
+    bool Compressor::Decompress(std::span<const uint8_t> compressedData, std::span<uint8_t> out, size_t& outSize) {
+        outSize = 0;
+
+        uint8_t flags = 0;
+        size_t rawSize = 0;
+        size_t headerSize = 0;
+        if (!ParseFrameHeader(compressedData, flags, rawSize, headerSize)) {
+            return false;
+        }
+        if (out.size() < rawSize) {
+            RF_NETWORK_WARN_LIMITED("Compressor::Decompress: output too small ({} < {} bytes)", out.size(), rawSize);
+            return false;
+        }
+
+        if ((flags & kFlagCompressed) == 0) {
+            if (rawSize != 0) {
+                std::memcpy(out.data(), compressedData.data() + kFlagsSize, rawSize);
+            }
+            outSize = rawSize;
+            return true;
+        }
+
+        const char* src = reinterpret_cast<const char*>(compressedData.data() + headerSize);
+        const int srcSize = static_cast<int>(compressedData.size() - headerSize);
+        char* dst = reinterpret_cast<char*>(out.data());
+
+        int written = -1;
+        if ((flags & kFlagDictionary) != 0) {
+            if (!m_dictionary) {
+                RF_NETWORK_WARN_LIMITED("Compressor::Decompress: dictionary frame but no dictionary loaded");
+                return false;
+            }
+            const auto dictionary = m_dictionary->GetBytes();
+            written = LZ4_decompress_safe_usingDict(src, dst, srcSize, static_cast<int>(rawSize),
+                reinterpret_cast<const char*>(dictionary.data()), static_cast<int>(dictionary.size()));
+        }
+        else {
+            written = LZ4_decompress_safe(src, dst, srcSize, static_cast<int>(rawSize));
+        }
+        if (written < 0 || static_cast<size_t>(written) != rawSize) {
+            RF_NETWORK_ERROR("Compressor::Decompress: LZ4 decompression failed ({} bytes input)", compressedData.size());
+            return false;
+        }
+
+        outSize = rawSize;
+        RF_NETWORK_TRACE("Decompress ok: in={} bytes, out={} bytes", compressedData.size(), outSize);
+        return true;
+    }
+
+    std::vector<uint8_t> Compressor::Decompress(const std::vector<uint8_t>& compressedData) {
+        size_t rawSize = 0;
+        if (!GetDecompressedSize(compressedData, rawSize)) {
             return {};
         }
-        catch (...) {
-            RF_NETWORK_ERROR("Compressor::Decompress threw: unknown exception");
+
+        std::vector<uint8_t> out(rawSize);
+        size_t written = 0;
+        if (!Decompress(compressedData, out, written)) {
             return {};
         }
+        return out;
     }
 
 } // namespace RiftNet::Compression
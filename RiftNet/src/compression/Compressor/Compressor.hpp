@@ -1,31 +1,147 @@
 #pragma once
 
-#include <riftcompress.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
-// Forward declare the Compressor class from the global namespace
-class Compressor;
-
 namespace RiftNet::Compression {
 
+    /**
+     * @class CompressionDictionary
+     * @brief A shared LZ4 dictionary: sample bytes that small, repetitive payloads are compressed
+     * against. Any bytes work as a raw-content dictionary; one trained with `zstd --train` on
+     * captured messages works too. Immutable once created, so one instance can serve every connection.
+     */
+    class CompressionDictionary {
+    public:
+        // LZ4 can only reference this far back; only the last kMaxSize bytes of a longer dictionary are used.
+        static constexpr size_t kMaxSize = 64 * 1024;
+
+        // @return nullptr if bytes is empty.
+        static std::shared_ptr<const CompressionDictionary> Create(std::span<const uint8_t> bytes);
+
+        ~CompressionDictionary();
+
+        // FNV-1a hash of the dictionary bytes; peers only compress with a dictionary whose ids match.
+        uint32_t GetId() const { return m_id; }
+        std::span<const uint8_t> GetBytes() const { return m_bytes; }
+
+    private:
+        friend class Compressor;
+        struct State; // the preloaded LZ4 stream
+
+        CompressionDictionary() = default;
+
+        std::vector<uint8_t>   m_bytes;
+        uint32_t               m_id{ 0 };
+        std::unique_ptr<State> m_state;
+    };
+
     /**
      * @class Compressor
      * @brief Manages the compression and decompression pipeline for a connection.
-     * This is a stateful wrapper around the stateless riftcompress library.
+     * Uses the LZ4 block format directly so callers can compress into, and decompress
+     * from, buffers they own. Frame layout: [u8 flags][payload], where payload is the raw bytes
+     * ("stored") or, with kFlagCompressed, [varint raw size][LZ4 block].
+     *
+     * Payloads are stored rather than compressed when they are below the threshold, when LZ4
+     * would not make them smaller, or while the recent compression ratio shows no gain.
+     * Compression calls may run concurrently; the setters must be called before traffic flows.
      */
     class Compressor {
     public:
+        // Largest payload Decompress will inflate; guards against hostile size headers.
+        static constexpr size_t kMaxDecompressedSize = 1024 * 1024;
+
+        // Frame flag bits
+        static constexpr uint8_t kFlagCompressed = 0x01;
+        static constexpr uint8_t kFlagDictionary = 0x02; // compressed against the shared dictionary
+        static constexpr uint8_t kFlagStream = 0x04;     // StreamCompressor frame; see StreamDecompressor
+        static constexpr uint8_t kFlagStreamReset = 0x08; // stream keyframe: history starts over
+
+        // Default thresholds: below these LZ4 rarely beats its own overhead, unless a dictionary
+        // gives it something to match against.
+        static constexpr size_t kDefaultThreshold = 64;
+        static constexpr size_t kDefaultDictionaryThreshold = 16;
+
         Compressor();
-        ~Compressor(); // Required for unique_ptr to incomplete type
+        ~Compressor();
+
+        // Returns to the state of a new Compressor: no dictionary, default threshold, no ratio history.
+        void Reset();
 
         /**
-         * @brief Compresses a block of data using the configured algorithm (LZ4 by default).
+         * @brief Upper bound of the frame size CompressInto can produce for plainSize input bytes.
+         * A payload that does not shrink is stored, so this is one byte over plainSize.
+         */
+        static size_t CompressBound(size_t plainSize);
+
+        /**
+         * @brief Payloads smaller than this are stored uncompressed.
+         * 0 picks kDefaultThreshold, or kDefaultDictionaryThreshold while a dictionary is in use.
+         */
+        void SetThreshold(size_t bytes);
+
+        /**
+         * @brief Sets the dictionary used to decompress kFlagDictionary frames from the peer.
+         * Compression only uses it once SetDictionaryCompression(true) says the peer has it too.
+         */
+        void SetDictionary(std::shared_ptr<const CompressionDictionary> dictionary);
+        void SetDictionaryCompression(bool enabled);
+        bool IsDictionaryCompressionEnabled() const;
+
+        /**
+         * @brief Compresses plainData into a caller-provided buffer.
+         * @param plainData The data to compress.
+         * @param out Destination; should be at least CompressBound(plainData.size()) bytes, and must not overlap plainData.
+         * @return The number of bytes written to out, or 0 on failure.
+         */
+        size_t CompressInto(std::span<const uint8_t> plainData, std::span<uint8_t> out);
+
+        /**
+         * @brief Compresses a block of data using LZ4.
          * @param plainData The data to compress.
          * @return A vector containing the compressed data.
          */
         std::vector<uint8_t> Compress(const std::vector<uint8_t>& plainData);
 
+        /**
+         * @brief Reads the uncompressed size declared by a frame, without decompressing it.
+         * @param compressedData A complete compressed frame.
+         * @param outSize Receives the declared size.
+         * @return False if the frame is malformed or declares more than kMaxDecompressedSize.
+         */
+        static bool GetDecompressedSize(std::span<const uint8_t> compressedData, size_t& outSize);
+
+        /**
+         * @brief If the frame is stored uncompressed, points outPayload at its bytes inside the frame.
+         * @return False for compressed or malformed frames.
+         */
+        static bool TryGetStored(std::span<const uint8_t> compressedData, std::span<const uint8_t>& outPayload);
+
+        // True for frames that only a StreamDecompressor can decode.
+        static bool IsStreamFrame(std::span<const uint8_t> compressedData) {
+            return !compressedData.empty() && (compressedData[0] & kFlagStream) != 0;
+        }
+
+        // The varint raw-size header of compressed frames, shared with StreamCompressor.
+        static size_t SizeHeaderLength(size_t rawSize);
+        static void WriteSizeHeader(uint8_t* out, size_t rawSize);
+        // @return Bytes read, or 0 if the header is truncated or declares more than kMaxDecompressedSize.
+        static size_t ReadSizeHeader(std::span<const uint8_t> in, size_t& rawSize);
+
+        /**
+         * @brief Decompresses a frame into a caller-provided buffer without allocating.
+         * @param compressedData The frame to decompress.
+         * @param out Destination; must be at least GetDecompressedSize() bytes.
+         * @param outSize Receives the number of bytes written to out.
+         * @return True on success, false on a malformed frame or a too-small destination.
+         */
+        bool Decompress(std::span<const uint8_t> compressedData, std::span<uint8_t> out, size_t& outSize);
+
         /**
          * @brief Decompresses a block of data.
          * @param compressedData The data to decompress.
@@ -34,8 +150,19 @@ namespace RiftNet::Compression {
         std::vector<uint8_t> Decompress(const std::vector<uint8_t>& compressedData);
 
     private:
-        // A unique_ptr to the Compressor class from your riftcompress library.
-        std::unique_ptr<::Compressor> m_compressor;
+        // False while the running ratio says compression is not paying off
+        bool ShouldAttempt();
+        void RecordRatio(size_t plainSize, size_t compressedSize);
+
+        std::shared_ptr<const CompressionDictionary> m_dictionary;
+        std::atomic<bool>     m_useDictionary{ false };
+        std::atomic<size_t>   m_threshold{ 0 };
+
+        // Exponentially weighted compressed/raw ratio in 1/1024ths, and payloads left to store
+        // before compression is tried again
+        static constexpr uint32_t kInitialRatio = 512;
+        std::atomic<uint32_t> m_ratio{ kInitialRatio };
+        std::atomic<uint32_t> m_bypassRemaining{ 0 };
     };
 
 } // namespace RiftNet::Compression
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "SnapshotDelta.hpp"
+
+#include "../Compressor/Compressor.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <algorithm> // For std::min
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RIFT_SNAPSHOT_SSE2 1
+#endif
+
+namespace RiftNet::Compression {
+
+    namespace {
+        constexpr size_t kMaxVarintSize = 3; // enough for MAX_SNAPSHOT_SIZE
+
+        // Unchanged bytes shorter than this stay inside the changed range: a new op would cost more
+        constexpr size_t kMinSkip = 4;
+
+        // First index in [pos, size) where a and b differ, or size
+        size_t FindChange(const uint8_t* a, const uint8_t* b, size_t pos, size_t size) {
+#if defined(RIFT_SNAPSHOT_SSE2)
+            for (; pos + 16 <= size; pos += 16) {
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + pos));
+                const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + pos));
+                const uint32_t equal = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+                if (equal != 0xFFFF) {
+                    return pos + std::countr_zero(~equal);
+                }
+            }
+#else
+            for (; pos + 8 <= size; pos += 8) {
+                uint64_t x, y;
+                std::memcpy(&x, a + pos, sizeof(x));
+                std::memcpy(&y, b + pos, sizeof(y));
+                if (x != y) {
+                    break; // located byte by byte below, whatever the endianness
+                }
+            }
+#endif
+            while (pos < size && a[pos] == b[pos]) {
+                ++pos;
+            }
+            return pos;
+        }
+
+        // End of the changed range starting at pos: the first run of kMinSkip equal bytes, or size
+        size_t FindChangeEnd(const uint8_t* a, const uint8_t* b, size_t pos, size_t size) {
+            size_t equalRun = 0;
+            for (; pos < size; ++pos) {
+                if (a[pos] != b[pos]) {
+                    equalRun = 0;
+                }
+                else if (++equalRun == kMinSkip) {
+                    return pos + 1 - kMinSkip;
+                }
+            }
+            return size - equalRun;
+        }
+
+        uint8_t* WriteVarint(uint8_t* out, size_t value) {
+            Compressor::WriteSizeHeader(out, value);
+            return out + Compressor::SizeHeaderLength(value);
+        }
+
+        bool ReadVarint(std::span<const uint8_t>& in, size_t& value) {
+            const size_t read = Compressor::ReadSizeHeader(in, value);
+            in = in.subspan(read);
+            return read != 0;
+        }
+    }
+
+    size_t SnapshotDelta::EncodeBound(size_t size) {
+        // Every op but the first and last skips at least kMinSkip bytes
+        return kMaxVarintSize + size + (size / kMinSkip + 2) * 2 * kMaxVarintSize;
+    }
+
+    size_t SnapshotDelta::Encode(std::span<const uint8_t> current, std::span<const uint8_t> baseline, std::span<uint8_t> out) {
+        const size_t size = current.size();
+        const size_t common = (std::min)(size, baseline.size());
+        const uint8_t* cur = current.data();
+        const uint8_t* base = baseline.data();
+
+        uint8_t* p = WriteVarint(out.data(), size);
+        size_t pos = 0;
+        while (pos < size) {
+            const size_t start = pos < common ? FindChange(cur, base, pos, common) : pos;
+            if (start == size) {
+                break; // the rest is unchanged
+            }
+            const size_t end = start < common ? FindChangeEnd(cur, base, start, common) : size;
+
+            p = WriteVarint(p, start - pos);
+            p = WriteVarint(p, end - start);
+            const size_t xorEnd = (std::min)(end, common);
+            for (size_t i = start; i < xorEnd; ++i) {
+                *p++ = cur[i] ^ base[i];
+            }
+            if (end > xorEnd) {
+                std::memcpy(p, cur + xorEnd, end - xorEnd);
+                p += end - xorEnd;
+            }
+            pos = end;
+        }
+        return static_cast<size_t>(p - out.data());
+    }
+
+    bool SnapshotDelta::Decode(std::span<const uint8_t> delta, std::span<const uint8_t> baseline, std::vector<uint8_t>& out) {
+        size_t size = 0;
+        if (!ReadVarint(delta, size) || size > MAX_SNAPSHOT_SIZE) {
+            RF_NETWORK_WARN_LIMITED("SnapshotDelta: bad snapshot size");
+            return false;
+        }
+
+        // Start from the baseline, zero-extended; ops then XOR in what changed
+        const size_t common = (std::min)(size, baseline.size());
+        out.resize(size);
+        if (common > 0) {
+            std::memcpy(out.data(), baseline.data(), common);
+        }
+        std::memset(out.data() + common, 0, size - common);
+
+        size_t pos = 0;
+        while (!delta.empty()) {
+            size_t skip = 0;
+            size_t length = 0;
+            if (!ReadVarint(delta, skip) || !ReadVarint(delta, length) ||
+                skip > size - pos || length > size - pos - skip || length > delta.size()) {
+                RF_NETWORK_WARN_LIMITED("SnapshotDelta: malformed delta");
+                return false;
+            }
+            pos += skip;
+            for (size_t i = 0; i < length; ++i) {
+                out[pos + i] ^= delta[i];
+            }
+            pos += length;
+            delta = delta.subspan(length);
+        }
+        return true;
+    }
+
+    bool SnapshotEncoder::Encode(std::span<const uint8_t> snapshot, std::vector<uint8_t>& out, uint32_t& outId, uint32_t& outBaselineId) {
+        if (snapshot.empty() || snapshot.size() > MAX_SNAPSHOT_SIZE) {
+            return false;
+        }
+
+        // The peer holds its last SNAPSHOT_HISTORY snapshots, so an older ack is no use as a baseline
+        std::span<const uint8_t> baseline;
+        outBaselineId = 0;
+        if (m_ackedId != 0 && m_nextId - m_ackedId < SNAPSHOT_HISTORY) {
+            const Entry& acked = m_history[m_ackedId % SNAPSHOT_HISTORY];
+            if (acked.id == m_ackedId) {
+                baseline = acked.bytes;
+                outBaselineId = m_ackedId;
+            }
+        }
+
+        out.resize(SnapshotDelta::EncodeBound(snapshot.size()));
+        out.resize(SnapshotDelta::Encode(snapshot, baseline, out));
+
+        outId = m_nextId++;
+        Entry& entry = m_history[outId % SNAPSHOT_HISTORY];
+        entry.id = outId;
+        entry.bytes.assign(snapshot.begin(), snapshot.end());
+        return true;
+    }
+
+    void SnapshotEncoder::OnAck(uint32_t id) {
+        if (id > m_ackedId && id < m_nextId) {
+            m_ackedId = id;
+        }
+    }
+
+    bool SnapshotDecoder::Decode(uint32_t id, uint32_t baselineId, std::span<const uint8_t> delta, std::span<const uint8_t>& outSnapshot) {
+        if (id <= m_newestId) {
+            return false; // late or duplicate: a newer snapshot already replaced it
+        }
+
+        std::span<const uint8_t> baseline;
+        if (baselineId != 0) {
+            // A baseline in the same slot as id would be overwritten while it is read
+            const Entry& base = m_history[baselineId % SNAPSHOT_HISTORY];
+            if (baselineId >= id || id - baselineId >= SNAPSHOT_HISTORY || base.id != baselineId) {
+                RF_NETWORK_DEBUG("SnapshotDecoder: baseline {} of snapshot {} is not held", baselineId, id);
+                return false;
+            }
+            baseline = base.bytes;
+        }
+
+        Entry& entry = m_history[id % SNAPSHOT_HISTORY];
+        entry.id = 0; // not a valid baseline unless it decodes
+        if (!SnapshotDelta::Decode(delta, baseline, entry.bytes)) {
+            return false;
+        }
+        entry.id = id;
+        m_newestId = id;
+        outSnapshot = entry.bytes;
+        return true;
+    }
+
+} // namespace RiftNet::Compression
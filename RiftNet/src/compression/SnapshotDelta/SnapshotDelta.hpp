@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace RiftNet::Compression {
+
+    // Largest snapshot SnapshotEncoder takes. Each side keeps SNAPSHOT_HISTORY of them, so this also
+    // bounds the memory a peer can make a connection hold.
+    constexpr size_t MAX_SNAPSHOT_SIZE = 32 * 1024;
+
+    // Snapshots each side remembers. A baseline the peer acknowledged more than this many snapshots
+    // ago is too old, and the next snapshot is sent whole.
+    constexpr uint32_t SNAPSHOT_HISTORY = 32;
+
+    /**
+     * @class SnapshotDelta
+     * @brief Encodes a snapshot as the byte ranges that differ from a baseline, XORed with it.
+     * Layout: [varint size] then ops [varint skip][varint length][length bytes] until size bytes are
+     * covered; skipped bytes are the baseline's, and bytes past the baseline's end XOR with zero.
+     * Unchanged regions are found 16 bytes at a time (SSE2 where available). The XORed bytes are
+     * mostly zero bits, so the frame compresses far better than the snapshot itself.
+     */
+    class SnapshotDelta {
+    public:
+        // Upper bound of the bytes Encode writes for a snapshot of size bytes.
+        static size_t EncodeBound(size_t size);
+
+        /**
+         * @brief Writes current as a delta against baseline (empty for a snapshot sent whole).
+         * @param out Destination; at least EncodeBound(current.size()) bytes.
+         * @return The number of bytes written.
+         */
+        static size_t Encode(std::span<const uint8_t> current, std::span<const uint8_t> baseline, std::span<uint8_t> out);
+
+        /**
+         * @brief Rebuilds the snapshot a delta was encoded from.
+         * @param out Receives the snapshot; its capacity is reused.
+         * @return False if the delta is malformed or larger than MAX_SNAPSHOT_SIZE.
+         */
+        static bool Decode(std::span<const uint8_t> delta, std::span<const uint8_t> baseline, std::vector<uint8_t>& out);
+    };
+
+    /**
+     * @class SnapshotEncoder
+     * @brief The sending half of snapshot replication: numbers snapshots, remembers the last
+     * SNAPSHOT_HISTORY sent, and encodes each against the newest one the peer reported receiving.
+     * Ids start at 1; baseline id 0 means the snapshot was sent whole. Not thread-safe.
+     */
+    class SnapshotEncoder {
+    public:
+        /**
+         * @brief Encodes the next snapshot and remembers it as a possible baseline.
+         * @param out Receives the delta; its capacity is reused.
+         * @param outId The id the snapshot is sent with.
+         * @param outBaselineId The id it is encoded against, or 0.
+         * @return False if snapshot is empty or larger than MAX_SNAPSHOT_SIZE.
+         */
+        bool Encode(std::span<const uint8_t> snapshot, std::vector<uint8_t>& out, uint32_t& outId, uint32_t& outBaselineId);
+
+        // The peer decoded snapshot id. Older acks than the newest one seen are ignored.
+        void OnAck(uint32_t id);
+
+        // Forgets the acknowledged baseline: the next snapshot is sent whole.
+        void Reset() { m_ackedId = 0; }
+
+        uint32_t GetAckedId() const { return m_ackedId; }
+
+    private:
+        struct Entry {
+            uint32_t id{ 0 };
+            std::vector<uint8_t> bytes;
+        };
+
+        std::array<Entry, SNAPSHOT_HISTORY> m_history{}; // snapshot id lives in slot id % SNAPSHOT_HISTORY
+        uint32_t m_nextId{ 1 };
+        uint32_t m_ackedId{ 0 };
+    };
+
+    /**
+     * @class SnapshotDecoder
+     * @brief The receiving half: rebuilds snapshots from their baselines and remembers the last
+     * SNAPSHOT_HISTORY, which the sender may use as baselines once acknowledged. A snapshot older
+     * than the newest one decoded is dropped, like a late packet on a sequenced channel. Not thread-safe.
+     */
+    class SnapshotDecoder {
+    public:
+        /**
+         * @brief Decodes snapshot id, encoded against baselineId (0 = sent whole).
+         * @param outSnapshot On success, views the snapshot; valid until the next call.
+         * @return False if the snapshot is stale, its baseline is no longer held, or the delta is malformed.
+         */
+        bool Decode(uint32_t id, uint32_t baselineId, std::span<const uint8_t> delta, std::span<const uint8_t>& outSnapshot);
+
+        // Newest snapshot decoded, or 0.
+        uint32_t GetNewestId() const { return m_newestId; }
+
+    private:
+        struct Entry {
+            uint32_t id{ 0 };
+            std::vector<uint8_t> bytes;
+        };
+
+        std::array<Entry, SNAPSHOT_HISTORY> m_history{};
+        uint32_t m_newestId{ 0 };
+    };
+
+} // namespace RiftNet::Compression
@@ -0,0 +1,213 @@
+#include "pch.h"
+#include "StreamCompressor.hpp"
+
+#include "../Compressor/Compressor.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <lz4.h>
+
+#include <algorithm> // For std::clamp
+#include <bit>
+#include <cstring>
+
+namespace RiftNet::Compression {
+
+    namespace {
+        constexpr size_t kFlagsSize = 1;
+        constexpr size_t kWindowLogSize = 1;
+        constexpr size_t kMaxSizeHeader = 3;
+
+        constexpr uint8_t kMinWindowLog = std::countr_zero(MIN_STREAM_WINDOW);
+        constexpr uint8_t kMaxWindowLog = std::countr_zero(MAX_STREAM_WINDOW);
+
+        // Both ends size their ring from the window alone, which keeps them in step
+        size_t RingSize(uint8_t windowLog) {
+            return size_t{ 2 } << windowLog;
+        }
+
+        // Where the next message of plainSize bytes goes: the ring restarts when it would not fit.
+        size_t NextRingPos(size_t pos, size_t plainSize, size_t ringSize) {
+            return pos + plainSize > ringSize ? 0 : pos;
+        }
+
+        struct StreamFrame {
+            bool    keyframe{ false };
+            uint8_t windowLog{ 0 };
+            size_t  rawSize{ 0 };
+            size_t  headerSize{ 0 };
+        };
+
+        bool ParseStreamFrame(std::span<const uint8_t> frame, StreamFrame& out) {
+            constexpr uint8_t required = Compressor::kFlagStream | Compressor::kFlagCompressed;
+            constexpr uint8_t known = required | Compressor::kFlagStreamReset;
+            if (frame.size() < kFlagsSize || (frame[0] & required) != required || (frame[0] & ~known) != 0) {
+                RF_NETWORK_WARN_LIMITED("StreamDecompressor: not a stream frame");
+                return false;
+            }
+            out.keyframe = (frame[0] & Compressor::kFlagStreamReset) != 0;
+            out.headerSize = kFlagsSize;
+
+            if (out.keyframe) {
+                if (frame.size() < kFlagsSize + kWindowLogSize) {
+                    RF_NETWORK_WARN_LIMITED("StreamDecompressor: truncated keyframe");
+                    return false;
+                }
+                out.windowLog = frame[kFlagsSize];
+                if (out.windowLog < kMinWindowLog || out.windowLog > kMaxWindowLog) {
+                    RF_NETWORK_WARN_LIMITED("StreamDecompressor: keyframe window 2^{} out of range", out.windowLog);
+                    return false;
+                }
+                out.headerSize += kWindowLogSize;
+            }
+
+            const size_t sizeHeader = Compressor::ReadSizeHeader(frame.subspan(out.headerSize), out.rawSize);
+            if (sizeHeader == 0) {
+                return false;
+            }
+            out.headerSize += sizeHeader;
+            return true;
+        }
+    }
+
+    // =========================
+    // StreamCompressor
+    // =========================
+
+    struct StreamCompressor::State {
+        LZ4_stream_t stream;
+    };
+
+    StreamCompressor::StreamCompressor(size_t windowBytes)
+        : m_state(std::make_unique<State>()),
+          m_window(std::bit_floor(std::clamp(windowBytes, MIN_STREAM_WINDOW, MAX_STREAM_WINDOW))),
+          m_windowLog(static_cast<uint8_t>(std::countr_zero(m_window))),
+          m_ring(RingSize(m_windowLog)) {
+        RF_NETWORK_DEBUG("StreamCompressor initialized with a {} byte window", m_window);
+    }
+
+    StreamCompressor::~StreamCompressor() = default;
+
+    size_t StreamCompressor::CompressBound(size_t plainSize) {
+        if (plainSize > MAX_STREAM_WINDOW) return 0;
+        return kFlagsSize + kWindowLogSize + kMaxSizeHeader + static_cast<size_t>(LZ4_COMPRESSBOUND(plainSize));
+    }
+
+    size_t StreamCompressor::CompressInto(std::span<const uint8_t> plainData, std::span<uint8_t> out) {
+        const size_t plainSize = plainData.size();
+        if (plainSize > m_window || out.size() < CompressBound(plainSize)) {
+            RF_NETWORK_WARN_LIMITED("StreamCompressor::CompressInto: invalid sizes (in={} bytes, window={} bytes, out capacity={} bytes)",
+                plainSize, m_window, out.size());
+            return 0;
+        }
+
+        const bool keyframe = m_resetPending;
+        if (keyframe) {
+            LZ4_initStream(&m_state->stream, sizeof(m_state->stream));
+            m_ringPos = 0;
+        }
+
+        // LZ4 references earlier messages where they sit in the ring, so the plaintext goes there first
+        m_ringPos = NextRingPos(m_ringPos, plainSize, m_ring.size());
+        uint8_t* const plain = m_ring.data() + m_ringPos;
+        if (plainSize != 0) {
+            std::memcpy(plain, plainData.data(), plainSize);
+        }
+
+        size_t headerSize = kFlagsSize;
+        out[0] = Compressor::kFlagStream | Compressor::kFlagCompressed;
+        if (keyframe) {
+            out[0] |= Compressor::kFlagStreamReset;
+            out[headerSize++] = m_windowLog;
+        }
+        Compressor::WriteSizeHeader(out.data() + headerSize, plainSize);
+        headerSize += Compressor::SizeHeaderLength(plainSize);
+
+        // Always compressed, even without gain: the peer can only mirror history that LZ4 decoded
+        const int written = LZ4_compress_fast_continue(&m_state->stream,
+            reinterpret_cast<const char*>(plain), reinterpret_cast<char*>(out.data() + headerSize),
+            static_cast<int>(plainSize), static_cast<int>(out.size() - headerSize), 1);
+        if (written <= 0) {
+            RF_NETWORK_ERROR("StreamCompressor::CompressInto: LZ4 compression failed ({} bytes input)", plainSize);
+            m_resetPending = true;
+            return 0;
+        }
+
+        m_ringPos += plainSize;
+        m_resetPending = false;
+        RF_NETWORK_TRACE("Stream compress ok: in={} bytes, out={} bytes{}", plainSize, headerSize + written,
+            keyframe ? " (keyframe)" : "");
+        return headerSize + static_cast<size_t>(written);
+    }
+
+    // =========================
+    // StreamDecompressor
+    // =========================
+
+    struct StreamDecompressor::State {
+        LZ4_streamDecode_t stream;
+    };
+
+    StreamDecompressor::StreamDecompressor()
+        : m_state(std::make_unique<State>()) {
+    }
+
+    StreamDecompressor::~StreamDecompressor() = default;
+
+    size_t StreamDecompressor::GetKeyframeMemory(std::span<const uint8_t> frame) {
+        StreamFrame header;
+        if (!ParseStreamFrame(frame, header) || !header.keyframe) {
+            return 0;
+        }
+        return RingSize(header.windowLog);
+    }
+
+    bool StreamDecompressor::Decompress(std::span<const uint8_t> frame, std::span<const uint8_t>& outPlain) {
+        StreamFrame header;
+        if (!ParseStreamFrame(frame, header)) {
+            m_synchronized = false;
+            return false;
+        }
+
+        if (header.keyframe) {
+            m_ring.resize(RingSize(header.windowLog));
+            m_ring.shrink_to_fit();
+            m_ringPos = 0;
+            LZ4_setStreamDecode(&m_state->stream, nullptr, 0);
+            m_synchronized = true;
+        }
+        else if (!m_synchronized) {
+            RF_NETWORK_DEBUG("StreamDecompressor: dropping a frame while waiting for a keyframe");
+            return false;
+        }
+
+        if (header.rawSize > m_ring.size() / 2) {
+            RF_NETWORK_WARN_LIMITED("StreamDecompressor: {} byte message exceeds the {} byte window", header.rawSize, m_ring.size() / 2);
+            m_synchronized = false;
+            return false;
+        }
+
+        // Same placement rule as the compressor, so LZ4 finds history where it expects it
+        m_ringPos = NextRingPos(m_ringPos, header.rawSize, m_ring.size());
+        uint8_t* const plain = m_ring.data() + m_ringPos;
+        const int written = LZ4_decompress_safe_continue(&m_state->stream,
+            reinterpret_cast<const char*>(frame.data() + header.headerSize), reinterpret_cast<char*>(plain),
+            static_cast<int>(frame.size() - header.headerSize), static_cast<int>(header.rawSize));
+        if (written < 0 || static_cast<size_t>(written) != header.rawSize) {
+            RF_NETWORK_ERROR("StreamDecompressor: LZ4 decompression failed ({} bytes input); waiting for a keyframe", frame.size());
+            m_synchronized = false;
+            return false;
+        }
+
+        m_ringPos += header.rawSize;
+        outPlain = std::span<const uint8_t>(plain, header.rawSize);
+        return true;
+    }
+
+    void StreamDecompressor::Reset() {
+        m_ring.clear();
+        m_ring.shrink_to_fit();
+        m_ringPos = 0;
+        m_synchronized = false;
+    }
+
+} // namespace RiftNet::Compression
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace RiftNet::Compression {
+
+    // Bounds of the history a stream may reference. The ring each side keeps is twice the window,
+    // so the largest stays within LZ4's 64KB reach.
+    constexpr size_t MIN_STREAM_WINDOW = 1024;
+    constexpr size_t MAX_STREAM_WINDOW = 32 * 1024;
+
+    /**
+     * @class StreamCompressor
+     * @brief Compresses a sequence of messages against each other, so repetition between
+     * consecutive messages (successive snapshots of the same state, say) compresses too, not
+     * just repetition within one. The peer's StreamDecompressor must see every frame, in order:
+     * use it only on an ordered reliable channel. Frame layout:
+     * [u8 flags][u8 window log2, keyframes only][varint raw size][LZ4 block].
+     *
+     * Plaintext is kept in a ring buffer of twice the window that the decompressor mirrors exactly
+     * (LZ4's "synchronized" streaming mode), so history survives across messages without copies.
+     * Not thread-safe.
+     */
+    class StreamCompressor {
+    public:
+        // @param windowBytes Rounded down to a power of two within [MIN_STREAM_WINDOW, MAX_STREAM_WINDOW].
+        explicit StreamCompressor(size_t windowBytes);
+        ~StreamCompressor();
+
+        StreamCompressor(const StreamCompressor&) = delete;
+        StreamCompressor& operator=(const StreamCompressor&) = delete;
+
+        // Upper bound of the frame size CompressInto can produce for plainSize input bytes.
+        static size_t CompressBound(size_t plainSize);
+
+        // Largest message this stream takes; longer ones would not fit the ring, so compress them on their own.
+        size_t GetMaxMessageSize() const { return m_window; }
+
+        // Ring bytes this stream holds; the peer's StreamDecompressor holds the same.
+        size_t GetMemoryUsage() const { return m_ring.size(); }
+
+        /**
+         * @brief Compresses plainData against the history of earlier messages and appends it to that history.
+         * @param out Destination; at least CompressBound(plainData.size()) bytes.
+         * @return The number of bytes written to out, or 0 on failure (the next frame is then a keyframe).
+         */
+        size_t CompressInto(std::span<const uint8_t> plainData, std::span<uint8_t> out);
+
+        /**
+         * @brief Drops the history: the next frame is a keyframe the peer can decode from scratch.
+         * Call when a frame may not reach the peer, or when the peer reports it lost sync.
+         */
+        void Reset() { m_resetPending = true; }
+
+    private:
+        struct State; // LZ4 stream
+
+        std::unique_ptr<State> m_state;
+        size_t                 m_window;
+        uint8_t                m_windowLog;
+        std::vector<uint8_t>   m_ring;
+        size_t                 m_ringPos{ 0 };
+        bool                   m_resetPending{ true };
+    };
+
+    /**
+     * @class StreamDecompressor
+     * @brief Decodes the frames of one StreamCompressor, which must arrive complete and in order.
+     * After a decode failure every frame is refused until the next keyframe. Not thread-safe.
+     */
+    class StreamDecompressor {
+    public:
+        StreamDecompressor();
+        ~StreamDecompressor();
+
+        StreamDecompressor(const StreamDecompressor&) = delete;
+        StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+
+        // @return The ring bytes a keyframe asks for, or 0 if frame is not a well-formed keyframe.
+        static size_t GetKeyframeMemory(std::span<const uint8_t> frame);
+
+        /**
+         * @brief Decodes a frame into the history ring.
+         * @param outPlain On success, views the message inside the ring; valid until the next call.
+         * @return False on a malformed frame, or while waiting for a keyframe after losing sync.
+         */
+        bool Decompress(std::span<const uint8_t> frame, std::span<const uint8_t>& outPlain);
+
+        bool IsSynchronized() const { return m_synchronized; }
+        size_t GetMemoryUsage() const { return m_ring.size(); }
+
+        // Frees the history; frames are refused until the next keyframe.
+        void Reset();
+
+    private:
+        struct State; // LZ4 decode stream
+
+        std::unique_ptr<State> m_state;
+        std::vector<uint8_t>   m_ring;
+        size_t                 m_ringPos{ 0 };
+        bool                   m_synchronized{ false };
+    };
+
+} // namespace RiftNet::Compression
@@ -3,7 +3,6 @@
 
 #include "pch.h"
 #include "framework.h"
-WIN32_LEAN_AND_MEAN
 
 // TODO: This is an example of a library function
 void fnRiftNet()
@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "ApiConfig.hpp"
+
+namespace RiftNet::Api {
+
+    static_assert(RIFT_LATENCY_BUCKETS == Metrics::LATENCY_BUCKET_COUNT, "histogram bucket counts differ");
+
+    // Cast as is, an unknown channel type would be retransmitted like a reliable channel yet
+    // framed, and dropped when late, like a sequenced one
+    bool IsValidChannelConfig(const RiftChannelType* types, uint32_t count) {
+        if (count > RIFT_MAX_CHANNELS || (count != 0 && !types)) return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (types[i] < RIFT_CHANNEL_RELIABLE_ORDERED || types[i] > RIFT_CHANNEL_UNRELIABLE_SEQUENCED) return false;
+        }
+        return true;
+    }
+
+    bool IsValidCongestionConfig(RiftCongestionControl control, uint64_t pacingRate) {
+        if (control < RIFT_CONGESTION_NONE || control > RIFT_CONGESTION_BBR) return false;
+        return control != RIFT_CONGESTION_FIXED_RATE || pacingRate != 0;
+    }
+
+    // RiftChannelType and Protocol::ChannelType list the same types in the same order
+    std::vector<Protocol::ChannelType> CopyChannelTypes(const RiftChannelType* types, uint32_t count) {
+        std::vector<Protocol::ChannelType> out;
+        for (uint32_t i = 0; i < count; ++i) {
+            out.push_back(static_cast<Protocol::ChannelType>(types[i]));
+        }
+        return out;
+    }
+
+    // RiftCongestionControl and Protocol::CongestionAlgorithm list the same algorithms in the same order
+    std::unique_ptr<Protocol::ICongestionController> MakeCongestionController(RiftCongestionControl control, uint64_t pacingRate) {
+        return Protocol::CreateCongestionController(static_cast<Protocol::CongestionAlgorithm>(control), pacingRate);
+    }
+
+    // RiftPendingSendPolicy and Protocol::PendingOverflowPolicy list the same policies in the same order
+    Protocol::PendingOverflowPolicy ToOverflowPolicy(RiftPendingSendPolicy policy) {
+        return static_cast<Protocol::PendingOverflowPolicy>(policy);
+    }
+
+    Networking::ImpairmentProfile CopyImpairment(const RiftImpairmentConfig& config) {
+        Networking::ImpairmentProfile out;
+        out.lossPercent = config.loss_percent;
+        out.duplicatePercent = config.duplicate_percent;
+        out.reorderPercent = config.reorder_percent;
+        out.latency = std::chrono::milliseconds(config.latency_ms);
+        out.jitter = std::chrono::milliseconds(config.jitter_ms);
+        out.reorderDelay = std::chrono::milliseconds(config.reorder_delay_ms);
+        out.bandwidth = config.bandwidth;
+        out.seed = config.seed;
+        return out;
+    }
+
+    // RiftSendPriority lists NORMAL first so zero-initialized options get it; Protocol::SendPriority is in urgency order
+    bool ToSendOptions(const RiftSendOptions* options, Protocol::SendOptions& out) {
+        out = {};
+        if (!options) return true;
+        switch (options->priority) {
+        case RIFT_PRIORITY_NORMAL:   out.priority = Protocol::SendPriority::Normal; break;
+        case RIFT_PRIORITY_CRITICAL: out.priority = Protocol::SendPriority::Critical; break;
+        case RIFT_PRIORITY_HIGH:     out.priority = Protocol::SendPriority::High; break;
+        case RIFT_PRIORITY_LOW:      out.priority = Protocol::SendPriority::Low; break;
+        default: return false;
+        }
+        out.latestKey = options->latest_key;
+        return true;
+    }
+
+    void CopyConnectionStats(const Protocol::CongestionStats& stats, RiftConnectionStats& out) {
+        out.rtt_ms = stats.smoothedRTT_ms;
+        out.rtt_variance_ms = stats.rttVariance_ms;
+        out.rto_ms = stats.retransmissionTimeout_ms;
+        out.congestion_window = stats.congestionWindow;
+        out.bytes_in_flight = stats.bytesInFlight;
+        out.pacing_rate = static_cast<uint64_t>(stats.pacingRate);
+    }
+
+    void CopyHistogram(const Metrics::HistogramSnapshot& histogram, RiftLatencyHistogram& out) {
+        out.count = histogram.count;
+        out.sum_us = histogram.sumMicros;
+        for (size_t i = 0; i < RIFT_LATENCY_BUCKETS; ++i) {
+            out.buckets[i] = histogram.buckets[i];
+        }
+    }
+
+    void CopyMetrics(const Metrics::ConnectionMetricsSnapshot& metrics, RiftStats& out) {
+        out.packets_sent = metrics.packetsSent;
+        out.bytes_sent = metrics.bytesSent;
+        out.packets_received = metrics.packetsReceived;
+        out.bytes_received = metrics.bytesReceived;
+        out.retransmits = metrics.retransmits;
+        out.duplicates_dropped = metrics.duplicatesDropped;
+        out.replays_dropped = metrics.replaysDropped;
+        out.decrypt_failures = metrics.decryptFailures;
+        out.compress_input_bytes = metrics.compressInputBytes;
+        out.compress_output_bytes = metrics.compressOutputBytes;
+        CopyHistogram(metrics.rtt, out.rtt);
+    }
+
+    void CopyIOStats(const Networking::IOStats& stats, RiftStats& out) {
+        out.receive_pool_exhausted = stats.receivePoolExhausted;
+        out.send_pool_exhausted = stats.sendPoolExhausted;
+        CopyHistogram(stats.sendCompletionLatency, out.send_completion_latency);
+    }
+
+} // namespace RiftNet::Api
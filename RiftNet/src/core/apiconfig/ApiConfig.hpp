@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../../../include/RiftNet/RiftCommon.hpp"
+#include "../impairedio/ImpairedNetworkIO.hpp"
+#include "../networkio/INetworkIO.hpp"
+#include "../../protocol/ChannelSet/ChannelSet.hpp"
+#include "../../protocol/CongestionControl/CongestionControl.hpp"
+#include "../../protocol/PendingSendQueue/PendingSendQueue.hpp"
+#include "../../protocol/SendScheduler/SendScheduler.hpp"
+#include "../../protocol/UDPReliabilityProtocol/UDPReliabilityProtocol.hpp"
+#include "../../../utilities/metrics/Metrics.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace RiftNet::Api {
+
+    // Conversions between the C API's config and stats structs and the library's own types,
+    // shared by RiftServer and RiftClient so the two sides cannot read a config differently.
+
+    /**
+     * @brief False unless count is within RIFT_MAX_CHANNELS, types is set when count is not zero,
+     * and every type is a RiftChannelType.
+     */
+    bool IsValidChannelConfig(const RiftChannelType* types, uint32_t count);
+
+    /**
+     * @brief False for an unknown algorithm, or fixed-rate pacing without a rate.
+     */
+    bool IsValidCongestionConfig(RiftCongestionControl control, uint64_t pacingRate);
+
+    // These expect values the checks above (and create's own range checks) accepted
+    std::vector<Protocol::ChannelType> CopyChannelTypes(const RiftChannelType* types, uint32_t count);
+    std::unique_ptr<Protocol::ICongestionController> MakeCongestionController(RiftCongestionControl control, uint64_t pacingRate);
+    Protocol::PendingOverflowPolicy ToOverflowPolicy(RiftPendingSendPolicy policy);
+    Networking::ImpairmentProfile CopyImpairment(const RiftImpairmentConfig& config);
+
+    /**
+     * @brief Per-message send options; null gives the defaults.
+     * @return False for an unknown priority.
+     */
+    bool ToSendOptions(const RiftSendOptions* options, Protocol::SendOptions& out);
+
+    void CopyConnectionStats(const Protocol::CongestionStats& stats, RiftConnectionStats& out);
+    void CopyHistogram(const Metrics::HistogramSnapshot& histogram, RiftLatencyHistogram& out);
+    void CopyMetrics(const Metrics::ConnectionMetricsSnapshot& metrics, RiftStats& out);
+    void CopyIOStats(const Networking::IOStats& stats, RiftStats& out);
+
+} // namespace RiftNet::Api
@@ -0,0 +1,114 @@
+// File: PacketBuffer.hpp
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace RiftNet {
+    namespace Networking {
+
+        // Bytes reserved in front of the payload so each send stage can prepend its header in place:
+        // 8-byte wire nonce + GeneralPacketHeader + ExtendedReliabilityPacketHeader + ChannelHeader or FragmentHeader, rounded up.
+        constexpr size_t PACKET_BUFFER_HEADROOM = 48;
+
+        // Bytes reserved behind the payload for the 16-byte AEAD tag appended by in-place encryption.
+        constexpr size_t PACKET_BUFFER_TAILROOM = 16;
+
+        /**
+         * @class PacketBuffer
+         * @brief A contiguous byte buffer with reserved headroom and tailroom.
+         * Send stages write into it in place: the compressor fills the payload, the packet
+         * factory prepends headers, the encryptor appends the tag and the nonce is prepended
+         * last. Shared through PacketBufferPtr so the retransmit queue and the socket layer
+         * can hold the same bytes without copying them.
+         */
+        class PacketBuffer {
+        public:
+            explicit PacketBuffer(size_t capacity, size_t headroom = PACKET_BUFFER_HEADROOM)
+                : m_storage(std::make_unique_for_overwrite<uint8_t[]>(capacity))
+                , m_capacity(capacity)
+                , m_head(headroom < capacity ? headroom : capacity)
+                , m_tail(m_head) {
+            }
+
+            PacketBuffer(const PacketBuffer&) = delete;
+            PacketBuffer& operator=(const PacketBuffer&) = delete;
+
+            /**
+             * @brief Allocates a buffer able to hold payloadCapacity bytes plus the standard head/tailroom.
+             */
+            static std::shared_ptr<PacketBuffer> Create(size_t payloadCapacity) {
+                return std::make_shared<PacketBuffer>(PACKET_BUFFER_HEADROOM + payloadCapacity + PACKET_BUFFER_TAILROOM);
+            }
+
+            /**
+             * @brief Allocates a buffer and copies the given bytes into it (used for cleartext control frames).
+             */
+            static std::shared_ptr<PacketBuffer> FromBytes(const uint8_t* data, size_t size) {
+                auto buffer = Create(size);
+                if (size > 0) {
+                    std::memcpy(buffer->Append(size), data, size);
+                }
+                return buffer;
+            }
+
+            uint8_t* Data() noexcept { return m_storage.get() + m_head; }
+            const uint8_t* Data() const noexcept { return m_storage.get() + m_head; }
+            uint32_t Size() const noexcept { return static_cast<uint32_t>(m_tail - m_head); }
+            bool Empty() const noexcept { return m_tail == m_head; }
+
+            std::span<uint8_t> Span() noexcept { return { Data(), Size() }; }
+            std::span<const uint8_t> Span() const noexcept { return { Data(), Size() }; }
+
+            size_t Headroom() const noexcept { return m_head; }
+            size_t Tailroom() const noexcept { return m_capacity - m_tail; }
+
+            /**
+             * @brief Grows the view by n bytes at the front.
+             * @return Pointer to the first of the new bytes, or nullptr if there is not enough headroom.
+             */
+            uint8_t* Prepend(size_t n) noexcept {
+                if (n > m_head) return nullptr;
+                m_head -= n;
+                return m_storage.get() + m_head;
+            }
+
+            /**
+             * @brief Grows the view by n bytes at the back.
+             * @return Pointer to the first of the new bytes, or nullptr if there is not enough tailroom.
+             */
+            uint8_t* Append(size_t n) noexcept {
+                if (n > Tailroom()) return nullptr;
+                uint8_t* start = m_storage.get() + m_tail;
+                m_tail += n;
+                return start;
+            }
+
+            /**
+             * @brief Shrinks the view by n bytes at the back (e.g. after a stage wrote less than it reserved).
+             */
+            void TrimBack(size_t n) noexcept {
+                m_tail -= (n < Size()) ? n : Size();
+            }
+
+            /**
+             * @brief Empties the view and re-reserves the given headroom.
+             */
+            void Reset(size_t headroom = PACKET_BUFFER_HEADROOM) noexcept {
+                m_head = headroom < m_capacity ? headroom : m_capacity;
+                m_tail = m_head;
+            }
+
+        private:
+            std::unique_ptr<uint8_t[]> m_storage;
+            size_t m_capacity;
+            size_t m_head;
+            size_t m_tail;
+        };
+
+        using PacketBufferPtr = std::shared_ptr<PacketBuffer>;
+
+    } // namespace Networking
+} // namespace RiftNet
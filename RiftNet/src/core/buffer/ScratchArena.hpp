@@ -0,0 +1,59 @@
+// File: ScratchArena.hpp
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace RiftNet {
+    namespace Networking {
+
+        // Initial size of each thread's scratch arena; covers any datagram that fits the receive buffer.
+        constexpr size_t SCRATCH_ARENA_INITIAL_SIZE = 64 * 1024;
+
+        /**
+         * @class ScratchArena
+         * @brief A per-thread, grow-only byte region for short-lived receive-path work (e.g. decompression).
+         * The returned span is only valid until the next Acquire() on the same thread, so callers
+         * must finish with it before handing control back to the I/O loop.
+         */
+        class ScratchArena {
+        public:
+            /**
+             * @brief Returns the calling thread's arena.
+             */
+            static ScratchArena& Local() {
+                thread_local ScratchArena arena;
+                return arena;
+            }
+
+            /**
+             * @brief Returns a span of exactly size bytes, growing the arena only if it is too small.
+             */
+            std::span<uint8_t> Acquire(size_t size) {
+                if (size > m_capacity) {
+                    size_t newCapacity = m_capacity;
+                    while (newCapacity < size) newCapacity *= 2;
+                    m_storage = std::make_unique_for_overwrite<uint8_t[]>(newCapacity);
+                    m_capacity = newCapacity;
+                }
+                return { m_storage.get(), size };
+            }
+
+            size_t Capacity() const noexcept { return m_capacity; }
+
+        private:
+            ScratchArena()
+                : m_storage(std::make_unique_for_overwrite<uint8_t[]>(SCRATCH_ARENA_INITIAL_SIZE))
+                , m_capacity(SCRATCH_ARENA_INITIAL_SIZE) {
+            }
+
+            ScratchArena(const ScratchArena&) = delete;
+            ScratchArena& operator=(const ScratchArena&) = delete;
+
+            std::unique_ptr<uint8_t[]> m_storage;
+            size_t m_capacity;
+        };
+
+    } // namespace Networking
+} // namespace RiftNet
@@ -0,0 +1,85 @@
+#include "pch.h"
+#include "CaptureNetworkIO.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+using namespace RiftNet::Logging;
+
+namespace RiftNet::Networking {
+
+    CaptureNetworkIO::CaptureNetworkIO(std::unique_ptr<INetworkIO> inner, std::shared_ptr<CaptureWriter> capture)
+        : m_inner(std::move(inner))
+        , m_capture(std::move(capture)) {
+    }
+
+    CaptureNetworkIO::~CaptureNetworkIO() {
+        Stop();
+    }
+
+    std::unique_ptr<INetworkIO> CaptureNetworkIO::Wrap(std::unique_ptr<INetworkIO> inner, std::shared_ptr<CaptureWriter> capture) {
+        if (!inner || !capture) {
+            return inner;
+        }
+        return std::make_unique<CaptureNetworkIO>(std::move(inner), std::move(capture));
+    }
+
+    bool CaptureNetworkIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+        if (!eventHandler) {
+            RF_NETWORK_CRITICAL("CaptureNetworkIO: INetworkIOEvents handler cannot be null.");
+            return false;
+        }
+        m_eventHandler = eventHandler;
+        RF_NETWORK_WARN("CaptureNetworkIO: capturing traffic on {}:{}", listenIp, listenPort);
+        return m_inner->Init(listenIp, listenPort, this);
+    }
+
+    bool CaptureNetworkIO::Start() {
+        return m_inner->Start();
+    }
+
+    void CaptureNetworkIO::Stop() {
+        m_inner->Stop();
+    }
+
+    bool CaptureNetworkIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        m_capture->Record(CaptureRecordKind::Sent, recipient, data, size);
+        return m_inner->SendData(recipient, data, size);
+    }
+
+    bool CaptureNetworkIO::SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) {
+        if (buffer) {
+            m_capture->Record(CaptureRecordKind::Sent, recipient, buffer->Data(), buffer->Size());
+        }
+        return m_inner->SendData(recipient, buffer);
+    }
+
+    void CaptureNetworkIO::BeginSendBatch() {
+        m_inner->BeginSendBatch();
+    }
+
+    void CaptureNetworkIO::EndSendBatch() {
+        m_inner->EndSendBatch();
+    }
+
+    bool CaptureNetworkIO::IsRunning() const {
+        return m_inner->IsRunning();
+    }
+
+    IOStats CaptureNetworkIO::GetStats() const {
+        return m_inner->GetStats();
+    }
+
+    void CaptureNetworkIO::OnRawDataReceived(const NetworkEndpoint& sender, uint8_t* data, uint32_t size, OverlappedIOContext* context) {
+        // Before the handler runs: it decrypts in place
+        m_capture->Record(CaptureRecordKind::Received, sender, data, size);
+        m_eventHandler->OnRawDataReceived(sender, data, size, context);
+    }
+
+    void CaptureNetworkIO::OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) {
+        m_eventHandler->OnSendCompleted(context, success, bytesSent);
+    }
+
+    void CaptureNetworkIO::OnNetworkError(const std::string& errorMessage, int errorCode) {
+        m_eventHandler->OnNetworkError(errorMessage, errorCode);
+    }
+
+} // namespace RiftNet::Networking
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../networkio/INetworkIO.hpp"
+#include "../networkio/INetworkIOEvents.hpp"
+#include "PacketCapture.hpp"
+
+#include <memory>
+
+namespace RiftNet::Networking {
+
+    /**
+     * @class CaptureNetworkIO
+     * @brief Wraps another INetworkIO and records every datagram crossing it into a CaptureWriter:
+     * receives before the handler sees (and decrypts) them, sends as they are handed down.
+     * Recording is a copy into the mapped file on the calling thread; nothing is queued or held,
+     * so timing and threading are those of the wrapped layer.
+     */
+    class CaptureNetworkIO : public INetworkIO, public INetworkIOEvents {
+    public:
+        CaptureNetworkIO(std::unique_ptr<INetworkIO> inner, std::shared_ptr<CaptureWriter> capture);
+        ~CaptureNetworkIO() override;
+
+        /**
+         * @brief Returns `inner` wrapped when there is a capture, and `inner` itself otherwise.
+         */
+        static std::unique_ptr<INetworkIO> Wrap(std::unique_ptr<INetworkIO> inner, std::shared_ptr<CaptureWriter> capture);
+
+        // --- INetworkIO Interface Implementation ---
+        bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+        bool Start() override;
+        void Stop() override;
+        bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+        bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) override;
+        void BeginSendBatch() override;
+        void EndSendBatch() override;
+        bool IsRunning() const override;
+        IOStats GetStats() const override;
+
+        // --- INetworkIOEvents Interface Implementation (from the wrapped layer) ---
+        void OnRawDataReceived(const NetworkEndpoint& sender, uint8_t* data, uint32_t size, OverlappedIOContext* context) override;
+        void OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) override;
+        void OnNetworkError(const std::string& errorMessage, int errorCode = 0) override;
+
+    private:
+        std::unique_ptr<INetworkIO>    m_inner;
+        std::shared_ptr<CaptureWriter> m_capture; // shared with the server, which records payloads into it
+        INetworkIOEvents*              m_eventHandler = nullptr;
+    };
+
+} // namespace RiftNet::Networking
@@ -0,0 +1,297 @@
+#include "pch.h"
+#include "PacketCapture.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace RiftNet::Logging;
+
+namespace RiftNet::Networking {
+
+    namespace {
+        constexpr char CAPTURE_MAGIC[8] = { 'R', 'I', 'F', 'T', 'C', 'A', 'P', '\0' };
+
+        constexpr uint64_t PaddedSize(uint32_t size) {
+            return (static_cast<uint64_t>(size) + 7) & ~uint64_t{ 7 };
+        }
+    }
+
+    // =====================================================================================
+    // CaptureWriter
+    // =====================================================================================
+
+    std::unique_ptr<CaptureWriter> CaptureWriter::Open(const std::string& path, uint64_t capacityBytes) {
+        std::unique_ptr<CaptureWriter> writer(new CaptureWriter());
+        if (!writer->Map(path, (std::max)(capacityBytes, uint64_t{ sizeof(CaptureFileHeader) }))) {
+            return nullptr;
+        }
+
+        CaptureFileHeader header{};
+        std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+        header.version = CAPTURE_FORMAT_VERSION;
+        header.headerSize = sizeof(CaptureFileHeader);
+        header.startUnixUs = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::memcpy(writer->m_base, &header, sizeof(header));
+        writer->m_start = std::chrono::steady_clock::now();
+
+        RF_NETWORK_INFO("CaptureWriter: recording to {} ({} MB).", path, writer->m_capacity >> 20);
+        return writer;
+    }
+
+    CaptureWriter::~CaptureWriter() {
+        Close();
+    }
+
+    bool CaptureWriter::Map(const std::string& path, uint64_t capacityBytes) {
+        m_path = path;
+        m_capacity = capacityBytes;
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to create {}. Error: {}", path, GetLastError());
+            return false;
+        }
+        m_file = file;
+        // Mapping past the end of the file extends it to the capacity
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+            static_cast<DWORD>(capacityBytes >> 32), static_cast<DWORD>(capacityBytes), nullptr);
+        if (!mapping) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to map {}. Error: {}", path, GetLastError());
+            return false;
+        }
+        m_mapping = mapping;
+        m_base = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, static_cast<SIZE_T>(capacityBytes)));
+        if (!m_base) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to map a view of {}. Error: {}", path, GetLastError());
+            return false;
+        }
+#else
+        m_file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (m_file < 0) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to create {}. Error: {}", path, std::strerror(errno));
+            return false;
+        }
+        if (ftruncate(m_file, static_cast<off_t>(capacityBytes)) != 0) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to size {}. Error: {}", path, std::strerror(errno));
+            return false;
+        }
+        void* base = mmap(nullptr, capacityBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+        if (base == MAP_FAILED) {
+            RF_NETWORK_ERROR("CaptureWriter: failed to map {}. Error: {}", path, std::strerror(errno));
+            return false;
+        }
+        m_base = static_cast<uint8_t*>(base);
+#endif
+        return true;
+    }
+
+    void CaptureWriter::Record(CaptureRecordKind kind, const NetworkEndpoint& endpoint, const uint8_t* data, uint32_t size) {
+        CaptureRecordHeader header{};
+        header.kind = static_cast<uint8_t>(kind);
+        header.size = size;
+        header.port = endpoint.port;
+        header.family = endpoint.family;
+        std::memcpy(header.address, endpoint.address, sizeof(header.address));
+        Append(header, data);
+    }
+
+    void CaptureWriter::RecordPayload(uint64_t clientId, uint8_t channel, const uint8_t* data, uint32_t size) {
+        CaptureRecordHeader header{};
+        header.kind = static_cast<uint8_t>(CaptureRecordKind::Payload);
+        header.size = size;
+        header.channel = channel;
+        header.clientId = clientId;
+        Append(header, data);
+    }
+
+    void CaptureWriter::Append(CaptureRecordHeader header, const uint8_t* data) {
+        if (!m_base) return;
+        header.timeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_start).count());
+
+        // Reserve by CAS rather than fetch_add, so a record that does not fit leaves the end where it was
+        const uint64_t total = sizeof(CaptureRecordHeader) + PaddedSize(header.size);
+        uint64_t offset = m_offset.load(std::memory_order_relaxed);
+        do {
+            if (offset + total > m_capacity) {
+                if (m_dropped.fetch_add(1, std::memory_order_relaxed) == 0) {
+                    RF_NETWORK_WARN("CaptureWriter: {} is full; further records are dropped.", m_path);
+                }
+                return;
+            }
+        } while (!m_offset.compare_exchange_weak(offset, offset + total, std::memory_order_relaxed));
+
+        // The file was created empty, so the padding is already zero
+        std::memcpy(m_base + offset, &header, sizeof(header));
+        if (header.size != 0) {
+            std::memcpy(m_base + offset + sizeof(header), data, header.size);
+        }
+        m_recordCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void CaptureWriter::Close() {
+        const uint64_t used = m_offset.load(std::memory_order_acquire);
+        if (m_base) {
+            auto* header = reinterpret_cast<CaptureFileHeader*>(m_base);
+            header->recordBytes = used - sizeof(CaptureFileHeader);
+            header->recordCount = m_recordCount.load(std::memory_order_relaxed);
+            header->droppedRecords = m_dropped.load(std::memory_order_relaxed);
+            RF_NETWORK_INFO("CaptureWriter: {} records ({} bytes) written to {}, {} dropped.",
+                header->recordCount, header->recordBytes, m_path, header->droppedRecords);
+        }
+#if defined(_WIN32)
+        if (m_base) {
+            FlushViewOfFile(m_base, 0);
+            UnmapViewOfFile(m_base);
+        }
+        if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+        if (m_file) {
+            // Trim the unused capacity; only possible once the mapping is gone
+            LARGE_INTEGER size{};
+            size.QuadPart = static_cast<LONGLONG>(m_base ? used : 0);
+            if (SetFilePointerEx(static_cast<HANDLE>(m_file), size, nullptr, FILE_BEGIN)) {
+                SetEndOfFile(static_cast<HANDLE>(m_file));
+            }
+            CloseHandle(static_cast<HANDLE>(m_file));
+        }
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        if (m_base) {
+            msync(m_base, m_capacity, MS_SYNC);
+            munmap(m_base, m_capacity);
+        }
+        if (m_file >= 0) {
+            if (ftruncate(m_file, static_cast<off_t>(m_base ? used : 0)) != 0) {
+                RF_NETWORK_WARN("CaptureWriter: failed to trim {}. Error: {}", m_path, std::strerror(errno));
+            }
+            close(m_file);
+        }
+        m_file = -1;
+#endif
+        m_base = nullptr;
+    }
+
+    // =====================================================================================
+    // CaptureReader
+    // =====================================================================================
+
+    std::unique_ptr<CaptureReader> CaptureReader::Open(const std::string& path) {
+        std::unique_ptr<CaptureReader> reader(new CaptureReader());
+        if (!reader->Map(path)) {
+            return nullptr;
+        }
+        if (reader->m_size < sizeof(CaptureFileHeader)) {
+            RF_NETWORK_ERROR("CaptureReader: {} is too short to be a capture.", path);
+            return nullptr;
+        }
+        const CaptureFileHeader& header = reader->GetHeader();
+        if (std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0 ||
+            header.version == 0 || header.version > CAPTURE_FORMAT_VERSION ||
+            header.headerSize != sizeof(CaptureFileHeader)) {
+            RF_NETWORK_ERROR("CaptureReader: {} is not a capture this build can read.", path);
+            return nullptr;
+        }
+        // A writer that never closed left the totals at zero; read until the records run out
+        if (header.recordBytes != 0) {
+            reader->m_size = (std::min)(reader->m_size, sizeof(CaptureFileHeader) + header.recordBytes);
+        }
+        return reader;
+    }
+
+    CaptureReader::~CaptureReader() {
+#if defined(_WIN32)
+        if (m_base) UnmapViewOfFile(m_base);
+        if (m_mapping) CloseHandle(static_cast<HANDLE>(m_mapping));
+        if (m_file) CloseHandle(static_cast<HANDLE>(m_file));
+#else
+        if (m_base) munmap(const_cast<uint8_t*>(m_base), m_mappedSize);
+        if (m_file >= 0) close(m_file);
+#endif
+    }
+
+    bool CaptureReader::Map(const std::string& path) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            RF_NETWORK_ERROR("CaptureReader: failed to open {}. Error: {}", path, GetLastError());
+            return false;
+        }
+        m_file = file;
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            RF_NETWORK_ERROR("CaptureReader: {} is empty.", path);
+            return false;
+        }
+        m_size = static_cast<uint64_t>(size.QuadPart);
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            RF_NETWORK_ERROR("CaptureReader: failed to map {}. Error: {}", path, GetLastError());
+            return false;
+        }
+        m_mapping = mapping;
+        m_base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        m_file = open(path.c_str(), O_RDONLY);
+        if (m_file < 0) {
+            RF_NETWORK_ERROR("CaptureReader: failed to open {}. Error: {}", path, std::strerror(errno));
+            return false;
+        }
+        struct stat info {};
+        if (fstat(m_file, &info) != 0 || info.st_size == 0) {
+            RF_NETWORK_ERROR("CaptureReader: {} is empty.", path);
+            return false;
+        }
+        m_size = m_mappedSize = static_cast<uint64_t>(info.st_size);
+        void* base = mmap(nullptr, m_mappedSize, PROT_READ, MAP_PRIVATE, m_file, 0);
+        m_base = base == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(base);
+#endif
+        if (!m_base) {
+            RF_NETWORK_ERROR("CaptureReader: failed to map {}.", path);
+            return false;
+        }
+        return true;
+    }
+
+    const CaptureFileHeader& CaptureReader::GetHeader() const {
+        return *reinterpret_cast<const CaptureFileHeader*>(m_base);
+    }
+
+    bool CaptureReader::Next(CaptureRecord& out) {
+        if (m_offset + sizeof(CaptureRecordHeader) > m_size) return false;
+
+        CaptureRecordHeader header;
+        std::memcpy(&header, m_base + m_offset, sizeof(header));
+        const uint64_t dataOffset = m_offset + sizeof(header);
+        if (header.kind < static_cast<uint8_t>(CaptureRecordKind::Received) ||
+            header.kind > static_cast<uint8_t>(CaptureRecordKind::Payload) ||
+            dataOffset + header.size > m_size) {
+            return false; // the zeroed tail of an unclosed capture, or a record cut short
+        }
+
+        out.kind = static_cast<CaptureRecordKind>(header.kind);
+        out.time = std::chrono::microseconds(header.timeUs);
+        out.endpoint = NetworkEndpoint();
+        out.endpoint.port = header.port;
+        out.endpoint.family = header.family;
+        std::memcpy(out.endpoint.address, header.address, sizeof(header.address));
+        out.clientId = header.clientId;
+        out.channel = header.channel;
+        out.data = { m_base + dataOffset, header.size };
+
+        m_offset = dataOffset + PaddedSize(header.size);
+        return true;
+    }
+
+} // namespace RiftNet::Networking
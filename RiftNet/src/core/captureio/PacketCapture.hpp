@@ -0,0 +1,153 @@
+#pragma once
+
+#include "../networkio/NetworkEndpoint.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace RiftNet::Networking {
+
+    // What a capture record holds.
+    enum class CaptureRecordKind : uint8_t {
+        Received = 1, // a datagram as the socket delivered it, before decryption
+        Sent = 2,     // a datagram as handed to the socket
+        Payload = 3,  // an application message after decryption and reassembly, as the server raised it
+    };
+
+    // The file starts with this header, followed by records back to back.
+    struct CaptureFileHeader {
+        char     magic[8];         // "RIFTCAP\0"
+        uint32_t version;          // CAPTURE_FORMAT_VERSION
+        uint32_t headerSize;       // sizeof(CaptureFileHeader); records start here
+        int64_t  startUnixUs;      // wall-clock time of the first timestamp's zero, for reference
+        uint64_t recordBytes;      // bytes of records after the header
+        uint64_t recordCount;
+        uint64_t droppedRecords;   // records that no longer fit once the file was full
+    };
+
+    // Each record is this header and `size` bytes, padded to 8 bytes.
+    struct CaptureRecordHeader {
+        uint64_t timeUs;      // since the capture was opened
+        uint64_t clientId;    // Payload: the sending client; else 0
+        uint32_t size;        // bytes of data that follow
+        uint8_t  kind;        // CaptureRecordKind
+        uint8_t  channel;     // Payload: the channel it arrived on; else 0
+        uint16_t port;        // Received / Sent: the peer, host byte order
+        uint16_t family;      // Received / Sent: AF_INET or AF_INET6; Payload: 0
+        uint16_t reserved[3];
+        uint8_t  address[16]; // as NetworkEndpoint::address
+    };
+
+    static_assert(sizeof(CaptureFileHeader) == 48 && sizeof(CaptureRecordHeader) == 48,
+        "capture layouts are part of the file format");
+
+    constexpr uint32_t CAPTURE_FORMAT_VERSION = 1;
+
+    /**
+     * @class CaptureWriter
+     * @brief Appends timestamped records to a memory-mapped file of fixed capacity.
+     * The file is sized to its capacity when opened and mapped once; each Record reserves its
+     * bytes with one compare-and-swap and copies them into the mapping, so any thread may record
+     * at once without a lock or a system call. Once the file is full, records are counted and
+     * dropped. The destructor writes the totals into the header and trims the file to what was
+     * used; a writer must outlive every thread that records into it.
+     */
+    class CaptureWriter {
+    public:
+        /**
+         * @brief Creates and maps `path` (replacing any file there) with room for `capacityBytes`.
+         * @return nullptr if the file cannot be created or mapped.
+         */
+        static std::unique_ptr<CaptureWriter> Open(const std::string& path, uint64_t capacityBytes);
+
+        ~CaptureWriter();
+
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+        void Record(CaptureRecordKind kind, const NetworkEndpoint& endpoint, const uint8_t* data, uint32_t size);
+        void RecordPayload(uint64_t clientId, uint8_t channel, const uint8_t* data, uint32_t size);
+
+        uint64_t GetRecordCount() const { return m_recordCount.load(std::memory_order_relaxed); }
+        uint64_t GetDroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    private:
+        CaptureWriter() = default;
+
+        bool Map(const std::string& path, uint64_t capacityBytes);
+        void Append(CaptureRecordHeader header, const uint8_t* data); // stamps the time
+        void Close();
+
+        uint8_t* m_base = nullptr;  // the mapped file, header first
+        uint64_t m_capacity = 0;    // bytes of the mapping
+#if defined(_WIN32)
+        void* m_file = nullptr;     // HANDLE
+        void* m_mapping = nullptr;  // HANDLE
+#else
+        int m_file = -1;
+#endif
+        std::chrono::steady_clock::time_point m_start;
+
+        std::atomic<uint64_t> m_offset{ sizeof(CaptureFileHeader) }; // end of the last reserved record
+        std::atomic<uint64_t> m_recordCount{ 0 };
+        std::atomic<uint64_t> m_dropped{ 0 };
+        std::string m_path;
+    };
+
+    // One record as CaptureReader returns it; `data` points into the reader's mapping.
+    struct CaptureRecord {
+        CaptureRecordKind kind = CaptureRecordKind::Received;
+        std::chrono::microseconds time{ 0 };
+        NetworkEndpoint endpoint; // Received / Sent
+        uint64_t clientId = 0;    // Payload
+        uint8_t channel = 0;      // Payload
+        std::span<const uint8_t> data;
+    };
+
+    /**
+     * @class CaptureReader
+     * @brief Maps a file written by CaptureWriter read-only and walks its records in order.
+     */
+    class CaptureReader {
+    public:
+        /**
+         * @return nullptr if `path` cannot be mapped or is not a capture of a known version.
+         */
+        static std::unique_ptr<CaptureReader> Open(const std::string& path);
+
+        ~CaptureReader();
+
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+
+        const CaptureFileHeader& GetHeader() const;
+
+        /**
+         * @brief Reads the next record into `out`. Returns false at the end, or at a truncated record.
+         */
+        bool Next(CaptureRecord& out);
+
+        void Rewind() { m_offset = sizeof(CaptureFileHeader); }
+
+    private:
+        CaptureReader() = default;
+
+        bool Map(const std::string& path);
+
+        const uint8_t* m_base = nullptr;
+        uint64_t m_size = 0;   // header plus recordBytes, at most the file size
+        uint64_t m_offset = sizeof(CaptureFileHeader);
+#if defined(_WIN32)
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#else
+        int m_file = -1;
+        uint64_t m_mappedSize = 0;
+#endif
+    };
+
+} // namespace RiftNet::Networking
@@ -2,13 +2,17 @@
 #include "Connection.hpp"
 
 #include "../../protocol/PacketFactory/PacketFactory.hpp"
-#include "../../security/handshake/Handshake.hpp"
+#include "../buffer/ScratchArena.hpp"
+#include "../../security/Handshake/Handshake.hpp"
 #include "../../../utilities/logger/Logger.hpp" // adjust include path if needed
 
+#include <sodium.h>
+
 #include <vector>
 #include <string>
 #include <cstring>
 #include <array>
+#include <algorithm> // For std::clamp, std::min
 #include <cstdint>
 
 namespace {
@@ -32,33 +36,54 @@ namespace {
         return (static_cast<uint64_t>(lo) << 32) | hi;
     }
 #endif
+
+    // How long a coalescing batch may wait for more messages before the timer flushes it.
+    constexpr auto COALESCE_FLUSH_DELAY = std::chrono::milliseconds(10);
+
+    // Packets SendPackets seals per Encryptor::EncryptBatch call; bounds its stack arrays.
+    constexpr size_t SEAL_BATCH = 32;
 } // namespace
 
 namespace RiftNet::Protocol {
 
     Connection::Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer)
-        : m_endpoint(endpoint)
+        : Connection(endpoint, isServer, nullptr)
     {
-        try {
-            RF_NETWORK_DEBUG("Connection ctor: endpoint={}:{} isServer={}",
-                endpoint.ipAddress, endpoint.port, isServer ? "true" : "false");
+    }
 
-            m_encryptor = std::make_unique<RiftNet::Security::Encryptor>(isServer);
-            m_compressor = std::make_unique<RiftNet::Compression::Compressor>();
+    Connection::Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer,
+        std::unique_ptr<KeyExchangeX25519> keyExchange)
+        : Connection(endpoint, isServer, std::move(keyExchange), RecycledParts{})
+    {
+    }
 
-            // Nonce policy: Client even, Server odd
-            if (isServer) {
-                m_txNonce.store(1, std::memory_order_relaxed);
-                m_rxNonce.store(0, std::memory_order_relaxed);
+    Connection::Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer,
+        std::unique_ptr<KeyExchangeX25519> keyExchange, RecycledParts parts)
+        : m_endpoint(endpoint), m_isServer(isServer)
+    {
+        try {
+            RF_NETWORK_DEBUG("Connection ctor: endpoint={} isServer={}",
+                endpoint, isServer ? "true" : "false");
+
+            if (parts.encryptor) {
+                parts.encryptor->Reset(isServer, std::move(keyExchange));
+                m_encryptor = std::move(parts.encryptor);
+            }
+            else {
+                m_encryptor = std::make_unique<RiftNet::Security::Encryptor>(isServer, std::move(keyExchange));
+            }
+            if (parts.compressor) {
+                parts.compressor->Reset();
+                m_compressor = std::move(parts.compressor);
             }
             else {
-                m_txNonce.store(0, std::memory_order_relaxed);
-                m_rxNonce.store(1, std::memory_order_relaxed);
+                m_compressor = std::make_unique<RiftNet::Compression::Compressor>();
             }
 
-            RF_NETWORK_DEBUG("Connection ctor complete: txNonce={} rxNonce={}",
-                m_txNonce.load(std::memory_order_relaxed),
-                m_rxNonce.load(std::memory_order_relaxed));
+            // Nonce policy: Client even, Server odd
+            m_txNonce.store(isServer ? 1 : 0, std::memory_order_relaxed);
+
+            RF_NETWORK_DEBUG("Connection ctor complete: txNonce={}", m_txNonce.load(std::memory_order_relaxed));
         }
         catch (const std::exception& e) {
             RF_NETWORK_CRITICAL("Exception in Connection ctor: {}", e.what());
@@ -70,16 +95,259 @@ namespace RiftNet::Protocol {
         }
     }
 
+    Connection::~Connection() {
+        sodium_memzero(m_resumptionSecret.data(), m_resumptionSecret.size());
+    }
+
+    Connection::RecycledParts Connection::ReleaseParts() {
+        if (m_encryptor) {
+            m_encryptor->Clear();
+        }
+        return RecycledParts{ std::move(m_encryptor), std::move(m_compressor) };
+    }
+
     void Connection::SetSendCallback(SendCallback cb) { m_sendCallback = cb; }
     void Connection::SetAppDataCallback(AppDataCallback cb) { m_appDataCallback = cb; }
+    void Connection::SetTimerCallback(TimerCallback cb) { m_timerCallback = cb; }
+    void Connection::SetExtendedAcks(bool offer) { m_offerExtendedAcks.store(offer, std::memory_order_relaxed); }
+
+    bool Connection::SetChannels(const std::vector<ChannelType>& types) {
+        std::lock_guard<std::mutex> lock(m_channelSendMtx);
+        if (!m_channels.Configure(types)) {
+            RF_NETWORK_ERROR("SetChannels: {} channels requested, at most {} supported", types.size(), MAX_CHANNELS);
+            return false;
+        }
+        return true;
+    }
+
+    void Connection::SetCongestionController(std::unique_ptr<ICongestionController> controller) {
+        const bool enabled = controller != nullptr;
+        RF_NETWORK_DEBUG("SetCongestionController: algorithm={}",
+            enabled ? static_cast<int>(controller->GetAlgorithm()) : static_cast<int>(CongestionAlgorithm::None));
+
+        UDPReliabilityProtocol::SetCongestionController(m_reliabilityState, std::move(controller));
+        {
+            std::lock_guard<std::mutex> lock(m_pacingMtx);
+            m_pacingEnabled = enabled;
+            UpdateQueueSendsLocked();
+        }
+        if (!enabled) {
+            DrainSendQueue(std::chrono::steady_clock::now()); // no pacer or window left: only a budget holds packets
+        }
+    }
+
+    void Connection::SetRetransmitTimeoutBounds(std::chrono::milliseconds minRto, std::chrono::milliseconds maxRto) {
+        RF_NETWORK_DEBUG("SetRetransmitTimeoutBounds: {} - {} ms", minRto.count(), maxRto.count());
+        UDPReliabilityProtocol::SetRetransmitTimeoutBounds(m_reliabilityState,
+            static_cast<float>(minRto.count()), static_cast<float>(maxRto.count()));
+    }
+
+    void Connection::SetSendBudget(uint32_t bytesPerTick, std::chrono::milliseconds tick) {
+        RF_NETWORK_DEBUG("SetSendBudget: {} bytes per {} ms", bytesPerTick, tick.count());
+        {
+            std::lock_guard<std::mutex> lock(m_pacingMtx);
+            m_sendBudget.Configure(bytesPerTick, tick);
+            UpdateQueueSendsLocked();
+        }
+        if (bytesPerTick == 0) {
+            DrainSendQueue(std::chrono::steady_clock::now());
+        }
+    }
+
+    void Connection::UpdateQueueSendsLocked() {
+        m_queueSends.store(m_pacingEnabled || m_sendBudget.IsEnabled(), std::memory_order_release);
+    }
+
+    void Connection::SetMaxDatagramSize(uint32_t bytes, bool probe) {
+        const uint32_t size = std::clamp(bytes, MIN_DATAGRAM_SIZE, MAX_DATAGRAM_SIZE);
+        RF_NETWORK_DEBUG("SetMaxDatagramSize: {} bytes (requested {}), probe={}", size, bytes, probe);
+
+        std::lock_guard<std::mutex> lock(m_mtuMtx);
+        m_maxDatagramSize.store(size, std::memory_order_relaxed);
+        m_mtuProber = probe ? std::make_unique<PathMtuProber>(size) : nullptr;
+    }
+
+    uint32_t Connection::GetMaxDatagramSize() const {
+        return m_maxDatagramSize.load(std::memory_order_relaxed);
+    }
+
+    void Connection::SetCompression(std::shared_ptr<const RiftNet::Compression::CompressionDictionary> dictionary, uint32_t threshold) {
+        m_dictionaryId = dictionary ? dictionary->GetId() : 0;
+        m_compressor->SetDictionary(std::move(dictionary));
+        m_compressor->SetThreshold(threshold);
+    }
+
+    void Connection::SetStreamCompression(uint32_t windowBytes) {
+        RF_NETWORK_DEBUG("SetStreamCompression: window={} bytes", windowBytes);
+        m_streamWindow.store(windowBytes, std::memory_order_relaxed);
+    }
+
+    void Connection::SetPendingSendLimit(uint32_t capacityBytes, PendingOverflowPolicy policy) {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        m_pendingSends.Configure(capacityBytes != 0 ? capacityBytes : DEFAULT_PENDING_SEND_CAPACITY, policy);
+    }
+
+    // ---------------- Session resumption ----------------
+
+    void Connection::SetSessionTicket(RiftNet::Security::ResumptionTicket ticket) {
+        std::lock_guard<std::mutex> lock(m_ticketMtx);
+        sodium_memzero(m_sessionTicket.secret.data(), m_sessionTicket.secret.size());
+        m_sessionTicket = std::move(ticket);
+    }
+
+    bool Connection::GetSessionTicket(RiftNet::Security::ResumptionTicket& outTicket) const {
+        std::lock_guard<std::mutex> lock(m_ticketMtx);
+        if (m_sessionTicket.ticket.empty()) return false;
+        outTicket = m_sessionTicket;
+        return true;
+    }
+
+    void Connection::SetResumptionSecret(const RiftNet::Security::KeyBuffer& secret) {
+        m_resumptionSecret = secret;
+        m_hasResumptionSecret = true;
+    }
+
+    void Connection::DeliverEarlyData() {
+        if (m_earlyData.empty()) return;
+        RF_NETWORK_DEBUG("Delivering {} bytes of 0-RTT data from {}", m_earlyData.size(), GetEndpoint());
+        DeliverCoalesced(m_earlyData);
+        sodium_memzero(m_earlyData.data(), m_earlyData.size());
+        m_earlyData.clear();
+        m_earlyData.shrink_to_fit();
+    }
+
+    void Connection::SendSessionTicket(const RiftNet::Security::ResumptionTicket& ticket) {
+        if (!IsSecure() || ticket.ticket.empty()) return;
+
+        const uint32_t size = static_cast<uint32_t>(ticket.ticket.size() + ticket.secret.size());
+        auto packet = RiftNet::Networking::PacketBuffer::Create(size);
+        uint8_t* body = packet->Append(size);
+        std::memcpy(body, ticket.ticket.data(), ticket.ticket.size());
+        std::memcpy(body + ticket.ticket.size(), ticket.secret.data(), ticket.secret.size());
+        if (PacketFactory::CreateUnreliableDataPacket(*packet, PacketType::Session_Ticket)) {
+            RF_NETWORK_DEBUG("Sending session ticket to {}", GetEndpoint());
+            SendPacket(packet, /*retainPlaintext=*/false); // sealed in place, so the secret leaves no plaintext copy
+        }
+    }
+
+    std::vector<uint8_t> Connection::SealEarlyDataLocked(const RiftNet::Security::ResumptionTicket& ticket) {
+        // What a cleartext RESUME leaves of the datagram once its own fields and the AEAD tag are in
+        const size_t limit = m_maxDatagramSize.load(std::memory_order_relaxed);
+        const size_t fixed = Handshake::Hello::kMaxSize + sizeof(uint16_t) + ticket.ticket.size() +
+            RiftNet::Security::Encryptor::kTagSize;
+        const size_t budget = limit > fixed ? limit - fixed : 0;
+
+        // Framed like a coalesced payload; stops at the first message that cannot go, so order holds
+        std::vector<uint8_t> plain;
+        const uint64_t first = m_pendingSends.GetFrontSequence();
+        uint64_t taken = 0;
+        m_pendingSends.ForEach([&](std::span<const uint8_t> data, bool /*reliable*/, uint8_t channel) {
+            const size_t framed = COALESCED_LENGTH_PREFIX_SIZE + data.size();
+            if (channel != DEFAULT_CHANNEL || data.size() > COALESCED_MAX_MESSAGE_SIZE || plain.size() + framed > budget) {
+                return false;
+            }
+            plain.push_back(static_cast<uint8_t>(data.size() & 0xFF));
+            plain.push_back(static_cast<uint8_t>(data.size() >> 8));
+            plain.insert(plain.end(), data.begin(), data.end());
+            ++taken;
+            return true;
+            });
+        if (taken == 0) return {};
+
+        const RiftNet::Security::KeyBuffer key = RiftNet::Security::DeriveEarlyDataKey(ticket.secret, m_encryptor->GetPublicKey());
+        std::vector<uint8_t> sealed = RiftNet::Security::SealEarlyData(key, plain);
+        sodium_memzero(plain.data(), plain.size());
+        if (sealed.empty()) return {};
+
+        m_earlyDataEnd = first + taken;
+        m_sentEarlyData = true;
+        RF_NETWORK_DEBUG("BeginHandshake: {} pending message(s) go as 0-RTT data ({} bytes)", taken, sealed.size());
+        return sealed;
+    }
+
+    bool Connection::AcceptEarlyData(const byte_vec& peerPub, std::span<const uint8_t> sealed) {
+        const RiftNet::Security::KeyBuffer key = RiftNet::Security::DeriveEarlyDataKey(m_resumptionSecret, peerPub);
+        if (!RiftNet::Security::OpenEarlyData(key, sealed, m_earlyData)) {
+            RF_NETWORK_WARN("Handshake: 0-RTT data from {} does not authenticate; ignoring it", GetEndpoint());
+            return false;
+        }
+        return true;
+    }
+
+    // ---------------- Connection IDs ----------------
+
+    void Connection::SetConnectionMigration(bool offer) { m_offerConnectionId.store(offer, std::memory_order_relaxed); }
+
+    void Connection::SetRoutingId(uint32_t routingId) { m_routingId = routingId; }
+
+    uint32_t Connection::GetRoutingId() const {
+        if (m_isServer) return m_routingId;
+        return m_routingActive.load(std::memory_order_acquire) ? m_routingId : 0;
+    }
+
+    uint32_t Connection::TxPrefixSize() const {
+        return (!m_isServer && m_routingActive.load(std::memory_order_acquire)) ? ROUTING_ID_SIZE : 0;
+    }
+
+    uint32_t Connection::RxPrefixSize() const {
+        return (m_isServer && m_routingActive.load(std::memory_order_acquire)) ? ROUTING_ID_SIZE : 0;
+    }
+
+    bool Connection::ProcessMigratedPacket(const RiftNet::Networking::NetworkEndpoint& from, uint8_t* data, uint32_t size,
+        const std::function<bool(const RiftNet::Networking::NetworkEndpoint& previous)>& rebind) {
+        if (!m_isServer || !IsSecure() || !m_routingActive.load(std::memory_order_acquire)) return false;
+        RiftNet::Metrics::Add(m_metrics.packetsReceived);
+        RiftNet::Metrics::Add(m_metrics.bytesReceived, size);
+
+        uint64_t nonce = 0;
+        uint8_t* plain = nullptr;
+        uint32_t plainSize = 0;
+        if (!OpenSealedPacket(data, size, nonce, plain, plainSize)) return false;
+
+        // Only the peer can seal, but anyone can replay: a copy of an old datagram sent from
+        // elsewhere must not pull the connection away from the peer. A new one that is merely
+        // reordered is still the peer's, and its nonce is now recorded, so it is delivered here
+        // or never; only the newest datagram may move the connection.
+        switch (RecordRxNonce(nonce)) {
+        case RiftNet::Security::ReplayWindow::Result::Replayed:
+            RF_NETWORK_DEBUG("Replayed datagram for {} arrived from {}; dropping", GetEndpoint(), from);
+            return false;
+        case RiftNet::Security::ReplayWindow::Result::Accepted:
+            HandleDecryptedPacket(plain, plainSize);
+            return false;
+        case RiftNet::Security::ReplayWindow::Result::Advanced:
+            break;
+        }
+
+        // Nothing is delivered, or sent, on behalf of an address the table did not give us
+        const RiftNet::Networking::NetworkEndpoint previous = GetEndpoint();
+        if (!rebind(previous)) {
+            RF_NETWORK_WARN_LIMITED("Connection at {} could not move to {}; dropping the datagram", previous, from);
+            return false;
+        }
+        RF_NETWORK_DEBUG("Connection migrated from {} to {}", previous, from);
+
+        HandleDecryptedPacket(plain, plainSize);
+        return true;
+    }
+
+    void Connection::SetEndpoint(const RiftNet::Networking::NetworkEndpoint& endpoint) {
+        std::lock_guard<std::mutex> lock(m_endpointMtx);
+        m_endpoint = endpoint;
+    }
+
+    RiftNet::Security::ReplayWindow::Result Connection::RecordRxNonce(uint64_t nonce) {
+        return m_rxWindow.Record(nonce >> 1);
+    }
 
     bool Connection::InitializeSession(const byte_vec& remotePublicKey) {
         try {
             RF_NETWORK_DEBUG("InitializeSession: remotePublicKey size={}", remotePublicKey.size());
             const bool ok = m_encryptor->InitializeSession(remotePublicKey);
-            RF_NETWORK_INFO("InitializeSession: {}", ok ? "success" : "failure");
+            RF_NETWORK_DEBUG("InitializeSession: {}", ok ? "success" : "failure");
             if (ok) {
                 FlushPendingSends();
+                SendMtuProbeIfDue(std::chrono::steady_clock::now());
             }
             return ok;
         }
@@ -113,26 +381,150 @@ namespace RiftNet::Protocol {
             return;
         }
 
-        auto hello = Handshake::BuildHello(pub);
+        // A client holding a ticket resumes; each ticket is presented once, since the server redeems it once
+        RiftNet::Security::ResumptionTicket ticket;
+        if (!m_isServer) {
+            std::lock_guard<std::mutex> lock(m_ticketMtx);
+            ticket = std::move(m_sessionTicket);
+            m_sessionTicket = {};
+        }
+
+        std::vector<uint8_t> hello;
+        if (!ticket.ticket.empty()) {
+            std::vector<uint8_t> sealed;
+            {
+                std::lock_guard<std::mutex> lock(m_pendingMtx);
+                sealed = SealEarlyDataLocked(ticket);
+            }
+            sodium_memzero(ticket.secret.data(), ticket.secret.size());
+            hello = Handshake::BuildResume(pub, GetHelloCaps(), m_dictionaryId, m_routingId, ticket.ticket, sealed);
+        }
+        else {
+            hello = Handshake::BuildHello(pub, GetHelloCaps(), m_dictionaryId, m_routingId);
+        }
         if (hello.empty()) {
-            RF_NETWORK_ERROR("BeginHandshake: BuildHello failed");
+            RF_NETWORK_ERROR("BeginHandshake: building the HELLO failed");
+            return;
+        }
+
+        const auto endpoint = GetEndpoint();
+        RF_NETWORK_DEBUG("BeginHandshake: sending {} ({} bytes) to {}",
+            ticket.ticket.empty() ? "HELLO" : "RESUME", hello.size(), endpoint);
+        SendDatagram(endpoint, RiftNet::Networking::PacketBuffer::FromBytes(hello.data(), hello.size())); // plaintext
+    }
+
+    uint8_t Connection::GetHelloCaps() const {
+        uint8_t caps = m_offerExtendedAcks.load(std::memory_order_relaxed) ? Handshake::Hello::kCapExtendedAcks : 0;
+        if (m_dictionaryId != 0) {
+            caps |= Handshake::Hello::kCapDictionary;
+        }
+        // A server only assigns a routing id to a client that asked for one, and only then sends it
+        if (m_isServer ? m_routingActive.load(std::memory_order_acquire) : m_offerConnectionId.load(std::memory_order_relaxed)) {
+            caps |= Handshake::Hello::kCapConnectionId;
+        }
+        if (m_isServer && m_earlyDataAccepted) {
+            caps |= Handshake::Hello::kCapEarlyData;
+        }
+        return caps;
+    }
+
+    void Connection::SendHandshakeResponse(const RiftNet::Security::Cookie& cookie) {
+        auto response = Handshake::BuildResponse(m_encryptor->GetPublicKey(), GetHelloCaps(), m_dictionaryId,
+            /*routingId=*/0, cookie);
+        if (response.empty()) {
+            RF_NETWORK_ERROR("SendHandshakeResponse: BuildResponse failed");
             return;
         }
 
-        RF_NETWORK_DEBUG("BeginHandshake: sending HELLO ({} bytes) to {}:{}",
-            hello.size(), m_endpoint.ipAddress, m_endpoint.port);
-        m_sendCallback(m_endpoint, hello); // plaintext
+        const auto endpoint = GetEndpoint();
+        RF_NETWORK_DEBUG("Handshake: answering {}'s cookie challenge ({} bytes)", endpoint, response.size());
+        SendDatagram(endpoint, RiftNet::Networking::PacketBuffer::FromBytes(response.data(), response.size())); // plaintext
     }
 
     bool Connection::MaybeHandleCleartextHandshake(const uint8_t* data, uint32_t size) {
+        RiftNet::Security::Cookie cookie{};
+        if (Handshake::TryParseChallenge(data, size, cookie)) {
+            // Only a client that sent a HELLO expects a challenge; a server never answers one
+            if (m_isServer || !m_handshakeStarted.load(std::memory_order_acquire) || !m_sendCallback) {
+                RF_NETWORK_WARN_LIMITED("Unexpected handshake challenge from {}; dropping", GetEndpoint());
+                return true;
+            }
+            SendHandshakeResponse(cookie);
+            return true;
+        }
+
+        // A server reaches here with the client's response, whose cookie RiftServer already checked,
+        // or with its resume, whose ticket RiftServer already redeemed
         byte_vec peerPub;
-        if (!Handshake::TryParseHello(data, size, peerPub)) return false;
+        uint8_t peerCaps = 0;
+        uint32_t peerDictionaryId = 0;
+        uint32_t peerRoutingId = 0;
+        std::span<const uint8_t> ticket;
+        std::span<const uint8_t> sealedEarlyData;
+        const bool resume = m_isServer && Handshake::TryParseResume(data, size, peerPub, peerCaps, peerDictionaryId,
+            peerRoutingId, ticket, sealedEarlyData);
+        if (!resume &&
+            !Handshake::TryParseHello(data, size, peerPub, peerCaps, peerDictionaryId, peerRoutingId) &&
+            !Handshake::TryParseResponse(data, size, peerPub, peerCaps, peerDictionaryId, peerRoutingId, cookie)) {
+            return false;
+        }
+
+        // One thread derives the session: a copy of this packet that a receive thread hands in
+        // while a server's handshake thread is still on it is dropped rather than racing it
+        if (m_sessionStarting.exchange(true, std::memory_order_acq_rel)) {
+            RF_NETWORK_DEBUG("Handshake with {} already in progress; dropping duplicate", GetEndpoint());
+            return true;
+        }
+
+        RF_NETWORK_DEBUG("Handshake {} received from {} (pub=32 bytes, caps=0x{:02x})",
+            resume ? "RESUME" : "HELLO", GetEndpoint(), peerCaps);
 
-        RF_NETWORK_INFO("Handshake HELLO received from {}:{} (pub=32 bytes)",
-            m_endpoint.ipAddress, m_endpoint.port);
+        if (m_isServer) {
+            // Our HELLO carries these answers, so settle them before InitializeSession sends it
+            m_routingActive.store(m_routingId != 0 && (peerCaps & Handshake::Hello::kCapConnectionId) != 0,
+                std::memory_order_release);
+            if (resume && m_hasResumptionSecret && !sealedEarlyData.empty()) {
+                m_earlyDataAccepted = AcceptEarlyData(peerPub, sealedEarlyData);
+            }
+            sodium_memzero(m_resumptionSecret.data(), m_resumptionSecret.size());
+            m_hasResumptionSecret = false;
+        }
+        else {
+            if (m_offerConnectionId.load(std::memory_order_relaxed) &&
+                (peerCaps & Handshake::Hello::kCapConnectionId) != 0 && peerRoutingId != 0) {
+                m_routingId = peerRoutingId;
+                m_routingActive.store(true, std::memory_order_release);
+            }
+
+            // The server already delivered what went as 0-RTT data; the rest is flushed once secure
+            std::lock_guard<std::mutex> lock(m_pendingMtx);
+            if (m_sentEarlyData && (peerCaps & Handshake::Hello::kCapEarlyData) != 0) {
+                RF_NETWORK_DEBUG("Handshake: server accepted our 0-RTT data");
+                m_pendingSends.DropBefore(m_earlyDataEnd);
+            }
+            m_sentEarlyData = false;
+        }
+
+        // Both HELLOs must offer the extended header; decide before any sealed traffic flows
+        const bool extended = m_offerExtendedAcks.load(std::memory_order_relaxed) &&
+            (peerCaps & Handshake::Hello::kCapExtendedAcks) != 0;
+        if (!UDPReliabilityProtocol::SetHeaderFormat(m_reliabilityState,
+            extended ? ReliabilityHeaderFormat::Extended : ReliabilityHeaderFormat::Compact)) {
+            RF_NETWORK_WARN("Handshake: reliability header format already in use; keeping it");
+        }
+
+        // Likewise the dictionary: only compress against it if the peer loaded the same one
+        const bool sameDictionary = m_dictionaryId != 0 && (peerCaps & Handshake::Hello::kCapDictionary) != 0 &&
+            peerDictionaryId == m_dictionaryId;
+        if (m_dictionaryId != 0 && !sameDictionary) {
+            RF_NETWORK_WARN("Handshake: peer has no matching compression dictionary (ours={:08x}, theirs={:08x}); using plain LZ4",
+                m_dictionaryId, peerDictionaryId);
+        }
+        m_compressor->SetDictionaryCompression(sameDictionary);
 
         if (!InitializeSession(peerPub)) {
             RF_NETWORK_ERROR("Handshake: InitializeSession failed");
+            m_sessionStarting.store(false, std::memory_order_release);
             return true; // consumed (it was a HELLO), even if failed
         }
 
@@ -145,62 +537,75 @@ namespace RiftNet::Protocol {
             RF_NETWORK_TRACE("Handshake: our HELLO already sent");
         }
 
-        RF_NETWORK_INFO("Handshake complete: encryption initialized");
+        RF_NETWORK_DEBUG("Handshake complete: encryption initialized");
         return true;
     }
 
     void Connection::FlushPendingSends() {
-        // Move pending sends out under lock to avoid recursion holding the lock
-        std::deque<PendingSend> local;
+        // Take the queue out under lock, so sending neither holds it nor copies each message again
+        PendingSendQueue local;
         {
             std::lock_guard<std::mutex> lock(m_pendingMtx);
-            if (m_pendingSends.empty()) return;
-            local.swap(m_pendingSends);
-            m_pendingBytes = 0;
-        }
-        RF_NETWORK_INFO("Flushing {} pre-secure payload(s)", local.size());
-        for (auto& ps : local) {
-            SendApplicationData(ps.data.data(), static_cast<uint32_t>(ps.data.size()), ps.reliable);
+            if (m_pendingSends.Empty()) return;
+            local = m_pendingSends.Take();
+            m_pendingOverflowWarned = false;
         }
+        RF_NETWORK_DEBUG("Flushing {} pre-secure payload(s), {} bytes", local.GetCount(), local.GetUsedBytes());
+
+        // Default-channel messages go out in coalesced batches even with coalescing off (the peer always
+        // accepts them), so a reconnect's backlog costs a few datagrams rather than one per message
+        const uint32_t configured = m_coalesceBudget.load(std::memory_order_relaxed);
+        const uint32_t budget = configured != 0 ? configured : MAX_COALESCE_BUDGET;
+
+        std::unique_lock<std::mutex> lock(m_coalesceMtx);
+        local.Drain([&](std::span<const uint8_t> data, bool reliable, uint8_t channel) {
+            const uint32_t size = static_cast<uint32_t>(data.size());
+            if (channel == DEFAULT_CHANNEL) {
+                CoalesceLocked(data.data(), size, reliable, budget);
+                return;
+            }
+            // Channel messages are never coalesced: send the batches first so the queue order holds
+            FlushBatchLocked(/*isReliable=*/true);
+            FlushBatchLocked(/*isReliable=*/false);
+            lock.unlock();
+            SendChannelData(channel, data.data(), size);
+            lock.lock();
+            });
+        FlushBatchLocked(/*isReliable=*/true);
+        FlushBatchLocked(/*isReliable=*/false);
     }
 
     // ---------------------------------------------------
 
-    void Connection::ProcessIncomingRawPacket(const uint8_t* data, uint32_t size) {
+    void Connection::ProcessIncomingRawPacket(uint8_t* data, uint32_t size) {
         RF_NETWORK_TRACE("ProcessIncomingRawPacket: size={}", static_cast<size_t>(size));
+        RiftNet::Metrics::Add(m_metrics.packetsReceived);
+        RiftNet::Metrics::Add(m_metrics.bytesReceived, size);
 
         // If not initialized yet, check for cleartext handshake
         if (!m_encryptor || !m_encryptor->IsInitialized()) {
             if (MaybeHandleCleartextHandshake(data, size)) {
                 return; // handled HELLO
             }
-            RF_NETWORK_WARN("Packet received before encryption initialized (non-handshake); dropping");
-            return;
-        }
-
-        // Secure path: wire = [8-byte nonce BE][ciphertext+tag]
-        if (size < 8) {
-            RF_NETWORK_WARN("Encrypted frame too small: {} bytes", size);
+            RF_NETWORK_WARN_LIMITED("Packet received before encryption initialized (non-handshake); dropping");
             return;
         }
 
-        uint64_t nonce_be = 0;
-        std::memcpy(&nonce_be, data, sizeof(nonce_be));
-        const uint64_t nonce = be64_to_host(nonce_be);
-
         try {
-            std::vector<uint8_t> decrypted_packet;
-
-            if (!m_encryptor->Decrypt({ data + 8, data + size }, decrypted_packet, nonce)) {
-                RF_NETWORK_WARN("Decryption failed (auth failure / bad nonce). wire_nonce={}", nonce);
+            uint64_t nonce = 0;
+            uint8_t* plain = nullptr;
+            uint32_t plainSize = 0;
+            if (!OpenSealedPacket(data, size, nonce, plain, plainSize)) {
                 return;
             }
 
-            // Track last seen rx nonce for diagnostics only
-            m_rxNonce.store(nonce, std::memory_order_relaxed);
-
-            HandleDecryptedPacket(decrypted_packet.data(),
-                static_cast<uint32_t>(decrypted_packet.size()));
+            // A duplicate that raced this one through decryption loses here
+            if (RecordRxNonce(nonce) == RiftNet::Security::ReplayWindow::Result::Replayed) {
+                RiftNet::Metrics::Add(m_metrics.replaysDropped);
+                RF_NETWORK_DEBUG("Dropping replayed datagram: wire_nonce={}", nonce);
+                return;
+            }
+            HandleDecryptedPacket(plain, plainSize);
         }
         catch (const std::exception& e) {
             RF_NETWORK_ERROR("Exception in ProcessIncomingRawPacket: {}", e.what());
@@ -210,47 +615,128 @@ namespace RiftNet::Protocol {
         }
     }
 
+    bool Connection::OpenSealedPacket(uint8_t* data, uint32_t size, uint64_t& outNonce, uint8_t*& outPlain,
+        uint32_t& outPlainSize) {
+        // Secure path: wire = [routing id, if negotiated][8-byte nonce BE][ciphertext+tag]
+        const uint32_t prefix = RxPrefixSize();
+        if (size < prefix + 8) {
+            RF_NETWORK_WARN_LIMITED("Encrypted frame too small: {} bytes", size);
+            return false;
+        }
+        if (prefix != 0) {
+            const uint32_t routingId = static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+            if (routingId != m_routingId) {
+                RF_NETWORK_WARN_LIMITED("Datagram carries routing id {:08x}, expected {:08x}; dropping", routingId, m_routingId);
+                return false;
+            }
+            data += prefix;
+            size -= prefix;
+        }
+
+        uint64_t nonce_be = 0;
+        std::memcpy(&nonce_be, data, sizeof(nonce_be));
+        outNonce = be64_to_host(nonce_be);
+
+        // Reject replays before paying for the AEAD: the peer seals each nonce once, with its own parity
+        // (client even, server odd), so a repeated, reflected or too-old nonce cannot be genuine
+        if ((outNonce & 1) != (m_isServer ? 0u : 1u) || !m_rxWindow.IsFresh(outNonce >> 1)) {
+            RiftNet::Metrics::Add(m_metrics.replaysDropped);
+            RF_NETWORK_DEBUG("Dropping replayed or out-of-window datagram: wire_nonce={}", outNonce);
+            return false;
+        }
+
+        // Decrypt in place: the plaintext overwrites the ciphertext in the receive buffer
+        uint8_t* ciphertext = data + 8;
+        const size_t ciphertext_size = size - 8;
+        size_t decrypted_size = 0;
+        if (!m_encryptor->Decrypt({ ciphertext, ciphertext_size }, { ciphertext, ciphertext_size }, outNonce, decrypted_size)) {
+            RiftNet::Metrics::Add(m_metrics.decryptFailures);
+            RF_NETWORK_WARN_LIMITED("Decryption failed (auth failure / bad nonce). wire_nonce={}", outNonce);
+            return false;
+        }
+        outPlain = ciphertext;
+        outPlainSize = static_cast<uint32_t>(decrypted_size);
+        return true;
+    }
+
     void Connection::HandleDecryptedPacket(const uint8_t* data, uint32_t size) {
         RF_NETWORK_TRACE("HandleDecryptedPacket: size={}", static_cast<size_t>(size));
 
         try {
             GeneralPacketHeader generalHeader{};
-            ReliabilityPacketHeader reliabilityHeader{};
+            ExtendedReliabilityPacketHeader reliabilityHeader{};
             const uint8_t* compressed_payload = nullptr;
             uint32_t compressed_payload_size = 0;
 
             if (!PacketFactory::ParsePacket(data, size, generalHeader, reliabilityHeader,
-                compressed_payload, compressed_payload_size)) {
-                RF_NETWORK_WARN("Invalid packet format");
+                compressed_payload, compressed_payload_size,
+                UDPReliabilityProtocol::GetHeaderFormat(m_reliabilityState))) {
+                RF_NETWORK_WARN_LIMITED("Invalid packet format");
                 return;
             }
 
-            // Decompress
-            std::vector<uint8_t> final_payload =
-                m_compressor->Decompress({ compressed_payload, compressed_payload + compressed_payload_size });
-
-            bool processPayload = true;
-            if (generalHeader.Type == PacketType::Data_Reliable) {
-                if (!UDPReliabilityProtocol::ProcessIncomingHeader(m_reliabilityState, reliabilityHeader)) {
-                    RF_NETWORK_TRACE("Duplicate reliable packet ignored");
-                    processPayload = false;
+            // Ack-only packets carry no payload: apply the acks and stop there
+            if (generalHeader.Type == PacketType::Heartbeat_Ack) {
+                const auto now = std::chrono::steady_clock::now();
+                UDPReliabilityProtocol::ProcessIncomingAck(m_reliabilityState, reliabilityHeader, now);
+                if (UDPReliabilityProtocol::HasFastRetransmitPending(m_reliabilityState)) {
+                    SendRetransmissions(now);
+                }
+                DrainSendQueue(now); // acks may have opened the congestion window
+                return;
+            }
+            if (generalHeader.Type == PacketType::Mtu_Probe) {
+                HandleMtuProbe(compressed_payload, compressed_payload_size, size);
+                return;
+            }
+            if (generalHeader.Type == PacketType::Mtu_Probe_Ack) {
+                HandleMtuProbeAck(compressed_payload, compressed_payload_size);
+                return;
+            }
+            if (generalHeader.Type == PacketType::Compression_Stream_Reset) {
+                HandleStreamResetRequest(compressed_payload, compressed_payload_size);
+                return;
+            }
+            if (generalHeader.Type == PacketType::Snapshot_Ack) {
+                HandleSnapshotAck(compressed_payload, compressed_payload_size);
+                return;
+            }
+            if (generalHeader.Type == PacketType::Session_Ticket) {
+                const uint32_t ticketSize = static_cast<uint32_t>(RiftNet::Security::SESSION_TICKET_SIZE);
+                if (m_isServer || compressed_payload_size != ticketSize + sizeof(RiftNet::Security::KeyBuffer)) {
+                    RF_NETWORK_WARN_LIMITED("Unexpected session ticket ({} bytes); dropping", compressed_payload_size);
+                    return;
                 }
+                RiftNet::Security::ResumptionTicket ticket;
+                ticket.ticket.assign(compressed_payload, compressed_payload + ticketSize);
+                std::memcpy(ticket.secret.data(), compressed_payload + ticketSize, ticket.secret.size());
+                RF_NETWORK_DEBUG("Received a session ticket");
+                SetSessionTicket(std::move(ticket));
+                return;
             }
 
-            if (processPayload) {
-                if (!final_payload.empty()) {
-                    if (m_appDataCallback) {
-                        m_appDataCallback(final_payload.data(),
-                            static_cast<uint32_t>(final_payload.size()));
-                    }
-                    else {
-                        RF_NETWORK_WARN("AppDataCallback not set; dropping {} bytes", final_payload.size());
-                    }
+            if (IsReliableDataType(generalHeader.Type)) {
+                const auto now = std::chrono::steady_clock::now();
+                const bool fresh = UDPReliabilityProtocol::ProcessIncomingHeader(m_reliabilityState, reliabilityHeader, now);
+                // Holes reported by the peer are resent right away rather than on the next timer
+                if (UDPReliabilityProtocol::HasFastRetransmitPending(m_reliabilityState)) {
+                    SendRetransmissions(now);
                 }
-                else {
-                    RF_NETWORK_TRACE("Final payload empty after decompression; dropping");
+                DrainSendQueue(now); // queued data may now fit the window, and can carry the ack
+                SendAckIfDue(now);
+                if (!fresh) {
+                    RiftNet::Metrics::Add(m_metrics.duplicatesDropped);
+                    RF_NETWORK_TRACE("Duplicate reliable packet ignored");
+                    return;
                 }
             }
+
+            if (IsFragmentDataType(generalHeader.Type)) {
+                HandleFragment(generalHeader.Type, compressed_payload, compressed_payload_size);
+                return;
+            }
+            DeliverPayload(generalHeader.Type, compressed_payload, compressed_payload_size);
         }
         catch (const std::exception& e) {
             RF_NETWORK_ERROR("Exception in HandleDecryptedPacket: {}", e.what());
@@ -260,121 +746,759 @@ namespace RiftNet::Protocol {
         }
     }
 
-    void Connection::SendApplicationData(const uint8_t* data, uint32_t size, bool isReliable) {
-        RF_NETWORK_TRACE("SendApplicationData: size={} reliable={}", static_cast<size_t>(size), isReliable);
-
-        if (!m_encryptor || !m_encryptor->IsInitialized()) {
-            // Queue instead of dropping, and kick handshake.
-            BeginHandshake();
-
-            PendingSend ps;
-            ps.data.assign(data, data + size);
-            ps.reliable = isReliable;
+    void Connection::DeliverPayload(PacketType type, const uint8_t* body, uint32_t size) {
+        if (type == PacketType::Data_Snapshot) {
+            HandleSnapshot(body, size);
+            return;
+        }
 
-            {
-                std::lock_guard<std::mutex> lock(m_pendingMtx);
-                m_pendingSends.push_back(std::move(ps));
-                m_pendingBytes += size;
-
-                // Backpressure: drop oldest until under limit
-                while (m_pendingBytes > kMaxPendingBytes && !m_pendingSends.empty()) {
-                    m_pendingBytes -= m_pendingSends.front().data.size();
-                    RF_NETWORK_WARN("Pending send queue overflow; dropping oldest payload of {} bytes",
-                        m_pendingSends.front().data.size());
-                    m_pendingSends.pop_front();
-                }
-            }
+        ChannelHeader channelHeader{};
+        if (IsChannelDataType(type) && !PacketFactory::ParseChannelHeader(body, size, channelHeader)) {
+            RF_NETWORK_WARN_LIMITED("Channel packet too short for its channel header");
+            return;
+        }
 
-            RF_NETWORK_WARN("Channel not secure yet; queued payload ({} bytes), pending={} bytes",
-                size, m_pendingBytes);
+        if (IsChannelDataType(type) && !m_appDataCallback) {
+            RF_NETWORK_WARN_LIMITED("AppDataCallback not set; dropping channel {} message", channelHeader.channel);
             return;
         }
 
-        try {
-            // Compress
-            std::vector<uint8_t> compressed_payload =
-                m_compressor->Compress({ data, data + size });
+        const std::span<const uint8_t> compressed{ body, size };
+        if (type == PacketType::Data_Channel_Ordered) {
+            // Held compressed and decompressed on release, since stream frames must decode in channel order.
+            // Serialized so an ordered channel's releases reach the app in order
+            std::lock_guard<std::mutex> lock(m_channelRecvMtx);
+            m_channels.Receive(type, channelHeader, compressed,
+                [this](const uint8_t* frame, uint32_t frameSize, uint8_t channel) { DeliverOrdered(frame, frameSize, channel); });
+            return;
+        }
 
-            // Packetize
-            std::vector<uint8_t> packet_bytes;
-            if (isReliable) {
-                packet_bytes = PacketFactory::CreateReliableDataPacket(
-                    m_reliabilityState,
-                    compressed_payload.data(),
-                    static_cast<uint32_t>(compressed_payload.size()));
-            }
-            else {
-                packet_bytes = PacketFactory::CreateUnreliableDataPacket(
-                    compressed_payload.data(),
-                    static_cast<uint32_t>(compressed_payload.size()));
-            }
+        std::span<const uint8_t> final_payload;
+        if (!DecompressPayload(compressed, final_payload)) {
+            return;
+        }
 
-            if (!packet_bytes.empty()) {
-                SendPacket(packet_bytes);
+        if (IsChannelDataType(type)) {
+            std::lock_guard<std::mutex> lock(m_channelRecvMtx);
+            m_channels.Receive(type, channelHeader, final_payload, m_appDataCallback);
+        }
+        else if (IsCoalescedDataType(type)) {
+            DeliverCoalesced(final_payload);
+        }
+        else if (!final_payload.empty()) {
+            if (m_appDataCallback) {
+                m_appDataCallback(final_payload.data(),
+                    static_cast<uint32_t>(final_payload.size()), DEFAULT_CHANNEL);
             }
             else {
-                RF_NETWORK_WARN("PacketFactory returned empty packet (reliable={})", isReliable);
+                RF_NETWORK_WARN_LIMITED("AppDataCallback not set; dropping {} bytes", final_payload.size());
             }
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Exception in SendApplicationData: {}", e.what());
-        }
-        catch (...) {
-            RF_NETWORK_ERROR("Unknown exception in SendApplicationData");
+        else {
+            RF_NETWORK_TRACE("Final payload empty after decompression; dropping");
         }
     }
 
-    void Connection::SendPacket(const std::vector<uint8_t>& packet_data) {
-        RF_NETWORK_TRACE("SendPacket: size={}", packet_data.size());
+    bool Connection::DecompressPayload(std::span<const uint8_t> compressed, std::span<const uint8_t>& outPayload) {
+        // Stored payloads are read in place; others decompress into this thread's scratch arena,
+        // which is only read until the callback returns
+        if (RiftNet::Compression::Compressor::TryGetStored(compressed, outPayload)) {
+            return true;
+        }
 
-        try {
-            // Prepare per-frame nonce
-            const uint64_t tx_nonce = m_txNonce.load(std::memory_order_relaxed);
+        size_t final_size = 0;
+        if (!RiftNet::Compression::Compressor::GetDecompressedSize(compressed, final_size)) {
+            RF_NETWORK_WARN_LIMITED("Invalid compressed payload ({} bytes)", compressed.size());
+            return false;
+        }
+
+        std::span<uint8_t> scratch = RiftNet::Networking::ScratchArena::Local().Acquire(final_size);
+        if (!m_compressor->Decompress(compressed, scratch, final_size)) {
+            RF_NETWORK_WARN_LIMITED("Decompression failed ({} bytes)", compressed.size());
+            return false;
+        }
+        outPayload = scratch.first(final_size);
+        return true;
+    }
 
-            // Encrypt (ciphertext does not include nonce)
-            std::vector<uint8_t> encrypted_packet =
-                m_encryptor->Encrypt(packet_data, tx_nonce);
+    void Connection::DeliverOrdered(const uint8_t* frame, uint32_t size, uint8_t channel) {
+        const std::span<const uint8_t> compressed{ frame, size };
+        std::span<const uint8_t> final_payload;
 
-            if (encrypted_packet.empty()) {
-                RF_NETWORK_WARN("Encryption failed: empty packet (nonce={})", tx_nonce);
+        if (!RiftNet::Compression::Compressor::IsStreamFrame(compressed)) {
+            if (!DecompressPayload(compressed, final_payload)) return;
+        }
+        else {
+            auto& decoder = m_streamDecoders[channel];
+            const size_t held = decoder ? decoder->GetMemoryUsage() : 0;
+            const size_t needed = RiftNet::Compression::StreamDecompressor::GetKeyframeMemory(compressed);
+            if (needed != 0 && m_streamRecvBytes - held + needed > kMaxStreamMemory) {
+                // A peer within its own cap never gets here, so asking for a keyframe would not help
+                RF_NETWORK_WARN_LIMITED("Stream keyframe on channel {} needs {} bytes past the {} byte cap; dropping",
+                    channel, needed, kMaxStreamMemory);
                 return;
             }
+            if (!decoder) {
+                decoder = std::make_unique<RiftNet::Compression::StreamDecompressor>();
+            }
 
-            // Build wire: [nonce_be (8)][ciphertext...]
-            std::vector<uint8_t> wire;
-            wire.resize(8 + encrypted_packet.size());
-            uint64_t be = host_to_be64(tx_nonce);
-            std::memcpy(wire.data(), &be, sizeof(be));
-            std::memcpy(wire.data() + 8, encrypted_packet.data(), encrypted_packet.size());
+            const bool decoded = decoder->Decompress(compressed, final_payload);
+            m_streamRecvBytes = m_streamRecvBytes - held + decoder->GetMemoryUsage();
+            if (!decoded) {
+                // Until a keyframe arrives every frame fails the same way; each asks again in case a request was lost
+                SendStreamResetRequest(channel);
+                return;
+            }
+        }
 
-            // Only bump nonce after successful encrypt + wire build
-            m_txNonce.fetch_add(2, std::memory_order_relaxed);
+        m_appDataCallback(final_payload.data(), static_cast<uint32_t>(final_payload.size()), channel);
+    }
 
-            if (m_sendCallback) {
-                m_sendCallback(m_endpoint, wire);
-            }
-            else {
-                RF_NETWORK_WARN("SendCallback not set; dropping {} bytes", wire.size());
-            }
+    void Connection::HandleFragment(PacketType type, const uint8_t* payload, uint32_t size) {
+        FragmentHeader fragmentHeader{};
+        if (!PacketFactory::ParseFragmentHeader(payload, size, fragmentHeader)) {
+            RF_NETWORK_WARN_LIMITED("Malformed fragment header ({} bytes)", size);
+            return;
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Exception in SendPacket: {}", e.what());
+
+        // Pieces travel with their message's guarantees: a reliable message is never left to unreliable pieces
+        const bool reliable = IsReliableDataType(type);
+        if (IsReliableDataType(fragmentHeader.innerType) != reliable) {
+            RF_NETWORK_WARN_LIMITED("Fragment reliability does not match its message type {}",
+                static_cast<int>(fragmentHeader.innerType));
+            return;
         }
-        catch (...) {
-            RF_NETWORK_ERROR("Unknown exception in SendPacket");
+
+        PacketType innerType{};
+        std::vector<uint8_t> message;
+        {
+            std::lock_guard<std::mutex> lock(m_fragmentMtx);
+            if (!m_reassembler.AddFragment(fragmentHeader, { payload, size }, reliable,
+                std::chrono::steady_clock::now(), innerType, message)) {
+                return; // more pieces to come
+            }
         }
+
+        RF_NETWORK_TRACE("Reassembled message {} ({} pieces, {} bytes)",
+            fragmentHeader.messageId, fragmentHeader.count, message.size());
+        DeliverPayload(innerType, message.data(), static_cast<uint32_t>(message.size()));
     }
 
-    void Connection::Update(std::chrono::steady_clock::time_point now) {
-        try {
-            UDPReliabilityProtocol::ProcessRetransmissions(
-                m_reliabilityState, now,
-                [this](const std::vector<uint8_t>& retransmit_packet) {
-                    // Re-encrypt and send with a NEW nonce each time
-                    SendPacket(retransmit_packet);
-                }
-            );
-        }
+    bool Connection::SendApplicationData(const uint8_t* data, uint32_t size, bool isReliable, const SendOptions& options) {
+        RF_NETWORK_TRACE("SendApplicationData: size={} reliable={}", static_cast<size_t>(size), isReliable);
+
+        if (!m_encryptor || !m_encryptor->IsInitialized()) {
+            // Queue instead of dropping, and kick handshake.
+            return QueuePendingSend(data, size, isReliable, DEFAULT_CHANNEL);
+        }
+
+        // A batch goes out at normal priority, so messages with their own options are sent on their own
+        const uint32_t budget = m_coalesceBudget.load(std::memory_order_relaxed);
+        if (budget != 0 && options.IsDefault()) {
+            return CoalesceOrSend(data, size, isReliable, budget);
+        }
+
+        // Backpressure: refuse before compressing if the reliable window has no free slot
+        if (isReliable && !HasReliableWindowSpace()) {
+            RF_NETWORK_WARN_LIMITED("Reliable send window full ({} in flight); rejecting {} bytes",
+                UDPReliabilityProtocol::GetSendWindowSize(m_reliabilityState), static_cast<size_t>(size));
+            return false;
+        }
+
+        return SendPayload(data, size, isReliable, isReliable ? PacketType::Data_Reliable : PacketType::Data_Unreliable,
+            {}, nullptr, options);
+    }
+
+    bool Connection::QueuePendingSend(const uint8_t* data, uint32_t size, bool isReliable, uint8_t channel) {
+        using PushResult = PendingSendQueue::PushResult;
+        PushResult result = PushResult::Queued;
+        size_t evicted = 0;
+        size_t pendingBytes = 0;
+        size_t capacity = 0;
+        PendingOverflowPolicy policy = PendingOverflowPolicy::DropOldest;
+        bool firstOverflow = false;
+        {
+            std::lock_guard<std::mutex> lock(m_pendingMtx);
+            result = m_pendingSends.Push({ data, size }, isReliable, channel, evicted);
+            pendingBytes = m_pendingSends.GetUsedBytes();
+            capacity = m_pendingSends.GetCapacity();
+            policy = m_pendingSends.GetPolicy();
+            if ((result != PushResult::Queued || evicted != 0) && !m_pendingOverflowWarned) {
+                m_pendingOverflowWarned = firstOverflow = true;
+            }
+        }
+
+        // A reconnect storm overflows on every send; warn once and keep the rest at debug
+        if (result != PushResult::Queued || evicted != 0) {
+            const char* action = policy == PendingOverflowPolicy::DropOldest ? "dropping oldest payloads"
+                : policy == PendingOverflowPolicy::DropNewest ? "dropping new payloads" : "rejecting new payloads";
+            if (firstOverflow) {
+                RF_NETWORK_WARN("Pre-secure send queue full ({} bytes); {} until the handshake completes", capacity, action);
+            }
+            else {
+                RF_NETWORK_DEBUG("Pre-secure send queue full; {} ({} bytes, {} evicted)", action, static_cast<size_t>(size), evicted);
+            }
+        }
+        RF_NETWORK_TRACE("Channel not secure yet; queued payload ({} bytes), pending={} bytes", size, pendingBytes);
+
+        // After queuing, so a resuming client's first message can go in its RESUME
+        BeginHandshake();
+        return result != PushResult::Rejected;
+    }
+
+    bool Connection::SendChannelData(uint8_t channel, const uint8_t* data, uint32_t size, const SendOptions& options) {
+        RF_NETWORK_TRACE("SendChannelData: channel={} size={}", channel, static_cast<size_t>(size));
+
+        ChannelType type{};
+        uint16_t sequence = 0;
+        std::lock_guard<std::mutex> lock(m_channelSendMtx);
+        if (!m_channels.GetSendInfo(channel, type, sequence)) {
+            RF_NETWORK_WARN_LIMITED("SendChannelData: channel {} is not configured", channel);
+            return false;
+        }
+        const bool isReliable = type != ChannelType::UnreliableSequenced;
+
+        if (!IsSecure()) {
+            // Numbered when actually sent, so queued messages keep their order (and go at normal priority)
+            return QueuePendingSend(data, size, isReliable, channel);
+        }
+
+        if (isReliable && !HasReliableWindowSpace()) {
+            RF_NETWORK_WARN_LIMITED("Reliable send window full; rejecting {} bytes on channel {}", static_cast<size_t>(size), channel);
+            return false;
+        }
+
+        // The sequence is only consumed once the packet is queued: a gap would stall an ordered channel
+        const ChannelHeader header{ channel, sequence };
+        RiftNet::Compression::StreamCompressor* stream = GetSendStream(channel, type, size);
+        if (!SendPayload(data, size, isReliable, ChannelPacketType(type),
+            { reinterpret_cast<const uint8_t*>(&header), sizeof(header) }, stream, options)) {
+            if (stream) {
+                stream->Reset(); // its history now holds a message the peer will never see
+            }
+            return false;
+        }
+        m_channels.CommitSend(channel);
+        return true;
+    }
+
+    bool Connection::SendSnapshot(const uint8_t* data, uint32_t size) {
+        if (!IsSecure()) {
+            RF_NETWORK_TRACE("SendSnapshot: not secure yet; dropping {} bytes", static_cast<size_t>(size));
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_snapshotSendMtx);
+        if (!m_snapshotEncoder) {
+            m_snapshotEncoder = std::make_unique<RiftNet::Compression::SnapshotEncoder>();
+        }
+        SnapshotHeader header{};
+        if (!m_snapshotEncoder->Encode({ data, size }, m_snapshotDelta, header.id, header.baselineId)) {
+            RF_NETWORK_WARN_LIMITED("SendSnapshot: {} bytes is empty or above the {} byte limit",
+                static_cast<size_t>(size), RiftNet::Compression::MAX_SNAPSHOT_SIZE);
+            return false;
+        }
+        RF_NETWORK_TRACE("SendSnapshot: id={} baseline={} {} bytes as {}", header.id, header.baselineId,
+            static_cast<size_t>(size), m_snapshotDelta.size());
+        // Each snapshot holds the whole state, so a queued one is no use once a newer one is queued
+        return SendPayload(m_snapshotDelta.data(), static_cast<uint32_t>(m_snapshotDelta.size()), false,
+            PacketType::Data_Snapshot, { reinterpret_cast<const uint8_t*>(&header), sizeof(header) }, nullptr,
+            SendOptions{ SendPriority::Normal, 1 });
+    }
+
+    RiftNet::Compression::StreamCompressor* Connection::GetSendStream(uint8_t channel, ChannelType type, uint32_t size) {
+        const uint32_t window = m_streamWindow.load(std::memory_order_relaxed);
+        if (window == 0 || type != ChannelType::ReliableOrdered) {
+            return nullptr;
+        }
+
+        auto& encoder = m_streamEncoders[channel];
+        if (!encoder) {
+            auto created = std::make_unique<RiftNet::Compression::StreamCompressor>(window);
+            if (m_streamSendBytes + created->GetMemoryUsage() > kMaxStreamMemory) {
+                RF_NETWORK_DEBUG("Stream compression memory cap ({} bytes) reached; channel {} compresses per message",
+                    kMaxStreamMemory, channel);
+                return nullptr;
+            }
+            m_streamSendBytes += created->GetMemoryUsage();
+            encoder = std::move(created);
+        }
+        return size <= encoder->GetMaxMessageSize() ? encoder.get() : nullptr;
+    }
+
+    bool Connection::SendPayload(const uint8_t* data, uint32_t size, bool isReliable, PacketType type,
+        std::span<const uint8_t> header, RiftNet::Compression::StreamCompressor* stream, const SendOptions& options) {
+        try {
+            // Compress straight into the packet buffer; headers and tag go into its head/tailroom
+            const size_t bound = stream ? RiftNet::Compression::StreamCompressor::CompressBound(size)
+                                        : RiftNet::Compression::Compressor::CompressBound(size);
+            auto packet = RiftNet::Networking::PacketBuffer::Create(bound);
+            uint8_t* payload = packet->Append(bound);
+
+            const size_t compressed_size = stream ? stream->CompressInto({ data, size }, { payload, bound })
+                                                  : m_compressor->CompressInto({ data, size }, { payload, bound });
+            if (compressed_size == 0) {
+                RF_NETWORK_WARN_LIMITED("Compression failed (size={})", static_cast<size_t>(size));
+                return false;
+            }
+            packet->TrimBack(bound - compressed_size);
+            RiftNet::Metrics::Add(m_metrics.compressInputBytes, size);
+            RiftNet::Metrics::Add(m_metrics.compressOutputBytes, compressed_size);
+
+            if (!header.empty()) {
+                std::memcpy(packet->Prepend(header.size()), header.data(), header.size());
+            }
+            return SendFrame(packet, type, isReliable, options);
+        }
+        catch (const std::exception& e) {
+            RF_NETWORK_ERROR("Exception in SendPayload: {}", e.what());
+        }
+        catch (...) {
+            RF_NETWORK_ERROR("Unknown exception in SendPayload");
+        }
+        return false;
+    }
+
+    bool Connection::SendFrame(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable,
+        const SendOptions& options) {
+        if (packet->Size() > DatagramPayloadCapacity(isReliable)) {
+            return SendFragmented(packet, type, isReliable, options);
+        }
+        if (m_queueSends.load(std::memory_order_acquire)) {
+            return EnqueueSend({ &packet, 1 }, type, isReliable, type, options);
+        }
+        return PacketizeAndSend(packet, type, isReliable);
+    }
+
+    bool Connection::CanSendCompressed() const {
+        return IsSecure() && m_coalesceBudget.load(std::memory_order_relaxed) == 0;
+    }
+
+    bool Connection::UsesDictionaryCompression() const {
+        return m_compressor->IsDictionaryCompressionEnabled();
+    }
+
+    bool Connection::SendCompressedApplicationData(std::span<const uint8_t> frame, uint32_t rawSize, bool isReliable) {
+        if (!CanSendCompressed()) {
+            return false;
+        }
+        if (isReliable && !HasReliableWindowSpace()) {
+            RF_NETWORK_WARN_LIMITED("Reliable send window full ({} in flight); rejecting {} byte frame",
+                UDPReliabilityProtocol::GetSendWindowSize(m_reliabilityState), frame.size());
+            return false;
+        }
+        try {
+            // Each connection encrypts in place, so each needs its own copy of the shared frame
+            auto packet = RiftNet::Networking::PacketBuffer::FromBytes(frame.data(), frame.size());
+            RiftNet::Metrics::Add(m_metrics.compressInputBytes, rawSize);
+            RiftNet::Metrics::Add(m_metrics.compressOutputBytes, frame.size());
+            return SendFrame(packet, isReliable ? PacketType::Data_Reliable : PacketType::Data_Unreliable, isReliable);
+        }
+        catch (const std::exception& e) {
+            RF_NETWORK_ERROR("Exception in SendCompressedApplicationData: {}", e.what());
+        }
+        catch (...) {
+            RF_NETWORK_ERROR("Unknown exception in SendCompressedApplicationData");
+        }
+        return false;
+    }
+
+    bool Connection::SendFragmented(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable,
+        const SendOptions& options) {
+        const uint32_t pieceSize = DatagramPayloadCapacity(isReliable) - static_cast<uint32_t>(sizeof(FragmentHeader));
+        const uint16_t messageId = m_nextFragmentId.fetch_add(1, std::memory_order_relaxed);
+
+        const auto fragments = PacketFactory::CreateFragments(packet->Span(), type, messageId, pieceSize);
+        if (fragments.empty()) {
+            RF_NETWORK_WARN_LIMITED("Payload of {} bytes needs more than {} fragments; rejecting",
+                packet->Size(), MAX_FRAGMENTS_PER_MESSAGE);
+            return false;
+        }
+
+        // All or nothing: a reliable message missing pieces would sit in the peer's reassembly until it expires
+        const uint32_t count = static_cast<uint32_t>(fragments.size());
+        if (isReliable && !HasReliableWindowSpace(count)) {
+            RF_NETWORK_WARN_LIMITED("Reliable send window has no room for {} fragments; rejecting {} bytes",
+                count, packet->Size());
+            return false;
+        }
+
+        RF_NETWORK_TRACE("SendFragmented: {} bytes as {} fragments (id={})", packet->Size(), count, messageId);
+        const PacketType fragmentType = isReliable ? PacketType::Data_Reliable_Fragment : PacketType::Data_Unreliable_Fragment;
+        if (m_queueSends.load(std::memory_order_acquire)) {
+            return EnqueueSend(fragments, fragmentType, isReliable, type, options);
+        }
+        // Sealed as one batch
+        if (!PacketizeAndSend(fragments, fragmentType, isReliable)) {
+            RF_NETWORK_WARN_LIMITED("Fragmented send of message {} failed part way", messageId);
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t Connection::DatagramPayloadCapacity(bool isReliable) const {
+        uint32_t headers = DATAGRAM_OVERHEAD + TxPrefixSize() + static_cast<uint32_t>(sizeof(GeneralPacketHeader));
+        if (isReliable) {
+            headers += ReliabilityHeaderSize(UDPReliabilityProtocol::GetHeaderFormat(m_reliabilityState));
+        }
+        return m_maxDatagramSize.load(std::memory_order_relaxed) - headers;
+    }
+
+    bool Connection::PacketizeAndSend(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable) {
+        return PacketizeAndSend({ &packet, 1 }, type, isReliable);
+    }
+
+    bool Connection::PacketizeAndSend(std::span<const RiftNet::Networking::PacketBufferPtr> packets, PacketType type, bool isReliable) {
+        size_t packetized = 0;
+        for (; packetized < packets.size(); ++packetized) {
+            const bool ok = isReliable
+                ? PacketFactory::CreateReliableDataPacket(m_reliabilityState, packets[packetized], type)
+                : PacketFactory::CreateUnreliableDataPacket(*packets[packetized], type);
+            if (!ok) {
+                RF_NETWORK_WARN_LIMITED("PacketFactory failed to build packet (reliable={})", isReliable);
+                break;
+            }
+        }
+        if (packetized == 0) {
+            return false;
+        }
+
+        // Packets already numbered are awaiting acks, so they go out even if a later one failed
+        SendPackets(packets.first(packetized), isReliable);
+        if (isReliable) {
+            ArmTimer(std::chrono::steady_clock::now() +
+                UDPReliabilityProtocol::GetRetransmissionTimeout(m_reliabilityState));
+        }
+        return packetized == packets.size();
+    }
+
+    bool Connection::HasReliableWindowSpace(uint32_t slots) const {
+        return UDPReliabilityProtocol::HasSendWindowSpace(m_reliabilityState,
+            slots + m_queuedReliable.load(std::memory_order_acquire));
+    }
+
+    // ---------------- Send queue ----------------
+
+    bool Connection::EnqueueSend(std::span<const RiftNet::Networking::PacketBufferPtr> packets, PacketType type,
+        bool isReliable, PacketType messageType, const SendOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(m_pacingMtx);
+            uint64_t key = 0;
+            uint64_t generation = 0;
+            if (!isReliable) {
+                size_t bytes = 0;
+                for (const auto& packet : packets) {
+                    bytes += packet->Size();
+                }
+                if (m_sendQueue.GetUnreliableBytes() + bytes > kMaxQueuedUnreliableBytes) {
+                    RF_NETWORK_WARN_LIMITED("Send queue full ({} unreliable bytes); rejecting {} bytes",
+                        m_sendQueue.GetUnreliableBytes(), bytes);
+                    return false;
+                }
+                if (options.latestKey != 0) {
+                    key = (static_cast<uint64_t>(messageType) << 32) | options.latestKey;
+                    generation = m_sendQueue.Supersede(key);
+                }
+            }
+            else {
+                m_queuedReliable.fetch_add(static_cast<uint32_t>(packets.size()), std::memory_order_acq_rel);
+            }
+            for (const auto& packet : packets) {
+                m_sendQueue.Push(options.priority, packet, type, isReliable, key, generation);
+            }
+        }
+
+        DrainSendQueue(std::chrono::steady_clock::now());
+        return true;
+    }
+
+    void Connection::DrainSendQueue(std::chrono::steady_clock::time_point now) {
+        std::lock_guard<std::mutex> lock(m_pacingMtx);
+        if (m_sendQueue.Empty()) return;
+
+        m_pacer.SetRate(UDPReliabilityProtocol::GetPacingRate(m_reliabilityState));
+
+        // Most urgent first, each priority strictly FIFO so channel and coalescing order survive.
+        // A reliable packet waiting on acks holds back the reliable ones after it, even less urgent
+        // ones that would fit, but not unreliable packets of lower priorities.
+        bool windowBlocked = false;
+        for (size_t priority = 0; priority < SEND_PRIORITY_COUNT; ++priority) {
+            while (SendScheduler::Entry* next = m_sendQueue.Front(priority)) {
+                const uint32_t bytes = next->bytes;
+                if (next->reliable && (windowBlocked ||
+                    !UDPReliabilityProtocol::HasCongestionWindowSpace(m_reliabilityState, bytes))) {
+                    windowBlocked = true;
+                    break; // an ack will reopen the window and drain again
+                }
+                if (!m_pacer.CanSend(now) || !m_sendBudget.CanSend(now)) {
+                    ArmTimer((std::max)(m_pacer.NextSendTime(now), m_sendBudget.NextSendTime(now)));
+                    return;
+                }
+
+                if (PacketizeAndSend(next->packet, next->type, next->reliable)) {
+                    m_pacer.OnSent(bytes);
+                    m_sendBudget.OnSent(bytes);
+                }
+                else if (next->reliable && !UDPReliabilityProtocol::HasSendWindowSpace(m_reliabilityState)) {
+                    windowBlocked = true;
+                    break; // keep it until acks free a slot
+                }
+                else {
+                    RF_NETWORK_WARN_LIMITED("Dropping queued packet of {} bytes", static_cast<size_t>(bytes));
+                }
+
+                if (next->reliable) {
+                    m_queuedReliable.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                m_sendQueue.PopFront(priority);
+            }
+        }
+    }
+
+    std::chrono::steady_clock::time_point Connection::GetSendQueueDeadline(std::chrono::steady_clock::time_point now) {
+        if (!m_queueSends.load(std::memory_order_acquire)) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        std::lock_guard<std::mutex> lock(m_pacingMtx);
+        // The first packet DrainSendQueue would send, skipping reliable ones held by the window as it does
+        bool windowBlocked = false;
+        for (size_t priority = 0; priority < SEND_PRIORITY_COUNT; ++priority) {
+            const SendScheduler::Entry* next = m_sendQueue.Front(priority);
+            if (!next) continue;
+            if (next->reliable && (windowBlocked ||
+                !UDPReliabilityProtocol::HasCongestionWindowSpace(m_reliabilityState, next->bytes))) {
+                windowBlocked = true;
+                continue; // waiting on acks, not on time; a less urgent unreliable packet may not be
+            }
+            return (std::max)(m_pacer.NextSendTime(now), m_sendBudget.NextSendTime(now));
+        }
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    // ---------------- Send coalescing ----------------
+
+    void Connection::SetCoalescing(uint32_t budgetBytes) {
+        const uint32_t budget = (budgetBytes > MAX_COALESCE_BUDGET) ? MAX_COALESCE_BUDGET : budgetBytes;
+        m_coalesceBudget.store(budget, std::memory_order_relaxed);
+        if (budget == 0) {
+            Flush(); // nothing may be left behind once coalescing is off
+        }
+    }
+
+    bool Connection::CoalesceOrSend(const uint8_t* data, uint32_t size, bool isReliable, uint32_t budget) {
+        std::lock_guard<std::mutex> lock(m_coalesceMtx);
+        return CoalesceLocked(data, size, isReliable, budget);
+    }
+
+    bool Connection::CoalesceLocked(const uint8_t* data, uint32_t size, bool isReliable, uint32_t budget) {
+        try {
+            // A full batch must fit one datagram even if it is stored uncompressed
+            const uint32_t capacity = DatagramPayloadCapacity(isReliable);
+            const uint32_t expansion = static_cast<uint32_t>(
+                RiftNet::Compression::Compressor::CompressBound(capacity) - capacity);
+            budget = (std::min)(budget, capacity - expansion);
+
+            std::vector<uint8_t>& batch = isReliable ? m_coalescedReliable : m_coalescedUnreliable;
+
+            const size_t framed = COALESCED_LENGTH_PREFIX_SIZE + static_cast<size_t>(size);
+            const bool overflows = !batch.empty() && batch.size() + framed > budget;
+            const bool alone = framed > budget || size > COALESCED_MAX_MESSAGE_SIZE;
+
+            // An open reliable batch holds a window slot in reserve; a new batch or lone packet needs one more.
+            if (isReliable) {
+                const uint32_t slots = (batch.empty() ? 0u : 1u) + ((overflows || alone || batch.empty()) ? 1u : 0u);
+                if (!HasReliableWindowSpace(slots)) {
+                    RF_NETWORK_WARN_LIMITED("Reliable send window full; rejecting {} bytes", static_cast<size_t>(size));
+                    return false;
+                }
+            }
+
+            if (overflows) {
+                FlushBatchLocked(isReliable);
+            }
+
+            // Too big to share a datagram: send alone, after anything queued before it
+            if (alone) {
+                return SendPayload(data, size, isReliable, isReliable ? PacketType::Data_Reliable : PacketType::Data_Unreliable);
+            }
+
+            if (batch.empty()) {
+                ArmTimer(std::chrono::steady_clock::now() + COALESCE_FLUSH_DELAY);
+            }
+            if (batch.capacity() < budget) {
+                batch.reserve(budget);
+            }
+            batch.push_back(static_cast<uint8_t>(size & 0xFF));
+            batch.push_back(static_cast<uint8_t>(size >> 8));
+            batch.insert(batch.end(), data, data + size);
+            return true;
+        }
+        catch (const std::exception& e) {
+            RF_NETWORK_ERROR("Exception in CoalesceLocked: {}", e.what());
+        }
+        catch (...) {
+            RF_NETWORK_ERROR("Unknown exception in CoalesceLocked");
+        }
+        return false;
+    }
+
+    void Connection::FlushBatchLocked(bool isReliable) {
+        std::vector<uint8_t>& batch = isReliable ? m_coalescedReliable : m_coalescedUnreliable;
+        if (batch.empty()) return;
+
+        RF_NETWORK_TRACE("FlushBatch: {} bytes reliable={}", batch.size(), isReliable);
+        SendPayload(batch.data(), static_cast<uint32_t>(batch.size()), isReliable,
+            isReliable ? PacketType::Data_Reliable_Coalesced : PacketType::Data_Unreliable_Coalesced);
+        batch.clear(); // keeps capacity for the next tick
+    }
+
+    void Connection::Flush() {
+        if (!IsSecure()) return; // pre-secure sends are still in m_pendingSends
+
+        std::lock_guard<std::mutex> lock(m_coalesceMtx);
+        FlushBatchLocked(/*isReliable=*/true);
+        FlushBatchLocked(/*isReliable=*/false);
+    }
+
+    void Connection::DeliverCoalesced(std::span<const uint8_t> payload) {
+        if (!m_appDataCallback) {
+            RF_NETWORK_WARN_LIMITED("AppDataCallback not set; dropping coalesced payload of {} bytes", payload.size());
+            return;
+        }
+
+        while (payload.size() >= COALESCED_LENGTH_PREFIX_SIZE) {
+            const uint32_t length = static_cast<uint32_t>(payload[0]) | (static_cast<uint32_t>(payload[1]) << 8);
+            payload = payload.subspan(COALESCED_LENGTH_PREFIX_SIZE);
+            if (length > payload.size()) {
+                RF_NETWORK_WARN_LIMITED("Truncated coalesced message ({} > {} bytes left); dropping rest", length, payload.size());
+                return;
+            }
+            if (length != 0) {
+                m_appDataCallback(payload.data(), length, DEFAULT_CHANNEL);
+            }
+            payload = payload.subspan(length);
+        }
+
+        if (!payload.empty()) {
+            RF_NETWORK_WARN_LIMITED("Coalesced payload has {} trailing byte(s)", payload.size());
+        }
+    }
+
+    void Connection::SendPacket(const RiftNet::Networking::PacketBufferPtr& packet, bool retainPlaintext) {
+        SendPackets({ &packet, 1 }, retainPlaintext);
+    }
+
+    void Connection::SendPackets(std::span<const RiftNet::Networking::PacketBufferPtr> packets, bool retainPlaintext) {
+        RF_NETWORK_TRACE("SendPackets: count={}", packets.size());
+
+        try {
+            using RiftNet::Networking::PacketBuffer;
+            using RiftNet::Security::Encryptor;
+
+            std::array<RiftNet::Security::SealJob, SEAL_BATCH> jobs;
+            std::array<RiftNet::Networking::PacketBufferPtr, SEAL_BATCH> wires;
+
+            // Read once: a migration mid-batch just moves the next batch
+            const RiftNet::Networking::NetworkEndpoint endpoint = GetEndpoint();
+            const bool prefixRoutingId = TxPrefixSize() != 0;
+
+            for (size_t first = 0; first < packets.size(); first += SEAL_BATCH) {
+                const size_t count = (std::min)(SEAL_BATCH, packets.size() - first);
+
+                // Reserve the batch's nonces up front: sends, retransmits from the timer thread and fast
+                // retransmits from the receive path can race, and a nonce must never be used twice.
+                const uint64_t first_nonce = m_txNonce.fetch_add(2 * count, std::memory_order_relaxed);
+
+                size_t prepared = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    const auto& packet = packets[first + i];
+                    const uint32_t plain_size = packet->Size();
+
+                    // Encrypt (ciphertext does not include nonce). Reliable packets stay queued
+                    // for retransmission as plaintext, so they are encrypted into a fresh wire buffer.
+                    RiftNet::Networking::PacketBufferPtr wire =
+                        retainPlaintext ? PacketBuffer::Create(plain_size) : packet;
+
+                    uint8_t* out = retainPlaintext ? wire->Append(plain_size + Encryptor::kTagSize) : packet->Data();
+                    if (!retainPlaintext && !wire->Append(Encryptor::kTagSize)) {
+                        RF_NETWORK_WARN_LIMITED("SendPacket: no tailroom for auth tag (size={})", plain_size);
+                        continue;
+                    }
+
+                    jobs[prepared] = { packet->Span().first(plain_size), { out, plain_size + Encryptor::kTagSize },
+                        first_nonce + 2 * i };
+                    wires[prepared++] = std::move(wire);
+                }
+
+                m_encryptor->EncryptBatch({ jobs.data(), prepared });
+
+                for (size_t i = 0; i < prepared; ++i) {
+                    RiftNet::Networking::PacketBufferPtr wire = std::move(wires[i]);
+                    if (jobs[i].sealed == 0) {
+                        RF_NETWORK_WARN_LIMITED("Encryption failed: empty packet (nonce={})", jobs[i].nonce);
+                        continue;
+                    }
+
+                    // Build wire: [nonce_be (8)][ciphertext...]
+                    uint8_t* nonce_ptr = wire->Prepend(sizeof(uint64_t));
+                    if (!nonce_ptr) {
+                        RF_NETWORK_WARN_LIMITED("SendPacket: no headroom for wire nonce");
+                        continue;
+                    }
+                    uint64_t be = host_to_be64(jobs[i].nonce);
+                    std::memcpy(nonce_ptr, &be, sizeof(be));
+
+                    // [routing id LE (4)] in front, so the server finds the connection from any address
+                    if (prefixRoutingId) {
+                        uint8_t* routing_ptr = wire->Prepend(ROUTING_ID_SIZE);
+                        if (!routing_ptr) {
+                            RF_NETWORK_WARN_LIMITED("SendPacket: no headroom for routing id");
+                            continue;
+                        }
+                        for (uint32_t b = 0; b < ROUTING_ID_SIZE; ++b) {
+                            routing_ptr[b] = static_cast<uint8_t>(m_routingId >> (8 * b));
+                        }
+                    }
+
+                    if (m_sendCallback) {
+                        SendDatagram(endpoint, wire);
+                    }
+                    else {
+                        RF_NETWORK_WARN_LIMITED("SendCallback not set; dropping {} bytes", wire->Size());
+                    }
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            RF_NETWORK_ERROR("Exception in SendPacket: {}", e.what());
+        }
+        catch (...) {
+            RF_NETWORK_ERROR("Unknown exception in SendPacket");
+        }
+    }
+
+    void Connection::SendDatagram(const RiftNet::Networking::NetworkEndpoint& endpoint,
+        const RiftNet::Networking::PacketBufferPtr& datagram) {
+        RiftNet::Metrics::Add(m_metrics.packetsSent);
+        RiftNet::Metrics::Add(m_metrics.bytesSent, datagram->Size());
+        m_sendCallback(endpoint, datagram);
+    }
+
+    void Connection::Update(std::chrono::steady_clock::time_point now) {
+        try {
+            // Messages queued during this tick go out before any retransmissions, and may
+            // carry the pending ack so no standalone one is needed
+            Flush();
+            DrainSendQueue(now);
+            SendRetransmissions(now);
+            SendAckIfDue(now);
+            SendMtuProbeIfDue(now);
+            {
+                std::lock_guard<std::mutex> lock(m_fragmentMtx);
+                m_reassembler.ExpireStale(now);
+            }
+        }
         catch (const std::exception& e) {
             RF_NETWORK_ERROR("Exception in Update: {}", e.what());
         }
@@ -383,16 +1507,275 @@ namespace RiftNet::Protocol {
         }
     }
 
-    bool Connection::IsTimedOut(std::chrono::steady_clock::time_point now, std::chrono::seconds timeout) const {
+    void Connection::SendRetransmissions(std::chrono::steady_clock::time_point now) {
+        // Collected and sealed as one batch, re-encrypted with a NEW nonce each time
+        std::vector<RiftNet::Networking::PacketBufferPtr> resend;
+        UDPReliabilityProtocol::ProcessRetransmissions(
+            m_reliabilityState, now,
+            [&resend](const RiftNet::Networking::PacketBufferPtr& retransmit_packet) {
+                resend.push_back(retransmit_packet);
+            }
+        );
+        if (!resend.empty()) {
+            RiftNet::Metrics::Add(m_metrics.retransmits, resend.size());
+            SendPackets(resend, /*retainPlaintext=*/true);
+        }
+    }
+
+    void Connection::SendAckIfDue(std::chrono::steady_clock::time_point now) {
+        const auto deadline = UDPReliabilityProtocol::GetAckDeadline(m_reliabilityState);
+        if (deadline == std::chrono::steady_clock::time_point::max()) return;
+
+        if (deadline > now) {
+            ArmTimer(deadline);
+            return;
+        }
+
+        // [GeneralHeader][ReliabilityHeader] only; encrypted in place like any unreliable packet
+        auto packet = RiftNet::Networking::PacketBuffer::Create(0);
+        if (UDPReliabilityProtocol::PrepareAckPacket(m_reliabilityState, packet)) {
+            RF_NETWORK_TRACE("Sending standalone ack to {}", GetEndpoint());
+            SendPacket(packet, /*retainPlaintext=*/false);
+        }
+    }
+
+    // ---------------- Path MTU probing ----------------
+
+    void Connection::SendMtuProbeIfDue(std::chrono::steady_clock::time_point now) {
+        if (!IsSecure()) return;
+
+        uint32_t probeSize = 0;
+        auto nextProbe = std::chrono::steady_clock::time_point::max();
+        {
+            std::lock_guard<std::mutex> lock(m_mtuMtx);
+            if (!m_mtuProber) return;
+
+            // A probe is only answered once, so give it a couple of RTOs rather than one
+            const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                2 * UDPReliabilityProtocol::GetRetransmissionTimeout(m_reliabilityState));
+            probeSize = m_mtuProber->PollProbe(now, timeout);
+            nextProbe = m_mtuProber->GetNextProbeTime();
+        }
+        if (nextProbe != std::chrono::steady_clock::time_point::max()) {
+            ArmTimer(nextProbe);
+        }
+        if (probeSize == 0) return;
+
+        // [GeneralHeader][u16 size][zero padding], sized so the whole datagram is probeSize bytes
+        const uint32_t bodySize = probeSize - DATAGRAM_OVERHEAD - TxPrefixSize() - static_cast<uint32_t>(sizeof(GeneralPacketHeader));
+        auto packet = RiftNet::Networking::PacketBuffer::Create(bodySize);
+        uint8_t* body = packet->Append(bodySize);
+        std::memset(body, 0, bodySize);
+        body[0] = static_cast<uint8_t>(probeSize & 0xFF);
+        body[1] = static_cast<uint8_t>(probeSize >> 8);
+        if (!PacketFactory::CreateUnreliableDataPacket(*packet, PacketType::Mtu_Probe)) {
+            RF_NETWORK_WARN_LIMITED("SendMtuProbe: no headroom for general header");
+            return;
+        }
+
+        RF_NETWORK_TRACE("Sending {} byte path MTU probe to {}", probeSize, GetEndpoint());
+        SendPacket(packet, /*retainPlaintext=*/false);
+    }
+
+    void Connection::HandleMtuProbe(const uint8_t* payload, uint32_t payloadSize, uint32_t packetSize) {
+        if (payloadSize < sizeof(uint16_t)) {
+            RF_NETWORK_WARN_LIMITED("Path MTU probe too short ({} bytes)", payloadSize);
+            return;
+        }
+        const uint32_t probeSize = static_cast<uint32_t>(payload[0]) | (static_cast<uint32_t>(payload[1]) << 8);
+        const uint32_t arrived = packetSize + DATAGRAM_OVERHEAD + RxPrefixSize();
+        if (probeSize != arrived) {
+            RF_NETWORK_WARN_LIMITED("Path MTU probe claims {} bytes but arrived as {}", probeSize, arrived);
+            return;
+        }
+
+        auto packet = RiftNet::Networking::PacketBuffer::Create(sizeof(uint16_t));
+        std::memcpy(packet->Append(sizeof(uint16_t)), payload, sizeof(uint16_t));
+        if (PacketFactory::CreateUnreliableDataPacket(*packet, PacketType::Mtu_Probe_Ack)) {
+            SendPacket(packet, /*retainPlaintext=*/false);
+        }
+    }
+
+    void Connection::HandleMtuProbeAck(const uint8_t* payload, uint32_t payloadSize) {
+        if (payloadSize < sizeof(uint16_t)) {
+            RF_NETWORK_WARN_LIMITED("Path MTU probe ack too short ({} bytes)", payloadSize);
+            return;
+        }
+        const uint32_t probeSize = static_cast<uint32_t>(payload[0]) | (static_cast<uint32_t>(payload[1]) << 8);
+        {
+            std::lock_guard<std::mutex> lock(m_mtuMtx);
+            if (!m_mtuProber || !m_mtuProber->OnProbeAck(probeSize)) return;
+            m_maxDatagramSize.store(m_mtuProber->GetDatagramSize(), std::memory_order_relaxed);
+        }
+        SendMtuProbeIfDue(std::chrono::steady_clock::now()); // on to the next size
+    }
+
+    void Connection::SendStreamResetRequest(uint8_t channel) {
+        auto packet = RiftNet::Networking::PacketBuffer::Create(sizeof(uint8_t));
+        *packet->Append(sizeof(uint8_t)) = channel;
+        if (PacketFactory::CreateUnreliableDataPacket(*packet, PacketType::Compression_Stream_Reset)) {
+            RF_NETWORK_DEBUG("Asking {} for a stream keyframe on channel {}", GetEndpoint(), channel);
+            SendPacket(packet, /*retainPlaintext=*/false);
+        }
+    }
+
+    void Connection::HandleStreamResetRequest(const uint8_t* payload, uint32_t payloadSize) {
+        if (payloadSize < sizeof(uint8_t) || payload[0] >= MAX_CHANNELS) {
+            RF_NETWORK_WARN_LIMITED("Malformed stream reset request ({} bytes)", payloadSize);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_channelSendMtx);
+        if (auto& encoder = m_streamEncoders[payload[0]]) {
+            RF_NETWORK_DEBUG("Peer {} lost stream sync on channel {}; next message is a keyframe", GetEndpoint(), payload[0]);
+            encoder->Reset();
+        }
+    }
+
+    void Connection::HandleSnapshot(const uint8_t* body, uint32_t size) {
+        SnapshotHeader header{};
+        if (!PacketFactory::ParseSnapshotHeader(body, size, header)) {
+            RF_NETWORK_WARN_LIMITED("Malformed snapshot header ({} bytes)", size);
+            return;
+        }
+        std::span<const uint8_t> delta;
+        if (!DecompressPayload({ body, size }, delta)) {
+            return;
+        }
+
+        {
+            // Serialized so snapshots reach the app in id order, each decoded against the history before it
+            std::lock_guard<std::mutex> lock(m_snapshotRecvMtx);
+            if (!m_snapshotDecoder) {
+                m_snapshotDecoder = std::make_unique<RiftNet::Compression::SnapshotDecoder>();
+            }
+            std::span<const uint8_t> snapshot;
+            if (!m_snapshotDecoder->Decode(header.id, header.baselineId, delta, snapshot)) {
+                RF_NETWORK_TRACE("Snapshot {} (baseline {}) not decoded; newest is {}",
+                    header.id, header.baselineId, m_snapshotDecoder->GetNewestId());
+                return;
+            }
+            if (m_appDataCallback) {
+                m_appDataCallback(snapshot.data(), static_cast<uint32_t>(snapshot.size()), SNAPSHOT_CHANNEL);
+            }
+        }
+
+        // Acked one by one: a lost ack only keeps the sender on an older baseline for a tick
+        auto packet = RiftNet::Networking::PacketBuffer::Create(sizeof(uint32_t));
+        uint8_t* out = packet->Append(sizeof(uint32_t));
+        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+            out[i] = static_cast<uint8_t>(header.id >> (8 * i));
+        }
+        if (PacketFactory::CreateUnreliableDataPacket(*packet, PacketType::Snapshot_Ack)) {
+            SendPacket(packet, /*retainPlaintext=*/false);
+        }
+    }
+
+    void Connection::HandleSnapshotAck(const uint8_t* payload, uint32_t payloadSize) {
+        if (payloadSize < sizeof(uint32_t)) {
+            RF_NETWORK_WARN_LIMITED("Snapshot ack too short ({} bytes)", payloadSize);
+            return;
+        }
+        uint32_t id = 0;
+        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+            id |= static_cast<uint32_t>(payload[i]) << (8 * i);
+        }
+        std::lock_guard<std::mutex> lock(m_snapshotSendMtx);
+        if (m_snapshotEncoder) {
+            m_snapshotEncoder->OnAck(id);
+        }
+    }
+
+    bool Connection::IsTimedOut(std::chrono::steady_clock::time_point now, std::chrono::milliseconds timeout) const {
         return UDPReliabilityProtocol::IsConnectionTimedOut(m_reliabilityState, now, timeout);
     }
 
+    std::chrono::steady_clock::time_point Connection::GetNextDeadline(std::chrono::milliseconds idleTimeout) {
+        // Disarm first: an ArmTimer racing the reads below then reports its deadline through the
+        // callback instead of skipping it behind a stale armed deadline that this call replaces.
+        constexpr auto disarmed = std::chrono::steady_clock::time_point::max().time_since_epoch().count();
+        m_armedDeadline.store(disarmed, std::memory_order_release);
+
+        auto next = UDPReliabilityProtocol::GetTimeoutDeadline(m_reliabilityState, idleTimeout);
+
+        const auto retransmit = UDPReliabilityProtocol::GetNextRetransmitTime(m_reliabilityState);
+        if (retransmit < next) next = retransmit;
+
+        const auto ack = UDPReliabilityProtocol::GetAckDeadline(m_reliabilityState);
+        if (ack < next) next = ack;
+
+        {
+            std::lock_guard<std::mutex> lock(m_coalesceMtx);
+            if (!m_coalescedReliable.empty() || !m_coalescedUnreliable.empty()) {
+                const auto flush = std::chrono::steady_clock::now() + COALESCE_FLUSH_DELAY;
+                if (flush < next) next = flush;
+            }
+        }
+
+        const auto queued = GetSendQueueDeadline(std::chrono::steady_clock::now());
+        if (queued < next) next = queued;
+
+        {
+            std::lock_guard<std::mutex> lock(m_fragmentMtx);
+            const auto expiry = m_reassembler.GetNextExpiry();
+            if (expiry < next) next = expiry;
+        }
+
+        if (IsSecure()) {
+            std::lock_guard<std::mutex> lock(m_mtuMtx);
+            if (m_mtuProber) {
+                const auto probe = m_mtuProber->GetNextProbeTime();
+                if (probe < next) next = probe;
+            }
+        }
+
+        // Publish unless an earlier deadline was armed meanwhile; that one has been reported already
+        auto armed = disarmed;
+        const auto ticks = next.time_since_epoch().count();
+        while (ticks < armed && !m_armedDeadline.compare_exchange_weak(armed, ticks, std::memory_order_acq_rel)) {
+        }
+        if (armed < ticks) {
+            next = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(armed));
+        }
+        return next;
+    }
+
+    void Connection::ArmTimer(std::chrono::steady_clock::time_point deadline) {
+        const auto ticks = deadline.time_since_epoch().count();
+        auto armed = m_armedDeadline.load(std::memory_order_acquire);
+        while (ticks < armed) {
+            if (m_armedDeadline.compare_exchange_weak(armed, ticks, std::memory_order_acq_rel)) {
+                if (m_timerCallback) {
+                    m_timerCallback(deadline);
+                }
+                return;
+            }
+        }
+    }
+
     bool Connection::IsSecure() const {
         return m_encryptor && m_encryptor->IsInitialized();
     }
 
-    const RiftNet::Networking::NetworkEndpoint& Connection::GetEndpoint() const {
+    RiftNet::Networking::NetworkEndpoint Connection::GetEndpoint() const {
+        std::lock_guard<std::mutex> lock(m_endpointMtx);
         return m_endpoint;
     }
 
+    CongestionStats Connection::GetCongestionStats() const {
+        return UDPReliabilityProtocol::GetCongestionStats(m_reliabilityState);
+    }
+
+    RiftNet::Metrics::ConnectionMetricsSnapshot Connection::GetMetrics() const {
+        return m_metrics.Snapshot(m_reliabilityState.rttSamples);
+    }
+
+    uint32_t Connection::GetUnackedCount() const {
+        return UDPReliabilityProtocol::GetSendWindowSize(m_reliabilityState);
+    }
+
+    size_t Connection::GetPendingSendBytes() const {
+        std::lock_guard<std::mutex> lock(m_pendingMtx);
+        return m_pendingSends.GetUsedBytes();
+    }
+
 } // namespace RiftNet::Protocol
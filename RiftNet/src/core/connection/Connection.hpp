@@ -1,10 +1,23 @@
 #pragma once
 
 #include "../../protocol/UDPReliabilityProtocol/UDPReliabilityProtocol.hpp"
+#include "../../protocol/ChannelSet/ChannelSet.hpp"
+#include "../../protocol/FragmentReassembler/FragmentReassembler.hpp"
+#include "../../protocol/PathMtuProber/PathMtuProber.hpp"
+#include "../../protocol/PendingSendQueue/PendingSendQueue.hpp"
+#include "../../protocol/SendScheduler/SendScheduler.hpp"
 #include "../networkio/NetworkEndpoint.hpp"
-#include "../../security/crypto/Encryptor.hpp"
-#include "../../compression/compressor/Compressor.hpp"
+#include "../buffer/PacketBuffer.hpp"
+#include "../../security/Crypto/Encryptor.hpp"
+#include "../../security/HandshakeCookie/HandshakeCookie.hpp"
+#include "../../security/ReplayWindow/ReplayWindow.hpp"
+#include "../../security/SessionTicket/SessionTicket.hpp"
+#include "../../compression/Compressor/Compressor.hpp"
+#include "../../compression/StreamCompressor/StreamCompressor.hpp"
+#include "../../compression/SnapshotDelta/SnapshotDelta.hpp"
+#include "../../../utilities/metrics/Metrics.hpp"
 
+#include <array>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -13,6 +26,7 @@
 #include <atomic>
 #include <mutex>
 #include <cstdint>
+#include <span>
 
 namespace RiftNet::Protocol {
 
@@ -23,62 +37,431 @@ namespace RiftNet::Protocol {
      */
     class Connection {
     public:
-        using SendCallback = std::function<void(const RiftNet::Networking::NetworkEndpoint&, const std::vector<uint8_t>&)>;
-        using AppDataCallback = std::function<void(const uint8_t*, uint32_t)>;
+        using SendCallback = std::function<void(const RiftNet::Networking::NetworkEndpoint&, const RiftNet::Networking::PacketBufferPtr&)>;
+        // data, size, channel id (DEFAULT_CHANNEL for data sent with SendApplicationData)
+        using AppDataCallback = std::function<void(const uint8_t*, uint32_t, uint8_t)>;
+        using TimerCallback = std::function<void(std::chrono::steady_clock::time_point)>;
 
         explicit Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer);
+        // keyExchange: a pre-generated local keypair (see KeyPool), or nullptr to generate one.
+        Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer,
+            std::unique_ptr<KeyExchangeX25519> keyExchange);
+
+        // Heap objects a ConnectionPool keeps from a finished connection for the next one.
+        struct RecycledParts {
+            std::unique_ptr<RiftNet::Security::Encryptor>     encryptor;  // cleared: no keys, no keypair
+            std::unique_ptr<RiftNet::Compression::Compressor> compressor;
+        };
+        // As above, reusing parts where given instead of allocating them.
+        Connection(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer,
+            std::unique_ptr<KeyExchangeX25519> keyExchange, RecycledParts parts);
+        ~Connection(); // wipes the resumption secret
+
+        /**
+         * @brief Takes the recyclable parts, wiping the session keys, e.g. as the connection is
+         * destroyed. The connection must not be used afterwards.
+         */
+        RecycledParts ReleaseParts();
 
         // --- Configuration ---
         void SetSendCallback(SendCallback cb);
         void SetAppDataCallback(AppDataCallback cb);
 
+        /**
+         * @brief Called with a deadline whenever Update() is needed earlier than last reported,
+         * e.g. when a reliable packet starts a retransmission timer or a coalescing batch opens.
+         */
+        void SetTimerCallback(TimerCallback cb);
+
+        /**
+         * @brief Offers ReliabilityHeaderFormat::Extended (32-bit sequences, 128-packet acks) in
+         * our HELLO. It is used only if the peer's HELLO offers it too; call before the handshake.
+         */
+        void SetExtendedAcks(bool offer);
+
+        /**
+         * @brief Configures the logical channels this side sends on; channel i has types[i].
+         * Receiving needs no configuration. Call before sending on a channel.
+         * @return False if more than MAX_CHANNELS are given.
+         */
+        bool SetChannels(const std::vector<ChannelType>& types);
+
+        /**
+         * @brief Installs a congestion controller (see CreateCongestionController), or removes it with nullptr.
+         * While one is installed, data packets wait in the send queue (see SendScheduler) for the pacer
+         * and reliable ones also for room in the congestion window; acks, handshake packets and
+         * retransmissions are not held.
+         */
+        void SetCongestionController(std::unique_ptr<ICongestionController> controller);
+
+        /**
+         * @brief Sets the range the retransmission timeout is kept in (100 ms to 3 s by default).
+         */
+        void SetRetransmitTimeoutBounds(std::chrono::milliseconds minRto, std::chrono::milliseconds maxRto);
+
+        /**
+         * @brief Caps the data payload bytes sent per tick (see SendBudget). While set, data packets
+         * wait in the send queue, most urgent first (see SendOptions), for the budget as well as any pacer.
+         * @param bytesPerTick 0 removes the cap.
+         */
+        void SetSendBudget(uint32_t bytesPerTick, std::chrono::milliseconds tick);
+
+        /**
+         * @brief Sets the largest datagram (UDP payload bytes) this side sends, clamped to
+         * [MIN_DATAGRAM_SIZE, MAX_DATAGRAM_SIZE]. Payloads that do not fit after compression are
+         * split into fragments and reassembled by the peer.
+         * @param probe Once secure, probe for larger sizes the path carries (see PathMtuProber)
+         *        and raise the size as probes are acknowledged.
+         */
+        void SetMaxDatagramSize(uint32_t bytes, bool probe);
+        uint32_t GetMaxDatagramSize() const;
+
+        /**
+         * @brief Configures payload compression; call before the handshake.
+         * @param dictionary Shared dictionary offered in our HELLO; compression uses it only if the
+         *        peer's HELLO offers one with the same id. nullptr for plain LZ4.
+         * @param threshold Payloads smaller than this are sent uncompressed; 0 for the default.
+         */
+        void SetCompression(std::shared_ptr<const RiftNet::Compression::CompressionDictionary> dictionary, uint32_t threshold);
+
+        /**
+         * @brief Compresses messages on ReliableOrdered channels against the earlier messages on the
+         * same channel (see StreamCompressor), so state that changes little between messages costs
+         * little. Messages larger than the window are compressed on their own.
+         * @param windowBytes History each channel keeps, clamped to [MIN_STREAM_WINDOW, MAX_STREAM_WINDOW]; 0 disables.
+         */
+        void SetStreamCompression(uint32_t windowBytes);
+
+        /**
+         * @brief Sizes the queue that holds sends made before the handshake completes and sets what
+         * a send does when it is full (see PendingOverflowPolicy); call before sending.
+         * @param capacityBytes 0 for DEFAULT_PENDING_SEND_CAPACITY.
+         */
+        void SetPendingSendLimit(uint32_t capacityBytes, PendingOverflowPolicy policy);
+
+        // --- Session resumption (see SessionTicketIssuer) ---
+        /**
+         * @brief Client: a ticket from an earlier session. The handshake then opens with a RESUME
+         * that also carries the default-channel messages queued so far, as far as they fit one
+         * datagram, sealed as 0-RTT data; the server delivers them on arrival if it redeems the
+         * ticket, and otherwise they are sent once the handshake completes. Call before sending.
+         */
+        void SetSessionTicket(RiftNet::Security::ResumptionTicket ticket);
+        // Client: the newest ticket the server issued, unless it has been presented since.
+        bool GetSessionTicket(RiftNet::Security::ResumptionTicket& outTicket) const;
+
+        // Server: the secret from the client's redeemed ticket; call before passing its RESUME in.
+        void SetResumptionSecret(const RiftNet::Security::KeyBuffer& secret);
+        // Server: hands the RESUME's accepted 0-RTT messages to the app. Call once the connection is announced.
+        void DeliverEarlyData();
+        // Server: sends the client a ticket for its next connect. Unreliable; a lost one just means a full handshake.
+        void SendSessionTicket(const RiftNet::Security::ResumptionTicket& ticket);
+
+        // --- Connection IDs (migration) ---
+        // Client: offers to prefix its datagrams with a server-assigned routing id; call before the handshake.
+        void SetConnectionMigration(bool offer);
+        /**
+         * @brief Server: the routing id to assign if the client offers connection IDs (see
+         * ConnectionTable::ReserveRoutingId); call before the handshake. 0 assigns none.
+         */
+        void SetRoutingId(uint32_t routingId);
+        // The routing id in use, or 0 if none was negotiated (or assigned, on a server).
+        uint32_t GetRoutingId() const;
+        /**
+         * @brief Server: a datagram carrying this connection's routing id from another endpoint.
+         * If it authenticates but arrived out of order, it is processed without moving. If it is
+         * newer than anything received so far, rebind(previous endpoint)
+         * is asked to move the connection to from (ConnectionTable::Rebind, which calls
+         * SetEndpoint), and the packet is processed only if it did.
+         * @return True if the connection moved.
+         */
+        bool ProcessMigratedPacket(const RiftNet::Networking::NetworkEndpoint& from, uint8_t* data, uint32_t size,
+            const std::function<bool(const RiftNet::Networking::NetworkEndpoint& previous)>& rebind);
+        // Where this connection sends from now on; ConnectionTable::Rebind keeps it in step with the table.
+        void SetEndpoint(const RiftNet::Networking::NetworkEndpoint& endpoint);
+
         // --- Handshake / Session setup ---
         void BeginHandshake();                         // safe to call multiple times
         bool InitializeSession(const byte_vec& remotePublicKey);
         const byte_vec& GetPublicKey() const;
 
         // --- Main Pipeline Methods ---
-        void ProcessIncomingRawPacket(const uint8_t* data, uint32_t size);
-        void SendApplicationData(const uint8_t* data, uint32_t size, bool isReliable);
-        void Update(std::chrono::steady_clock::time_point now);
+        void ProcessIncomingRawPacket(uint8_t* data, uint32_t size); // decrypts in place
+        // Returns false if the payload was not accepted (reliable send window full, or a send failure).
+        // Messages with options other than the default are not coalesced.
+        bool SendApplicationData(const uint8_t* data, uint32_t size, bool isReliable, const SendOptions& options = {});
+        /**
+         * @brief Sends one message on a configured channel. Channel messages are never coalesced.
+         * @return False if the channel is not configured, the reliable window is full, or the send failed.
+         */
+        bool SendChannelData(uint8_t channel, const uint8_t* data, uint32_t size, const SendOptions& options = {});
+
+        /**
+         * @brief Sends one snapshot of replicated state, unreliably, as a delta against the newest
+         * snapshot the peer acknowledged decoding (see SnapshotEncoder). The peer delivers the whole
+         * snapshot with channel SNAPSHOT_CHANNEL and drops any older than one it already delivered.
+         * Snapshots are not queued before the handshake completes: the next one supersedes them. In
+         * the send queue, likewise, a new snapshot supersedes one still waiting.
+         * @return False if not secure, size is 0 or above MAX_SNAPSHOT_SIZE, or the send failed.
+         */
+        bool SendSnapshot(const uint8_t* data, uint32_t size);
+
+        // --- Pre-compressed sends (one compression fanned out to many connections) ---
+        // True while SendCompressedApplicationData applies: secure, and not coalescing (batches compress as a whole).
+        bool CanSendCompressed() const;
+        // Whether this connection's frames are compressed against the shared dictionary (negotiated in the handshake).
+        bool UsesDictionaryCompression() const;
+        /**
+         * @brief SendApplicationData for a payload already compressed into a frame by a Compressor
+         * set up like this connection's (same dictionary use); only headers and encryption are added.
+         * @param rawSize Bytes of the payload before compression, for the compression counters.
+         * @return False if not CanSendCompressed(), the reliable window is full, or the send failed.
+         */
+        bool SendCompressedApplicationData(std::span<const uint8_t> frame, uint32_t rawSize, bool isReliable);
+
+        void Update(std::chrono::steady_clock::time_point now); // also flushes coalesced sends and due acks
+
+        // --- Send coalescing ---
+        /**
+         * @brief Enables packing several messages into one datagram.
+         * While enabled, secure sends are queued per reliability class and flushed as one
+         * Data_*_Coalesced packet when the next message would exceed budgetBytes, on Update,
+         * or on Flush. Messages that do not fit in an empty batch are sent on their own.
+         * @param budgetBytes Framed payload bytes per datagram (clamped to MAX_COALESCE_BUDGET, and on each
+         *        send to what fits the current datagram size); 0 disables.
+         */
+        void SetCoalescing(uint32_t budgetBytes);
+        void Flush();
 
         // --- State Queries ---
-        bool IsTimedOut(std::chrono::steady_clock::time_point now, std::chrono::seconds timeout) const;
+        bool IsTimedOut(std::chrono::steady_clock::time_point now, std::chrono::milliseconds timeout) const;
+
+        /**
+         * @brief Returns when Update() or the idle timeout next needs attention, and records it
+         * as the armed deadline so the timer callback only fires for earlier ones. A deadline armed
+         * while it runs is reported through the callback and kept if earlier, and is then returned.
+         */
+        std::chrono::steady_clock::time_point GetNextDeadline(std::chrono::milliseconds idleTimeout);
         bool IsSecure() const;
-        const RiftNet::Networking::NetworkEndpoint& GetEndpoint() const;
+        RiftNet::Networking::NetworkEndpoint GetEndpoint() const; // by value: migration can change it
+        CongestionStats GetCongestionStats() const;
+        // Traffic counters and RTT samples since the connection was created; lock-free.
+        RiftNet::Metrics::ConnectionMetricsSnapshot GetMetrics() const;
+        uint32_t GetUnackedCount() const;     // reliable packets sent and not yet acknowledged
+        size_t   GetPendingSendBytes() const; // queued until the handshake completes
 
     private:
         // --- Private Pipeline Methods ---
         void HandleDecryptedPacket(const uint8_t* data, uint32_t size);
-        void SendPacket(const std::vector<uint8_t>& packet_data);
+        // retainPlaintext: encrypt into a separate wire buffer so the packet can be re-sent (reliable path);
+        // otherwise the packet buffer is encrypted and sent in place.
+        void SendPacket(const RiftNet::Networking::PacketBufferPtr& packet, bool retainPlaintext);
+        // SendPacket for several packets, encrypted in batches with Encryptor::EncryptBatch.
+        void SendPackets(std::span<const RiftNet::Networking::PacketBufferPtr> packets, bool retainPlaintext);
+        // Hands a finished datagram to the send callback, counting it.
+        void SendDatagram(const RiftNet::Networking::NetworkEndpoint& endpoint, const RiftNet::Networking::PacketBufferPtr& datagram);
         bool MaybeHandleCleartextHandshake(const uint8_t* data, uint32_t size);
+        // Checks the routing id prefix (if any) and the nonce against the replay window, then decrypts
+        // a sealed datagram in place.
+        bool OpenSealedPacket(uint8_t* data, uint32_t size, uint64_t& outNonce, uint8_t*& outPlain, uint32_t& outPlainSize);
+        // Marks an authenticated nonce as received in the replay window.
+        RiftNet::Security::ReplayWindow::Result RecordRxNonce(uint64_t nonce);
+        // Client: seals the front default-channel pending messages for a RESUME. Caller holds m_pendingMtx.
+        std::vector<uint8_t> SealEarlyDataLocked(const RiftNet::Security::ResumptionTicket& ticket);
+        // Server: opens a RESUME's 0-RTT data into m_earlyData; false if it does not authenticate.
+        bool AcceptEarlyData(const byte_vec& peerPub, std::span<const uint8_t> sealed);
+        // Routing id prefix bytes on the datagrams this side sends and receives
+        uint32_t TxPrefixSize() const;
+        uint32_t RxPrefixSize() const;
+        // Capability flags for our HELLO or handshake response
+        uint8_t GetHelloCaps() const;
+        // Client: echoes the server's cookie back with our HELLO fields
+        void SendHandshakeResponse(const RiftNet::Security::Cookie& cookie);
+
+        // Compresses (with stream, if given), packetizes and sends one payload as a single datagram of
+        // the given type, with header (a ChannelHeader or SnapshotHeader, if any) in front of the compressed payload.
+        bool SendPayload(const uint8_t* data, uint32_t size, bool isReliable, PacketType type,
+            std::span<const uint8_t> header = {}, RiftNet::Compression::StreamCompressor* stream = nullptr,
+            const SendOptions& options = {});
+
+        // Sends a compressed payload buffer (channel header, if any, already in front) as one datagram or
+        // fragments, now or through the send queue.
+        bool SendFrame(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable,
+            const SendOptions& options = {});
+
+        // The channel's stream compressor, created on first use, or nullptr where messages of this
+        // size are compressed on their own. Caller holds m_channelSendMtx.
+        RiftNet::Compression::StreamCompressor* GetSendStream(uint8_t channel, ChannelType type, uint32_t size);
+
+        // Splits a packet body too large for one datagram into fragments and sends each; for
+        // reliable ones the whole message must fit the send window.
+        bool SendFragmented(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable,
+            const SendOptions& options);
+
+        // Packet body bytes (after the general and reliability headers) one datagram can carry.
+        uint32_t DatagramPayloadCapacity(bool isReliable) const;
+
+        // Stamps the headers onto a compressed payload buffer and sends it now.
+        bool PacketizeAndSend(const RiftNet::Networking::PacketBufferPtr& packet, PacketType type, bool isReliable);
+        // Same for several payloads of one type, sent as one batch; false if any could not be packetized.
+        bool PacketizeAndSend(std::span<const RiftNet::Networking::PacketBufferPtr> packets, PacketType type, bool isReliable);
 
-        // Flush any queued app payloads now that the channel is secure
+        // Checks the reliable send window, counting reliable packets still waiting in the send queue.
+        bool HasReliableWindowSpace(uint32_t slots = 1) const;
+
+        // Send queue: appends a message's compressed payload buffers (one, or its fragments) at the
+        // options' priority, then sends what the pacer, the budget and the window allow.
+        // messageType is the type before fragmenting, which scopes the latest-only key.
+        bool EnqueueSend(std::span<const RiftNet::Networking::PacketBufferPtr> packets, PacketType type, bool isReliable,
+            PacketType messageType, const SendOptions& options);
+        void DrainSendQueue(std::chrono::steady_clock::time_point now);
+        // When the next queued packet may go out, or time_point::max() if none or all wait on acks.
+        std::chrono::steady_clock::time_point GetSendQueueDeadline(std::chrono::steady_clock::time_point now);
+        // Caller holds m_pacingMtx
+        void UpdateQueueSendsLocked();
+
+        // Holds a payload until the channel is secure; false if the overflow policy rejected it.
+        bool QueuePendingSend(const uint8_t* data, uint32_t size, bool isReliable, uint8_t channel);
+
+        // Appends a message to its coalescing batch, flushing first if it would overflow.
+        bool CoalesceOrSend(const uint8_t* data, uint32_t size, bool isReliable, uint32_t budget);
+        bool CoalesceLocked(const uint8_t* data, uint32_t size, bool isReliable, uint32_t budget); // caller holds m_coalesceMtx
+        void FlushBatchLocked(bool isReliable); // caller holds m_coalesceMtx
+
+        // Parses the channel header (if any) of a packet body, decompresses it and hands it to the app.
+        void DeliverPayload(PacketType type, const uint8_t* body, uint32_t size);
+
+        // Adds a fragment's piece to reassembly and delivers the message it completes, if any.
+        void HandleFragment(PacketType type, const uint8_t* payload, uint32_t size);
+
+        // Splits a decompressed coalesced payload and delivers each message to the app.
+        void DeliverCoalesced(std::span<const uint8_t> payload);
+
+        // Decompresses a frame in place (stored) or into this thread's scratch arena.
+        bool DecompressPayload(std::span<const uint8_t> compressed, std::span<const uint8_t>& outPayload);
+
+        // Decompresses a message an ordered channel released and hands it to the app. Stream frames
+        // decode only here, in channel order. Caller holds m_channelRecvMtx.
+        void DeliverOrdered(const uint8_t* frame, uint32_t size, uint8_t channel);
+
+        // Snapshot replication: rebuilds a Data_Snapshot body, delivers it and acks it; and applies the peer's acks
+        void HandleSnapshot(const uint8_t* body, uint32_t size);
+        void HandleSnapshotAck(const uint8_t* payload, uint32_t payloadSize);
+
+        // Stream compression resync: asks the peer for a keyframe, and answers the peer's request
+        void SendStreamResetRequest(uint8_t channel);
+        void HandleStreamResetRequest(const uint8_t* payload, uint32_t payloadSize);
+
+        // Reports deadline through the timer callback if it is earlier than the armed one.
+        void ArmTimer(std::chrono::steady_clock::time_point deadline);
+
+        // Resends fast-retransmit and timed-out reliable packets
+        void SendRetransmissions(std::chrono::steady_clock::time_point now);
+
+        // Sends a standalone Heartbeat_Ack if its delayed-ack deadline has passed, else arms the timer
+        void SendAckIfDue(std::chrono::steady_clock::time_point now);
+
+        // Path MTU probing: sends a due probe and answers or applies the peer's
+        void SendMtuProbeIfDue(std::chrono::steady_clock::time_point now);
+        void HandleMtuProbe(const uint8_t* payload, uint32_t payloadSize, uint32_t packetSize);
+        void HandleMtuProbeAck(const uint8_t* payload, uint32_t payloadSize);
+
+        // Sends the pre-secure queue now that the channel is secure, coalescing its default-channel messages
         void FlushPendingSends();
 
         // --- Connection State ---
-        RiftNet::Networking::NetworkEndpoint m_endpoint;
+        mutable std::mutex                   m_endpointMtx;
+        RiftNet::Networking::NetworkEndpoint m_endpoint; // under m_endpointMtx; changes when a server connection migrates
         ReliableConnectionState m_reliabilityState;
         std::unique_ptr<RiftNet::Security::Encryptor>     m_encryptor;
         std::unique_ptr<RiftNet::Compression::Compressor> m_compressor;
 
         // Nonce counters for encryption (Client even, Server odd)
         std::atomic<uint64_t> m_txNonce{ 0 };
-        std::atomic<uint64_t> m_rxNonce{ 0 }; // last seen rx (diagnostic)
+        RiftNet::Security::ReplayWindow m_rxWindow; // authenticated rx nonces, by counter (nonce / 2)
+
+        RiftNet::Metrics::ConnectionMetrics m_metrics;
 
         // Cleartext handshake state
+        bool              m_isServer;
         std::atomic<bool> m_handshakeStarted{ false };
+        std::atomic<bool> m_sessionStarting{ false }; // a peer HELLO is being turned into session keys
+        std::atomic<bool> m_offerExtendedAcks{ false };
+        uint32_t          m_dictionaryId{ 0 }; // 0 = no dictionary offered
+
+        // Connection IDs: the client prefixes m_routingId to its sealed datagrams once m_routingActive
+        std::atomic<bool> m_offerConnectionId{ false };
+        std::atomic<bool> m_routingActive{ false };
+        uint32_t          m_routingId{ 0 }; // server: assigned before the handshake; client: set before m_routingActive
+
+        // --- Session resumption ---
+        mutable std::mutex                 m_ticketMtx;
+        RiftNet::Security::ResumptionTicket m_sessionTicket;  // client: the ticket to present, then the newest issued
+        uint64_t                           m_earlyDataEnd{ 0 }; // client: pending messages below this went as 0-RTT data, under m_pendingMtx
+        bool                               m_sentEarlyData{ false }; // client, under m_pendingMtx
+        bool                               m_hasResumptionSecret{ false }; // server, before and during the handshake only
+        RiftNet::Security::KeyBuffer       m_resumptionSecret{};
+        bool                               m_earlyDataAccepted{ false };
+        std::vector<uint8_t>               m_earlyData; // server: framed like a coalesced payload, until DeliverEarlyData
 
         // --- Callbacks ---
         SendCallback    m_sendCallback;
         AppDataCallback m_appDataCallback;
+        TimerCallback   m_timerCallback;
+
+        // Earliest deadline already reported via m_timerCallback (steady_clock ticks)
+        std::atomic<std::chrono::steady_clock::rep> m_armedDeadline{
+            std::chrono::steady_clock::time_point::max().time_since_epoch().count() };
 
         // --- Pre-secure send queue ---
-        struct PendingSend { std::vector<uint8_t> data; bool reliable; };
-        std::mutex              m_pendingMtx;
-        std::deque<PendingSend> m_pendingSends;
-        size_t                  m_pendingBytes{ 0 };
-        static constexpr size_t kMaxPendingBytes = 512 * 1024; // backpressure
+        mutable std::mutex m_pendingMtx;
+        PendingSendQueue   m_pendingSends;
+        bool               m_pendingOverflowWarned{ false }; // one warning per handshake, under m_pendingMtx
+
+        // --- Coalescing batches: framed [u16 len][bytes] messages awaiting flush ---
+        std::atomic<uint32_t> m_coalesceBudget{ 0 }; // 0 = one datagram per send
+        std::mutex            m_coalesceMtx;
+        std::vector<uint8_t>  m_coalescedReliable;
+        std::vector<uint8_t>  m_coalescedUnreliable;
+
+        // --- Send queue: compressed payloads waiting for the pacer, the send budget or the congestion window ---
+        std::atomic<bool>       m_queueSends{ false }; // a congestion controller or a send budget is set
+        std::mutex              m_pacingMtx;
+        bool                    m_pacingEnabled{ false }; // under m_pacingMtx
+        SendScheduler           m_sendQueue;
+        Pacer                   m_pacer;
+        SendBudget              m_sendBudget;
+        std::atomic<uint32_t>   m_queuedReliable{ 0 }; // each holds a reliable window slot in reserve
+        static constexpr size_t kMaxQueuedUnreliableBytes = 256 * 1024;
+
+        // --- Logical channels: send numbering and receive reordering are locked separately ---
+        ChannelSet m_channels;
+        std::mutex m_channelSendMtx;
+        std::mutex m_channelRecvMtx;
+
+        // --- Stream compression of ordered channels: encoders under m_channelSendMtx, decoders under
+        // m_channelRecvMtx, each direction within kMaxStreamMemory of history ---
+        std::atomic<uint32_t> m_streamWindow{ 0 }; // 0 = off
+        std::array<std::unique_ptr<RiftNet::Compression::StreamCompressor>, MAX_CHANNELS>   m_streamEncoders;
+        std::array<std::unique_ptr<RiftNet::Compression::StreamDecompressor>, MAX_CHANNELS> m_streamDecoders;
+        size_t m_streamSendBytes{ 0 };
+        size_t m_streamRecvBytes{ 0 };
+        static constexpr size_t kMaxStreamMemory = 256 * 1024;
+
+        // --- Snapshot replication: each direction's history, created on first use ---
+        std::mutex m_snapshotSendMtx;
+        std::unique_ptr<RiftNet::Compression::SnapshotEncoder> m_snapshotEncoder;
+        std::vector<uint8_t> m_snapshotDelta; // encode buffer, under m_snapshotSendMtx
+        std::mutex m_snapshotRecvMtx;
+        std::unique_ptr<RiftNet::Compression::SnapshotDecoder> m_snapshotDecoder;
+
+        // --- Fragmentation and path MTU ---
+        std::atomic<uint32_t> m_maxDatagramSize{ DEFAULT_MAX_DATAGRAM_SIZE };
+        std::atomic<uint16_t> m_nextFragmentId{ 0 };
+        std::mutex            m_fragmentMtx;
+        FragmentReassembler   m_reassembler;
+        std::mutex            m_mtuMtx;
+        std::unique_ptr<PathMtuProber> m_mtuProber; // null when not probing
     };
 
 } // namespace RiftNet::Protocol
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "ConnectionPool.hpp"
+
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <sodium.h>
+
+#include <algorithm> // For std::max
+
+namespace RiftNet::Protocol {
+
+    ConnectionPool::ConnectionPool(size_t slabSize)
+        : m_state(std::make_shared<State>((std::max)(slabSize, size_t{ 1 }))) {
+    }
+
+    std::shared_ptr<Connection> ConnectionPool::Acquire(const RiftNet::Networking::NetworkEndpoint& endpoint,
+        bool isServer, std::unique_ptr<KeyExchangeX25519> keyExchange) {
+        return std::allocate_shared<Connection>(Allocator<Connection>(m_state), endpoint, isServer,
+            std::move(keyExchange), m_state->TakeParts());
+    }
+
+    size_t ConnectionPool::GetCapacity() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->slabs.size() * m_state->slabSize;
+    }
+
+    size_t ConnectionPool::GetFreeCount() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->freeBlocks.size();
+    }
+
+    ConnectionPool::State::~State() {
+        for (std::byte* slab : slabs) {
+            ::operator delete(slab, std::align_val_t(blockAlignment));
+        }
+    }
+
+    void* ConnectionPool::State::Allocate(size_t size, size_t alignment) {
+        // Blocks are rounded up to their alignment so every block in a slab is aligned too
+        const size_t rounded = (size + alignment - 1) & ~(alignment - 1);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (blockSize == 0) {
+            blockSize = rounded;
+            blockAlignment = alignment;
+        }
+        if (rounded != blockSize || alignment != blockAlignment) {
+            return ::operator new(size, std::align_val_t(alignment)); // not a connection block
+        }
+
+        if (freeBlocks.empty()) {
+            auto* slab = static_cast<std::byte*>(::operator new(slabSize * blockSize, std::align_val_t(blockAlignment)));
+            slabs.push_back(slab);
+            for (size_t i = slabSize; i-- > 0;) {
+                freeBlocks.push_back(slab + i * blockSize); // handed out first block first
+            }
+            RF_NETWORK_DEBUG("ConnectionPool: slab {} ({} connections of {} bytes)", slabs.size(), slabSize, blockSize);
+        }
+        void* block = freeBlocks.back();
+        freeBlocks.pop_back();
+        return block;
+    }
+
+    void ConnectionPool::State::Deallocate(void* block, size_t size, size_t alignment) {
+        // The destroyed connection may have left key material or traffic in its block
+        sodium_memzero(block, size);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::byte* p = static_cast<const std::byte*>(block);
+        for (const std::byte* slab : slabs) {
+            if (p >= slab && p < slab + slabSize * blockSize) {
+                freeBlocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block, std::align_val_t(alignment));
+    }
+
+    Connection::RecycledParts ConnectionPool::State::TakeParts() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (parts.empty()) {
+            return {};
+        }
+        Connection::RecycledParts taken = std::move(parts.back());
+        parts.pop_back();
+        return taken;
+    }
+
+    void ConnectionPool::State::Recycle(Connection::RecycledParts released) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Never more parts than connections the slabs can hold; extras are freed
+        if (parts.size() < slabs.size() * slabSize) {
+            parts.push_back(std::move(released));
+        }
+    }
+
+} // namespace RiftNet::Protocol
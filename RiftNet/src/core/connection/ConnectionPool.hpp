@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Connection.hpp"
+#include "../networkio/NetworkEndpoint.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace RiftNet::Protocol {
+
+    // Connections per slab a ConnectionPool allocates at once.
+    constexpr size_t DEFAULT_CONNECTION_SLAB_SIZE = 64;
+
+    /**
+     * @class ConnectionPool
+     * @brief Recycles connections for servers that accept and drop many of them. Each connection
+     * and its shared_ptr control block live in one block of a slab, so accepting a connection takes
+     * a block off a free list instead of allocating, and connections sit side by side in memory.
+     * When the last ConnectionPtr to a connection goes, its Encryptor (session keys wiped) and
+     * Compressor are kept for the next connection and its block is zeroed before reuse. Slabs are
+     * kept for the pool's lifetime, and for as long as any connection from it is alive. Thread-safe.
+     */
+    class ConnectionPool {
+    public:
+        explicit ConnectionPool(size_t slabSize = DEFAULT_CONNECTION_SLAB_SIZE);
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        // Constructs a connection as Connection(endpoint, isServer, keyExchange) would.
+        std::shared_ptr<Connection> Acquire(const RiftNet::Networking::NetworkEndpoint& endpoint, bool isServer,
+            std::unique_ptr<KeyExchangeX25519> keyExchange);
+
+        size_t GetCapacity() const;  // blocks in all slabs
+        size_t GetFreeCount() const; // blocks not holding a connection
+
+    private:
+        struct State {
+            explicit State(size_t slabSize) : slabSize(slabSize) {}
+            ~State();
+
+            void* Allocate(size_t size, size_t alignment);
+            void Deallocate(void* block, size_t size, size_t alignment);
+            Connection::RecycledParts TakeParts();
+            void Recycle(Connection::RecycledParts parts);
+
+            mutable std::mutex mutex;
+            const size_t slabSize;
+            // Set by the first allocation: all of them are one control block type
+            size_t blockSize{ 0 };
+            size_t blockAlignment{ 0 };
+            std::vector<std::byte*> slabs;
+            std::vector<void*> freeBlocks;
+            std::vector<Connection::RecycledParts> parts;
+        };
+
+        // Hands allocate_shared pool blocks, and takes a connection's parts back as it is destroyed.
+        template <typename T>
+        class Allocator {
+        public:
+            using value_type = T;
+
+            explicit Allocator(std::shared_ptr<State> state) : m_state(std::move(state)) {}
+            template <typename U>
+            Allocator(const Allocator<U>& other) : m_state(other.m_state) {}
+
+            T* allocate(size_t n) {
+                return static_cast<T*>(m_state->Allocate(n * sizeof(T), alignof(T)));
+            }
+            void deallocate(T* p, size_t n) {
+                m_state->Deallocate(p, n * sizeof(T), alignof(T));
+            }
+
+            template <typename U>
+            void destroy(U* p) {
+                if constexpr (std::is_same_v<U, Connection>) {
+                    m_state->Recycle(p->ReleaseParts());
+                }
+                p->~U();
+            }
+
+            template <typename U>
+            bool operator==(const Allocator<U>& other) const { return m_state == other.m_state; }
+
+        private:
+            template <typename U> friend class Allocator;
+            std::shared_ptr<State> m_state; // keeps the slabs alive while connections from them are
+        };
+
+        std::shared_ptr<State> m_state;
+    };
+
+} // namespace RiftNet::Protocol
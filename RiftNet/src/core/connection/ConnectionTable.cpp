@@ -0,0 +1,159 @@
+#include "pch.h"
+#include "ConnectionTable.hpp"
+
+#include <random>
+
+namespace RiftNet::Protocol {
+
+    namespace {
+        // 'R','F','N','T' read as a little-endian u32
+        constexpr uint32_t HANDSHAKE_MAGIC_LE = 0x544E4652u;
+
+        uint32_t RandomRoutingId() {
+            thread_local std::mt19937 generator{ std::random_device{}() };
+            return static_cast<uint32_t>(generator());
+        }
+    }
+
+    ConnectionPtr ConnectionTable::FindById(ConnectionId id) const {
+        const IdShard& shard = m_idShards[IdShardIndex(id)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.connections.find(id);
+        return (it != shard.connections.end()) ? it->second : nullptr;
+    }
+
+    ConnectionPtr ConnectionTable::FindByEndpoint(const RiftNet::Networking::NetworkEndpoint& endpoint) const {
+        const EndpointShard& shard = m_endpointShards[EndpointShardIndex(endpoint)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.connections.find(endpoint);
+        return (it != shard.connections.end()) ? it->second.connection : nullptr;
+    }
+
+    ConnectionPtr ConnectionTable::FindByRoutingId(uint32_t routingId, ConnectionId& outId) const {
+        {
+            const RoutingShard& shard = m_routingShards[routingId & (kShardCount - 1)];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.ids.find(routingId);
+            if (it == shard.ids.end()) {
+                return nullptr;
+            }
+            outId = it->second;
+        }
+        return FindById(outId);
+    }
+
+    uint32_t ConnectionTable::ReserveRoutingId(ConnectionId id) {
+        for (;;) {
+            const uint32_t routingId = RandomRoutingId();
+            if (routingId == 0 || routingId == HANDSHAKE_MAGIC_LE) continue;
+
+            RoutingShard& shard = m_routingShards[routingId & (kShardCount - 1)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (shard.ids.emplace(routingId, id).second) {
+                return routingId;
+            }
+        }
+    }
+
+    bool ConnectionTable::Rebind(ConnectionId id, const RiftNet::Networking::NetworkEndpoint& from,
+        const RiftNet::Networking::NetworkEndpoint& to) {
+        ConnectionPtr connection = FindById(id);
+        if (!connection) {
+            return false;
+        }
+
+        {
+            // Both entries change together, and a second migration of the same connection waits
+            // here until it can see this one; shards are locked in index order
+            const size_t fromIndex = EndpointShardIndex(from);
+            const size_t toIndex = EndpointShardIndex(to);
+            EndpointShard& fromShard = m_endpointShards[fromIndex];
+            EndpointShard& toShard = m_endpointShards[toIndex];
+            std::unique_lock<std::shared_mutex> firstLock(fromIndex <= toIndex ? fromShard.mutex : toShard.mutex);
+            std::unique_lock<std::shared_mutex> secondLock;
+            if (fromIndex != toIndex) {
+                secondLock = std::unique_lock<std::shared_mutex>(fromIndex < toIndex ? toShard.mutex : fromShard.mutex);
+            }
+
+            auto previous = fromShard.connections.find(from);
+            if (previous == fromShard.connections.end() || previous->second.id != id) {
+                return false; // moved or removed since the caller read its endpoint
+            }
+            if (!toShard.connections.emplace(to, EndpointEntry{ id, connection }).second) {
+                return false;
+            }
+            fromShard.connections.erase(previous);
+            connection->SetEndpoint(to);
+        }
+
+        // A Remove that ran meanwhile may have missed the new entry; one that runs later sees `to`
+        if (!FindById(id)) {
+            EndpointShard& shard = m_endpointShards[EndpointShardIndex(to)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.connections.find(to);
+            if (it != shard.connections.end() && it->second.id == id) {
+                shard.connections.erase(it);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    ConnectionPtr ConnectionTable::Remove(ConnectionId id) {
+        ConnectionPtr connection;
+        {
+            IdShard& shard = m_idShards[IdShardIndex(id)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.connections.find(id);
+            if (it == shard.connections.end()) {
+                return nullptr;
+            }
+            connection = std::move(it->second);
+            shard.connections.erase(it);
+        }
+
+        const RiftNet::Networking::NetworkEndpoint endpoint = connection->GetEndpoint();
+        EndpointShard& shard = m_endpointShards[EndpointShardIndex(endpoint)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.connections.find(endpoint);
+        if (it != shard.connections.end() && it->second.id == id) {
+            shard.connections.erase(it);
+        }
+        lock.unlock();
+
+        if (const uint32_t routingId = connection->GetRoutingId(); routingId != 0) {
+            RoutingShard& routingShard = m_routingShards[routingId & (kShardCount - 1)];
+            std::unique_lock<std::shared_mutex> routingLock(routingShard.mutex);
+            auto routed = routingShard.ids.find(routingId);
+            if (routed != routingShard.ids.end() && routed->second == id) {
+                routingShard.ids.erase(routed);
+            }
+        }
+        return connection;
+    }
+
+    void ConnectionTable::Clear() {
+        for (EndpointShard& shard : m_endpointShards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.connections.clear();
+        }
+        for (IdShard& shard : m_idShards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.connections.clear();
+        }
+        for (RoutingShard& shard : m_routingShards) {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.ids.clear();
+        }
+    }
+
+    size_t ConnectionTable::Size() const {
+        size_t total = 0;
+        for (const IdShard& shard : m_idShards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            total += shard.connections.size();
+        }
+        return total;
+    }
+
+} // namespace RiftNet::Protocol
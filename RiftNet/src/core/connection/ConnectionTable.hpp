@@ -0,0 +1,178 @@
+#pragma once
+
+#include "Connection.hpp"
+#include "../networkio/NetworkEndpoint.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace RiftNet::Protocol {
+
+    using ConnectionId = uint64_t;
+    using ConnectionPtr = std::shared_ptr<Connection>;
+
+    /**
+     * @class ConnectionTable
+     * @brief A sharded, read-mostly map of live connections, indexed by id, by remote endpoint and,
+     * for connections that negotiated connection IDs, by routing id. Each shard has its own
+     * shared_mutex, so lookups of existing connections only take a shared lock on one shard and
+     * never contend with lookups elsewhere. Inserts take the endpoint shard exclusively first and
+     * then the id or routing shard; nothing else nests shard locks, so there is no cycle.
+     */
+    class ConnectionTable {
+    public:
+        static constexpr size_t kShardBits = 6;
+        static constexpr size_t kShardCount = size_t{ 1 } << kShardBits;
+
+        ConnectionTable() = default;
+        ConnectionTable(const ConnectionTable&) = delete;
+        ConnectionTable& operator=(const ConnectionTable&) = delete;
+
+        ConnectionPtr FindById(ConnectionId id) const;
+        ConnectionPtr FindByEndpoint(const RiftNet::Networking::NetworkEndpoint& endpoint) const;
+        ConnectionPtr FindByRoutingId(uint32_t routingId, ConnectionId& outId) const;
+
+        /**
+         * @brief Picks a random routing id no other connection holds and maps it to id. Never 0, and
+         * never one whose little-endian bytes spell the handshake magic, so a routed datagram cannot
+         * pass for a cleartext handshake frame. Connections pass it to Connection::SetRoutingId.
+         */
+        uint32_t ReserveRoutingId(ConnectionId id);
+
+        /**
+         * @brief Moves a migrating connection (see Connection::ProcessMigratedPacket) from `from` to
+         * `to`: its endpoint entry and, with it, the connection's own endpoint.
+         * @return False, changing nothing, if the connection is gone, no longer at from, or
+         * another connection already holds to.
+         */
+        bool Rebind(ConnectionId id, const RiftNet::Networking::NetworkEndpoint& from,
+            const RiftNet::Networking::NetworkEndpoint& to);
+
+        /**
+         * @brief Returns the connection for endpoint, creating it with create(id) if there is none.
+         * The fast path is a shared-lock lookup; create runs under the endpoint shard's exclusive lock,
+         * so it must not touch the table other than through ReserveRoutingId.
+         * @param outCreated Set to true if this call inserted a new connection.
+         */
+        template <typename Factory>
+        ConnectionPtr FindOrCreate(const RiftNet::Networking::NetworkEndpoint& endpoint,
+            Factory&& create, ConnectionId& outId, bool& outCreated);
+
+        /**
+         * @brief Removes a connection by id.
+         * @return The removed connection, or nullptr if the id was unknown.
+         */
+        ConnectionPtr Remove(ConnectionId id);
+
+        /**
+         * @brief Calls fn(id, connection) for every connection, one shard at a time. Each shard's
+         * connections are copied out under its shared lock and fn runs after it is released, so
+         * fn may block or change the table; a connection added or removed meanwhile may be missed
+         * or still visited.
+         */
+        template <typename Fn>
+        void ForEach(Fn&& fn) const;
+
+        void Clear();
+        size_t Size() const;
+
+    private:
+        struct IdShard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<ConnectionId, ConnectionPtr> connections;
+        };
+
+        struct EndpointEntry {
+            ConnectionId id;
+            ConnectionPtr connection;
+        };
+
+        struct EndpointShard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<RiftNet::Networking::NetworkEndpoint, EndpointEntry> connections;
+        };
+
+        struct RoutingShard {
+            mutable std::shared_mutex mutex;
+            std::unordered_map<uint32_t, ConnectionId> ids;
+        };
+
+        static size_t IdShardIndex(ConnectionId id) noexcept {
+            return static_cast<size_t>(id) & (kShardCount - 1);
+        }
+
+        // Picks the shard from the high bits of a mixed hash so the per-shard maps still see
+        // well-distributed low bits.
+        static size_t EndpointShardIndex(const RiftNet::Networking::NetworkEndpoint& endpoint) noexcept {
+            const uint64_t h = static_cast<uint64_t>(std::hash<RiftNet::Networking::NetworkEndpoint>()(endpoint));
+            return static_cast<size_t>((h * 0x9E3779B97F4A7C15ull) >> (64 - kShardBits));
+        }
+
+        std::array<IdShard, kShardCount> m_idShards;
+        std::array<EndpointShard, kShardCount> m_endpointShards;
+        std::array<RoutingShard, kShardCount> m_routingShards; // routing ids are random, so the low bits pick the shard
+        std::atomic<ConnectionId> m_nextId{ 1 };
+    };
+
+    template <typename Factory>
+    ConnectionPtr ConnectionTable::FindOrCreate(const RiftNet::Networking::NetworkEndpoint& endpoint,
+        Factory&& create, ConnectionId& outId, bool& outCreated)
+    {
+        outCreated = false;
+        EndpointShard& shard = m_endpointShards[EndpointShardIndex(endpoint)];
+
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            if (auto it = shard.connections.find(endpoint); it != shard.connections.end()) {
+                outId = it->second.id;
+                return it->second.connection;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        if (auto it = shard.connections.find(endpoint); it != shard.connections.end()) {
+            outId = it->second.id; // Another thread created it between the two locks.
+            return it->second.connection;
+        }
+
+        const ConnectionId id = m_nextId.fetch_add(1, std::memory_order_relaxed);
+        ConnectionPtr connection = create(id);
+        if (!connection) {
+            return nullptr;
+        }
+
+        {
+            IdShard& idShard = m_idShards[IdShardIndex(id)];
+            std::unique_lock<std::shared_mutex> idLock(idShard.mutex);
+            idShard.connections.emplace(id, connection);
+        }
+        shard.connections.emplace(endpoint, EndpointEntry{ id, connection });
+
+        outId = id;
+        outCreated = true;
+        return connection;
+    }
+
+    template <typename Fn>
+    void ConnectionTable::ForEach(Fn&& fn) const {
+        std::vector<std::pair<ConnectionId, ConnectionPtr>> snapshot;
+        for (const IdShard& shard : m_idShards) {
+            {
+                std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                snapshot.assign(shard.connections.begin(), shard.connections.end());
+            }
+            for (const auto& [id, connection] : snapshot) {
+                fn(id, connection);
+            }
+            snapshot.clear();
+        }
+    }
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,598 @@
+#include "pch.h"
+#include "EpollSocketIO.hpp"
+
+#if defined(__linux__)
+
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <netinet/udp.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// Older libc headers lack the UDP offload options (Linux 4.18 / 5.0).
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+using namespace RiftNet::Logging;
+
+namespace RiftNet::Networking {
+
+    namespace {
+        constexpr uint32_t RECEIVE_BATCH = 32;
+        constexpr uint32_t GRO_SLOT_SIZE = 65536; // a GRO buffer can hold up to 64 KB of coalesced datagrams
+        constexpr uint32_t SEND_BATCH_MAX = 64;
+        constexpr uint32_t GSO_MAX_SEGMENTS = 64; // UDP_MAX_SEGMENTS
+        constexpr uint32_t GSO_MAX_BYTES = 65000; // below the 64 KB IP datagram limit with headers
+        constexpr int EPOLL_WAIT_TIMEOUT_MS = 100;
+        constexpr int SOCKET_BUFFER_BYTES = 4 * 1024 * 1024; // default; capped by net.core.rmem_max / wmem_max
+
+        // cmsg space for one UDP_SEGMENT (uint16_t) or UDP_GRO (int) value
+        struct ControlBuffer {
+            alignas(cmsghdr) char data[CMSG_SPACE(sizeof(int))];
+        };
+
+        // The worker thread running on this thread, so its sends use its own socket.
+        struct WorkerSocket {
+            const EpollSocketIO* owner = nullptr;
+            int socket = -1;
+        };
+        thread_local WorkerSocket t_workerSocket;
+
+        bool IsBufferFull(int error) {
+            return error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS;
+        }
+
+        // IPv4 peers of an IPv6 socket are written as v4-mapped addresses (::ffff:a.b.c.d)
+        socklen_t ToNative(const NetworkEndpoint& endpoint, int family, sockaddr_storage& out) {
+            std::memset(&out, 0, sizeof(out));
+            if (family == AF_INET6) {
+                sockaddr_in6 addr = endpoint.ToSockAddr6();
+                if (!endpoint.IsIPv6()) {
+                    std::memset(&addr.sin6_addr, 0, sizeof(addr.sin6_addr));
+                    addr.sin6_addr.s6_addr[10] = 0xFF;
+                    addr.sin6_addr.s6_addr[11] = 0xFF;
+                    std::memcpy(&addr.sin6_addr.s6_addr[12], endpoint.address, 4);
+                }
+                std::memcpy(&out, &addr, sizeof(addr));
+                return sizeof(addr);
+            }
+            const sockaddr_in addr = endpoint.ToSockAddr();
+            std::memcpy(&out, &addr, sizeof(addr));
+            return sizeof(addr);
+        }
+
+        NetworkEndpoint FromNative(const sockaddr_storage& in) {
+            if (in.ss_family == AF_INET6) {
+                sockaddr_in6 addr;
+                std::memcpy(&addr, &in, sizeof(addr));
+                if (IN6_IS_ADDR_V4MAPPED(&addr.sin6_addr)) {
+                    sockaddr_in v4{};
+                    v4.sin_family = AF_INET;
+                    v4.sin_port = addr.sin6_port;
+                    std::memcpy(&v4.sin_addr, &addr.sin6_addr.s6_addr[12], 4);
+                    return NetworkEndpoint(v4);
+                }
+                return NetworkEndpoint(addr);
+            }
+            sockaddr_in addr;
+            std::memcpy(&addr, &in, sizeof(addr));
+            return NetworkEndpoint(addr);
+        }
+    }
+
+    struct EpollSocketIO::ReceiveSlots {
+        explicit ReceiveSlots(uint32_t size)
+            : slotSize(size)
+            , storage(static_cast<size_t>(RECEIVE_BATCH) * size) {
+        }
+
+        uint32_t slotSize;
+        std::vector<uint8_t> storage;
+        std::array<mmsghdr, RECEIVE_BATCH> messages{};
+        std::array<iovec, RECEIVE_BATCH> iovecs{};
+        std::array<sockaddr_storage, RECEIVE_BATCH> addresses{};
+        std::array<ControlBuffer, RECEIVE_BATCH> controls{};
+    };
+
+    struct EpollSocketIO::SendBatch {
+        struct Entry {
+            NetworkEndpoint recipient;
+            PacketBufferPtr buffer; // zero-copy sends; else the bytes are at `offset` in `bytes`
+            size_t offset = 0;
+            uint32_t size = 0;
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+
+        // A sendmmsg message covers entries [first, first + count); count > 1 is a GSO send.
+        struct Message {
+            uint32_t first = 0;
+            uint32_t count = 0;
+        };
+
+        const EpollSocketIO* owner = nullptr;
+        uint32_t depth = 0;
+        std::vector<Entry> entries;
+        std::vector<uint8_t> bytes;
+        std::vector<Message> runs;
+        std::vector<mmsghdr> messages;
+        std::vector<iovec> iovecs;
+        std::vector<sockaddr_storage> addresses;
+        std::vector<ControlBuffer> controls;
+    };
+
+    EpollSocketIO::SendBatch& EpollSocketIO::ThreadBatch() {
+        thread_local SendBatch batch;
+        return batch;
+    }
+
+    EpollSocketIO::EpollSocketIO(Threading::ThreadConfig threads, SocketTuning tuning)
+        : m_threadConfig(std::move(threads)), m_tuning(tuning) {
+    }
+
+    EpollSocketIO::~EpollSocketIO() {
+        Stop();
+        CloseSockets();
+    }
+
+    int EpollSocketIO::OpenSocket(const std::string& listenIp, uint16_t port, bool reusePort) {
+        const int fd = socket(m_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+        if (fd < 0) {
+            RF_NETWORK_CRITICAL("Failed to create UDP socket. Error: {}", std::strerror(errno));
+            return -1;
+        }
+
+        const int on = 1;
+        if (reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+            RF_NETWORK_CRITICAL("Failed to set SO_REUSEPORT. Error: {}", std::strerror(errno));
+            close(fd);
+            return -1;
+        }
+
+        const int receiveBytes = m_tuning.socketReceiveBuffer ? static_cast<int>(m_tuning.socketReceiveBuffer) : SOCKET_BUFFER_BYTES;
+        const int sendBytes = m_tuning.socketSendBuffer ? static_cast<int>(m_tuning.socketSendBuffer) : SOCKET_BUFFER_BYTES;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBytes, sizeof(receiveBytes));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBytes, sizeof(sendBytes));
+
+        // Oversized datagrams are dropped rather than IP-fragmented, so path MTU probes mean something
+        if (m_family == AF_INET6) {
+            const int off = 0;
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+            const int pmtu = IPV6_PMTUDISC_DO;
+            if (setsockopt(fd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &pmtu, sizeof(pmtu)) != 0) {
+                RF_NETWORK_WARN("Failed to set IPV6_MTU_DISCOVER. Error: {}", std::strerror(errno));
+            }
+        }
+        else {
+            const int pmtu = IP_PMTUDISC_DO;
+            if (setsockopt(fd, IPPROTO_IP, IP_MTU_DISCOVER, &pmtu, sizeof(pmtu)) != 0) {
+                RF_NETWORK_WARN("Failed to set IP_MTU_DISCOVER. Error: {}", std::strerror(errno));
+            }
+        }
+
+        sockaddr_storage local;
+        const socklen_t localLength = ToNative(NetworkEndpoint(listenIp, port), m_family, local);
+        if (bind(fd, reinterpret_cast<const sockaddr*>(&local), localLength) != 0) {
+            RF_NETWORK_CRITICAL("Failed to bind socket to port {}. Error: {}", port, std::strerror(errno));
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool EpollSocketIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+        m_eventHandler = eventHandler;
+        if (!m_eventHandler) {
+            RF_NETWORK_CRITICAL("EpollSocketIO cannot be initialized with a null event handler.");
+            return false;
+        }
+
+        const uint32_t socketCount = m_threadConfig.ResolveThreadCount();
+        m_family = NetworkEndpoint(listenIp, listenPort).IsIPv6() ? AF_INET6 : AF_INET;
+        RF_NETWORK_INFO("Initializing EpollSocketIO on {}:{} with {} sockets", listenIp, listenPort, socketCount);
+
+        m_workers = std::vector<Worker>(socketCount);
+        uint16_t port = listenPort;
+        for (uint32_t i = 0; i < socketCount; ++i) {
+            Worker& worker = m_workers[i];
+            worker.socket = OpenSocket(listenIp, port, socketCount > 1);
+            if (worker.socket < 0) {
+                CloseSockets();
+                return false;
+            }
+
+            // With port 0 the first bind picks the port; the others join it
+            if (i == 0 && port == 0) {
+                sockaddr_storage bound{};
+                socklen_t length = sizeof(bound);
+                if (getsockname(worker.socket, reinterpret_cast<sockaddr*>(&bound), &length) == 0) {
+                    port = FromNative(bound).port;
+                }
+            }
+
+            const int on = 1;
+            const int off = 0;
+            if (i == 0) {
+                // Probing UDP_SEGMENT with 0 leaves the default segment size unset
+                m_gsoEnabled = setsockopt(worker.socket, SOL_UDP, UDP_SEGMENT, &off, sizeof(off)) == 0;
+                m_groEnabled = setsockopt(worker.socket, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0;
+            }
+            else if (m_groEnabled) {
+                setsockopt(worker.socket, SOL_UDP, UDP_GRO, &on, sizeof(on));
+            }
+
+            worker.epoll = epoll_create1(EPOLL_CLOEXEC);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            if (worker.epoll < 0 || epoll_ctl(worker.epoll, EPOLL_CTL_ADD, worker.socket, &event) != 0) {
+                RF_NETWORK_CRITICAL("Failed to set up epoll for socket {}. Error: {}", i, std::strerror(errno));
+                CloseSockets();
+                return false;
+            }
+        }
+
+        RF_NETWORK_INFO("EpollSocketIO bound port {}; UDP GSO {}, GRO {}", port,
+            m_gsoEnabled ? "on" : "off", m_groEnabled ? "on" : "off");
+        return true;
+    }
+
+    bool EpollSocketIO::Start() {
+        if (m_workers.empty()) {
+            RF_NETWORK_ERROR("EpollSocketIO cannot start: not initialized.");
+            return false;
+        }
+        if (m_isRunning.exchange(true)) {
+            return true;
+        }
+
+        for (uint32_t i = 0; i < m_workers.size(); ++i) {
+            m_workers[i].thread = std::jthread([this, i](std::stop_token stopToken) { WorkerThread(stopToken, i); });
+        }
+        RF_NETWORK_INFO("EpollSocketIO started {} worker threads.", m_workers.size());
+        return true;
+    }
+
+    void EpollSocketIO::Stop() {
+        if (!m_isRunning.exchange(false)) {
+            return;
+        }
+
+        RF_NETWORK_INFO("EpollSocketIO stopping...");
+        for (Worker& worker : m_workers) {
+            worker.thread.request_stop();
+        }
+        for (Worker& worker : m_workers) {
+            if (worker.thread.joinable()) {
+                worker.thread.join();
+            }
+        }
+        CloseSockets();
+    }
+
+    void EpollSocketIO::CloseSockets() {
+        for (Worker& worker : m_workers) {
+            if (worker.epoll >= 0) {
+                close(worker.epoll);
+                worker.epoll = -1;
+            }
+            if (worker.socket >= 0) {
+                close(worker.socket);
+                worker.socket = -1;
+            }
+        }
+    }
+
+    void EpollSocketIO::WorkerThread(std::stop_token stopToken, uint32_t index) {
+        m_threadConfig.ApplyToCurrentThread(index);
+        const Worker& worker = m_workers[index];
+        t_workerSocket = { this, worker.socket };
+
+        // Allocated here so the pages are first touched, and placed, on this thread's node
+        auto slots = std::make_unique<ReceiveSlots>(m_groEnabled ? GRO_SLOT_SIZE : m_tuning.bufferSize);
+
+        epoll_event event{};
+        while (!stopToken.stop_requested()) {
+            const int ready = epoll_wait(worker.epoll, &event, 1, EPOLL_WAIT_TIMEOUT_MS);
+            if (ready > 0) {
+                Receive(worker.socket, *slots);
+            }
+            else if (ready < 0 && errno != EINTR) {
+                RF_NETWORK_ERROR("epoll_wait failed on worker {}. Error: {}", index, std::strerror(errno));
+                m_eventHandler->OnNetworkError("epoll_wait failed", errno);
+                break;
+            }
+        }
+        t_workerSocket = {};
+    }
+
+    void EpollSocketIO::Receive(int socket, ReceiveSlots& slots) {
+        for (;;) {
+            for (uint32_t i = 0; i < RECEIVE_BATCH; ++i) {
+                slots.iovecs[i] = { slots.storage.data() + static_cast<size_t>(i) * slots.slotSize, slots.slotSize };
+                msghdr& header = slots.messages[i].msg_hdr;
+                header.msg_name = &slots.addresses[i];
+                header.msg_namelen = sizeof(sockaddr_storage);
+                header.msg_iov = &slots.iovecs[i];
+                header.msg_iovlen = 1;
+                header.msg_control = slots.controls[i].data;
+                header.msg_controllen = sizeof(slots.controls[i].data);
+                header.msg_flags = 0;
+            }
+
+            const int count = recvmmsg(socket, slots.messages.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                if (!IsBufferFull(errno) && m_isRunning) {
+                    RF_NETWORK_WARN_LIMITED("recvmmsg failed. Error: {}", std::strerror(errno));
+                }
+                return;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                const msghdr& header = slots.messages[i].msg_hdr;
+                const uint32_t length = slots.messages[i].msg_len;
+                if (header.msg_flags & MSG_TRUNC) {
+                    RF_NETWORK_WARN_LIMITED("Dropped a datagram larger than the {} byte receive buffer.", slots.slotSize);
+                    continue;
+                }
+
+                // With GRO the buffer may hold several datagrams of segmentSize bytes (the last one shorter)
+                uint32_t segmentSize = length;
+                for (const cmsghdr* cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&header), const_cast<cmsghdr*>(cmsg))) {
+                    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                        int gso = 0;
+                        std::memcpy(&gso, CMSG_DATA(cmsg), sizeof(gso));
+                        if (gso > 0) segmentSize = static_cast<uint32_t>(gso);
+                    }
+                }
+
+                const NetworkEndpoint sender = FromNative(slots.addresses[i]);
+                uint8_t* data = static_cast<uint8_t*>(slots.iovecs[i].iov_base);
+                for (uint32_t offset = 0; offset < length; offset += segmentSize) {
+                    m_eventHandler->OnRawDataReceived(sender, data + offset, (std::min)(segmentSize, length - offset), nullptr);
+                }
+            }
+
+            if (count < static_cast<int>(RECEIVE_BATCH)) {
+                return;
+            }
+        }
+    }
+
+    int EpollSocketIO::SendSocket() const {
+        if (t_workerSocket.owner == this) {
+            return t_workerSocket.socket;
+        }
+        return m_workers.empty() ? -1 : m_workers[0].socket;
+    }
+
+    bool EpollSocketIO::SendNow(int socket, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        sockaddr_storage address;
+        const socklen_t addressLength = ToNative(recipient, m_family, address);
+        const auto postedAt = std::chrono::steady_clock::now();
+
+        ssize_t sent;
+        do {
+            sent = sendto(socket, data, size, 0, reinterpret_cast<const sockaddr*>(&address), addressLength);
+        } while (sent < 0 && errno == EINTR);
+
+        if (sent < 0) {
+            if (IsBufferFull(errno)) {
+                m_sendsRejected.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if (m_isRunning) {
+                RF_NETWORK_WARN_LIMITED("sendto {} failed. Error: {}", recipient, std::strerror(errno));
+            }
+            m_eventHandler->OnSendCompleted(nullptr, false, 0);
+            return false;
+        }
+        m_sendCompletionLatency.Record(std::chrono::steady_clock::now() - postedAt);
+        m_eventHandler->OnSendCompleted(nullptr, true, static_cast<uint32_t>(sent));
+        return true;
+    }
+
+    bool EpollSocketIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        if (!m_isRunning || data == nullptr) return false;
+        SendBatch& batch = ThreadBatch();
+        if (batch.owner == this) {
+            return Queue(batch, recipient, data, size, nullptr);
+        }
+        return SendNow(SendSocket(), recipient, data, size);
+    }
+
+    bool EpollSocketIO::SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) {
+        if (!m_isRunning || !buffer || buffer->Empty()) return false;
+        SendBatch& batch = ThreadBatch();
+        if (batch.owner == this) {
+            return Queue(batch, recipient, buffer->Data(), buffer->Size(), buffer);
+        }
+        return SendNow(SendSocket(), recipient, buffer->Data(), buffer->Size());
+    }
+
+    void EpollSocketIO::BeginSendBatch() {
+        SendBatch& batch = ThreadBatch();
+        if (batch.owner == nullptr) {
+            batch.owner = this;
+        }
+        if (batch.owner == this) {
+            ++batch.depth;
+        }
+    }
+
+    void EpollSocketIO::EndSendBatch() {
+        SendBatch& batch = ThreadBatch();
+        if (batch.owner != this || --batch.depth != 0) {
+            return;
+        }
+        Flush(batch);
+        batch.owner = nullptr;
+    }
+
+    bool EpollSocketIO::Queue(SendBatch& batch, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size,
+        const PacketBufferPtr& buffer) {
+        if (batch.entries.size() >= SEND_BATCH_MAX) {
+            Flush(batch);
+        }
+
+        SendBatch::Entry entry;
+        entry.recipient = recipient;
+        entry.size = size;
+        entry.queuedAt = std::chrono::steady_clock::now();
+        if (buffer) {
+            // The buffer stays referenced until the flush, so its bytes need no copy
+            entry.buffer = buffer;
+        }
+        else {
+            entry.offset = batch.bytes.size();
+            batch.bytes.insert(batch.bytes.end(), data, data + size);
+        }
+        batch.entries.push_back(std::move(entry));
+        return true;
+    }
+
+    void EpollSocketIO::Flush(SendBatch& batch) {
+        const uint32_t count = static_cast<uint32_t>(batch.entries.size());
+        if (count == 0) {
+            return;
+        }
+        const int socket = SendSocket();
+        if (!m_isRunning || socket < 0) {
+            batch.entries.clear();
+            batch.bytes.clear();
+            return;
+        }
+
+        // Group runs of datagrams to one recipient that are all segmentSize bytes but the last,
+        // which may be shorter: the kernel splits such a run at segmentSize (UDP GSO).
+        batch.runs.clear();
+        const bool gso = m_gsoEnabled.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count;) {
+            const SendBatch::Entry& head = batch.entries[i];
+            uint32_t run = 1;
+            uint32_t runBytes = head.size;
+            while (gso && i + run < count && run < GSO_MAX_SEGMENTS) {
+                const SendBatch::Entry& next = batch.entries[i + run];
+                if (!(next.recipient == head.recipient) || batch.entries[i + run - 1].size != head.size ||
+                    next.size > head.size || runBytes + next.size > GSO_MAX_BYTES) {
+                    break;
+                }
+                runBytes += next.size;
+                ++run;
+            }
+            batch.runs.push_back({ i, run });
+            i += run;
+        }
+
+        const size_t messageCount = batch.runs.size();
+        batch.iovecs.resize(count);
+        batch.messages.resize(messageCount);
+        batch.addresses.resize(messageCount);
+        batch.controls.resize(messageCount);
+        for (uint32_t i = 0; i < count; ++i) {
+            const SendBatch::Entry& entry = batch.entries[i];
+            uint8_t* bytes = entry.buffer ? entry.buffer->Data() : batch.bytes.data() + entry.offset;
+            batch.iovecs[i] = { bytes, entry.size };
+        }
+        for (size_t m = 0; m < messageCount; ++m) {
+            const SendBatch::Message& run = batch.runs[m];
+            msghdr& header = batch.messages[m].msg_hdr;
+            header = {};
+            header.msg_name = &batch.addresses[m];
+            header.msg_namelen = ToNative(batch.entries[run.first].recipient, m_family, batch.addresses[m]);
+            header.msg_iov = &batch.iovecs[run.first];
+            header.msg_iovlen = run.count;
+            if (run.count > 1) {
+                header.msg_control = batch.controls[m].data;
+                header.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                const uint16_t segmentSize = static_cast<uint16_t>(batch.entries[run.first].size);
+                std::memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof(segmentSize));
+            }
+        }
+
+        auto complete = [&](const SendBatch::Message& run, bool success) {
+            const auto now = std::chrono::steady_clock::now();
+            for (uint32_t i = run.first; i < run.first + run.count; ++i) {
+                if (success) {
+                    m_sendCompletionLatency.Record(now - batch.entries[i].queuedAt);
+                }
+                m_eventHandler->OnSendCompleted(nullptr, success, success ? batch.entries[i].size : 0);
+            }
+        };
+
+        size_t next = 0;
+        while (next < messageCount) {
+            const int sent = sendmmsg(socket, batch.messages.data() + next, static_cast<unsigned int>(messageCount - next), 0);
+            if (sent > 0) {
+                for (size_t m = next; m < next + static_cast<size_t>(sent); ++m) {
+                    if (batch.runs[m].count > 1) {
+                        m_gsoSends.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    complete(batch.runs[m], true);
+                }
+                next += static_cast<size_t>(sent);
+                continue;
+            }
+            if (sent < 0 && errno == EINTR) {
+                continue;
+            }
+
+            // The message at `next` failed; skip it and go on with the rest.
+            const int error = errno;
+            const SendBatch::Message& run = batch.runs[next];
+            if (run.count > 1 && (error == EIO || error == EINVAL || error == EOPNOTSUPP)) {
+                // The socket accepted UDP_SEGMENT but the route's device cannot segment
+                if (m_gsoEnabled.exchange(false)) {
+                    RF_NETWORK_WARN("UDP GSO send failed ({}); sending datagrams one by one.", std::strerror(error));
+                }
+                for (uint32_t i = run.first; i < run.first + run.count; ++i) {
+                    SendNow(socket, batch.entries[i].recipient, static_cast<const uint8_t*>(batch.iovecs[i].iov_base), batch.entries[i].size);
+                }
+            }
+            else {
+                if (IsBufferFull(error)) {
+                    m_sendsRejected.fetch_add(run.count, std::memory_order_relaxed);
+                }
+                else {
+                    RF_NETWORK_WARN_LIMITED("sendmmsg to {} failed. Error: {}", batch.entries[run.first].recipient, std::strerror(error));
+                }
+                complete(run, false);
+            }
+            ++next;
+        }
+
+        batch.entries.clear();
+        batch.bytes.clear();
+    }
+
+    bool EpollSocketIO::IsRunning() const {
+        return m_isRunning;
+    }
+
+    uint64_t EpollSocketIO::GetGsoSendCount() const {
+        return m_gsoSends.load(std::memory_order_relaxed);
+    }
+
+    IOStats EpollSocketIO::GetStats() const {
+        IOStats stats;
+        stats.sendPoolExhausted = m_sendsRejected.load(std::memory_order_relaxed);
+        stats.sendCompletionLatency = m_sendCompletionLatency.Snapshot();
+        return stats;
+    }
+
+} // namespace RiftNet::Networking
+
+#endif // defined(__linux__)
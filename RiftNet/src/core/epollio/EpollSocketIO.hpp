@@ -0,0 +1,98 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "../networkio/INetworkIO.hpp"
+#include "../networkio/INetworkIOEvents.hpp"
+#include "../threadconfig/ThreadConfig.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace RiftNet::Networking {
+
+    /**
+     * @class EpollSocketIO
+     * @brief A Linux implementation of the INetworkIO interface on epoll with batched system calls.
+     * Each worker thread owns one UDP socket bound to the same port with SO_REUSEPORT, so the
+     * kernel hashes every client to one worker and its datagrams are handled in arrival order.
+     * Workers wait in epoll_wait and drain their socket with recvmmsg; with UDP GRO the kernel
+     * may hand over several datagrams from one sender in a single buffer, which is split again
+     * before the handler sees it. Event handlers are called with a null OverlappedIOContext.
+     * Sends made between BeginSendBatch and EndSendBatch are queued on the calling thread and
+     * handed to the kernel with one sendmmsg at the end of the batch; runs of equal-size
+     * datagrams to one destination go out as a single UDP GSO (UDP_SEGMENT) send where the
+     * kernel supports it. Other sends are written with sendto at once.
+     * SocketTuning sets the socket buffer sizes (4 MB each when left at zero) and, without GRO,
+     * the receive slot size; the receive pool settings do not apply.
+     */
+    class EpollSocketIO : public INetworkIO {
+    public:
+        explicit EpollSocketIO(Threading::ThreadConfig threads = {}, SocketTuning tuning = {});
+        virtual ~EpollSocketIO() override;
+
+        // --- INetworkIO Interface Implementation ---
+        bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+        bool Start() override;
+        void Stop() override;
+        bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+        bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) override;
+        void BeginSendBatch() override;
+        void EndSendBatch() override;
+        bool IsRunning() const override;
+        IOStats GetStats() const override;
+
+        /**
+         * @brief Batched sends that went out as one GSO send of several datagrams.
+         */
+        uint64_t GetGsoSendCount() const;
+
+    private:
+        struct Worker {
+            int socket = -1;
+            int epoll = -1;
+            std::jthread thread;
+        };
+
+        // recvmmsg buffers, allocated by the worker that uses them (so on its NUMA node).
+        struct ReceiveSlots;
+
+        // Sends queued by one thread's open batch. Kept per thread and reused, so steady
+        // batching does not allocate.
+        struct SendBatch;
+        static SendBatch& ThreadBatch();
+
+        int OpenSocket(const std::string& listenIp, uint16_t port, bool reusePort);
+        void WorkerThread(std::stop_token stopToken, uint32_t index);
+        void Receive(int socket, ReceiveSlots& slots);
+
+        bool SendNow(int socket, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size);
+        bool Queue(SendBatch& batch, const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size,
+            const PacketBufferPtr& buffer);
+        void Flush(SendBatch& batch);
+        int SendSocket() const; // the calling worker's socket, else worker 0's
+        void CloseSockets();
+
+        INetworkIOEvents* m_eventHandler = nullptr;
+        Threading::ThreadConfig m_threadConfig;
+        SocketTuning m_tuning;
+        std::vector<Worker> m_workers;
+        int m_family = 0;           // AF_INET or AF_INET6, from the listen address
+        bool m_groEnabled = false;
+        std::atomic<bool> m_gsoEnabled{ false }; // cleared if the device rejects a segmented send
+
+        std::atomic<uint64_t> m_sendsRejected{ 0 }; // socket buffer full (EAGAIN / ENOBUFS)
+        std::atomic<uint64_t> m_gsoSends{ 0 };
+        Metrics::LatencyHistogram m_sendCompletionLatency;
+
+        std::atomic<bool> m_isRunning = false;
+    };
+
+} // namespace RiftNet::Networking
+
+#endif // defined(__linux__)
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "EventQueue.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <thread>
+
+namespace RiftNet::Networking {
+
+    namespace {
+        // A released slot keeps at most this much payload capacity, so one huge message does not pin memory
+        constexpr size_t MAX_RETAINED_PAYLOAD = 64 * 1024;
+    }
+
+    EventQueue::EventQueue(size_t capacity)
+        : m_mask(std::bit_ceil((std::max)(capacity, size_t{ 2 })) - 1) {
+        m_slots = std::make_unique<Slot[]>(m_mask + 1);
+        for (size_t i = 0; i <= m_mask; ++i) {
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool EventQueue::Push(const RiftEvent& event) {
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            if (m_closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+            slot = &m_slots[pos & m_mask];
+            const size_t seq = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0) {
+                // Full: the reader still holds this slot. Wait for it to poll.
+                std::this_thread::yield();
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+            else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->event = event;
+        if (event.type == RIFT_EVENT_PACKET_RECEIVED) {
+            const uint8_t* data = event.data.packet.data;
+            slot->payload.assign(data, data + event.data.packet.size);
+            slot->event.data.packet.data = nullptr; // pointed at the slot's copy when polled
+        }
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t EventQueue::Poll(RiftEvent* out, size_t maxEvents) {
+        std::lock_guard<std::mutex> lock(m_pollMutex);
+        ReleaseHeld();
+
+        size_t count = 0;
+        while (count < maxEvents) {
+            Slot& slot = m_slots[m_dequeuePos & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+                break; // empty, or the next producer has not finished writing
+            }
+            out[count] = slot.event;
+            if (slot.event.type == RIFT_EVENT_PACKET_RECEIVED) {
+                out[count].data.packet.data = slot.payload.data();
+            }
+            ++count;
+            ++m_dequeuePos;
+        }
+        return count;
+    }
+
+    void EventQueue::ReleaseHeld() {
+        for (; m_heldFrom != m_dequeuePos; ++m_heldFrom) {
+            Slot& slot = m_slots[m_heldFrom & m_mask];
+            if (slot.payload.capacity() > MAX_RETAINED_PAYLOAD) {
+                std::vector<uint8_t>().swap(slot.payload);
+            }
+            slot.sequence.store(m_heldFrom + m_mask + 1, std::memory_order_release);
+        }
+    }
+
+} // namespace RiftNet::Networking
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../../../include/RiftNet/RiftCommon.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace RiftNet::Networking {
+
+    // Largest queue rift_*_poll_events mode accepts
+    constexpr size_t MAX_EVENT_QUEUE_SIZE = size_t{ 1 } << 20;
+
+    /**
+     * @class EventQueue
+     * @brief Carries RiftEvents from the network threads to one application thread.
+     * Any thread may Push; a bounded lock-free ring (Vyukov) holds the events, and each slot
+     * keeps its own payload buffer, reused from event to event so steady traffic does not
+     * allocate. Poll hands out up to max events whose packet data points into those slots,
+     * and the slots are only recycled at the next Poll, after the application is done with them.
+     */
+    class EventQueue {
+    public:
+        // @param capacity Events the ring holds, rounded up to a power of two.
+        explicit EventQueue(size_t capacity);
+
+        EventQueue(const EventQueue&) = delete;
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        /**
+         * @brief Queues a copy of event (and, for a packet, its payload). Waits while the ring is
+         * full, so a slow reader holds back the network threads instead of losing events.
+         * @return False if the queue is closed.
+         */
+        bool Push(const RiftEvent& event);
+
+        /**
+         * @brief Takes up to maxEvents queued events, in queue order, and releases the previous batch.
+         * Packet data stays valid until the next call. Serialized internally; meant for one thread.
+         */
+        size_t Poll(RiftEvent* out, size_t maxEvents);
+
+        // Stops Push waiting for room (and accepting events), e.g. while the owner shuts down.
+        void Close() { m_closed.store(true, std::memory_order_release); }
+        void Open() { m_closed.store(false, std::memory_order_release); }
+
+    private:
+        struct Slot {
+            std::atomic<size_t>  sequence{ 0 };
+            RiftEvent            event{};
+            std::vector<uint8_t> payload;
+        };
+
+        void ReleaseHeld(); // Caller must hold m_pollMutex.
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t                  m_mask;
+
+        alignas(64) std::atomic<size_t> m_enqueuePos{ 0 };
+        alignas(64) std::mutex m_pollMutex;
+        size_t m_dequeuePos{ 0 }; // next slot to read
+        size_t m_heldFrom{ 0 };   // first slot handed out by the last Poll and not yet released
+        std::atomic<bool> m_closed{ false };
+    };
+
+} // namespace RiftNet::Networking
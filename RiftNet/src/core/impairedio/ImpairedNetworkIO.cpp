@@ -0,0 +1,264 @@
+#include "pch.h"
+#include "ImpairedNetworkIO.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <algorithm>
+
+using namespace RiftNet::Logging;
+
+namespace RiftNet::Networking {
+
+    namespace {
+        constexpr std::chrono::milliseconds DEFAULT_REORDER_DELAY{ 10 };
+
+        // std heap helpers build a max-heap; invert so the earliest due datagram is on top.
+        struct LaterDue {
+            template <typename T>
+            bool operator()(const T& a, const T& b) const {
+                return a.due != b.due ? a.due > b.due : a.order > b.order;
+            }
+        };
+    }
+
+    ImpairedNetworkIO::ImpairedNetworkIO(std::unique_ptr<INetworkIO> inner, const ImpairmentProfile& profile)
+        : m_inner(std::move(inner))
+        , m_profile(profile)
+        , m_delays(profile.latency.count() > 0 || profile.jitter.count() > 0 ||
+            profile.reorderPercent > 0.0f || profile.bandwidth > 0)
+        , m_rng(profile.seed) {
+    }
+
+    ImpairedNetworkIO::~ImpairedNetworkIO() {
+        Stop();
+    }
+
+    std::unique_ptr<INetworkIO> ImpairedNetworkIO::Wrap(std::unique_ptr<INetworkIO> inner, const ImpairmentProfile& profile) {
+        if (!inner || !profile.IsActive()) {
+            return inner;
+        }
+        return std::make_unique<ImpairedNetworkIO>(std::move(inner), profile);
+    }
+
+    bool ImpairedNetworkIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+        if (!eventHandler) {
+            RF_NETWORK_CRITICAL("ImpairedNetworkIO: INetworkIOEvents handler cannot be null.");
+            return false;
+        }
+        m_eventHandler = eventHandler;
+        RF_NETWORK_WARN("ImpairedNetworkIO: impairing traffic on {}:{} (loss {}%, duplicate {}%, reorder {}%, latency {} ms, jitter {} ms, bandwidth {} B/s, seed {})",
+            listenIp, listenPort, m_profile.lossPercent, m_profile.duplicatePercent, m_profile.reorderPercent,
+            m_profile.latency.count(), m_profile.jitter.count(), m_profile.bandwidth, m_profile.seed);
+        return m_inner->Init(listenIp, listenPort, this);
+    }
+
+    bool ImpairedNetworkIO::Start() {
+        m_started = true;
+        if (m_delays && !m_worker.joinable()) {
+            m_worker = std::jthread([this](std::stop_token stopToken) { Worker(stopToken); });
+        }
+        return m_inner->Start();
+    }
+
+    void ImpairedNetworkIO::Stop() {
+        if (!m_started.exchange(false)) {
+            m_inner->Stop();
+            return;
+        }
+        if (m_worker.joinable()) {
+            m_worker.request_stop();
+            m_wake.notify_all();
+            m_worker.join();
+        }
+        m_inner->Stop();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_held.empty()) {
+            RF_NETWORK_DEBUG("ImpairedNetworkIO: discarding {} held datagrams.", m_held.size());
+            m_held.clear();
+        }
+        RF_NETWORK_INFO("ImpairedNetworkIO: out dropped {} (+{} over the queue), duplicated {}, reordered {}; in dropped {} (+{}), duplicated {}, reordered {}",
+            m_outbound.dropped, m_outbound.queueDropped, m_outbound.duplicated, m_outbound.reordered,
+            m_inbound.dropped, m_inbound.queueDropped, m_inbound.duplicated, m_inbound.reordered);
+    }
+
+    bool ImpairedNetworkIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        return Impair(false, recipient, data, size, nullptr);
+    }
+
+    bool ImpairedNetworkIO::SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) {
+        if (!buffer) return false;
+        return Impair(false, recipient, buffer->Data(), static_cast<uint32_t>(buffer->Size()), buffer);
+    }
+
+    void ImpairedNetworkIO::BeginSendBatch() {
+        m_inner->BeginSendBatch();
+    }
+
+    void ImpairedNetworkIO::EndSendBatch() {
+        m_inner->EndSendBatch();
+    }
+
+    bool ImpairedNetworkIO::IsRunning() const {
+        return m_inner->IsRunning();
+    }
+
+    IOStats ImpairedNetworkIO::GetStats() const {
+        return m_inner->GetStats();
+    }
+
+    void ImpairedNetworkIO::OnRawDataReceived(const NetworkEndpoint& sender, uint8_t* data, uint32_t size, OverlappedIOContext* context) {
+        if (!m_delays) {
+            // Only loss and duplication: deliver in place, from a copy for the second delivery
+            // since the handler may decrypt the first one in place.
+            Clock::duration delays[2];
+            uint32_t copies;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                copies = Plan(m_inbound, size, Clock::now(), delays);
+            }
+            if (copies == 0) return;
+            std::vector<uint8_t> duplicate;
+            if (copies == 2) duplicate.assign(data, data + size);
+            m_eventHandler->OnRawDataReceived(sender, data, size, context);
+            if (copies == 2) m_eventHandler->OnRawDataReceived(sender, duplicate.data(), size, nullptr);
+            return;
+        }
+        Impair(true, sender, data, size, nullptr);
+    }
+
+    void ImpairedNetworkIO::OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) {
+        m_eventHandler->OnSendCompleted(context, success, bytesSent);
+    }
+
+    void ImpairedNetworkIO::OnNetworkError(const std::string& errorMessage, int errorCode) {
+        m_eventHandler->OnNetworkError(errorMessage, errorCode);
+    }
+
+    bool ImpairedNetworkIO::Chance(float percent) {
+        if (percent <= 0.0f) return false;
+        return std::uniform_real_distribution<float>(0.0f, 100.0f)(m_rng) < percent;
+    }
+
+    uint32_t ImpairedNetworkIO::Plan(Direction& direction, uint32_t size, Clock::time_point now, Clock::duration (&delays)[2]) {
+        if (Chance(m_profile.lossPercent)) {
+            ++direction.dropped;
+            return 0;
+        }
+        uint32_t copies = 1;
+        if (Chance(m_profile.duplicatePercent)) {
+            ++direction.duplicated;
+            copies = 2;
+        }
+
+        for (uint32_t i = 0; i < copies; ++i) {
+            Clock::duration delay{ 0 };
+            if (m_profile.bandwidth > 0) {
+                // Each copy takes its turn on the link; one that would wait too long is tail-dropped.
+                const Clock::time_point departs = (std::max)(now, direction.linkFreeAt);
+                if (departs - now > kMaxQueueDelay) {
+                    ++direction.queueDropped;
+                    copies = i;
+                    break;
+                }
+                direction.linkFreeAt = departs + std::chrono::nanoseconds(
+                    static_cast<uint64_t>(size) * 1000000000ull / m_profile.bandwidth);
+                delay = direction.linkFreeAt - now;
+            }
+            delay += m_profile.latency;
+            if (m_profile.jitter.count() > 0) {
+                delay += std::chrono::microseconds(std::uniform_int_distribution<int64_t>(
+                    0, std::chrono::duration_cast<std::chrono::microseconds>(m_profile.jitter).count())(m_rng));
+            }
+            if (Chance(m_profile.reorderPercent)) {
+                ++direction.reordered;
+                delay += m_profile.reorderDelay.count() > 0 ? m_profile.reorderDelay : DEFAULT_REORDER_DELAY;
+            }
+            delays[i] = delay;
+        }
+        return copies;
+    }
+
+    bool ImpairedNetworkIO::Impair(bool inbound, const NetworkEndpoint& endpoint, const uint8_t* data, uint32_t size, const PacketBufferPtr& buffer) {
+        const Clock::time_point now = Clock::now();
+        Clock::duration delays[2];
+        uint32_t copies;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            copies = Plan(inbound ? m_inbound : m_outbound, size, now, delays);
+            if (m_delays) {
+                for (uint32_t i = 0; i < copies; ++i) {
+                    Held held;
+                    held.due = now + delays[i];
+                    held.order = m_nextOrder++;
+                    held.inbound = inbound;
+                    held.endpoint = endpoint;
+                    if (buffer) held.buffer = buffer;
+                    else held.bytes.assign(data, data + size);
+                    m_held.push_back(std::move(held));
+                    std::push_heap(m_held.begin(), m_held.end(), LaterDue{});
+                }
+            }
+        }
+
+        if (m_delays) {
+            if (copies > 0) m_wake.notify_one();
+            return true; // a lost datagram was "sent"; the loss happens on the wire
+        }
+
+        // Outbound only: inbound without delays is handled in OnRawDataReceived.
+        bool sent = true;
+        for (uint32_t i = 0; i < copies; ++i) {
+            sent = (buffer ? m_inner->SendData(endpoint, buffer) : m_inner->SendData(endpoint, data, size)) && sent;
+        }
+        return sent;
+    }
+
+    void ImpairedNetworkIO::Deliver(Held& held) {
+        if (held.inbound) {
+            m_eventHandler->OnRawDataReceived(held.endpoint, held.bytes.data(),
+                static_cast<uint32_t>(held.bytes.size()), nullptr);
+        }
+        else if (held.buffer) {
+            m_inner->SendData(held.endpoint, held.buffer);
+        }
+        else {
+            m_inner->SendData(held.endpoint, held.bytes.data(), static_cast<uint32_t>(held.bytes.size()));
+        }
+    }
+
+    void ImpairedNetworkIO::Worker(std::stop_token stopToken) {
+        std::vector<Held> due;
+        while (!stopToken.stop_requested()) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_held.empty()) {
+                    m_wake.wait(lock, stopToken, [this] { return !m_held.empty(); });
+                }
+                else {
+                    // Wakes early when a datagram due sooner is queued, and re-checks the top.
+                    const Clock::time_point next = m_held.front().due;
+                    m_wake.wait_until(lock, stopToken, next, [this, next] {
+                        return m_held.front().due < next || Clock::now() >= next;
+                    });
+                }
+                if (stopToken.stop_requested()) break;
+
+                const Clock::time_point now = Clock::now();
+                while (!m_held.empty() && m_held.front().due <= now) {
+                    std::pop_heap(m_held.begin(), m_held.end(), LaterDue{});
+                    due.push_back(std::move(m_held.back()));
+                    m_held.pop_back();
+                }
+            }
+
+            if (due.empty()) continue;
+            m_inner->BeginSendBatch();
+            for (Held& held : due) {
+                Deliver(held);
+            }
+            m_inner->EndSendBatch();
+            due.clear();
+        }
+    }
+
+} // namespace RiftNet::Networking
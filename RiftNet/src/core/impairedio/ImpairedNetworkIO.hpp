@@ -0,0 +1,124 @@
+#pragma once
+
+#include "../networkio/INetworkIO.hpp"
+#include "../networkio/INetworkIOEvents.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace RiftNet::Networking {
+
+    /**
+     * @brief What an ImpairedNetworkIO does to every datagram, applied alike to sends and receives.
+     * All zeros leaves the traffic untouched.
+     */
+    struct ImpairmentProfile {
+        float lossPercent = 0.0f;      // chance a datagram is dropped
+        float duplicatePercent = 0.0f; // chance a second copy follows, with its own delay
+        float reorderPercent = 0.0f;   // chance a datagram is held back reorderDelay behind the ones after it
+        std::chrono::milliseconds latency{ 0 };
+        std::chrono::milliseconds jitter{ 0 };       // uniform extra delay in [0, jitter]
+        std::chrono::milliseconds reorderDelay{ 0 }; // 0 = 10 ms
+        uint64_t bandwidth = 0;        // bytes/s per direction; 0 = unlimited
+        uint64_t seed = 0;             // same seed and traffic, same impairments
+
+        bool IsActive() const {
+            return lossPercent > 0.0f || duplicatePercent > 0.0f || reorderPercent > 0.0f ||
+                latency.count() > 0 || jitter.count() > 0 || bandwidth > 0;
+        }
+    };
+
+    /**
+     * @class ImpairedNetworkIO
+     * @brief Wraps another INetworkIO and makes the link it carries behave like a bad network:
+     * loss, duplication, reordering, latency with jitter and a bandwidth cap, from a seeded RNG.
+     * Drops and duplicates without any delay happen inline; delayed datagrams wait in a queue
+     * ordered by due time and are sent or delivered from one worker thread. Received data is
+     * copied before it is held, so handlers see a null OverlappedIOContext for those datagrams.
+     * A bandwidth cap serializes each direction and tail-drops once the queue holds more
+     * than kMaxQueueDelay of traffic, like a router buffer.
+     */
+    class ImpairedNetworkIO : public INetworkIO, public INetworkIOEvents {
+    public:
+        ImpairedNetworkIO(std::unique_ptr<INetworkIO> inner, const ImpairmentProfile& profile);
+        ~ImpairedNetworkIO() override;
+
+        /**
+         * @brief Returns `inner` wrapped when `profile` impairs anything, and `inner` itself otherwise.
+         */
+        static std::unique_ptr<INetworkIO> Wrap(std::unique_ptr<INetworkIO> inner, const ImpairmentProfile& profile);
+
+        // --- INetworkIO Interface Implementation ---
+        bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+        bool Start() override;
+        void Stop() override;
+        bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+        bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) override;
+        void BeginSendBatch() override;
+        void EndSendBatch() override;
+        bool IsRunning() const override;
+        IOStats GetStats() const override;
+
+        // --- INetworkIOEvents Interface Implementation (from the wrapped layer) ---
+        void OnRawDataReceived(const NetworkEndpoint& sender, uint8_t* data, uint32_t size, OverlappedIOContext* context) override;
+        void OnSendCompleted(OverlappedIOContext* context, bool success, uint32_t bytesSent) override;
+        void OnNetworkError(const std::string& errorMessage, int errorCode = 0) override;
+
+        static constexpr std::chrono::milliseconds kMaxQueueDelay{ 200 };
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Direction {
+            Clock::time_point linkFreeAt{}; // when the capped link finishes the datagrams already queued
+            uint64_t dropped = 0;
+            uint64_t queueDropped = 0;
+            uint64_t duplicated = 0;
+            uint64_t reordered = 0;
+        };
+
+        struct Held {
+            Clock::time_point due;
+            uint64_t order = 0; // keeps datagrams due at the same time in arrival order
+            bool inbound = false;
+            NetworkEndpoint endpoint;
+            PacketBufferPtr buffer;     // outbound zero-copy sends
+            std::vector<uint8_t> bytes; // everything else
+        };
+
+        /**
+         * @brief Rolls the impairments for one datagram. Returns how many copies to deliver (0 .. 2)
+         * and their delays from now. Caller must hold m_mutex.
+         */
+        uint32_t Plan(Direction& direction, uint32_t size, Clock::time_point now, Clock::duration (&delays)[2]);
+        bool Chance(float percent);
+
+        bool Impair(bool inbound, const NetworkEndpoint& endpoint, const uint8_t* data, uint32_t size, const PacketBufferPtr& buffer);
+        void Deliver(Held& held);
+        void Worker(std::stop_token stopToken);
+
+        std::unique_ptr<INetworkIO> m_inner;
+        const ImpairmentProfile     m_profile;
+        const bool                  m_delays; // anything is ever held; otherwise all work is inline
+        INetworkIOEvents*           m_eventHandler = nullptr;
+        std::atomic<bool>           m_started{ false };
+
+        std::mutex                  m_mutex;
+        std::condition_variable_any m_wake;
+        std::vector<Held>           m_held; // min-heap on (due, order)
+        uint64_t                    m_nextOrder = 0;
+        std::mt19937_64             m_rng;
+        Direction                   m_outbound;
+        Direction                   m_inbound;
+        std::jthread                m_worker;
+    };
+
+} // namespace RiftNet::Networking
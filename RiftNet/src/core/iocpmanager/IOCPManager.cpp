@@ -1,35 +1,34 @@
 #include "pch.h"
+
+#if defined(_WIN32)
+
 #include "IOCPManager.hpp"
 #include "../../../utilities/logger/Logger.hpp"
 
+#include <algorithm>
+#include <chrono>
+
 using namespace RiftNet::Logging;
 
 namespace RiftNet::Networking {
 
-    // Helper function to determine the optimal number of worker threads.
-    static unsigned int DetermineNumWorkerThreads(uint32_t concurrentThreads) {
-        if (concurrentThreads > 0) {
-            return concurrentThreads;
-        }
-        unsigned int num_threads = std::thread::hardware_concurrency();
-        return (num_threads > 0) ? num_threads : 4; // Default to 4 if hardware_concurrency is not available.
-    }
-
     IOCPManager::IOCPManager() = default;
 
     IOCPManager::~IOCPManager() {
         Stop();
     }
 
-    bool IOCPManager::Start(OnIOCompletedCallback callback, uint32_t concurrentThreads) {
+    bool IOCPManager::Start(OnIOCompletedCallback callback, const Threading::ThreadConfig& threads, ULONG batchSize) {
         if (m_isRunning) {
             return true;
         }
 
         m_ioCompletedCallback = callback;
+        m_batchSize = (batchSize > 0) ? batchSize : 1;
+        m_threadConfig = threads;
 
         // Create the I/O Completion Port. The last parameter (NumberOfConcurrentThreads) is a hint to the OS.
-        m_iocpHandle = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, concurrentThreads);
+        m_iocpHandle = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, threads.threadCount);
         if (m_iocpHandle == NULL) {
             RF_NETWORK_CRITICAL("Failed to create IOCP handle. Error: {}", GetLastError());
             return false;
@@ -37,13 +36,13 @@ namespace RiftNet::Networking {
 
         m_isRunning = true;
 
-        unsigned int threadCount = DetermineNumWorkerThreads(concurrentThreads);
-        RF_NETWORK_INFO("IOCPManager starting with {} worker threads.", threadCount);
+        const uint32_t threadCount = threads.ResolveThreadCount();
+        RF_NETWORK_INFO("IOCPManager starting with {} worker threads (batch size {}).", threadCount, m_batchSize);
 
         try {
             m_workerThreads.reserve(threadCount);
-            for (unsigned int i = 0; i < threadCount; ++i) {
-                m_workerThreads.emplace_back(&IOCPManager::WorkerThread, this);
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                m_workerThreads.emplace_back(&IOCPManager::WorkerThread, this, i);
             }
         }
         catch (const std::system_error& e) {
@@ -100,50 +99,79 @@ namespace RiftNet::Networking {
         return true;
     }
 
-    void IOCPManager::WorkerThread() {
+    void IOCPManager::WorkerThread(uint32_t index) {
+        m_threadConfig.ApplyToCurrentThread(index);
+
         std::stringstream ss_start;
         ss_start << std::this_thread::get_id();
         RF_NETWORK_DEBUG("IOCP worker thread {} starting.", ss_start.str());
 
-        DWORD bytesTransferred = 0;
-        ULONG_PTR completionKey = 0;
-        OverlappedIOContext* pIoContext = nullptr;
-
-        while (m_isRunning.load(std::memory_order_acquire)) {
-            BOOL success = GetQueuedCompletionStatus(
+        std::vector<OVERLAPPED_ENTRY> entries(m_batchSize);
+        std::vector<IOCompletion> completions(m_batchSize);
+        bool shutdownRequested = false;
+        // Sleep before retrying after a failed dequeue, doubled per consecutive failure, so an error
+        // that keeps coming back does not spin the worker; reset by the next successful dequeue
+        constexpr std::chrono::milliseconds kMaxFailureBackoff{ 100 };
+        std::chrono::milliseconds failureBackoff{ 0 };
+
+        while (!shutdownRequested) {
+            ULONG entryCount = 0;
+            // No timeout: Stop() wakes every worker with a poison pill.
+            BOOL success = GetQueuedCompletionStatusEx(
                 m_iocpHandle,
-                &bytesTransferred,
-                &completionKey,
-                (LPOVERLAPPED*)&pIoContext,
-                100 // Timeout in ms to allow periodic checks of m_isRunning
+                entries.data(),
+                m_batchSize,
+                &entryCount,
+                INFINITE,
+                FALSE
             );
 
             if (!success) {
                 DWORD errorCode = GetLastError();
-                if (errorCode == WAIT_TIMEOUT) {
-                    continue; // Expected timeout, loop again.
+                if (errorCode == ERROR_ABANDONED_WAIT_0 || errorCode == ERROR_INVALID_HANDLE) {
+                    RF_NETWORK_WARN("IOCP handle closed while waiting (error {}). Exiting worker.", errorCode);
+                    break;
                 }
-
-                // An actual error occurred.
-                if (pIoContext != nullptr) {
-                    // An I/O operation itself failed. The owner needs to handle this.
-                    m_ioCompletedCallback(pIoContext, 0); // 0 bytes transferred signifies failure
-                }
-                else {
-                    // A critical error with GQCS itself, likely during shutdown.
-                    RF_NETWORK_WARN("GetQueuedCompletionStatus failed without a context. Error: {}. Assuming shutdown.", errorCode);
+                if (!m_isRunning) {
+                    break; // stopping: leave rather than wait for a pill on a failing port
                 }
+                failureBackoff = (std::min)((std::max)(failureBackoff * 2, std::chrono::milliseconds(1)), kMaxFailureBackoff);
+                RF_NETWORK_WARN_LIMITED("GetQueuedCompletionStatusEx failed. Error: {}; retrying in {} ms",
+                    errorCode, failureBackoff.count());
+                std::this_thread::sleep_for(failureBackoff);
                 continue;
             }
+            failureBackoff = std::chrono::milliseconds(0);
+
+            ULONG completionCount = 0;
+            ULONG poisonPills = 0;
+            for (ULONG i = 0; i < entryCount; ++i) {
+                const OVERLAPPED_ENTRY& entry = entries[i];
+
+                // This is the explicit shutdown signal from Stop().
+                if (entry.lpOverlapped == NULL) {
+                    ++poisonPills;
+                    continue;
+                }
+
+                // A non-zero status means the I/O operation itself failed; report it as 0 bytes.
+                const bool failed = (entry.Internal != 0);
+                completions[completionCount++] = {
+                    reinterpret_cast<OverlappedIOContext*>(entry.lpOverlapped),
+                    failed ? 0 : entry.dwNumberOfBytesTransferred
+                };
+            }
 
-            // This is the explicit shutdown signal from Stop().
-            if (pIoContext == NULL) {
-                break;
+            if (completionCount > 0 && m_ioCompletedCallback) {
+                m_ioCompletedCallback(completions.data(), completionCount);
             }
 
-            // A valid operation completed.
-            if (m_ioCompletedCallback) {
-                m_ioCompletedCallback(pIoContext, bytesTransferred);
+            if (poisonPills > 0) {
+                shutdownRequested = true;
+                // One pill per worker: hand any extras we dequeued to the remaining threads.
+                for (ULONG i = 1; i < poisonPills; ++i) {
+                    PostQueuedCompletionStatus(m_iocpHandle, 0, 0, NULL);
+                }
             }
         }
 
@@ -153,3 +181,5 @@ namespace RiftNet::Networking {
     }
 
 } // namespace RiftNet::Networking
+
+#endif // defined(_WIN32)
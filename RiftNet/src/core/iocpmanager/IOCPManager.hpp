@@ -1,6 +1,9 @@
 #pragma once
 
+#if defined(_WIN32)
+
 #include "../riftnetio/RiftNetIO.hpp"
+#include "../threadconfig/ThreadConfig.hpp"
 #include <Windows.h>
 #include <vector>
 #include <thread>
@@ -10,6 +13,15 @@
 namespace RiftNet {
     namespace Networking {
 
+        // Default number of completions a worker dequeues per GetQueuedCompletionStatusEx call.
+        constexpr ULONG DEFAULT_IOCP_DEQUEUE_BATCH = 64;
+
+        // One dequeued I/O completion. bytesTransferred is 0 if the operation failed.
+        struct IOCompletion {
+            OverlappedIOContext* context;
+            DWORD bytesTransferred;
+        };
+
         /**
          * @class IOCPManager
          * @brief Manages the I/O Completion Port, worker threads, and dispatching of completed I/O events.
@@ -17,8 +29,8 @@ namespace RiftNet {
          */
         class IOCPManager {
         public:
-            // Callback to notify the owner of a completed I/O operation.
-            using OnIOCompletedCallback = std::function<void(OverlappedIOContext*, DWORD)>;
+            // Callback to notify the owner of a batch of completed I/O operations, in dequeue order.
+            using OnIOCompletedCallback = std::function<void(const IOCompletion*, ULONG)>;
 
             IOCPManager();
             ~IOCPManager();
@@ -29,11 +41,13 @@ namespace RiftNet {
 
             /**
              * @brief Starts the IOCP worker threads.
-             * @param callback The function to call when an I/O operation completes.
-             * @param concurrentThreads The number of threads to run. 0 means system default (number of cores).
+             * @param callback The function to call with each batch of completed I/O operations.
+             * @param threads Worker count, affinity, priority and names; threadCount 0 means one per allowed core.
+             * @param batchSize Maximum completions dequeued (and dispatched) per kernel call.
              * @return True on success, false on failure.
              */
-            bool Start(OnIOCompletedCallback callback, uint32_t concurrentThreads = 0);
+            bool Start(OnIOCompletedCallback callback, const Threading::ThreadConfig& threads = {},
+                ULONG batchSize = DEFAULT_IOCP_DEQUEUE_BATCH);
 
             /**
              * @brief Stops all worker threads and cleans up resources.
@@ -51,14 +65,18 @@ namespace RiftNet {
             /**
              * @brief The main function for each worker thread.
              */
-            void WorkerThread();
+            void WorkerThread(uint32_t index);
 
             HANDLE m_iocpHandle = INVALID_HANDLE_VALUE;
             std::vector<std::thread> m_workerThreads;
             std::atomic<bool> m_isRunning = false;
             OnIOCompletedCallback m_ioCompletedCallback;
+            ULONG m_batchSize = DEFAULT_IOCP_DEQUEUE_BATCH;
+            Threading::ThreadConfig m_threadConfig;
         };
 
     } // namespace Networking
 
-} // namespace RiftNet
\ No newline at end of file
+} // namespace RiftNet
+
+#endif // defined(_WIN32)
@@ -3,6 +3,8 @@
 
 #include "NetworkEndpoint.hpp"
 #include "IOContext.hpp"
+#include "../../../utilities/metrics/Metrics.hpp"
+#include <algorithm>
 #include <string>
 #include <cstdint>
 #include <vector>
@@ -12,6 +14,26 @@ namespace RiftNet {
 
         class INetworkIOEvents; // Forward declaration
 
+        // What a socket layer counts about itself; zero where an implementation keeps no such count.
+        struct IOStats {
+            uint64_t receivePoolExhausted{ 0 }; // times a receive context was wanted with the pool at its cap
+            uint64_t sendPoolExhausted{ 0 };    // sends that found no pooled context or slot free
+            Metrics::HistogramSnapshot sendCompletionLatency; // from posting a send to dequeuing its completion
+        };
+
+        // Sizing a socket layer is created with; each implementation uses the fields that apply to it.
+        struct SocketTuning {
+            uint32_t receivePoolSize = 128;    // receives posted at start, and the step the pool grows by
+            uint32_t receivePoolMax = 0;       // 0 = 8 x receivePoolSize
+            uint32_t bufferSize = DEFAULT_IOCP_UDP_BUFFER_SIZE; // bytes per receive or send buffer
+            uint32_t socketReceiveBuffer = 0;  // SO_RCVBUF bytes; 0 = the implementation's default
+            uint32_t socketSendBuffer = 0;     // SO_SNDBUF bytes; 0 = the implementation's default
+
+            uint32_t ResolveReceivePoolMax() const {
+                return receivePoolMax != 0 ? (std::max)(receivePoolMax, receivePoolSize) : receivePoolSize * 8;
+            }
+        };
+
         class INetworkIO {
         public:
             virtual ~INetworkIO() = default;
@@ -27,9 +49,21 @@ namespace RiftNet {
 
             virtual bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) = 0;
 
+            // Zero-copy variant: the implementation holds a reference to the buffer until the send completes
+            // and transmits its current view [Data(), Data() + Size()) without copying it.
+            virtual bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) = 0;
+
+            // Brackets a run of sends from the calling thread that the implementation may hand to
+            // the kernel together at EndSendBatch. Calls nest; every Begin needs a matching End on
+            // the same thread. The default sends each datagram as SendData is called.
+            virtual void BeginSendBatch() {}
+            virtual void EndSendBatch() {}
+
 
             virtual bool IsRunning() const = 0;
 
+            virtual IOStats GetStats() const { return {}; }
+
 
             //virtual OverlappedIOContext* GetFreeReceiveContext() = 0;
             //virtual void ReturnReceiveContext(OverlappedIOContext* pContext) = 0;
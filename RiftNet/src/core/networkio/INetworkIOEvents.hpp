@@ -13,11 +13,15 @@ namespace RiftNet {
         public:
             virtual ~INetworkIOEvents() = default;
 
+            // data points into the receive context's buffer and stays valid (and writable, so
+            // handlers may decrypt in place) until this call returns and the receive is re-posted.
+            // context is null for backends that do not use overlapped contexts (e.g. RioSocketIO).
             virtual void OnRawDataReceived(const NetworkEndpoint& sender,
-                const uint8_t* data,
+                uint8_t* data,
                 uint32_t size,
                 OverlappedIOContext* context) = 0;
 
+            // context may be null (see OnRawDataReceived).
             virtual void OnSendCompleted(OverlappedIOContext* context,
                 bool success,
                 uint32_t bytesSent) = 0;
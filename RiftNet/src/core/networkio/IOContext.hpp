@@ -1,14 +1,18 @@
 // File: OverlappedIOContext.h
 #pragma once
 
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
 #include <Winsock2.h> 
+#endif
 #include <vector>   
 #include <cstring>   
+#include <chrono>
 #include "NetworkEndpoint.hpp"
+#include "../buffer/PacketBuffer.hpp"
 
 
 const int DEFAULT_IOCP_UDP_BUFFER_SIZE = 4096;
@@ -22,6 +26,7 @@ namespace RiftNet {
             Send
         };
 
+#if defined(_WIN32)
         struct OverlappedIOContext {
             OVERLAPPED      overlapped;
             IOOperationType operationType;
@@ -30,6 +35,9 @@ namespace RiftNet {
             sockaddr_in     remoteAddrNative;
             int             remoteAddrNativeLen;
             NetworkEndpoint endpoint;
+            bool            isPooled = false; // Owned by a context pool; return it instead of deleting.
+            PacketBufferPtr sendBuffer;       // Zero-copy send: keeps the caller's bytes alive until completion.
+            std::chrono::steady_clock::time_point postedAt; // Send: when it was handed to WSASendTo.
 
             OverlappedIOContext(IOOperationType opType, size_t bufferSize = DEFAULT_IOCP_UDP_BUFFER_SIZE)
                 : operationType(opType), buffer(bufferSize), remoteAddrNativeLen(sizeof(sockaddr_in)) {
@@ -47,7 +55,19 @@ namespace RiftNet {
                 wsaBuf.buf = buffer.data();
                 wsaBuf.len = static_cast<ULONG>(buffer.size());
             }
+
+            void ResetForSend(uint32_t size) {
+                ZeroMemory(&overlapped, sizeof(OVERLAPPED));
+                operationType = IOOperationType::Send;
+                remoteAddrNativeLen = sizeof(sockaddr_in);
+                wsaBuf.buf = buffer.data();
+                wsaBuf.len = static_cast<ULONG>(size);
+            }
         };
+#else
+        // Only the Windows backends use overlapped contexts; elsewhere handlers always get null.
+        struct OverlappedIOContext;
+#endif
 
     } // namespace Networking
 } // namespace RiftForged
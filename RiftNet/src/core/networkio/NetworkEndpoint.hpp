@@ -1,44 +1,95 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <cstdint> // For uint16_t
+#include <cstdio>
+#include <cstring>
 
+#if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #ifndef NOMINMAX
 #define NOMINMAX
 #endif
-#include <Winsock2.h>  
-#include <Ws2tcpip.h>  
-#pragma comment(lib, "Ws2_32.lib") 
+#include <Winsock2.h>
+#include <Ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#ifdef SPDLOG_USE_STD_FORMAT
+#include <format>
+#else
+#include <spdlog/fmt/fmt.h>
+#endif
 
 
 namespace RiftNet {
     namespace Networking {
 
+        /**
+         * @brief A compact, trivially copyable UDP endpoint used as the hot-path key.
+         * The address is kept in binary network byte order (IPv4 in the first 4 bytes), so
+         * receive, lookup and send never format or parse strings. Text conversion only
+         * happens for logging (ToString / fmt formatter) and at the public API boundary.
+         */
         struct NetworkEndpoint {
-            std::string ipAddress;
-            uint16_t port;
+            uint8_t  address[16] = {}; // network byte order; IPv4 uses address[0..3]
+            uint16_t port = 0;         // host byte order
+            uint16_t family = AF_INET;
+
+            NetworkEndpoint() = default;
+
+            // Parses a textual IPv4 or IPv6 address; used for configuration, not per packet.
+            NetworkEndpoint(const std::string& ip, uint16_t p)
+                : port(p) {
+                if (inet_pton(AF_INET, ip.c_str(), address) == 1) {
+                    family = AF_INET;
+                }
+                else if (inet_pton(AF_INET6, ip.c_str(), address) == 1) {
+                    family = AF_INET6;
+                }
+            }
+
+            NetworkEndpoint(const sockaddr_in& addr)
+                : port(ntohs(addr.sin_port)), family(AF_INET) {
+                std::memcpy(address, &addr.sin_addr, sizeof(addr.sin_addr));
+            }
 
-            NetworkEndpoint(const std::string& ip = "", uint16_t p = 0)
-                : ipAddress(ip), port(p) {
+            NetworkEndpoint(const sockaddr_in6& addr)
+                : port(ntohs(addr.sin6_port)), family(AF_INET6) {
+                std::memcpy(address, &addr.sin6_addr, sizeof(addr.sin6_addr));
             }
 
-            NetworkEndpoint(const sockaddr_in& addr) {
-                char ipStr[INET_ADDRSTRLEN] = { 0 };
-                inet_ntop(AF_INET, &(addr.sin_addr), ipStr, INET_ADDRSTRLEN);
-                ipAddress = ipStr;
-                port = ntohs(addr.sin_port);
+            bool IsIPv6() const { return family == AF_INET6; }
+
+            /**
+             * @brief Writes "ip:port" (or "[ip]:port" for IPv6) into out without allocating.
+             * @return The number of characters written, excluding the terminator.
+             */
+            size_t FormatTo(char* out, size_t capacity) const {
+                char ipStr[INET6_ADDRSTRLEN] = { 0 };
+                inet_ntop(family, address, ipStr, sizeof(ipStr));
+                const int written = IsIPv6()
+                    ? std::snprintf(out, capacity, "[%s]:%u", ipStr, static_cast<unsigned>(port))
+                    : std::snprintf(out, capacity, "%s:%u", ipStr, static_cast<unsigned>(port));
+                if (written < 0) return 0;
+                return (static_cast<size_t>(written) < capacity) ? static_cast<size_t>(written) : capacity - 1;
             }
 
             std::string ToString() const {
-                return ipAddress + ":" + std::to_string(port);
+                char buffer[INET6_ADDRSTRLEN + 8];
+                return std::string(buffer, FormatTo(buffer, sizeof(buffer)));
             }
 
             bool operator<(const NetworkEndpoint& other) const {
-                if (ipAddress < other.ipAddress) {
-                    return true;
+                if (family != other.family) {
+                    return family < other.family;
                 }
-                if (ipAddress > other.ipAddress) {
-                    return false;
+                if (int cmp = std::memcmp(address, other.address, sizeof(address)); cmp != 0) {
+                    return cmp < 0;
                 }
                 return port < other.port;
             }
@@ -47,14 +98,63 @@ namespace RiftNet {
                 sockaddr_in addr = {};
                 addr.sin_family = AF_INET;
                 addr.sin_port = htons(port);
-                inet_pton(AF_INET, ipAddress.c_str(), &addr.sin_addr);
+                std::memcpy(&addr.sin_addr, address, sizeof(addr.sin_addr));
+                return addr;
+            }
+
+            sockaddr_in6 ToSockAddr6() const {
+                sockaddr_in6 addr = {};
+                addr.sin6_family = AF_INET6;
+                addr.sin6_port = htons(port);
+                std::memcpy(&addr.sin6_addr, address, sizeof(addr.sin6_addr));
                 return addr;
             }
 
             bool operator==(const NetworkEndpoint& other) const {
-                return ipAddress == other.ipAddress && port == other.port;
+                return port == other.port && family == other.family &&
+                    std::memcmp(address, other.address, sizeof(address)) == 0;
             }
         };
 
     } // namespace Networking
 } // namespace RiftForged
+
+// Integer hash for NetworkEndpoint so it can be used in std::unordered_map.
+namespace std {
+    template <>
+    struct hash<RiftNet::Networking::NetworkEndpoint> {
+        size_t operator()(const RiftNet::Networking::NetworkEndpoint& ep) const noexcept {
+            uint64_t lo = 0, hi = 0;
+            std::memcpy(&lo, ep.address, sizeof(lo));
+            std::memcpy(&hi, ep.address + sizeof(lo), sizeof(hi));
+
+            // splitmix64 finalizer over the folded address, port and family
+            uint64_t h = lo ^ (hi * 0x9E3779B97F4A7C15ull) ^ (static_cast<uint64_t>(ep.port) << 48) ^ ep.family;
+            h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+            h ^= h >> 27; h *= 0x94D049BB133111EBull;
+            h ^= h >> 31;
+            return static_cast<size_t>(h);
+        }
+    };
+}
+
+// Lets log calls take an endpoint directly; it is only formatted if the message is emitted.
+#ifdef SPDLOG_USE_STD_FORMAT
+template <>
+struct std::formatter<RiftNet::Networking::NetworkEndpoint> : std::formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const RiftNet::Networking::NetworkEndpoint& ep, FormatContext& ctx) const {
+        char buffer[INET6_ADDRSTRLEN + 8];
+        return std::formatter<std::string_view>::format(std::string_view(buffer, ep.FormatTo(buffer, sizeof(buffer))), ctx);
+    }
+};
+#else
+template <>
+struct fmt::formatter<RiftNet::Networking::NetworkEndpoint> : fmt::formatter<std::string_view> {
+    template <typename FormatContext>
+    auto format(const RiftNet::Networking::NetworkEndpoint& ep, FormatContext& ctx) const {
+        char buffer[INET6_ADDRSTRLEN + 8];
+        return fmt::formatter<std::string_view>::format(std::string_view(buffer, ep.FormatTo(buffer, sizeof(buffer))), ctx);
+    }
+};
+#endif
@@ -1,4 +1,7 @@
 #include "pch.h"
+
+#if defined(_WIN32)
+
 #include "RiftNetIO.hpp"
 #include "../../../utilities/logger/Logger.hpp"
 #include "../iocpmanager/IOCPManager.hpp"
@@ -10,7 +13,20 @@ using namespace RiftNet::Logging;
 
 namespace RiftNet::Networking {
 
-    WinSocketIO::WinSocketIO() {
+    namespace {
+        // Send contexts are fixed-size (SocketTuning::bufferSize); the pool starts at
+        // SEND_POOL_INITIAL_SIZE and grows by SEND_POOL_GROW_STEP up to SEND_POOL_MAX_SIZE.
+        constexpr size_t SEND_POOL_INITIAL_SIZE = 256;
+        constexpr size_t SEND_POOL_GROW_STEP = 64;
+        constexpr size_t SEND_POOL_MAX_SIZE = 4096;
+    }
+
+    WinSocketIO::WinSocketIO(uint32_t receiveShards, Threading::ThreadConfig threads, SocketTuning tuning)
+        : m_tuning(tuning), m_threadConfig(std::move(threads)), m_shardThreadConfig(m_threadConfig) {
+        if (!m_shardThreadConfig.name.empty()) {
+            m_shardThreadConfig.name += " Shard";
+        }
+
         // Initialize Winsock
         WSADATA wsaData;
         int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -18,6 +34,11 @@ namespace RiftNet::Networking {
             // This is a catastrophic failure, throwing is appropriate.
             throw std::runtime_error("WSAStartup failed with error: " + std::to_string(result));
         }
+
+        m_shards.reserve(receiveShards);
+        for (uint32_t i = 0; i < receiveShards; ++i) {
+            m_shards.push_back(std::make_unique<ReceiveShard>());
+        }
     }
 
     WinSocketIO::~WinSocketIO() {
@@ -45,6 +66,25 @@ namespace RiftNet::Networking {
             return false;
         }
 
+        // Oversized datagrams are dropped rather than IP-fragmented, so path MTU probes mean something
+        DWORD dontFragment = TRUE;
+        if (setsockopt(m_socket, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&dontFragment), sizeof(dontFragment)) == SOCKET_ERROR) {
+            RF_NETWORK_WARN("Failed to set IP_DONTFRAGMENT. Error: {}", WSAGetLastError());
+        }
+
+        if (m_tuning.socketReceiveBuffer != 0) {
+            const int bytes = static_cast<int>(m_tuning.socketReceiveBuffer);
+            if (setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes)) == SOCKET_ERROR) {
+                RF_NETWORK_WARN("Failed to set SO_RCVBUF to {}. Error: {}", bytes, WSAGetLastError());
+            }
+        }
+        if (m_tuning.socketSendBuffer != 0) {
+            const int bytes = static_cast<int>(m_tuning.socketSendBuffer);
+            if (setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes)) == SOCKET_ERROR) {
+                RF_NETWORK_WARN("Failed to set SO_SNDBUF to {}. Error: {}", bytes, WSAGetLastError());
+            }
+        }
+
         sockaddr_in localAddr{};
         localAddr.sin_family = AF_INET;
         localAddr.sin_port = htons(listenPort);
@@ -58,7 +98,8 @@ namespace RiftNet::Networking {
         }
 
         m_iocpManager = std::make_unique<IOCPManager>();
-        if (!m_iocpManager->Start([this](auto... args) { this->OnIOCompleted(args...); })) {
+        if (!m_iocpManager->Start([this](const IOCompletion* completions, ULONG count) { OnIOBatchCompleted(completions, count); },
+            m_threadConfig)) {
             RF_NETWORK_CRITICAL("Failed to start IOCP Manager.");
             return false;
         }
@@ -67,15 +108,25 @@ namespace RiftNet::Networking {
             return false;
         }
 
-        const int POOL_SIZE = 128;
-        m_receiveContextPool.reserve(POOL_SIZE);
-        m_freeReceiveContexts.reserve(POOL_SIZE);
-        for (int i = 0; i < POOL_SIZE; ++i) {
-            auto context = std::make_unique<OverlappedIOContext>(IOOperationType::Recv);
-            m_freeReceiveContexts.push_back(context.get());
-            m_receiveContextPool.push_back(std::move(context));
-        }
-        RF_NETWORK_DEBUG("Receive context pool initialized with {} contexts.", POOL_SIZE);
+        // Built on a thread on the workers' node, so the buffers they touch are local to them
+        const uint32_t poolSize = m_tuning.receivePoolSize;
+        m_threadConfig.RunOnNode([&] {
+            m_receiveContextPool.reserve(m_tuning.ResolveReceivePoolMax());
+            m_freeReceiveContexts.reserve(poolSize);
+            for (uint32_t i = 0; i < poolSize; ++i) {
+                auto context = std::make_unique<OverlappedIOContext>(IOOperationType::Recv, m_tuning.bufferSize);
+                m_freeReceiveContexts.push_back(context.get());
+                m_receiveContextPool.push_back(std::move(context));
+            }
+
+            std::lock_guard<std::mutex> lock(m_sendPoolMutex);
+            m_sendContextPool.reserve(SEND_POOL_MAX_SIZE);
+            m_freeSendContexts.reserve(SEND_POOL_MAX_SIZE);
+            GrowSendContextPool(SEND_POOL_INITIAL_SIZE);
+            });
+        RF_NETWORK_DEBUG("Receive context pool initialized with {} contexts of {} bytes (cap {}).",
+            poolSize, m_tuning.bufferSize, m_tuning.ResolveReceivePoolMax());
+        RF_NETWORK_DEBUG("Send context pool initialized with {} contexts.", SEND_POOL_INITIAL_SIZE);
 
         return true;
     }
@@ -86,6 +137,21 @@ namespace RiftNet::Networking {
         }
         m_isRunning = true;
 
+        if (!m_shards.empty()) {
+            m_shardsRunning = true;
+            try {
+                for (uint32_t i = 0; i < m_shards.size(); ++i) {
+                    m_shards[i]->thread = std::thread(&WinSocketIO::ShardThread, this, m_shards[i].get(), i);
+                }
+            }
+            catch (const std::system_error& e) {
+                RF_NETWORK_CRITICAL("Failed to create receive shard thread: {}", e.what());
+                Stop();
+                return false;
+            }
+            RF_NETWORK_INFO("WinSocketIO dispatching receives to {} shard threads.", m_shards.size());
+        }
+
         RF_NETWORK_INFO("WinSocketIO started. Posting initial receive requests.");
 
         int postedCount = 0;
@@ -117,16 +183,35 @@ namespace RiftNet::Networking {
         if (m_iocpManager) {
             m_iocpManager->Stop();
         }
+
+        // The IOCP workers are gone, so nothing is queued on the shards past this point
+        StopShards();
     }
 
     bool WinSocketIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
         if (!m_isRunning || data == nullptr) return false;
 
-        auto sendContext = new OverlappedIOContext(IOOperationType::Send, size);
+        auto sendContext = GetFreeSendContext(size);
         memcpy(sendContext->buffer.data(), data, size);
-        sendContext->wsaBuf.len = size;
+        return PostSend(sendContext, recipient);
+    }
+
+    bool WinSocketIO::SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) {
+        if (!m_isRunning || !buffer || buffer->Empty()) return false;
+
+        // The context only provides the OVERLAPPED; WSASendTo reads straight from the shared buffer.
+        auto sendContext = GetFreeSendContext(0);
+        sendContext->sendBuffer = buffer;
+        sendContext->wsaBuf.buf = reinterpret_cast<char*>(buffer->Data());
+        sendContext->wsaBuf.len = buffer->Size();
+        return PostSend(sendContext, recipient);
+    }
+
+    bool WinSocketIO::PostSend(OverlappedIOContext* sendContext, const NetworkEndpoint& recipient) {
         sendContext->endpoint = recipient;
         sendContext->remoteAddrNative = recipient.ToSockAddr();
+        const ULONG size = sendContext->wsaBuf.len;
+        sendContext->postedAt = std::chrono::steady_clock::now();
 
         DWORD bytesSent = 0;
         int result = WSASendTo(
@@ -138,13 +223,13 @@ namespace RiftNet::Networking {
         if (result == SOCKET_ERROR) {
             int error = WSAGetLastError();
             if (error != WSA_IO_PENDING) {
-                RF_NETWORK_ERROR("WSASendTo to {} failed immediately. Error: {}", recipient.ToString(), error);
-                delete sendContext;
+                RF_NETWORK_ERROR("WSASendTo to {} failed immediately. Error: {}", recipient, error);
+                ReturnSendContext(sendContext);
                 return false;
             }
         }
 
-        RF_NETWORK_TRACE("Posted send of {} bytes to {}.", size, recipient.ToString());
+        RF_NETWORK_TRACE("Posted send of {} bytes to {}.", size, recipient);
         return true;
     }
 
@@ -152,37 +237,122 @@ namespace RiftNet::Networking {
         return m_isRunning;
     }
 
+    uint64_t WinSocketIO::GetSendHeapFallbackCount() const {
+        return m_sendHeapFallbacks.load(std::memory_order_relaxed);
+    }
+
+    IOStats WinSocketIO::GetStats() const {
+        IOStats stats;
+        stats.receivePoolExhausted = m_receivePoolExhausted.load(std::memory_order_relaxed);
+        stats.sendPoolExhausted = GetSendHeapFallbackCount();
+        stats.sendCompletionLatency = m_sendCompletionLatency.Snapshot();
+        return stats;
+    }
+
+    void WinSocketIO::OnIOBatchCompleted(const IOCompletion* completions, ULONG count) {
+        for (ULONG i = 0; i < count; ++i) {
+            OnIOCompleted(completions[i].context, completions[i].bytesTransferred);
+        }
+    }
+
     void WinSocketIO::OnIOCompleted(OverlappedIOContext* context, DWORD bytesTransferred) {
         if (!m_isRunning) {
-            if (context->operationType == IOOperationType::Send) delete context;
+            if (context->operationType == IOOperationType::Send) ReturnSendContext(context);
             return;
         }
 
         switch (context->operationType) {
         case IOOperationType::Recv: {
-            if (bytesTransferred > 0) {
-                context->endpoint = NetworkEndpoint(context->remoteAddrNative);
-                RF_NETWORK_TRACE("Received {} bytes from {}.", bytesTransferred, context->endpoint.ToString());
-                m_eventHandler->OnRawDataReceived(
-                    context->endpoint, (const uint8_t*)context->buffer.data(), bytesTransferred, context
-                );
-            }
-            // Always re-post the receive, even on 0-byte reads or errors, to keep listening.
-            PostReceive(context);
+            const uint32_t stillPosted = m_receivesPosted.fetch_sub(1, std::memory_order_acq_rel) - 1;
+            if (stillPosted < (std::max)(m_tuning.receivePoolSize / 4, 1u)) {
+                GrowReceives();
+            }
+            if (bytesTransferred > 0 && !m_shards.empty()) {
+                DispatchToShard(context, bytesTransferred);
+                break;
+            }
+            DeliverReceive(context, bytesTransferred);
             break;
         }
         case IOOperationType::Send: {
-            RF_NETWORK_TRACE("Send to {} completed, success: {}, bytes: {}.", context->endpoint.ToString(), bytesTransferred > 0, bytesTransferred);
+            RF_NETWORK_TRACE("Send to {} completed, success: {}, bytes: {}.", context->endpoint, bytesTransferred > 0, bytesTransferred);
+            m_sendCompletionLatency.Record(std::chrono::steady_clock::now() - context->postedAt);
             m_eventHandler->OnSendCompleted(context, bytesTransferred > 0, bytesTransferred);
-            delete context; // Send contexts are heap-allocated per-operation.
+            ReturnSendContext(context);
             break;
         }
         default:
-            RF_NETWORK_WARN("Unhandled IOOperationType in OnIOCompleted.");
+            RF_NETWORK_WARN_LIMITED("Unhandled IOOperationType in OnIOCompleted.");
             break;
         }
     }
 
+    void WinSocketIO::DeliverReceive(OverlappedIOContext* context, DWORD bytesTransferred) {
+        if (bytesTransferred > 0 && m_isRunning) {
+            context->endpoint = NetworkEndpoint(context->remoteAddrNative);
+            RF_NETWORK_TRACE("Received {} bytes from {}.", bytesTransferred, context->endpoint);
+            m_eventHandler->OnRawDataReceived(
+                context->endpoint, reinterpret_cast<uint8_t*>(context->buffer.data()), bytesTransferred, context
+            );
+        }
+        // Always re-post the receive, even on 0-byte reads or errors, to keep listening.
+        PostReceive(context);
+    }
+
+    void WinSocketIO::DispatchToShard(OverlappedIOContext* context, DWORD bytesTransferred) {
+        context->endpoint = NetworkEndpoint(context->remoteAddrNative);
+        ReceiveShard& shard = *m_shards[std::hash<NetworkEndpoint>{}(context->endpoint) % m_shards.size()];
+        context->wsaBuf.len = bytesTransferred; // ResetForReceive restores it before the re-post
+
+        bool wasEmpty = false;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            wasEmpty = shard.queue.empty();
+            shard.queue.push_back(context);
+        }
+        // A non-empty queue means the shard is already awake draining it
+        if (wasEmpty) {
+            shard.ready.notify_one();
+        }
+    }
+
+    void WinSocketIO::ShardThread(ReceiveShard* shard, uint32_t index) {
+        m_shardThreadConfig.ApplyToCurrentThread(index);
+
+        std::vector<OverlappedIOContext*> batch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(shard->mutex);
+                shard->ready.wait(lock, [&] { return !shard->queue.empty() || !m_shardsRunning; });
+                if (shard->queue.empty()) break;
+                batch.swap(shard->queue);
+            }
+            for (OverlappedIOContext* context : batch) {
+                DeliverReceive(context, context->wsaBuf.len);
+            }
+            batch.clear();
+        }
+    }
+
+    void WinSocketIO::StopShards() {
+        if (!m_shardsRunning.exchange(false)) {
+            return;
+        }
+        for (auto& shard : m_shards) {
+            {
+                // Orders the flag change against a shard that is between its predicate check and its wait
+                std::lock_guard<std::mutex> lock(shard->mutex);
+            }
+            shard->ready.notify_all();
+        }
+        for (auto& shard : m_shards) {
+            if (shard->thread.joinable()) {
+                shard->thread.join();
+            }
+        }
+        RF_NETWORK_DEBUG("All receive shard threads have stopped.");
+    }
+
     bool WinSocketIO::PostReceive(OverlappedIOContext* context) {
         if (!m_isRunning) {
             ReturnReceiveContext(context);
@@ -192,6 +362,7 @@ namespace RiftNet::Networking {
         context->ResetForReceive();
         DWORD flags = 0;
         DWORD bytesReceived = 0;
+        m_receivesPosted.fetch_add(1, std::memory_order_acq_rel); // before the post: it may complete at once
 
         int result = WSARecvFrom(
             m_socket, &context->wsaBuf, 1, &bytesReceived, &flags,
@@ -202,6 +373,7 @@ namespace RiftNet::Networking {
         if (result == SOCKET_ERROR) {
             int error = WSAGetLastError();
             if (error != WSA_IO_PENDING) {
+                m_receivesPosted.fetch_sub(1, std::memory_order_acq_rel);
                 if (m_isRunning) {
                     RF_NETWORK_ERROR("WSARecvFrom failed immediately. Error: {}", error);
                 }
@@ -215,8 +387,11 @@ namespace RiftNet::Networking {
     OverlappedIOContext* WinSocketIO::GetFreeReceiveContext() {
         std::lock_guard<std::mutex> lock(m_poolMutex);
         if (m_freeReceiveContexts.empty()) {
-            RF_NETWORK_WARN("Receive context pool is empty. Allocating a new context.");
-            auto new_context = std::make_unique<OverlappedIOContext>(IOOperationType::Recv);
+            if (m_receiveContextPool.size() >= m_tuning.ResolveReceivePoolMax()) {
+                m_receivePoolExhausted.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            auto new_context = std::make_unique<OverlappedIOContext>(IOOperationType::Recv, m_tuning.bufferSize);
             auto* ptr = new_context.get();
             m_receiveContextPool.push_back(std::move(new_context));
             return ptr;
@@ -226,9 +401,76 @@ namespace RiftNet::Networking {
         return context;
     }
 
+    void WinSocketIO::GrowReceives() {
+        if (!m_isRunning || m_receivesGrowing.exchange(true, std::memory_order_acq_rel)) {
+            return; // another worker is already topping up
+        }
+
+        uint32_t posted = 0;
+        while (posted < m_tuning.receivePoolSize) {
+            OverlappedIOContext* context = GetFreeReceiveContext();
+            if (!context || !PostReceive(context)) break;
+            ++posted;
+        }
+        m_receivesGrowing.store(false, std::memory_order_release);
+
+        if (posted == 0) {
+            RF_NETWORK_WARN_LIMITED("Receive context pool is at its cap of {}; receives are running short.",
+                m_tuning.ResolveReceivePoolMax());
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        RF_NETWORK_DEBUG("Receive context pool grown to {} contexts.", m_receiveContextPool.size());
+    }
+
     void WinSocketIO::ReturnReceiveContext(OverlappedIOContext* context) {
         std::lock_guard<std::mutex> lock(m_poolMutex);
         m_freeReceiveContexts.push_back(context);
     }
 
+    OverlappedIOContext* WinSocketIO::GetFreeSendContext(uint32_t size) {
+        if (size <= m_tuning.bufferSize) {
+            std::lock_guard<std::mutex> lock(m_sendPoolMutex);
+            if (m_freeSendContexts.empty() && m_sendContextPool.size() < SEND_POOL_MAX_SIZE) {
+                GrowSendContextPool(SEND_POOL_GROW_STEP);
+            }
+            if (!m_freeSendContexts.empty()) {
+                OverlappedIOContext* context = m_freeSendContexts.back();
+                m_freeSendContexts.pop_back();
+                context->ResetForSend(size);
+                return context;
+            }
+        }
+
+        // Oversized payload or pool exhausted at its cap: one-off heap context.
+        const uint64_t fallbacks = m_sendHeapFallbacks.fetch_add(1, std::memory_order_relaxed) + 1;
+        RF_NETWORK_DEBUG("Send context pool fallback to heap ({} bytes, {} total fallbacks).", size, fallbacks);
+        auto* context = new OverlappedIOContext(IOOperationType::Send, size);
+        context->ResetForSend(size);
+        return context;
+    }
+
+    void WinSocketIO::ReturnSendContext(OverlappedIOContext* context) {
+        context->sendBuffer.reset();
+        if (!context->isPooled) {
+            delete context;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_sendPoolMutex);
+        m_freeSendContexts.push_back(context);
+    }
+
+    void WinSocketIO::GrowSendContextPool(size_t count) {
+        const size_t target = (std::min)(m_sendContextPool.size() + count, SEND_POOL_MAX_SIZE);
+        while (m_sendContextPool.size() < target) {
+            auto context = std::make_unique<OverlappedIOContext>(IOOperationType::Send, m_tuning.bufferSize);
+            context->isPooled = true;
+            m_freeSendContexts.push_back(context.get());
+            m_sendContextPool.push_back(std::move(context));
+        }
+        RF_NETWORK_DEBUG("Send context pool grown to {} contexts.", m_sendContextPool.size());
+    }
+
 } // namespace RiftNet::Networking
+
+#endif // defined(_WIN32)
@@ -1,25 +1,47 @@
 #pragma once
 
+#if defined(_WIN32)
+
 #include "../networkio/INetworkIO.hpp"
 #include "../networkio/INetworkIOEvents.hpp"
+#include "../threadconfig/ThreadConfig.hpp"
 // Removed the include for IOCPManager.hpp from the header
 
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace RiftNet::Networking {
 
     // Forward declaration: Tells the compiler this class exists without needing its full definition.
     class IOCPManager;
+    struct IOCompletion;
 
     /**
      * @class WinSocketIO / RiftNetIO
      * @brief A Windows-specific implementation of the INetworkIO interface using IOCP.
+     *
+     * By default a receive is handed to the event handler on whichever IOCP worker dequeued it,
+     * so two datagrams from one peer can be processed at once. With receive shards, each peer
+     * endpoint hashes to one of N shard threads instead: its datagrams are handled one at a
+     * time, in arrival order, and peers on different shards run in parallel.
+     *
+     * Every receive context is kept posted. When completions leave fewer than a quarter of
+     * SocketTuning::receivePoolSize posted (shard threads behind, say), another step of contexts
+     * is allocated and posted, up to the pool's cap.
      */
     class WinSocketIO : public INetworkIO { // Or class RiftNetIO if you renamed it
     public:
-        WinSocketIO();
+        /**
+         * @param receiveShards 0 = deliver receives on the IOCP workers; else the number of shard
+         *        threads receives are dispatched to by source endpoint.
+         * @param threads Placement of the IOCP workers and shard threads; with a NUMA node set, the
+         *        context pools are allocated on that node too.
+         * @param tuning Receive pool size and cap, context buffer size and socket buffer sizes.
+         */
+        explicit WinSocketIO(uint32_t receiveShards = 0, Threading::ThreadConfig threads = {}, SocketTuning tuning = {});
         virtual ~WinSocketIO() override;
 
         // --- INetworkIO Interface Implementation ---
@@ -27,25 +49,74 @@ namespace RiftNet::Networking {
         bool Start() override;
         void Stop() override;
         bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+        bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) override;
         bool IsRunning() const override;
+        IOStats GetStats() const override;
+
+        /**
+         * @brief Number of sends that could not be served from the send context pool
+         * (oversized payload or pool at its hard cap) and fell back to a heap allocation.
+         */
+        uint64_t GetSendHeapFallbackCount() const;
 
     private:
+        // Receive contexts queued for one shard thread; the context's wsaBuf.len holds the datagram size.
+        struct ReceiveShard {
+            std::mutex mutex;
+            std::condition_variable ready;
+            std::vector<OverlappedIOContext*> queue;
+            std::thread thread;
+        };
+
         /**
          * @brief The callback function passed to the IOCPManager.
-         * This is where completed I/O operations land.
+         * Each dequeued batch of completed I/O operations lands here.
+         */
+        void OnIOBatchCompleted(const IOCompletion* completions, ULONG count);
+
+        /**
+         * @brief Handles a single completed I/O operation from a batch.
          */
         void OnIOCompleted(OverlappedIOContext* context, DWORD bytesTransferred);
 
+        /**
+         * @brief Hands a received datagram to the event handler and re-posts its context.
+         */
+        void DeliverReceive(OverlappedIOContext* context, DWORD bytesTransferred);
+
+        /**
+         * @brief Queues a completed receive on the shard its sender hashes to.
+         */
+        void DispatchToShard(OverlappedIOContext* context, DWORD bytesTransferred);
+        void ShardThread(ReceiveShard* shard, uint32_t index);
+        void StopShards();
+
         /**
          * @brief Posts a receive request to the IOCP.
          */
         bool PostReceive(OverlappedIOContext* context);
 
+        /**
+         * @brief Posts a prepared send context (wsaBuf already set) to the given recipient.
+         */
+        bool PostSend(OverlappedIOContext* context, const NetworkEndpoint& recipient);
+
         /**
          * @brief Manages the pool of OverlappedIOContext objects for receiving data.
+         * GetFreeReceiveContext allocates a new context if none is free, or returns nullptr at the cap.
          */
         OverlappedIOContext* GetFreeReceiveContext();
         void ReturnReceiveContext(OverlappedIOContext* context);
+        // Posts another receivePoolSize contexts, as far as the cap allows, once few are left posted.
+        void GrowReceives();
+
+        /**
+         * @brief Manages the pool of fixed-size OverlappedIOContext objects for sending data.
+         * The pool grows in steps under load; beyond its cap, contexts come from the heap.
+         */
+        OverlappedIOContext* GetFreeSendContext(uint32_t size);
+        void ReturnSendContext(OverlappedIOContext* context);
+        void GrowSendContextPool(size_t count); // Caller must hold m_sendPoolMutex.
 
         SOCKET m_socket = INVALID_SOCKET;
         INetworkIOEvents* m_eventHandler = nullptr;
@@ -59,6 +130,26 @@ namespace RiftNet::Networking {
         std::vector<std::unique_ptr<OverlappedIOContext>> m_receiveContextPool;
         std::vector<OverlappedIOContext*> m_freeReceiveContexts;
         std::mutex m_poolMutex;
+        std::atomic<uint64_t> m_receivePoolExhausted{ 0 }; // receive contexts refused at the pool's cap
+        std::atomic<uint32_t> m_receivesPosted{ 0 }; // handed to WSARecvFrom and not yet completed
+        std::atomic<bool>     m_receivesGrowing{ false };
+        SocketTuning m_tuning;
+
+        // Context pooling for send operations; mirrors the receive pool above.
+        std::vector<std::unique_ptr<OverlappedIOContext>> m_sendContextPool;
+        std::vector<OverlappedIOContext*> m_freeSendContexts;
+        std::mutex m_sendPoolMutex;
+        std::atomic<uint64_t> m_sendHeapFallbacks{ 0 };
+        Metrics::LatencyHistogram m_sendCompletionLatency;
+
+        Threading::ThreadConfig m_threadConfig;
+        Threading::ThreadConfig m_shardThreadConfig; // same placement, named apart from the IOCP workers
+
+        // Empty unless constructed with receive shards
+        std::vector<std::unique_ptr<ReceiveShard>> m_shards;
+        std::atomic<bool> m_shardsRunning = false;
     };
 
 } // namespace RiftNet::Networking
+
+#endif // defined(_WIN32)
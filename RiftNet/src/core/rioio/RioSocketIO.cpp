@@ -0,0 +1,490 @@
+#include "pch.h"
+
+#if defined(_WIN32)
+
+#include "RioSocketIO.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+#include <WS2tcpip.h> // For inet_pton
+
+#include <array>
+
+using namespace RiftNet::Logging;
+
+#pragma comment(lib, "Ws2_32.lib")
+
+namespace RiftNet::Networking {
+
+    namespace {
+        // Every slot holds one datagram; matches the IOCP backend's receive buffer size.
+        constexpr uint32_t RIO_SLOT_SIZE = DEFAULT_IOCP_UDP_BUFFER_SIZE;
+        constexpr uint32_t RIO_RECEIVE_SLOT_COUNT = 1024;
+        constexpr uint32_t RIO_SEND_SLOT_COUNT = 1024;
+        constexpr ULONG RIO_DEQUEUE_BATCH = 256;
+        constexpr DWORD RIO_WAIT_TIMEOUT_MS = 100;
+
+        // Request contexts carry the slot index; the low bit tells sends from receives.
+        constexpr ULONG_PTR REQUEST_SEND_FLAG = 1;
+        inline PVOID MakeRequestContext(uint32_t slot, bool isSend) {
+            return reinterpret_cast<PVOID>((static_cast<ULONG_PTR>(slot) << 1) | (isSend ? REQUEST_SEND_FLAG : 0));
+        }
+
+        // The send batch open on this thread: sends to owner are deferred until its outermost EndSendBatch.
+        struct SendBatchState {
+            const RioSocketIO* owner = nullptr;
+            uint32_t depth = 0;
+            bool pending = false; // a deferred send is waiting for the commit
+        };
+        thread_local SendBatchState t_sendBatch;
+    }
+
+    RioSocketIO::RioSocketIO(Threading::ThreadConfig threads, SocketTuning tuning)
+        : m_threadConfig(std::move(threads)), m_tuning(tuning) {
+        // Initialize Winsock
+        WSADATA wsaData;
+        int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+        if (result != 0) {
+            // This is a catastrophic failure, throwing is appropriate.
+            throw std::runtime_error("WSAStartup failed with error: " + std::to_string(result));
+        }
+    }
+
+    RioSocketIO::~RioSocketIO() {
+        Stop();
+        ReleaseResources();
+        // Cleanup Winsock
+        WSACleanup();
+    }
+
+    bool RioSocketIO::Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) {
+        if (m_socket != INVALID_SOCKET) {
+            return true;
+        }
+
+        m_eventHandler = eventHandler;
+        if (!m_eventHandler) {
+            RF_NETWORK_CRITICAL("RioSocketIO cannot be initialized with a null event handler.");
+            return false;
+        }
+
+        RF_NETWORK_INFO("Initializing RioSocketIO on {}:{}", listenIp, listenPort);
+
+        m_socket = WSASocket(AF_INET, SOCK_DGRAM, IPPROTO_UDP, NULL, 0, WSA_FLAG_REGISTERED_IO);
+        if (m_socket == INVALID_SOCKET) {
+            RF_NETWORK_CRITICAL("Failed to create RIO socket. Error: {}", WSAGetLastError());
+            return false;
+        }
+
+        // Oversized datagrams are dropped rather than IP-fragmented, so path MTU probes mean something
+        DWORD dontFragment = TRUE;
+        if (setsockopt(m_socket, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&dontFragment), sizeof(dontFragment)) == SOCKET_ERROR) {
+            RF_NETWORK_WARN("Failed to set IP_DONTFRAGMENT. Error: {}", WSAGetLastError());
+        }
+
+        if (m_tuning.socketReceiveBuffer != 0) {
+            const int bytes = static_cast<int>(m_tuning.socketReceiveBuffer);
+            if (setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes)) == SOCKET_ERROR) {
+                RF_NETWORK_WARN("Failed to set SO_RCVBUF to {}. Error: {}", bytes, WSAGetLastError());
+            }
+        }
+        if (m_tuning.socketSendBuffer != 0) {
+            const int bytes = static_cast<int>(m_tuning.socketSendBuffer);
+            if (setsockopt(m_socket, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bytes), sizeof(bytes)) == SOCKET_ERROR) {
+                RF_NETWORK_WARN("Failed to set SO_SNDBUF to {}. Error: {}", bytes, WSAGetLastError());
+            }
+        }
+
+        sockaddr_in localAddr{};
+        localAddr.sin_family = AF_INET;
+        localAddr.sin_port = htons(listenPort);
+        inet_pton(AF_INET, listenIp.c_str(), &localAddr.sin_addr);
+
+        if (bind(m_socket, (SOCKADDR*)&localAddr, sizeof(localAddr)) == SOCKET_ERROR) {
+            RF_NETWORK_CRITICAL("Failed to bind socket to port {}. Error: {}", listenPort, WSAGetLastError());
+            ReleaseResources();
+            return false;
+        }
+
+        if (!LoadRioFunctionTable()) {
+            ReleaseResources();
+            return false;
+        }
+
+        if (!AllocateSlab(m_receiveSlab, RIO_RECEIVE_SLOT_COUNT) || !AllocateSlab(m_sendSlab, RIO_SEND_SLOT_COUNT)) {
+            ReleaseResources();
+            return false;
+        }
+
+        m_completionEvent = WSACreateEvent();
+        if (m_completionEvent == WSA_INVALID_EVENT) {
+            RF_NETWORK_CRITICAL("Failed to create RIO completion event. Error: {}", WSAGetLastError());
+            ReleaseResources();
+            return false;
+        }
+
+        RIO_NOTIFICATION_COMPLETION notification{};
+        notification.Type = RIO_EVENT_COMPLETION;
+        notification.Event.EventHandle = m_completionEvent;
+        notification.Event.NotifyReset = TRUE;
+
+        m_completionQueue = m_rio.RIOCreateCompletionQueue(RIO_RECEIVE_SLOT_COUNT + RIO_SEND_SLOT_COUNT, &notification);
+        if (m_completionQueue == RIO_INVALID_CQ) {
+            RF_NETWORK_CRITICAL("RIOCreateCompletionQueue failed. Error: {}", WSAGetLastError());
+            ReleaseResources();
+            return false;
+        }
+
+        m_requestQueue = m_rio.RIOCreateRequestQueue(
+            m_socket,
+            RIO_RECEIVE_SLOT_COUNT, 1,
+            RIO_SEND_SLOT_COUNT, 1,
+            m_completionQueue, m_completionQueue, nullptr);
+        if (m_requestQueue == RIO_INVALID_RQ) {
+            RF_NETWORK_CRITICAL("RIOCreateRequestQueue failed. Error: {}", WSAGetLastError());
+            ReleaseResources();
+            return false;
+        }
+
+        m_sendPostedAt = std::vector<std::atomic<std::chrono::steady_clock::rep>>(RIO_SEND_SLOT_COUNT);
+        {
+            std::lock_guard<std::mutex> lock(m_sendSlotMutex);
+            m_freeSendSlots.reserve(RIO_SEND_SLOT_COUNT);
+            for (uint32_t slot = RIO_SEND_SLOT_COUNT; slot > 0; --slot) {
+                m_freeSendSlots.push_back(slot - 1);
+            }
+        }
+
+        RF_NETWORK_DEBUG("RIO initialized: {} receive slots, {} send slots of {} bytes.",
+            RIO_RECEIVE_SLOT_COUNT, RIO_SEND_SLOT_COUNT, RIO_SLOT_SIZE);
+        return true;
+    }
+
+    bool RioSocketIO::Start() {
+        if (m_isRunning) {
+            return true;
+        }
+        if (m_requestQueue == RIO_INVALID_RQ) {
+            RF_NETWORK_ERROR("RioSocketIO::Start called before a successful Init.");
+            return false;
+        }
+        m_isRunning = true;
+
+        RF_NETWORK_INFO("RioSocketIO started. Posting initial receive requests.");
+
+        int postedCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_requestQueueMutex);
+            for (uint32_t slot = 0; slot < RIO_RECEIVE_SLOT_COUNT; ++slot) {
+                if (PostReceive(slot, RIO_MSG_DEFER)) {
+                    postedCount++;
+                }
+            }
+            m_rio.RIOReceive(m_requestQueue, nullptr, 0, RIO_MSG_COMMIT_ONLY, nullptr);
+        }
+        RF_NETWORK_DEBUG("Posted {} initial receive requests.", postedCount);
+
+        if (postedCount == 0) {
+            m_isRunning = false;
+            return false;
+        }
+
+        m_completionThread = std::jthread([this](std::stop_token st) { CompletionThread(st); });
+        return true;
+    }
+
+    void RioSocketIO::Stop() {
+        if (!m_isRunning.exchange(false)) {
+            return;
+        }
+
+        RF_NETWORK_INFO("RioSocketIO stopping...");
+
+        if (m_completionThread.joinable()) {
+            m_completionThread.request_stop();
+            WSASetEvent(m_completionEvent);
+            m_completionThread.join();
+        }
+
+        if (m_socket != INVALID_SOCKET) {
+            closesocket(m_socket);
+            m_socket = INVALID_SOCKET;
+            m_requestQueue = RIO_INVALID_RQ; // Owned by the socket.
+        }
+    }
+
+    bool RioSocketIO::SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        if (!m_isRunning || data == nullptr) return false;
+        return PostSend(recipient, data, size);
+    }
+
+    bool RioSocketIO::SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) {
+        if (!m_isRunning || !buffer || buffer->Empty()) return false;
+
+        // RIO can only transmit from registered memory, so the view is copied into a send slot
+        // rather than registering every packet buffer.
+        return PostSend(recipient, buffer->Data(), buffer->Size());
+    }
+
+    bool RioSocketIO::IsRunning() const {
+        return m_isRunning;
+    }
+
+    uint64_t RioSocketIO::GetSendSlotExhaustedCount() const {
+        return m_sendSlotsExhausted.load(std::memory_order_relaxed);
+    }
+
+    IOStats RioSocketIO::GetStats() const {
+        IOStats stats;
+        stats.sendPoolExhausted = GetSendSlotExhaustedCount();
+        stats.sendCompletionLatency = m_sendCompletionLatency.Snapshot();
+        return stats;
+    }
+
+    bool RioSocketIO::LoadRioFunctionTable() {
+        GUID functionTableId = WSAID_MULTIPLE_RIO;
+        DWORD bytes = 0;
+        m_rio.cbSize = sizeof(m_rio);
+
+        if (WSAIoctl(m_socket, SIO_GET_MULTIPLE_EXTENSION_FUNCTION_POINTER,
+                &functionTableId, sizeof(functionTableId),
+                &m_rio, sizeof(m_rio), &bytes, nullptr, nullptr) == SOCKET_ERROR) {
+            RF_NETWORK_CRITICAL("Registered I/O is not available. Error: {}", WSAGetLastError());
+            return false;
+        }
+        return true;
+    }
+
+    bool RioSocketIO::AllocateSlab(RioSlab& slab, uint32_t slotCount) {
+        slab.slotCount = slotCount;
+        slab.size = static_cast<size_t>(slotCount) * (RIO_SLOT_SIZE + sizeof(SOCKADDR_INET));
+        slab.base = static_cast<char*>(m_threadConfig.numaNode >= 0
+            ? VirtualAllocExNuma(GetCurrentProcess(), nullptr, slab.size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE,
+                static_cast<DWORD>(m_threadConfig.numaNode))
+            : VirtualAlloc(nullptr, slab.size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        if (!slab.base) {
+            RF_NETWORK_CRITICAL("Failed to allocate {} byte RIO slab. Error: {}", slab.size, GetLastError());
+            return false;
+        }
+
+        slab.bufferId = m_rio.RIORegisterBuffer(slab.base, static_cast<DWORD>(slab.size));
+        if (slab.bufferId == RIO_INVALID_BUFFERID) {
+            RF_NETWORK_CRITICAL("RIORegisterBuffer failed for {} byte slab. Error: {}", slab.size, WSAGetLastError());
+            FreeSlab(slab);
+            return false;
+        }
+        return true;
+    }
+
+    void RioSocketIO::FreeSlab(RioSlab& slab) {
+        if (slab.bufferId != RIO_INVALID_BUFFERID) {
+            m_rio.RIODeregisterBuffer(slab.bufferId);
+            slab.bufferId = RIO_INVALID_BUFFERID;
+        }
+        if (slab.base) {
+            VirtualFree(slab.base, 0, MEM_RELEASE);
+            slab.base = nullptr;
+        }
+        slab.size = 0;
+        slab.slotCount = 0;
+    }
+
+    RIO_BUF RioSocketIO::DataBuf(const RioSlab& slab, uint32_t slot, ULONG length) const {
+        RIO_BUF buf{};
+        buf.BufferId = slab.bufferId;
+        buf.Offset = slot * RIO_SLOT_SIZE;
+        buf.Length = length;
+        return buf;
+    }
+
+    RIO_BUF RioSocketIO::AddressBuf(const RioSlab& slab, uint32_t slot) const {
+        RIO_BUF buf{};
+        buf.BufferId = slab.bufferId;
+        buf.Offset = static_cast<ULONG>(slab.slotCount * RIO_SLOT_SIZE + slot * sizeof(SOCKADDR_INET));
+        buf.Length = sizeof(SOCKADDR_INET);
+        return buf;
+    }
+
+    SOCKADDR_INET* RioSocketIO::AddressAt(const RioSlab& slab, uint32_t slot) const {
+        return reinterpret_cast<SOCKADDR_INET*>(slab.base + AddressBuf(slab, slot).Offset);
+    }
+
+    bool RioSocketIO::PostReceive(uint32_t slot, DWORD flags) {
+        RIO_BUF data = DataBuf(m_receiveSlab, slot, RIO_SLOT_SIZE);
+        RIO_BUF remote = AddressBuf(m_receiveSlab, slot);
+
+        if (!m_rio.RIOReceiveEx(m_requestQueue, &data, 1, nullptr, &remote, nullptr, nullptr,
+                flags, MakeRequestContext(slot, false))) {
+            if (m_isRunning) {
+                RF_NETWORK_ERROR("RIOReceiveEx failed for slot {}. Error: {}", slot, WSAGetLastError());
+            }
+            return false;
+        }
+        return true;
+    }
+
+    void RioSocketIO::BeginSendBatch() {
+        if (t_sendBatch.owner == nullptr) {
+            t_sendBatch.owner = this;
+            t_sendBatch.pending = false;
+        }
+        if (t_sendBatch.owner == this) {
+            ++t_sendBatch.depth;
+        }
+    }
+
+    void RioSocketIO::EndSendBatch() {
+        if (t_sendBatch.owner != this || --t_sendBatch.depth != 0) {
+            return;
+        }
+        t_sendBatch.owner = nullptr;
+        if (!t_sendBatch.pending) {
+            return;
+        }
+        // A send from another thread may already have committed these; committing twice is harmless
+        std::lock_guard<std::mutex> lock(m_requestQueueMutex);
+        if (!m_rio.RIOSendEx(m_requestQueue, nullptr, 0, nullptr, nullptr, nullptr, nullptr, RIO_MSG_COMMIT_ONLY, nullptr)) {
+            RF_NETWORK_ERROR("RIOSendEx commit failed. Error: {}", WSAGetLastError());
+        }
+    }
+
+    bool RioSocketIO::PostSend(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) {
+        if (size > RIO_SLOT_SIZE) {
+            RF_NETWORK_ERROR("RioSocketIO: send of {} bytes exceeds the {} byte slot size.", size, RIO_SLOT_SIZE);
+            return false;
+        }
+
+        uint32_t slot = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_sendSlotMutex);
+            if (m_freeSendSlots.empty()) {
+                m_sendSlotsExhausted.fetch_add(1, std::memory_order_relaxed);
+                RF_NETWORK_WARN_LIMITED("RioSocketIO: all {} send slots in flight; dropping send to {}.",
+                    RIO_SEND_SLOT_COUNT, recipient);
+                return false;
+            }
+            slot = m_freeSendSlots.back();
+            m_freeSendSlots.pop_back();
+        }
+
+        memcpy(m_sendSlab.base + static_cast<size_t>(slot) * RIO_SLOT_SIZE, data, size);
+        SOCKADDR_INET* address = AddressAt(m_sendSlab, slot);
+        ZeroMemory(address, sizeof(SOCKADDR_INET));
+        address->Ipv4 = recipient.ToSockAddr();
+
+        RIO_BUF payload = DataBuf(m_sendSlab, slot, size);
+        RIO_BUF remote = AddressBuf(m_sendSlab, slot);
+        m_sendPostedAt[slot].store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+        const bool deferred = (t_sendBatch.owner == this);
+        BOOL posted = FALSE;
+        {
+            std::lock_guard<std::mutex> lock(m_requestQueueMutex);
+            posted = m_rio.RIOSendEx(m_requestQueue, &payload, 1, nullptr, &remote, nullptr, nullptr,
+                deferred ? RIO_MSG_DEFER : 0, MakeRequestContext(slot, true));
+        }
+        if (posted && deferred) {
+            t_sendBatch.pending = true;
+        }
+
+        if (!posted) {
+            RF_NETWORK_ERROR("RIOSendEx to {} failed. Error: {}", recipient, WSAGetLastError());
+            std::lock_guard<std::mutex> lock(m_sendSlotMutex);
+            m_freeSendSlots.push_back(slot);
+            return false;
+        }
+
+        RF_NETWORK_TRACE("Posted RIO send of {} bytes to {}.", size, recipient);
+        return true;
+    }
+
+    void RioSocketIO::CompletionThread(std::stop_token stopToken) {
+        m_threadConfig.ApplyToCurrentThread(0);
+        std::vector<RIORESULT> results(RIO_DEQUEUE_BATCH);
+
+        while (!stopToken.stop_requested()) {
+            const ULONG count = m_rio.RIODequeueCompletion(m_completionQueue, results.data(), RIO_DEQUEUE_BATCH);
+            if (count == RIO_CORRUPT_CQ) {
+                RF_NETWORK_CRITICAL("RIO completion queue is corrupt; stopping completion thread.");
+                m_eventHandler->OnNetworkError("RIO completion queue corrupt");
+                break;
+            }
+
+            if (count == 0) {
+                // Queue drained: arm the notification and sleep until more completions arrive.
+                m_rio.RIONotify(m_completionQueue);
+                WaitForSingleObject(m_completionEvent, RIO_WAIT_TIMEOUT_MS);
+                continue;
+            }
+
+            ProcessCompletions(results.data(), count);
+        }
+    }
+
+    void RioSocketIO::ProcessCompletions(const RIORESULT* results, ULONG count) {
+        std::array<uint32_t, RIO_DEQUEUE_BATCH> receiveSlots;
+        ULONG receiveCount = 0;
+
+        for (ULONG i = 0; i < count; ++i) {
+            const RIORESULT& result = results[i];
+            const uint32_t slot = static_cast<uint32_t>(result.RequestContext >> 1);
+
+            if (result.RequestContext & REQUEST_SEND_FLAG) {
+                // Read before the slot is freed and reused; deferred sends count their wait for the commit
+                const std::chrono::steady_clock::time_point postedAt(
+                    std::chrono::steady_clock::duration(m_sendPostedAt[slot].load(std::memory_order_relaxed)));
+                m_sendCompletionLatency.Record(std::chrono::steady_clock::now() - postedAt);
+                {
+                    std::lock_guard<std::mutex> lock(m_sendSlotMutex);
+                    m_freeSendSlots.push_back(slot);
+                }
+                if (m_isRunning) {
+                    m_eventHandler->OnSendCompleted(nullptr, result.Status == 0, result.BytesTransferred);
+                }
+                continue;
+            }
+
+            if (m_isRunning && result.Status == 0 && result.BytesTransferred > 0) {
+                const SOCKADDR_INET* address = AddressAt(m_receiveSlab, slot);
+                NetworkEndpoint sender(address->Ipv4);
+                uint8_t* data = reinterpret_cast<uint8_t*>(m_receiveSlab.base + static_cast<size_t>(slot) * RIO_SLOT_SIZE);
+                RF_NETWORK_TRACE("Received {} bytes from {}.", result.BytesTransferred, sender);
+                m_eventHandler->OnRawDataReceived(sender, data, result.BytesTransferred, nullptr);
+            }
+
+            receiveSlots[receiveCount++] = slot;
+        }
+
+        // Always re-post the receives, even on 0-byte reads or errors, to keep listening.
+        // They are deferred and committed together so the whole batch costs one kernel transition.
+        if (receiveCount > 0 && m_isRunning) {
+            std::lock_guard<std::mutex> lock(m_requestQueueMutex);
+            for (ULONG i = 0; i < receiveCount; ++i) {
+                PostReceive(receiveSlots[i], RIO_MSG_DEFER);
+            }
+            m_rio.RIOReceive(m_requestQueue, nullptr, 0, RIO_MSG_COMMIT_ONLY, nullptr);
+        }
+    }
+
+    void RioSocketIO::ReleaseResources() {
+        if (m_socket != INVALID_SOCKET) {
+            closesocket(m_socket);
+            m_socket = INVALID_SOCKET;
+            m_requestQueue = RIO_INVALID_RQ;
+        }
+        if (m_completionQueue != RIO_INVALID_CQ) {
+            m_rio.RIOCloseCompletionQueue(m_completionQueue);
+            m_completionQueue = RIO_INVALID_CQ;
+        }
+        if (m_completionEvent != WSA_INVALID_EVENT) {
+            WSACloseEvent(m_completionEvent);
+            m_completionEvent = WSA_INVALID_EVENT;
+        }
+        FreeSlab(m_receiveSlab);
+        FreeSlab(m_sendSlab);
+
+        std::lock_guard<std::mutex> lock(m_sendSlotMutex);
+        m_freeSendSlots.clear();
+    }
+
+} // namespace RiftNet::Networking
+
+#endif // defined(_WIN32)
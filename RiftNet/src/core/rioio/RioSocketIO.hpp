@@ -0,0 +1,112 @@
+#pragma once
+
+#if defined(_WIN32)
+
+#include "../networkio/INetworkIO.hpp"
+#include "../networkio/INetworkIOEvents.hpp"
+#include "../threadconfig/ThreadConfig.hpp"
+
+#include <WinSock2.h>
+#include <MSWSock.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RiftNet::Networking {
+
+    /**
+     * @class RioSocketIO
+     * @brief A Windows-specific implementation of the INetworkIO interface using Registered I/O.
+     * Receive and send buffers live in two slabs that are registered with RIO once at Init.
+     * A single completion thread drains the RIO completion queue in batches with
+     * RIODequeueCompletion and re-posts receives deferred, committing them once per batch.
+     * Event handlers are called on that thread with a null OverlappedIOContext.
+     * The thread is placed like worker 0 of the given ThreadConfig, and with a NUMA node set
+     * both slabs are allocated on that node.
+     * Sends made between BeginSendBatch and EndSendBatch are posted deferred and committed
+     * to the kernel with one call at the end of the batch.
+     * Of SocketTuning only the socket buffer sizes apply; the registered slabs are fixed-size.
+     */
+    class RioSocketIO : public INetworkIO {
+    public:
+        explicit RioSocketIO(Threading::ThreadConfig threads = {}, SocketTuning tuning = {});
+        virtual ~RioSocketIO() override;
+
+        // --- INetworkIO Interface Implementation ---
+        bool Init(const std::string& listenIp, uint16_t listenPort, INetworkIOEvents* eventHandler) override;
+        bool Start() override;
+        void Stop() override;
+        bool SendData(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size) override;
+        bool SendData(const NetworkEndpoint& recipient, const PacketBufferPtr& buffer) override;
+        void BeginSendBatch() override;
+        void EndSendBatch() override;
+        bool IsRunning() const override;
+        IOStats GetStats() const override;
+
+        /**
+         * @brief Number of sends dropped because every registered send slot was in flight.
+         */
+        uint64_t GetSendSlotExhaustedCount() const;
+
+    private:
+        // A registered region holding `slotCount` data slots followed by as many SOCKADDR_INET slots.
+        struct RioSlab {
+            char* base = nullptr;
+            size_t size = 0;
+            RIO_BUFFERID bufferId = RIO_INVALID_BUFFERID;
+            uint32_t slotCount = 0;
+        };
+
+        bool LoadRioFunctionTable();
+        bool AllocateSlab(RioSlab& slab, uint32_t slotCount);
+        void FreeSlab(RioSlab& slab);
+
+        RIO_BUF DataBuf(const RioSlab& slab, uint32_t slot, ULONG length) const;
+        RIO_BUF AddressBuf(const RioSlab& slab, uint32_t slot) const;
+        SOCKADDR_INET* AddressAt(const RioSlab& slab, uint32_t slot) const;
+
+        /**
+         * @brief Posts one receive slot. Caller must hold m_requestQueueMutex.
+         */
+        bool PostReceive(uint32_t slot, DWORD flags);
+
+        /**
+         * @brief Copies the payload into a free registered send slot and posts it.
+         */
+        bool PostSend(const NetworkEndpoint& recipient, const uint8_t* data, uint32_t size);
+
+        void CompletionThread(std::stop_token stopToken);
+        void ProcessCompletions(const RIORESULT* results, ULONG count);
+        void ReleaseResources();
+
+        SOCKET m_socket = INVALID_SOCKET;
+        INetworkIOEvents* m_eventHandler = nullptr;
+
+        RIO_EXTENSION_FUNCTION_TABLE m_rio{};
+        RIO_CQ m_completionQueue = RIO_INVALID_CQ;
+        RIO_RQ m_requestQueue = RIO_INVALID_RQ;
+        WSAEVENT m_completionEvent = WSA_INVALID_EVENT;
+        std::mutex m_requestQueueMutex; // RIO request queues are not thread-safe
+
+        RioSlab m_receiveSlab;
+        RioSlab m_sendSlab;
+        std::vector<uint32_t> m_freeSendSlots;
+        std::mutex m_sendSlotMutex;
+        std::atomic<uint64_t> m_sendSlotsExhausted{ 0 };
+        std::vector<std::atomic<std::chrono::steady_clock::rep>> m_sendPostedAt; // per send slot, for the latency histogram
+        Metrics::LatencyHistogram m_sendCompletionLatency;
+
+        Threading::ThreadConfig m_threadConfig;
+        SocketTuning m_tuning;
+
+        std::atomic<bool> m_isRunning = false;
+        std::jthread m_completionThread;
+    };
+
+} // namespace RiftNet::Networking
+
+#endif // defined(_WIN32)
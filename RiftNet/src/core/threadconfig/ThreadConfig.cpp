@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "ThreadConfig.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <bit>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace RiftNet::Threading {
+
+    namespace {
+#if defined(_WIN32)
+        // The processors the config allows, in the group of its NUMA node (group 0 without one)
+        bool ResolveAffinity(const ThreadConfig& config, GROUP_AFFINITY& out) {
+            out = {};
+            if (config.numaNode >= 0) {
+                if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(config.numaNode), &out)) {
+                    RF_NETWORK_WARN("ThreadConfig: unknown NUMA node {} (error {}); threads stay unpinned",
+                        config.numaNode, GetLastError());
+                    return false;
+                }
+                if (config.coreMask != 0) {
+                    out.Mask &= static_cast<ULONG_PTR>(config.coreMask);
+                }
+            }
+            else {
+                out.Mask = static_cast<ULONG_PTR>(config.coreMask);
+            }
+            return out.Mask != 0;
+        }
+
+        // The n-th set bit of mask, counting from the lowest and wrapping around
+        ULONG_PTR NthCore(ULONG_PTR mask, uint32_t n) {
+            n %= static_cast<uint32_t>(std::popcount(static_cast<uint64_t>(mask)));
+            while (n-- > 0) {
+                mask &= mask - 1;
+            }
+            return mask & (~mask + 1);
+        }
+#elif defined(__linux__)
+        // The first 64 CPUs the config allows, from the node's sysfs cpulist ("0-3,8-11")
+        uint64_t ResolveAffinity(const ThreadConfig& config) {
+            if (config.numaNode < 0) {
+                return config.coreMask;
+            }
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(config.numaNode) + "/cpulist");
+            uint64_t mask = 0;
+            std::string range;
+            while (std::getline(file, range, ',')) {
+                const size_t dash = range.find('-');
+                const unsigned long first = std::stoul(range.substr(0, dash));
+                const unsigned long last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+                for (unsigned long cpu = first; cpu <= last && cpu < 64; ++cpu) {
+                    mask |= 1ull << cpu;
+                }
+            }
+            if (mask == 0) {
+                RF_NETWORK_WARN("ThreadConfig: unknown NUMA node {}; threads stay unpinned", config.numaNode);
+                return 0;
+            }
+            return config.coreMask != 0 ? mask & config.coreMask : mask;
+        }
+
+        // The n-th set bit of mask, counting from the lowest and wrapping around
+        uint64_t NthCore(uint64_t mask, uint32_t n) {
+            n %= static_cast<uint32_t>(std::popcount(mask));
+            while (n-- > 0) {
+                mask &= mask - 1;
+            }
+            return mask & (~mask + 1);
+        }
+#endif
+    }
+
+    uint32_t ThreadConfig::ResolveThreadCount() const {
+        if (threadCount > 0) {
+            return threadCount;
+        }
+#if defined(_WIN32)
+        GROUP_AFFINITY affinity;
+        if ((coreMask != 0 || numaNode >= 0) && ResolveAffinity(*this, affinity)) {
+            return static_cast<uint32_t>(std::popcount(static_cast<uint64_t>(affinity.Mask)));
+        }
+#elif defined(__linux__)
+        if (coreMask != 0 || numaNode >= 0) {
+            if (const uint64_t mask = ResolveAffinity(*this)) {
+                return static_cast<uint32_t>(std::popcount(mask));
+            }
+        }
+#endif
+        const unsigned int cores = std::thread::hardware_concurrency();
+        return (cores > 0) ? cores : 4; // Default to 4 if hardware_concurrency is not available.
+    }
+
+    void ThreadConfig::ApplyToCurrentThread(uint32_t index) const {
+#if defined(_WIN32)
+        GROUP_AFFINITY affinity;
+        if ((coreMask != 0 || numaNode >= 0) && ResolveAffinity(*this, affinity)) {
+            // With a core mask each thread gets its own core; a node alone only bounds where threads run
+            if (coreMask != 0) {
+                affinity.Mask = NthCore(affinity.Mask, index);
+            }
+            if (!SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr)) {
+                RF_NETWORK_WARN("ThreadConfig: SetThreadGroupAffinity failed for worker {} (error {})", index, GetLastError());
+            }
+        }
+
+        if (priority != THREAD_PRIORITY_NORMAL && !SetThreadPriority(GetCurrentThread(), priority)) {
+            RF_NETWORK_WARN("ThreadConfig: SetThreadPriority({}) failed for worker {} (error {})", priority, index, GetLastError());
+        }
+
+        if (!name.empty()) {
+            const std::string full = name + " " + std::to_string(index);
+            const std::wstring wide(full.begin(), full.end()); // names are ASCII
+            SetThreadDescription(GetCurrentThread(), wide.c_str());
+        }
+#elif defined(__linux__)
+        if (coreMask != 0 || numaNode >= 0) {
+            if (uint64_t mask = ResolveAffinity(*this)) {
+                if (coreMask != 0) {
+                    mask = NthCore(mask, index);
+                }
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (int cpu = 0; cpu < 64; ++cpu) {
+                    if (mask & (1ull << cpu)) CPU_SET(cpu, &cpus);
+                }
+                if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) {
+                    RF_NETWORK_WARN("ThreadConfig: pthread_setaffinity_np failed for worker {} (error {})", index, error);
+                }
+            }
+        }
+
+        // Windows priorities have no unprivileged equivalent here; threads keep the default policy
+
+        if (!name.empty()) {
+            const std::string full = name + " " + std::to_string(index);
+            pthread_setname_np(pthread_self(), full.substr(0, 15).c_str()); // the kernel limit is 15 characters
+        }
+#else
+        (void)index;
+#endif
+    }
+
+    void ThreadConfig::RunOnNode(const std::function<void()>& fn) const {
+        if (numaNode < 0 && coreMask == 0) {
+            fn();
+            return;
+        }
+        std::thread placed([&] {
+            ApplyToCurrentThread(0);
+            fn();
+            });
+        placed.join();
+    }
+
+} // namespace RiftNet::Threading
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace RiftNet::Threading {
+
+    /**
+     * @struct ThreadConfig
+     * @brief Placement of a pool's worker threads, shared by IOCPManager and TaskThreadPool.
+     * Default-constructed, a pool runs one unpinned, normal-priority thread per core.
+     */
+    struct ThreadConfig {
+        uint32_t    threadCount = 0; // 0 = one per allowed core
+        uint64_t    coreMask = 0;    // 0 = any core; else thread i runs on the i-th set bit (wrapping)
+        int32_t     numaNode = -1;   // -1 = any node; else threads (and coreMask) are confined to this node
+        int         priority = 0;    // THREAD_PRIORITY_* passed to SetThreadPriority (Windows only); 0 = normal
+        std::string name;            // Thread i is named "<name> <i>"; empty = left unnamed
+
+        /**
+         * @brief threadCount, or the number of cores the mask and node allow, or hardware_concurrency.
+         */
+        uint32_t ResolveThreadCount() const;
+
+        /**
+         * @brief Pins, prioritizes and names the calling thread as worker `index` of this pool.
+         * Failures are logged and leave the thread as it was; they never stop the pool.
+         */
+        void ApplyToCurrentThread(uint32_t index) const;
+
+        /**
+         * @brief Runs fn on a temporary thread placed like worker 0 and waits for it.
+         * Memory fn first touches is then allocated on this config's NUMA node.
+         */
+        void RunOnNode(const std::function<void()>& fn) const;
+    };
+
+} // namespace RiftNet::Threading
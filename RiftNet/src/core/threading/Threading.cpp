@@ -1,8 +1,7 @@
     #include "pch.h"// File: ThreadPool.cpp
-#include "threading.hpp"
+#include "Threading.hpp"
 #include <iostream>
 #include <stdexcept> // For std::runtime_error
-#include <optional>  // For std::optional (Improvement #7)
 
 // Platform-specific includes for thread naming (Improvement #6)
 #if defined(__linux__)
@@ -17,24 +16,165 @@
 namespace RiftNet {
     namespace Threading {
 
+        namespace {
+            constexpr uint32_t TASK_NODE_POOL_SIZE = 4096; // posts beyond this many pending tasks allocate
+            constexpr uint32_t IDLE_SPIN_ROUNDS = 128;     // empty scans before a worker parks
+
+            ThreadConfig DefaultConfig(size_t numThreads) {
+                ThreadConfig config;
+                config.threadCount = static_cast<uint32_t>(numThreads);
+                config.name = "PoolWorker";
+                return config;
+            }
+
+            // The worker running on this thread, so its own posts go to its own deque
+            struct WorkerSlot {
+                const TaskThreadPool* pool = nullptr;
+                uint32_t index = 0;
+            };
+            thread_local WorkerSlot t_worker;
+
+            inline void CpuRelax() {
+#if defined(_WIN32)
+                YieldProcessor();
+#else
+                std::this_thread::yield();
+#endif
+            }
+
+            inline void DiscardTask(TaskNode* node) {
+                node->discard(*node);
+            }
+        }
+
+        // --- WorkDeque (Chase-Lev, after Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models") ---
+
+        bool TaskThreadPool::WorkDeque::push(TaskNode* node) {
+            const int64_t b = bottom_.load(std::memory_order_relaxed);
+            const int64_t t = top_.load(std::memory_order_acquire);
+            if (b - t >= kCapacity) {
+                return false;
+            }
+            slots_[b & (kCapacity - 1)].store(node, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_release); // publishes the node to thieves' acquire of bottom_
+            return true;
+        }
+
+        TaskNode* TaskThreadPool::WorkDeque::pop() {
+            const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top_.load(std::memory_order_relaxed);
+
+            if (t > b) { // empty
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            TaskNode* node = slots_[b & (kCapacity - 1)].load(std::memory_order_relaxed);
+            if (t == b) {
+                // Last task: race the thieves for it
+                if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    node = nullptr;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+            return node;
+        }
+
+        TaskNode* TaskThreadPool::WorkDeque::steal() {
+            int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b) {
+                return nullptr;
+            }
+            TaskNode* node = slots_[t & (kCapacity - 1)].load(std::memory_order_relaxed);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr; // another thief (or the owner) got it
+            }
+            return node;
+        }
+
+        // --- InjectionQueue (Vyukov bounded MPMC) ---
+
+        TaskThreadPool::InjectionQueue::InjectionQueue()
+            : cells_(std::make_unique<Cell[]>(kCapacity)) {
+            for (size_t i = 0; i < kCapacity; ++i) {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool TaskThreadPool::InjectionQueue::push(TaskNode* node) {
+            size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells_[pos & (kCapacity - 1)];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return false; // full
+                }
+                else {
+                    pos = enqueuePos_.load(std::memory_order_relaxed);
+                }
+            }
+            cell->node = node;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        TaskNode* TaskThreadPool::InjectionQueue::pop() {
+            size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells_[pos & (kCapacity - 1)];
+                const size_t seq = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0) {
+                    if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    return nullptr; // empty
+                }
+                else {
+                    pos = dequeuePos_.load(std::memory_order_relaxed);
+                }
+            }
+            TaskNode* node = cell->node;
+            cell->sequence.store(pos + kCapacity, std::memory_order_release);
+            return node;
+        }
+
+        // --- TaskThreadPool ---
+
         // Constructor
         TaskThreadPool::TaskThreadPool(size_t numThreads)
+            : TaskThreadPool(DefaultConfig(numThreads)) {
+        }
+
+        TaskThreadPool::TaskThreadPool(const ThreadConfig& config)
             // stop_ and paused_ are initialized by their in-class initializers in the header.
+            : nodes_(std::make_unique<TaskNode[]>(TASK_NODE_POOL_SIZE)),
+              threadCount_(config.ResolveThreadCount()), config_(config)
         {
-            if (numThreads == 0) {
-                threadCount_ = std::thread::hardware_concurrency();
-                if (threadCount_ == 0) { // Ensure at least one thread
-                    threadCount_ = 1;
-                }
+            for (uint32_t i = 0; i < TASK_NODE_POOL_SIZE; ++i) {
+                nodes_[i].pooled = true;
+                nodes_[i].next.store(i + 1 < TASK_NODE_POOL_SIZE ? i + 2 : 0, std::memory_order_relaxed);
             }
-            else {
-                threadCount_ = numThreads;
+            freeHead_.store(1, std::memory_order_relaxed);
+
+            deques_.reserve(threadCount_);
+            for (size_t i = 0; i < threadCount_; ++i) {
+                deques_.push_back(std::make_unique<WorkDeque>());
             }
 
             workers_.reserve(threadCount_); // Pre-allocate memory
             for (size_t i = 0; i < threadCount_; ++i) {
                 // Improvement #2: Cleaner thread creation
-                workers_.emplace_back(&TaskThreadPool::worker_loop, this);
+                workers_.emplace_back(&TaskThreadPool::worker_loop, this, static_cast<uint32_t>(i));
             }
         }
 
@@ -45,22 +185,16 @@ namespace RiftNet {
 
         // Signal threads to stop, wait for current tasks to complete, and join threads.
         void TaskThreadPool::stop() {
-            // Improvement #1: Simplified and safer stop logic
-            bool already_stopped = stop_.exchange(true); // Atomically set stop_ to true and get old value
-            if (already_stopped) {
-                // If stop() was already called and threads are joining/joined,
-                // we might just return or ensure joining is complete.
-                // The loop below will attempt to join, joinable() handles if already joined.
-            }
-
-            condition_.notify_all(); // Wake up all worker threads
+            stop_.store(true, std::memory_order_release);
+            wakeAll(); // Wake up all worker threads
 
             for (std::thread& worker : workers_) {
                 if (worker.joinable()) {
                     worker.join(); // Wait for the thread to finish
                 }
             }
-            // All threads are joined here.
+            // All threads are joined here; drop anything posted while they were draining.
+            clearQueue();
         }
 
         // Pause task processing
@@ -74,15 +208,32 @@ namespace RiftNet {
         void TaskThreadPool::resume() {
             // Improvement #3: Resume functionality
             paused_.store(false);
-            condition_.notify_all(); // Notify threads that they can resume processing
+            wakeAll(); // Notify threads that they can resume processing
         }
 
         // Clear all pending tasks from the queue
         void TaskThreadPool::clearQueue() {
-            // Improvement #4: Clear queue functionality
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            // Improvement #5: tasks_ is std::deque, which has clear()
-            tasks_.clear();
+            // Stealing is safe from any thread, so this can run alongside the workers
+            for (auto& deque : deques_) {
+                while (TaskNode* node = deque->steal()) {
+                    DiscardTask(node);
+                    releaseNode(node);
+                }
+            }
+            while (TaskNode* node = injected_.pop()) {
+                DiscardTask(node);
+                releaseNode(node);
+            }
+            std::deque<TaskNode*> overflow;
+            {
+                std::lock_guard<std::mutex> lock(overflowMutex_);
+                overflow.swap(overflow_);
+                overflowSize_.store(0, std::memory_order_relaxed);
+            }
+            for (TaskNode* node : overflow) {
+                DiscardTask(node);
+                releaseNode(node);
+            }
         }
 
         // Get the number of worker threads in the pool
@@ -90,57 +241,141 @@ namespace RiftNet {
             return threadCount_;
         }
 
+        TaskNode* TaskThreadPool::acquireNode() {
+            uint64_t head = freeHead_.load(std::memory_order_acquire);
+            while (true) {
+                const uint32_t index = static_cast<uint32_t>(head);
+                if (index == 0) {
+                    // Free list empty: more tasks pending than the pool holds
+                    return new TaskNode();
+                }
+                TaskNode& node = nodes_[index - 1];
+                const uint64_t tag = (head >> 32) + 1;
+                const uint64_t next = (tag << 32) | node.next.load(std::memory_order_relaxed);
+                if (freeHead_.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+                    return &node;
+                }
+            }
+        }
+
+        void TaskThreadPool::releaseNode(TaskNode* node) {
+            if (!node->pooled) {
+                delete node;
+                return;
+            }
+            const uint64_t index = static_cast<uint64_t>(node - nodes_.get()) + 1;
+            uint64_t head = freeHead_.load(std::memory_order_relaxed);
+            uint64_t next;
+            do {
+                node->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+                next = (((head >> 32) + 1) << 32) | index;
+            } while (!freeHead_.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        bool TaskThreadPool::submit(TaskNode* node) {
+            const bool onWorker = (t_worker.pool == this);
+            if (!(onWorker && deques_[t_worker.index]->push(node)) && !injected_.push(node)) {
+                std::lock_guard<std::mutex> lock(overflowMutex_);
+                overflow_.push_back(node);
+                overflowSize_.fetch_add(1, std::memory_order_relaxed);
+            }
+            wakeOne();
+            return true;
+        }
+
+        TaskNode* TaskThreadPool::findTask(uint32_t index, uint32_t& stealFrom) {
+            if (TaskNode* node = deques_[index]->pop()) return node;
+            if (TaskNode* node = injected_.pop()) return node;
+
+            if (overflowSize_.load(std::memory_order_relaxed) != 0) {
+                std::lock_guard<std::mutex> lock(overflowMutex_);
+                if (!overflow_.empty()) {
+                    TaskNode* node = overflow_.front();
+                    overflow_.pop_front();
+                    overflowSize_.fetch_sub(1, std::memory_order_relaxed);
+                    return node;
+                }
+            }
+
+            // Rotate the first victim so thieves spread over the other workers
+            const uint32_t count = static_cast<uint32_t>(deques_.size());
+            for (uint32_t i = 0; i < count; ++i) {
+                const uint32_t victim = (stealFrom + i) % count;
+                if (victim == index) continue;
+                if (TaskNode* node = deques_[victim]->steal()) {
+                    stealFrom = victim;
+                    return node;
+                }
+            }
+            stealFrom = (stealFrom + 1) % count;
+            return nullptr;
+        }
+
+        void TaskThreadPool::runTask(TaskNode* node) {
+            node->run(*node);
+            releaseNode(node);
+        }
+
+        void TaskThreadPool::wakeOne() {
+            // Pairs with the fence a parking worker issues after counting itself in sleepers_
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers_.load(std::memory_order_relaxed) != 0) {
+                wakeEpoch_.fetch_add(1, std::memory_order_release);
+                wakeEpoch_.notify_one();
+            }
+        }
+
+        void TaskThreadPool::wakeAll() {
+            wakeEpoch_.fetch_add(1, std::memory_order_release);
+            wakeEpoch_.notify_all();
+        }
+
         // Worker function that each thread will execute
-        void TaskThreadPool::worker_loop() {
-            // Improvement #6: Thread Naming
+        void TaskThreadPool::worker_loop(uint32_t index) {
+            // Improvement #6: Thread Naming (SetThreadDescription on Windows, with affinity and priority)
 #if defined(__linux__)
             pthread_setname_np(pthread_self(), "PoolWorker");
 #elif defined(__APPLE__)
             pthread_setname_np("PoolWorker");
-#elif defined(_WIN32)
-    // HRESULT hr = SetThreadDescription(GetCurrentThread(), L"PoolWorker");
-    // Note: SetThreadDescription is preferred but requires newer Windows SDK.
-    // As a fallback or for wider compatibility, thread naming might be skipped on Windows
-    // or use older techniques if necessary. For simplicity, we'll use a comment here.
-    // Consider how to handle errors or if wide char names are needed.
 #endif
+            config_.ApplyToCurrentThread(index);
+            t_worker = { this, index };
 
+            uint32_t stealFrom = index + 1;
+            uint32_t idleRounds = 0;
             while (true) {
-                std::optional<std::function<void()>> task_opt; // Improvement #7
-
-                { // Lock scope for accessing the tasks queue
-                    std::unique_lock<std::mutex> lock(queueMutex_);
-
-                    // Improvement #3: Wait condition updated for pause functionality
-                    // Improvement #7: stop_ and paused_ are atomic, use .load() for clarity
-                    condition_.wait(lock, [this] {
-                        return this->stop_.load() || (!this->paused_.load() && !this->tasks_.empty());
-                        });
-
-                    // If stop_ is true AND the queue is empty, then exit the loop.
-                    // This check is after the wait, ensuring tasks are drained if stop_ was signaled.
-                    if (this->stop_.load() && this->tasks_.empty()) {
-                        return; // Exit the worker loop
+                // While paused, only a stop gets workers going again, and then they drain the queues
+                const bool paused = paused_.load() && !stop_.load(std::memory_order_acquire);
+                if (!paused) {
+                    if (TaskNode* node = findTask(index, stealFrom)) {
+                        runTask(node);
+                        idleRounds = 0;
+                        continue;
                     }
-
-                    // If paused, or (not stopping and queue is empty), continue waiting
-                    // This specific condition is largely handled by the wait predicate,
-                    // but an explicit check after wake-up can be useful.
-                    // However, the current predicate should be sufficient.
-
-                    // Improvement #5: tasks_ is std::deque
-                    // Improvement #7: Minimized lock duration
-                    if (!this->paused_.load() && !this->tasks_.empty()) {
-                        task_opt = std::move(this->tasks_.front()); // Get task
-                        this->tasks_.pop_front();                   // Remove from deque
+                    if (stop_.load(std::memory_order_acquire)) {
+                        break; // stopping and nothing left
+                    }
+                    if (++idleRounds < IDLE_SPIN_ROUNDS) {
+                        CpuRelax();
+                        continue;
                     }
-                } // Mutex is released here (critical for Improvement #7)
+                }
+                idleRounds = 0;
 
-                // If a task was successfully dequeued, execute it outside the lock.
-                if (task_opt) {
-                    (*task_opt)(); // Execute the task
+                // Park: count ourselves in, then look once more, so a post either sees us or we see it
+                const uint32_t epoch = wakeEpoch_.load(std::memory_order_acquire);
+                sleepers_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                TaskNode* node = paused ? nullptr : findTask(index, stealFrom);
+                if (!node && !stop_.load(std::memory_order_acquire)) {
+                    wakeEpoch_.wait(epoch, std::memory_order_acquire);
+                }
+                sleepers_.fetch_sub(1, std::memory_order_relaxed);
+                if (node) {
+                    runTask(node);
                 }
             }
+            t_worker = {};
         }
     }
-}
\ No newline at end of file
+}
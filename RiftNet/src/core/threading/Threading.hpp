@@ -1,8 +1,20 @@
 #ifndef TASK_THREAD_POOL_H
 #define TASK_THREAD_POOL_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../threadconfig/ThreadConfig.hpp"
 
 
 // Platform-specific includes for thread naming
@@ -18,21 +30,57 @@
 namespace RiftNet {
     namespace Threading {
 
+        /**
+         * @brief One unit of pool work: a callable stored in place, so posting it allocates nothing.
+         * Nodes come from the pool's free list and go back to it once run.
+         */
+        struct TaskNode {
+            static constexpr size_t kStorageSize = 48;
+
+            alignas(std::max_align_t) unsigned char storage[kStorageSize];
+            void (*run)(TaskNode&) = nullptr;     // invokes, then destroys, the stored callable
+            void (*discard)(TaskNode&) = nullptr; // destroys it without running it
+            std::atomic<uint32_t> next{ 0 };      // free-list link (index + 1; 0 ends the list)
+            bool pooled = false;                  // false: heap-allocated because the free list ran dry
+        };
+
+        /**
+         * @class TaskThreadPool
+         * @brief Work-stealing pool. Each worker owns a lock-free Chase-Lev deque: tasks a worker
+         * posts go on its own deque, tasks posted from other threads (IOCP workers, say) go through
+         * a shared lock-free queue, and an idle worker steals from the others before it spins
+         * briefly and then parks.
+         */
         class TaskThreadPool {
         public:
+            // Largest callable post() stores without allocating
+            static constexpr size_t kInlineTaskSize = TaskNode::kStorageSize;
+
             // Constructor: Initializes the thread pool with a specific number of threads
             // Defaults to the number of hardware concurrency units if numThreads is 0
             explicit TaskThreadPool(size_t numThreads = 0);
 
+            // Constructor: Runs config.ResolveThreadCount() workers, placed and named as config describes
+            explicit TaskThreadPool(const ThreadConfig& config);
+
             // Destructor: Gracefully shuts down the thread pool
             ~TaskThreadPool();
 
+            TaskThreadPool(const TaskThreadPool&) = delete;
+            TaskThreadPool& operator=(const TaskThreadPool&) = delete;
+
             // Enqueues a task (a function or lambda) to be executed by a worker thread.
             // Returns a std::future<ReturnType> so the caller can get the result if needed.
             template<class F, class... Args>
             auto enqueue(F&& f, Args&&... args)
                 -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+            // Fire-and-forget: runs f on a worker with no allocation and no future. f must fit in
+            // kInlineTaskSize bytes; an exception escaping it is discarded (use enqueue to see it).
+            // Returns false if the pool is stopping.
+            template<class F>
+            bool post(F&& f);
+
             // Call stop to signal threads to stop processing new tasks and finish current ones.
             // This is useful for initiating shutdown before the destructor is called.
             void stop();
@@ -50,20 +98,100 @@ namespace RiftNet {
             size_t getThreadCount() const;
 
         private:
+            // Chase-Lev deque: the owning worker pushes and pops at the bottom, thieves take from the top.
+            class WorkDeque {
+            public:
+                bool push(TaskNode* node); // owner only; false when full
+                TaskNode* pop();           // owner only
+                TaskNode* steal();         // any thread
+            private:
+                static constexpr int64_t kCapacity = 1024; // power of two
+                alignas(64) std::atomic<int64_t> top_{ 0 };
+                alignas(64) std::atomic<int64_t> bottom_{ 0 };
+                std::atomic<TaskNode*> slots_[kCapacity]{};
+            };
+
+            // Bounded multi-producer multi-consumer queue (Vyukov) for tasks posted from outside the pool.
+            class InjectionQueue {
+            public:
+                InjectionQueue();
+                bool push(TaskNode* node); // false when full
+                TaskNode* pop();
+            private:
+                static constexpr size_t kCapacity = 4096; // power of two
+                struct Cell {
+                    std::atomic<size_t> sequence;
+                    TaskNode* node;
+                };
+                alignas(64) std::atomic<size_t> enqueuePos_{ 0 };
+                alignas(64) std::atomic<size_t> dequeuePos_{ 0 };
+                std::unique_ptr<Cell[]> cells_;
+            };
+
             // Worker function that each thread will execute
-            void worker_loop();
+            void worker_loop(uint32_t index);
+
+            TaskNode* acquireNode();
+            void releaseNode(TaskNode* node);
+            bool submit(TaskNode* node);
+            TaskNode* findTask(uint32_t index, uint32_t& stealFrom);
+            void runTask(TaskNode* node);
+            void wakeOne();
+            void wakeAll();
 
             std::vector<std::thread> workers_;
-            std::deque<std::function<void()>> tasks_; // Changed from std::queue to std::deque
+            std::vector<std::unique_ptr<WorkDeque>> deques_; // one per worker
+            InjectionQueue injected_;
+
+            // Used only when the deques and the injection queue are all full
+            std::mutex overflowMutex_;
+            std::deque<TaskNode*> overflow_;
+            std::atomic<size_t> overflowSize_{ 0 };
+
+            // Free list of preallocated nodes; the head packs (index + 1) with an ABA tag
+            std::unique_ptr<TaskNode[]> nodes_;
+            std::atomic<uint64_t> freeHead_{ 0 };
+
+            // Idle workers park on wakeEpoch_; posters bump it only when someone is parked
+            std::atomic<uint32_t> sleepers_{ 0 };
+            std::atomic<uint32_t> wakeEpoch_{ 0 };
 
-            std::mutex queueMutex_;
-            std::condition_variable condition_;
             std::atomic<bool> stop_{ false };      // Initialized to false
             std::atomic<bool> paused_{ false };    // New: Flag to signal threads to pause, initialized
 
             size_t threadCount_; // Store the number of threads
+            ThreadConfig config_;  // Applied by each worker to itself as it starts
         };
 
+        // --- Template Implementation for post ---
+        template<class F>
+        bool TaskThreadPool::post(F&& f) {
+            using Callable = std::decay_t<F>;
+            static_assert(sizeof(Callable) <= TaskNode::kStorageSize, "callable too large for post(); use enqueue()");
+            static_assert(alignof(Callable) <= alignof(std::max_align_t), "callable over-aligned for post()");
+
+            if (stop_.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            TaskNode* node = acquireNode();
+            new (node->storage) Callable(std::forward<F>(f));
+            node->run = [](TaskNode& n) {
+                Callable* callable = std::launder(reinterpret_cast<Callable*>(n.storage));
+                try {
+                    (*callable)();
+                }
+                catch (...) {
+                    // Nowhere to report it; enqueue() carries exceptions through its future
+                }
+                callable->~Callable();
+            };
+            node->discard = [](TaskNode& n) {
+                std::launder(reinterpret_cast<Callable*>(n.storage))->~Callable();
+            };
+            return submit(node);
+        }
+
         // --- Template Implementation for enqueue ---
         template<class F, class... Args>
         auto TaskThreadPool::enqueue(F&& f, Args&&... args)
@@ -80,20 +208,10 @@ namespace RiftNet {
             // Get the future associated with the packaged_task.
             std::future<ReturnType> res = task->get_future();
 
-            { // Lock scope for queue access
-                std::unique_lock<std::mutex> lock(queueMutex_);
-
-                // Don't allow enqueueing after stopping
-                if (stop_.load()) { // Use .load() for atomic bool
-                    throw std::runtime_error("enqueue on stopped TaskThreadPool");
-                }
-
-                // Add the task to the queue.
-                tasks_.emplace_back([task]() { (*task)(); }); // Use emplace_back for deque
-            } // Mutex is released here
-
-            // Notify one waiting worker thread that a new task is available.
-            condition_.notify_one();
+            // Don't allow enqueueing after stopping
+            if (!post([task]() { (*task)(); })) {
+                throw std::runtime_error("enqueue on stopped TaskThreadPool");
+            }
             return res;
         }
 
@@ -0,0 +1,194 @@
+#include "pch.h"
+#include "TimerWheel.hpp"
+
+#include <bit>
+#include <limits>
+
+namespace RiftNet::Networking {
+
+    namespace {
+        constexpr uint64_t SLOT_MASK = TimerWheel::kSlotsPerLevel - 1;
+
+        // Ticks covered by all levels; deadlines further out are clamped to this horizon.
+        constexpr uint64_t WHEEL_HORIZON_TICKS = uint64_t{ 1 } << (TimerWheel::kSlotBits * TimerWheel::kLevels);
+
+        constexpr uint32_t LevelShift(uint32_t level) {
+            return level * TimerWheel::kSlotBits;
+        }
+    }
+
+    TimerWheel::TimerWheel(Clock::time_point start)
+        : m_start(start) {
+    }
+
+    uint64_t TimerWheel::ToTick(Clock::time_point t) const {
+        if (t <= m_start) return 0;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(t - m_start).count());
+    }
+
+    uint64_t TimerWheel::DeadlineTick(Clock::time_point deadline) const {
+        if (deadline <= m_start) return 0;
+        // Round up so a timer never fires before its deadline
+        return static_cast<uint64_t>(std::chrono::ceil<std::chrono::milliseconds>(deadline - m_start).count());
+    }
+
+    TimerWheel::Clock::time_point TimerWheel::FromTick(uint64_t tick) const {
+        return m_start + std::chrono::milliseconds(tick);
+    }
+
+    void TimerWheel::Schedule(Key key, Clock::time_point deadline) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ScheduleLocked(key, DeadlineTick(deadline));
+    }
+
+    bool TimerWheel::ScheduleNoLaterThan(Key key, Clock::time_point deadline) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uint64_t tick = DeadlineTick(deadline);
+        if (tick < m_currentTick) tick = m_currentTick;
+
+        if (auto it = m_timers.find(key); it != m_timers.end() && it->second.deadlineTick <= tick) {
+            return false;
+        }
+        ScheduleLocked(key, tick);
+        return true;
+    }
+
+    void TimerWheel::Cancel(Key key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timers.erase(key); // its slot entry is discarded when reached
+    }
+
+    void TimerWheel::ScheduleLocked(Key key, uint64_t deadlineTick) {
+        if (deadlineTick < m_currentTick) {
+            deadlineTick = m_currentTick;
+        }
+        if (deadlineTick - m_currentTick >= WHEEL_HORIZON_TICKS) {
+            deadlineTick = m_currentTick + WHEEL_HORIZON_TICKS - 1;
+        }
+
+        const uint64_t generation = m_nextGeneration++;
+        m_timers[key] = Timer{ deadlineTick, generation };
+        Insert(Entry{ key, generation }, deadlineTick);
+    }
+
+    void TimerWheel::Insert(const Entry& entry, uint64_t deadlineTick) {
+        const uint64_t delta = deadlineTick - m_currentTick;
+
+        uint32_t level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t{ 1 } << LevelShift(level + 1))) {
+            ++level;
+        }
+
+        const uint32_t slot = static_cast<uint32_t>((deadlineTick >> LevelShift(level)) & SLOT_MASK);
+        m_levels[level].slots[slot].push_back(entry);
+        m_levels[level].occupied |= uint64_t{ 1 } << slot;
+    }
+
+    void TimerWheel::Cascade(uint32_t level) {
+        Level& wheel = m_levels[level];
+        const uint32_t slot = static_cast<uint32_t>((m_currentTick >> LevelShift(level)) & SLOT_MASK);
+        if ((wheel.occupied & (uint64_t{ 1 } << slot)) == 0) return;
+
+        std::vector<Entry> entries;
+        entries.swap(wheel.slots[slot]);
+        wheel.occupied &= ~(uint64_t{ 1 } << slot);
+
+        for (const Entry& entry : entries) {
+            auto it = m_timers.find(entry.key);
+            if (it == m_timers.end() || it->second.generation != entry.generation) continue; // stale
+            Insert(entry, it->second.deadlineTick);
+        }
+
+        // Give the storage back so the slot does not reallocate next round
+        entries.clear();
+        if (wheel.slots[slot].empty()) wheel.slots[slot].swap(entries);
+    }
+
+    size_t TimerWheel::Advance(Clock::time_point now, std::vector<Key>& expired) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t nowTick = ToTick(now);
+        const size_t before = expired.size();
+
+        while (m_currentTick <= nowTick) {
+            if (m_timers.empty()) {
+                // Nothing live: drop stale entries and jump straight to now
+                for (Level& wheel : m_levels) {
+                    for (auto& slot : wheel.slots) slot.clear();
+                    wheel.occupied = 0;
+                }
+                m_currentTick = nowTick + 1;
+                break;
+            }
+
+            // Pull entries down from coarser levels whose slot starts at this tick, coarsest first
+            for (uint32_t level = kLevels - 1; level > 0; --level) {
+                if ((m_currentTick & ((uint64_t{ 1 } << LevelShift(level)) - 1)) == 0) {
+                    Cascade(level);
+                }
+            }
+
+            Level& wheel = m_levels[0];
+            const uint32_t slot = static_cast<uint32_t>(m_currentTick & SLOT_MASK);
+            if (wheel.occupied & (uint64_t{ 1 } << slot)) {
+                std::vector<Entry> entries;
+                entries.swap(wheel.slots[slot]);
+                wheel.occupied &= ~(uint64_t{ 1 } << slot);
+
+                for (const Entry& entry : entries) {
+                    auto it = m_timers.find(entry.key);
+                    if (it == m_timers.end() || it->second.generation != entry.generation) continue; // stale
+                    expired.push_back(entry.key);
+                    m_timers.erase(it);
+                }
+
+                entries.clear();
+                if (wheel.slots[slot].empty()) wheel.slots[slot].swap(entries);
+            }
+
+            ++m_currentTick;
+        }
+
+        return expired.size() - before;
+    }
+
+    TimerWheel::Clock::time_point TimerWheel::NextDeadline() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_timers.empty()) return Clock::time_point::max();
+
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (uint32_t level = 0; level < kLevels; ++level) {
+            const uint64_t occupied = m_levels[level].occupied;
+            if (occupied == 0) continue;
+
+            const uint32_t shift = LevelShift(level);
+            const uint64_t base = m_currentTick >> shift;
+            const bool aligned = level == 0 || (m_currentTick & ((uint64_t{ 1 } << shift) - 1)) == 0;
+
+            // Rotate so bit k is the slot k steps ahead of the hand
+            uint64_t ahead = std::rotr(occupied, static_cast<int>(base & SLOT_MASK));
+            uint64_t candidate = std::numeric_limits<uint64_t>::max();
+            if ((ahead & 1) && aligned) {
+                candidate = m_currentTick; // due at the current tick
+            }
+            else {
+                const bool wrapped = (ahead & 1) != 0; // current slot, but only next time around
+                ahead &= ~uint64_t{ 1 };
+                if (ahead) {
+                    candidate = (base + static_cast<uint64_t>(std::countr_zero(ahead))) << shift;
+                }
+                else if (wrapped) {
+                    candidate = (base + kSlotsPerLevel) << shift;
+                }
+            }
+            if (candidate < best) best = candidate;
+        }
+
+        return best == std::numeric_limits<uint64_t>::max() ? Clock::time_point::max() : FromTick(best);
+    }
+
+    size_t TimerWheel::Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_timers.size();
+    }
+
+} // namespace RiftNet::Networking
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace RiftNet::Networking {
+
+    /**
+     * @class TimerWheel
+     * @brief A hierarchical timing wheel holding at most one deadline per key.
+     * Four levels of 64 slots each at 1 ms resolution cover about 4.6 hours; later deadlines
+     * are clamped to the horizon. Scheduling and cancelling are O(1), and Advance only touches
+     * the slots that elapsed, so idle keys cost nothing until their deadline comes up.
+     * Rescheduled or cancelled entries are dropped lazily when their slot is reached.
+     * All methods are thread-safe.
+     */
+    class TimerWheel {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Key = uint64_t;
+
+        static constexpr uint32_t kSlotBits = 6;
+        static constexpr uint32_t kSlotsPerLevel = 1u << kSlotBits;
+        static constexpr uint32_t kLevels = 4;
+
+        explicit TimerWheel(Clock::time_point start = Clock::now());
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+
+        /**
+         * @brief Sets the deadline for key, replacing any earlier or later one.
+         */
+        void Schedule(Key key, Clock::time_point deadline);
+
+        /**
+         * @brief Sets the deadline for key unless it already has an earlier or equal one.
+         * @return True if the deadline was changed.
+         */
+        bool ScheduleNoLaterThan(Key key, Clock::time_point deadline);
+
+        void Cancel(Key key);
+
+        /**
+         * @brief Moves the wheel forward to now and appends every key whose deadline passed.
+         * Expired keys are removed; reschedule them to be woken again.
+         * @return The number of keys appended to expired.
+         */
+        size_t Advance(Clock::time_point now, std::vector<Key>& expired);
+
+        /**
+         * @brief A lower bound on the earliest pending deadline, or Clock::time_point::max() if none.
+         * May be early (stale entries, or a coarse slot that still needs cascading), never late.
+         */
+        Clock::time_point NextDeadline() const;
+
+        size_t Size() const;
+
+    private:
+        struct Entry {
+            Key key;
+            uint64_t generation;
+        };
+
+        struct Timer {
+            uint64_t deadlineTick;
+            uint64_t generation;
+        };
+
+        struct Level {
+            std::array<std::vector<Entry>, kSlotsPerLevel> slots;
+            uint64_t occupied = 0; // bit i set if slots[i] may hold entries
+        };
+
+        uint64_t ToTick(Clock::time_point t) const;       // rounds down
+        uint64_t DeadlineTick(Clock::time_point t) const; // rounds up
+        Clock::time_point FromTick(uint64_t tick) const;
+
+        void ScheduleLocked(Key key, uint64_t deadlineTick);
+        void Insert(const Entry& entry, uint64_t deadlineTick);
+        void Cascade(uint32_t level);
+
+        mutable std::mutex m_mutex;
+        Clock::time_point m_start;
+        uint64_t m_currentTick = 0; // next tick to be processed
+        uint64_t m_nextGeneration = 1;
+        std::array<Level, kLevels> m_levels;
+        std::unordered_map<Key, Timer> m_timers;
+    };
+
+} // namespace RiftNet::Networking
@@ -0,0 +1,51 @@
+#include "pch.h"
+#include "TuningConfig.hpp"
+
+namespace RiftNet::Tuning {
+
+    namespace {
+        std::chrono::milliseconds OrDefault(uint32_t ms, std::chrono::milliseconds fallback) {
+            return ms != 0 ? std::chrono::milliseconds(ms) : fallback;
+        }
+    }
+
+    bool IsValidTuning(const RiftTuningConfig* tuning) {
+        if (!tuning) return true;
+        if (tuning->version == 0 || tuning->version > RIFT_TUNING_VERSION) return false;
+        if (tuning->buffer_size != 0 && (tuning->buffer_size < kMinBufferSize || tuning->buffer_size > kMaxBufferSize)) return false;
+        return ResolveMinRto(*tuning) <= ResolveMaxRto(*tuning);
+    }
+
+    RiftTuningConfig CopyTuning(const RiftTuningConfig* tuning) {
+        RiftTuningConfig out{};
+        if (tuning) out = *tuning; // version 1 is the whole struct; later versions copy only their prefix
+        return out;
+    }
+
+    std::chrono::milliseconds ResolveIdleTimeout(const RiftTuningConfig& tuning) {
+        return OrDefault(tuning.idle_timeout_ms, kDefaultIdleTimeout);
+    }
+
+    std::chrono::milliseconds ResolveMaxUpdateInterval(const RiftTuningConfig& tuning) {
+        return OrDefault(tuning.max_update_interval_ms, kDefaultMaxUpdateInterval);
+    }
+
+    std::chrono::milliseconds ResolveMinRto(const RiftTuningConfig& tuning) {
+        return OrDefault(tuning.min_rto_ms, kDefaultMinRto);
+    }
+
+    std::chrono::milliseconds ResolveMaxRto(const RiftTuningConfig& tuning) {
+        return OrDefault(tuning.max_rto_ms, kDefaultMaxRto);
+    }
+
+    Networking::SocketTuning CopySocketTuning(const RiftTuningConfig& tuning) {
+        Networking::SocketTuning out;
+        if (tuning.receive_pool_size != 0) out.receivePoolSize = tuning.receive_pool_size;
+        out.receivePoolMax = tuning.receive_pool_max;
+        if (tuning.buffer_size != 0) out.bufferSize = tuning.buffer_size;
+        out.socketReceiveBuffer = tuning.socket_receive_buffer;
+        out.socketSendBuffer = tuning.socket_send_buffer;
+        return out;
+    }
+
+} // namespace RiftNet::Tuning
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../../../include/RiftNet/RiftCommon.hpp"
+#include "../networkio/INetworkIO.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace RiftNet::Tuning {
+
+    // What a RiftTuningConfig field left at zero stands for, on the server and the client alike
+    inline constexpr std::chrono::milliseconds kDefaultIdleTimeout{ 30000 };      // give RTT time to form; clients send keepalives
+    inline constexpr std::chrono::milliseconds kDefaultMaxUpdateInterval{ 1000 }; // server timer thread's longest sleep
+    inline constexpr std::chrono::milliseconds kDefaultMinRto{ 100 };
+    inline constexpr std::chrono::milliseconds kDefaultMaxRto{ 3000 };
+
+    // The range of buffer_size: a full Ethernet datagram up to the largest UDP payload
+    inline constexpr uint32_t kMinBufferSize = 1500;
+    inline constexpr uint32_t kMaxBufferSize = 65536;
+
+    /**
+     * @brief False for an unknown version, an out-of-range buffer_size, or a minimum RTO above the
+     * maximum once zero bounds take their defaults. A null tuning keeps every default and is valid.
+     */
+    bool IsValidTuning(const RiftTuningConfig* tuning);
+
+    /**
+     * @brief A copy of a tuning IsValidTuning accepted, or all zero (every default) without one.
+     */
+    RiftTuningConfig CopyTuning(const RiftTuningConfig* tuning);
+
+    // The field, or its default when it is zero
+    std::chrono::milliseconds ResolveIdleTimeout(const RiftTuningConfig& tuning);
+    std::chrono::milliseconds ResolveMaxUpdateInterval(const RiftTuningConfig& tuning);
+    std::chrono::milliseconds ResolveMinRto(const RiftTuningConfig& tuning);
+    std::chrono::milliseconds ResolveMaxRto(const RiftTuningConfig& tuning);
+
+    /**
+     * @brief The socket layer's share of a tuning; zero fields keep SocketTuning's defaults.
+     */
+    Networking::SocketTuning CopySocketTuning(const RiftTuningConfig& tuning);
+
+} // namespace RiftNet::Tuning
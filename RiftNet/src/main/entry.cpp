@@ -1,8 +1,11 @@
 // RiftNet is a C++ library for a UDP-based networking solution designed for games and real-time applications. It provides a simple API for creating servers and clients, handling connections, and sending/receiving data efficiently.
 
 #include "pch.h"
+
+#if defined(_WIN32)
+
 #include "../core/networkio/INetworkIO.hpp"
-#include "../core/networkio/iocontext.hpp"
+#include "../core/networkio/IOContext.hpp"
 #include "../core/networkio/NetworkEndpoint.hpp"
 #include "../core/riftnetio/RiftNetIO.hpp"
 #include "../../utilities/logger/Logger.hpp"
@@ -16,14 +19,14 @@ public:
     virtual ~TestEventHandler() = default;
 
     void OnRawDataReceived(const RiftNet::Networking::NetworkEndpoint& sender,
-        const uint8_t* data,
+        uint8_t* data,
         uint32_t size,
         RiftNet::Networking::OverlappedIOContext* context) override
     {
         // For this test, we just log that we received something.
         // In the real server, this is where you would decrypt, decompress,
         // and process the packet.
-        RF_NETWORK_INFO("Received {} bytes from {}", size, sender.ToString());
+        RF_NETWORK_INFO("Received {} bytes from {}", size, sender);
     }
 
     void OnSendCompleted(RiftNet::Networking::OverlappedIOContext* context,
@@ -31,10 +34,10 @@ public:
         uint32_t bytesSent) override
     {
         if (success) {
-            RF_NETWORK_INFO("Successfully sent {} bytes to {}", bytesSent, context->endpoint.ToString());
+            RF_NETWORK_INFO("Successfully sent {} bytes to {}", bytesSent, context->endpoint);
         }
         else {
-            RF_NETWORK_WARN("Send operation to {} failed.", context->endpoint.ToString());
+            RF_NETWORK_WARN("Send operation to {} failed.", context->endpoint);
         }
     }
 
@@ -83,6 +86,9 @@ int main() {
     networkIO->Stop();
 
     RF_NETWORK_INFO("Server has stopped. Exiting.");
+    RiftNet::Logging::Logger::Shutdown();
 
     return 0;
 }
+
+#endif // defined(_WIN32)
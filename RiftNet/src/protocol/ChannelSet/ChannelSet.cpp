@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "ChannelSet.hpp"
+
+#include "../../../utilities/logger/Logger.hpp"
+
+namespace RiftNet::Protocol {
+
+    namespace {
+        constexpr uint32_t REORDER_MASK = CHANNEL_REORDER_WINDOW - 1;
+        static_assert((CHANNEL_REORDER_WINDOW & REORDER_MASK) == 0, "reorder window must be a power of two");
+
+        // Wrap-aware: true if s1 comes after s2 in a 16-bit channel sequence space.
+        bool IsChannelSequenceNewer(uint16_t s1, uint16_t s2) {
+            return static_cast<int16_t>(static_cast<uint16_t>(s1 - s2)) > 0;
+        }
+    }
+
+    bool ChannelSet::Configure(const std::vector<ChannelType>& types) {
+        if (types.size() > MAX_CHANNELS) {
+            return false;
+        }
+
+        m_send.clear();
+        for (ChannelType type : types) {
+            m_send.push_back(SendChannel{ type, 0 });
+        }
+        return true;
+    }
+
+    bool ChannelSet::GetSendInfo(uint8_t channel, ChannelType& type, uint16_t& sequence) const {
+        if (channel >= m_send.size()) {
+            return false;
+        }
+        type = m_send[channel].type;
+        sequence = m_send[channel].nextSequence;
+        return true;
+    }
+
+    void ChannelSet::CommitSend(uint8_t channel) {
+        if (channel < m_send.size()) {
+            ++m_send[channel].nextSequence;
+        }
+    }
+
+    void ChannelSet::Receive(PacketType type, const ChannelHeader& header, std::span<const uint8_t> payload,
+        const DeliverCallback& deliver) {
+        if (header.channel >= MAX_CHANNELS) {
+            RF_NETWORK_WARN_LIMITED("Channel message for invalid channel {}; dropping", header.channel);
+            return;
+        }
+        ReceiveChannel& channel = m_receive[header.channel];
+
+        switch (type) {
+        case PacketType::Data_Channel_Ordered:
+            ReceiveOrdered(channel, header, payload, deliver);
+            break;
+
+        case PacketType::Data_Channel_Unordered:
+            deliver(payload.data(), static_cast<uint32_t>(payload.size()), header.channel);
+            break;
+
+        case PacketType::Data_Channel_Sequenced:
+            if (channel.receivedAny && !IsChannelSequenceNewer(header.sequence, channel.nextSequence - 1)) {
+                RF_NETWORK_TRACE("Stale sequenced message {} on channel {}; dropping", header.sequence, header.channel);
+                return;
+            }
+            channel.receivedAny = true;
+            channel.nextSequence = static_cast<uint16_t>(header.sequence + 1);
+            deliver(payload.data(), static_cast<uint32_t>(payload.size()), header.channel);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void ChannelSet::ReceiveOrdered(ReceiveChannel& channel, const ChannelHeader& header, std::span<const uint8_t> payload,
+        const DeliverCallback& deliver) {
+        const uint16_t ahead = static_cast<uint16_t>(header.sequence - channel.nextSequence);
+
+        if (ahead != 0) {
+            if (!IsChannelSequenceNewer(header.sequence, channel.nextSequence)) {
+                return; // already delivered
+            }
+            if (ahead >= CHANNEL_REORDER_WINDOW) {
+                RF_NETWORK_WARN_LIMITED("Ordered message {} on channel {} is {} ahead of the reorder window; dropping",
+                    header.sequence, header.channel, ahead);
+                return;
+            }
+
+            // Hold it until the gap before it is filled
+            if (channel.held.empty()) {
+                channel.held.resize(CHANNEL_REORDER_WINDOW);
+            }
+            HeldMessage& held = channel.held[header.sequence & REORDER_MASK];
+            if (!held.present) {
+                held.present = true;
+                held.data.assign(payload.begin(), payload.end());
+            }
+            return;
+        }
+
+        deliver(payload.data(), static_cast<uint32_t>(payload.size()), header.channel);
+        ++channel.nextSequence;
+
+        // Release everything that was waiting on this message
+        while (!channel.held.empty()) {
+            HeldMessage& next = channel.held[channel.nextSequence & REORDER_MASK];
+            if (!next.present) break;
+
+            deliver(next.data.data(), static_cast<uint32_t>(next.data.size()), header.channel);
+            next.present = false;
+            next.data.clear(); // keeps capacity for reuse
+            ++channel.nextSequence;
+        }
+    }
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../Packet/Packet.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace RiftNet::Protocol {
+
+    // Delivery guarantees of a logical channel.
+    enum class ChannelType : uint8_t {
+        ReliableOrdered,     // Every message arrives, in send order; a gap holds back later messages on this channel only.
+        ReliableUnordered,   // Every message arrives, in arrival order.
+        UnreliableSequenced, // Messages may be lost; one older than the newest delivered is dropped.
+    };
+
+    // Out-of-order messages an ordered channel can hold while it waits for a gap to fill.
+    // Larger than any send window, so a reliable sender can never get further ahead than this.
+    constexpr uint32_t CHANNEL_REORDER_WINDOW = 256;
+
+    constexpr PacketType ChannelPacketType(ChannelType type) {
+        switch (type) {
+        case ChannelType::ReliableOrdered:   return PacketType::Data_Channel_Ordered;
+        case ChannelType::ReliableUnordered: return PacketType::Data_Channel_Unordered;
+        default:                             return PacketType::Data_Channel_Sequenced;
+        }
+    }
+
+    /**
+     * @class ChannelSet
+     * @brief Per-connection channel bookkeeping: send-side numbering and receive-side ordering.
+     * Channel types are configured on the sending side and travel in the packet type, so a
+     * receiver needs no configuration. Each ordered channel has its own reorder buffer, so a
+     * loss on one channel never delays another.
+     * Not thread-safe: the send half (GetSendInfo/CommitSend) and the receive half (Receive)
+     * are independent, and each must be serialized by the caller.
+     */
+    class ChannelSet {
+    public:
+        using DeliverCallback = std::function<void(const uint8_t*, uint32_t, uint8_t)>;
+
+        /**
+         * @brief Sets the type of each channel; channel i has types[i].
+         * @return False if more than MAX_CHANNELS are given.
+         */
+        bool Configure(const std::vector<ChannelType>& types);
+
+        /**
+         * @brief Looks up a configured channel and the sequence its next message will carry.
+         * @return False if the channel is not configured.
+         */
+        bool GetSendInfo(uint8_t channel, ChannelType& type, uint16_t& sequence) const;
+
+        /**
+         * @brief Consumes the sequence returned by GetSendInfo, once its message has been sent.
+         * A message that could not be sent must not be committed, or an ordered channel would wait for it forever.
+         */
+        void CommitSend(uint8_t channel);
+
+        /**
+         * @brief Processes one received (decompressed) channel message.
+         * Delivers it, and for ordered channels any buffered successors, in channel order.
+         * @param type Data_Channel_Ordered, Data_Channel_Unordered or Data_Channel_Sequenced.
+         */
+        void Receive(PacketType type, const ChannelHeader& header, std::span<const uint8_t> payload,
+            const DeliverCallback& deliver);
+
+    private:
+        struct SendChannel {
+            ChannelType type{ ChannelType::ReliableOrdered };
+            uint16_t nextSequence{ 0 };
+        };
+
+        struct HeldMessage {
+            bool present{ false };
+            std::vector<uint8_t> data;
+        };
+
+        struct ReceiveChannel {
+            uint16_t nextSequence{ 0 };      // ordered: next to deliver; sequenced: newest delivered + 1
+            bool     receivedAny{ false };   // sequenced only
+            std::vector<HeldMessage> held;   // ordered only; CHANNEL_REORDER_WINDOW slots, allocated on first gap
+        };
+
+        void ReceiveOrdered(ReceiveChannel& channel, const ChannelHeader& header, std::span<const uint8_t> payload,
+            const DeliverCallback& deliver);
+
+        std::vector<SendChannel> m_send;
+        std::array<ReceiveChannel, MAX_CHANNELS> m_receive;
+    };
+
+} // namespace RiftNet::Protocol
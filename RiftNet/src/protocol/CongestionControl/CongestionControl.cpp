@@ -0,0 +1,252 @@
+#include "pch.h"
+#include "CongestionControl.hpp"
+
+#include <algorithm> // For std::max, std::min
+#include <array>
+#include <cmath>     // For std::ceil
+#include <limits>
+
+namespace RiftNet::Protocol {
+
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // The bucket holds this much sending time, so a timer that fires a little late can catch up.
+        constexpr auto PACER_BURST_WINDOW = std::chrono::milliseconds(2);
+        constexpr uint32_t PACER_MIN_BURST = 2 * CONGESTION_MSS;
+
+        // --- Fixed rate ---
+
+        class FixedRateController final : public ICongestionController {
+        public:
+            explicit FixedRateController(uint64_t bytesPerSec) : m_rate(static_cast<double>(bytesPerSec)) {}
+
+            void OnPacketAcked(const CongestionAckSample&) override {}
+            void OnPacketLost(uint32_t, Clock::time_point, Clock::time_point, bool) override {}
+            uint32_t GetCongestionWindow() const override { return (std::numeric_limits<uint32_t>::max)(); }
+            double GetPacingRate(float) const override { return m_rate; }
+            CongestionAlgorithm GetAlgorithm() const override { return CongestionAlgorithm::FixedRate; }
+
+        private:
+            double m_rate;
+        };
+
+        // --- AIMD (NewReno-like) ---
+
+        class AIMDController final : public ICongestionController {
+        public:
+            void OnPacketAcked(const CongestionAckSample& sample) override {
+                // Application-limited: acks of a mostly empty window say nothing about the path
+                if (static_cast<uint64_t>(sample.bytesInFlight) * 2 < m_cwnd) return;
+
+                if (m_cwnd < m_ssthresh) {
+                    m_cwnd += sample.bytes; // slow start: doubles every round trip
+                }
+                else {
+                    m_cwnd += (std::max)(1u, CONGESTION_MSS * sample.bytes / m_cwnd); // ~one MSS per round trip
+                }
+            }
+
+            void OnPacketLost(uint32_t, Clock::time_point sentAt, Clock::time_point now, bool timeout) override {
+                if (m_reduced && sentAt <= m_recoveryStart) return; // same congestion event
+                m_reduced = true;
+                m_recoveryStart = now;
+                m_ssthresh = (std::max)(m_cwnd / 2, MIN_CONGESTION_WINDOW);
+                m_cwnd = timeout ? MIN_CONGESTION_WINDOW : m_ssthresh;
+            }
+
+            uint32_t GetCongestionWindow() const override { return m_cwnd; }
+
+            double GetPacingRate(float smoothedRTT_ms) const override {
+                // Pace slightly ahead of cwnd/RTT so pacing never becomes the bottleneck
+                const double gain = (m_cwnd < m_ssthresh) ? 2.0 : 1.25;
+                return gain * m_cwnd * 1000.0 / (std::max)(smoothedRTT_ms, 1.0f);
+            }
+
+            CongestionAlgorithm GetAlgorithm() const override { return CongestionAlgorithm::AIMD; }
+
+        private:
+            uint32_t m_cwnd{ INITIAL_CONGESTION_WINDOW };
+            uint32_t m_ssthresh{ (std::numeric_limits<uint32_t>::max)() };
+            bool m_reduced{ false };
+            Clock::time_point m_recoveryStart;
+        };
+
+        // --- BBR-like ---
+
+        constexpr double BBR_STARTUP_GAIN = 2.885; // 2/ln(2): doubles the sending rate every round
+        constexpr double BBR_CWND_GAIN = 2.0;
+        constexpr uint32_t BBR_BW_FILTER_ROUNDS = 10;
+        constexpr uint32_t BBR_FULL_BW_ROUNDS = 3;  // rounds without 25% growth before leaving startup
+        constexpr auto BBR_MIN_RTT_WINDOW = std::chrono::seconds(10);
+        constexpr std::array<double, 8> BBR_PROBE_GAINS{ 1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+
+        // Models the path as bottleneck bandwidth (max delivery rate over recent rounds) times
+        // min RTT. No ProbeRTT phase, and losses only matter when an RTO fires.
+        class BBRLikeController final : public ICongestionController {
+        public:
+            void OnPacketAcked(const CongestionAckSample& sample) override {
+                if (sample.rtt_ms > 0.0f &&
+                    (m_minRtt_ms <= 0.0f || sample.rtt_ms <= m_minRtt_ms || sample.now - m_minRttStamp > BBR_MIN_RTT_WINDOW)) {
+                    m_minRtt_ms = sample.rtt_ms;
+                    m_minRttStamp = sample.now;
+                }
+
+                // A round ends when a packet sent after the previous round ended is acked
+                bool roundStart = false;
+                if (sample.deliveredAtSend >= m_nextRoundDelivered) {
+                    m_nextRoundDelivered = sample.delivered;
+                    ++m_round;
+                    roundStart = true;
+                }
+
+                // An application-limited sample only shows what the app sent, so it may raise the
+                // estimate but never replace an expired one
+                const bool appLimited = static_cast<uint64_t>(sample.bytesInFlight) * 2 < GetCongestionWindow();
+                if (sample.deliveryRate > 0.0 && (sample.deliveryRate >= m_maxBw ||
+                    (!appLimited && m_round - m_maxBwRound >= BBR_BW_FILTER_ROUNDS))) {
+                    m_maxBw = sample.deliveryRate;
+                    m_maxBwRound = m_round;
+                }
+
+                switch (m_mode) {
+                case Mode::Startup:
+                    if (!roundStart || appLimited || m_maxBw <= 0.0) break;
+                    if (m_maxBw >= m_fullBw * 1.25) {
+                        m_fullBw = m_maxBw;
+                        m_fullBwRounds = 0;
+                    }
+                    else if (++m_fullBwRounds >= BBR_FULL_BW_ROUNDS) {
+                        m_mode = Mode::Drain; // the pipe is full; drain the queue startup built
+                    }
+                    break;
+
+                case Mode::Drain:
+                    if (sample.bytesInFlight <= Bdp()) {
+                        m_mode = Mode::ProbeBW;
+                        m_cycleIndex = 0;
+                        m_cycleStart = sample.now;
+                    }
+                    break;
+
+                case Mode::ProbeBW:
+                    if (m_minRtt_ms > 0.0f && sample.now - m_cycleStart >=
+                        std::chrono::microseconds(static_cast<int64_t>(m_minRtt_ms * 1000.0f))) {
+                        m_cycleIndex = (m_cycleIndex + 1) % BBR_PROBE_GAINS.size();
+                        m_cycleStart = sample.now;
+                    }
+                    break;
+                }
+            }
+
+            void OnPacketLost(uint32_t, Clock::time_point, Clock::time_point, bool timeout) override {
+                if (timeout) {
+                    m_maxBw *= 0.5; // a whole flight was lost: the estimate is stale
+                }
+            }
+
+            uint32_t GetCongestionWindow() const override {
+                if (m_maxBw <= 0.0 || m_minRtt_ms <= 0.0f) return INITIAL_CONGESTION_WINDOW;
+
+                // Floored at the initial window for the same reason as the pacing rate
+                const double gain = (m_mode == Mode::Startup) ? BBR_STARTUP_GAIN : BBR_CWND_GAIN;
+                const double cwnd = (std::min)(gain * Bdp(), static_cast<double>((std::numeric_limits<uint32_t>::max)()));
+                return (std::max)(static_cast<uint32_t>(cwnd), INITIAL_CONGESTION_WINDOW);
+            }
+
+            double GetPacingRate(float smoothedRTT_ms) const override {
+                // Never slower than an initial window per RTT, so a mostly idle connection that
+                // suddenly has a burst to send is not held to its old trickle
+                const double floor = INITIAL_CONGESTION_WINDOW * 1000.0 / (std::max)(smoothedRTT_ms, 1.0f);
+                if (m_maxBw <= 0.0) {
+                    return BBR_STARTUP_GAIN * floor;
+                }
+                switch (m_mode) {
+                case Mode::Startup: return (std::max)(BBR_STARTUP_GAIN * m_maxBw, floor);
+                case Mode::Drain:   return (std::max)(m_maxBw / BBR_STARTUP_GAIN, floor);
+                default:            return (std::max)(BBR_PROBE_GAINS[m_cycleIndex] * m_maxBw, floor);
+                }
+            }
+
+            CongestionAlgorithm GetAlgorithm() const override { return CongestionAlgorithm::BBRLike; }
+
+        private:
+            enum class Mode { Startup, Drain, ProbeBW };
+
+            double Bdp() const { return m_maxBw * m_minRtt_ms / 1000.0; }
+
+            Mode m_mode{ Mode::Startup };
+            double m_maxBw{ 0.0 };            // bytes/s
+            uint64_t m_maxBwRound{ 0 };
+            float m_minRtt_ms{ 0.0f };
+            Clock::time_point m_minRttStamp;
+
+            uint64_t m_round{ 0 };
+            uint64_t m_nextRoundDelivered{ 0 };
+
+            double m_fullBw{ 0.0 };
+            uint32_t m_fullBwRounds{ 0 };
+
+            size_t m_cycleIndex{ 0 };
+            Clock::time_point m_cycleStart;
+        };
+    }
+
+    std::unique_ptr<ICongestionController> CreateCongestionController(
+        CongestionAlgorithm algorithm, uint64_t fixedRateBytesPerSec) {
+        switch (algorithm) {
+        case CongestionAlgorithm::FixedRate: return std::make_unique<FixedRateController>(fixedRateBytesPerSec);
+        case CongestionAlgorithm::AIMD:      return std::make_unique<AIMDController>();
+        case CongestionAlgorithm::BBRLike:   return std::make_unique<BBRLikeController>();
+        default:                             return nullptr;
+        }
+    }
+
+    // =========================
+    // Pacer
+    // =========================
+
+    void Pacer::SetRate(double bytesPerSec) {
+        m_rate = (std::max)(bytesPerSec, 0.0);
+    }
+
+    double Pacer::Burst() const {
+        const double window = m_rate * std::chrono::duration<double>(PACER_BURST_WINDOW).count();
+        return (std::max)(window, static_cast<double>(PACER_MIN_BURST));
+    }
+
+    void Pacer::Refill(std::chrono::steady_clock::time_point now) {
+        if (!m_started) {
+            m_started = true;
+            m_tokens = Burst();
+            m_lastRefill = now;
+            return;
+        }
+        if (now <= m_lastRefill) return;
+
+        const double elapsed = std::chrono::duration<double>(now - m_lastRefill).count();
+        m_tokens = (std::min)(m_tokens + m_rate * elapsed, Burst());
+        m_lastRefill = now;
+    }
+
+    bool Pacer::CanSend(std::chrono::steady_clock::time_point now) {
+        if (m_rate <= 0.0) return true;
+        Refill(now);
+        return m_tokens > 0.0;
+    }
+
+    void Pacer::OnSent(uint32_t bytes) {
+        if (m_rate > 0.0) {
+            m_tokens -= bytes;
+        }
+    }
+
+    std::chrono::steady_clock::time_point Pacer::NextSendTime(std::chrono::steady_clock::time_point now) {
+        if (!CanSend(now)) {
+            const double wait_us = std::ceil(-m_tokens / m_rate * 1e6) + 1.0;
+            return now + std::chrono::microseconds(static_cast<int64_t>(wait_us));
+        }
+        return now;
+    }
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace RiftNet::Protocol {
+
+    // Segment size the window and pacer reason in; roughly one full datagram.
+    constexpr uint32_t CONGESTION_MSS = 1200;
+    constexpr uint32_t INITIAL_CONGESTION_WINDOW = 10 * CONGESTION_MSS; // cf. RFC 6928
+    constexpr uint32_t MIN_CONGESTION_WINDOW = 2 * CONGESTION_MSS;
+
+    enum class CongestionAlgorithm : uint8_t {
+        None,      // No window and no pacing: every packet goes out as soon as it is sent.
+        FixedRate, // Paced at a configured rate; the window is unlimited.
+        AIMD,      // Reno-style slow start, additive increase, halving on loss.
+        BBRLike,   // Paced at the measured bottleneck bandwidth, window of twice the BDP.
+    };
+
+    // What one acknowledged reliable packet tells the controller.
+    struct CongestionAckSample {
+        uint32_t bytes{ 0 };               // size of the acked packet
+        uint32_t bytesInFlight{ 0 };       // reliable bytes in flight before this ack
+        float    rtt_ms{ -1.0f };          // < 0 if the packet was resent (Karn's rule)
+        double   deliveryRate{ 0.0 };      // bytes/s delivered while it was in flight, 0 if unknown
+        uint64_t delivered{ 0 };           // total bytes acked so far, including this packet
+        uint64_t deliveredAtSend{ 0 };     // total bytes acked when this packet was sent
+        std::chrono::steady_clock::time_point now;
+    };
+
+    /**
+     * @class ICongestionController
+     * @brief Window and pacing-rate policy for one connection, fed by the reliability layer.
+     * Calls are made only by the thread that currently owns the connection's send state, one at a
+     * time, so implementations need no locking of their own and must not call back into the connection.
+     */
+    class ICongestionController {
+    public:
+        virtual ~ICongestionController() = default;
+
+        virtual void OnPacketAcked(const CongestionAckSample& sample) = 0;
+
+        /**
+         * @brief A reliable packet was found lost: a fast retransmit, or its RTO expired (timeout).
+         * @param sentAt When the lost transmission went out; losses of packets sent before the
+         *        last reduction belong to the same congestion event.
+         */
+        virtual void OnPacketLost(uint32_t bytes, std::chrono::steady_clock::time_point sentAt,
+            std::chrono::steady_clock::time_point now, bool timeout) = 0;
+
+        // Reliable bytes that may be in flight; UINT32_MAX for no limit.
+        virtual uint32_t GetCongestionWindow() const = 0;
+
+        // Bytes/s to pace all data packets at; 0 for no pacing.
+        virtual double GetPacingRate(float smoothedRTT_ms) const = 0;
+
+        virtual CongestionAlgorithm GetAlgorithm() const = 0;
+    };
+
+    /**
+     * @brief Creates a controller for one of the built-in algorithms.
+     * @param fixedRateBytesPerSec Pacing rate for FixedRate; ignored by the others.
+     * @return nullptr for CongestionAlgorithm::None.
+     */
+    std::unique_ptr<ICongestionController> CreateCongestionController(
+        CongestionAlgorithm algorithm, uint64_t fixedRateBytesPerSec = 0);
+
+    /**
+     * @class Pacer
+     * @brief Token bucket that spreads a connection's datagrams out at its pacing rate.
+     * A datagram may go out whenever the bucket is not empty and may take it negative, so
+     * datagrams larger than the bucket never stall. Not thread-safe.
+     */
+    class Pacer {
+    public:
+        // Bytes/s; 0 disables pacing (CanSend is always true).
+        void SetRate(double bytesPerSec);
+
+        bool CanSend(std::chrono::steady_clock::time_point now);
+        void OnSent(uint32_t bytes);
+
+        // When CanSend next becomes true (now if it already is).
+        std::chrono::steady_clock::time_point NextSendTime(std::chrono::steady_clock::time_point now);
+
+    private:
+        void Refill(std::chrono::steady_clock::time_point now);
+        double Burst() const;
+
+        double m_rate{ 0.0 };
+        double m_tokens{ 0.0 };
+        bool   m_started{ false };
+        std::chrono::steady_clock::time_point m_lastRefill;
+    };
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "FragmentReassembler.hpp"
+
+#include "../../../utilities/logger/Logger.hpp"
+
+namespace RiftNet::Protocol {
+
+    FragmentReassembler::FragmentReassembler(size_t memoryCap, size_t maxMessages)
+        : m_memoryCap(memoryCap)
+        , m_maxMessages(maxMessages) {
+    }
+
+    bool FragmentReassembler::AddFragment(const FragmentHeader& header, std::span<const uint8_t> piece, bool reliable,
+        std::chrono::steady_clock::time_point now, PacketType& outType, std::vector<uint8_t>& outMessage) {
+        auto it = m_messages.find(header.messageId);
+
+        // A different shape under the same id is a new message after the 16-bit id wrapped
+        if (it != m_messages.end() && (it->second.count != header.count ||
+            it->second.innerType != header.innerType || it->second.reliable != reliable)) {
+            RF_NETWORK_DEBUG("Fragment id {} reused; dropping its incomplete message", header.messageId);
+            Erase(it);
+            it = m_messages.end();
+        }
+
+        if (it == m_messages.end()) {
+            // Make room before the new message allocates anything, so a peer opening many ids
+            // with tiny pieces is held to the cap as surely as one sending large pieces
+            const size_t overhead = BookkeepingBytes(header.count);
+            while (m_messages.size() >= m_maxMessages || m_bufferedBytes + overhead + piece.size() > m_memoryCap) {
+                if (!EvictOldestUnreliable()) {
+                    RF_NETWORK_WARN_LIMITED("Reassembly limits ({} messages, {} bytes) reached; dropping new message {} of {} pieces",
+                        m_maxMessages, m_memoryCap, header.messageId, header.count);
+                    return false;
+                }
+            }
+
+            PartialMessage message;
+            message.innerType = header.innerType;
+            message.count = header.count;
+            message.reliable = reliable;
+            message.deadline = now + (reliable ? RELIABLE_REASSEMBLY_TIMEOUT : UNRELIABLE_REASSEMBLY_TIMEOUT);
+            message.pieces.resize(header.count);
+            message.present.resize(header.count, false);
+            message.overhead = overhead;
+            it = m_messages.emplace(header.messageId, std::move(message)).first;
+            m_bufferedBytes += overhead;
+        }
+
+        PartialMessage& message = it->second;
+        if (message.present[header.index]) {
+            return false; // duplicate piece
+        }
+
+        while (m_bufferedBytes + piece.size() > m_memoryCap) {
+            if (!EvictOldestUnreliable()) {
+                RF_NETWORK_WARN_LIMITED("Reassembly memory cap ({} bytes) reached; dropping fragment {}/{} of message {}",
+                    m_memoryCap, header.index, header.count, header.messageId);
+                return false;
+            }
+            // Eviction may have removed this very message
+            it = m_messages.find(header.messageId);
+            if (it == m_messages.end()) return false;
+        }
+
+        message.pieces[header.index].assign(piece.begin(), piece.end());
+        message.present[header.index] = true;
+        message.bytes += piece.size();
+        m_bufferedBytes += piece.size();
+        if (++message.received < message.count) {
+            return false;
+        }
+
+        // Complete: stitch the pieces together in index order
+        outType = message.innerType;
+        outMessage.clear();
+        outMessage.reserve(message.bytes);
+        for (const auto& part : message.pieces) {
+            outMessage.insert(outMessage.end(), part.begin(), part.end());
+        }
+        Erase(it);
+        return true;
+    }
+
+    void FragmentReassembler::ExpireStale(std::chrono::steady_clock::time_point now) {
+        for (auto it = m_messages.begin(); it != m_messages.end();) {
+            auto next = std::next(it);
+            if (it->second.deadline <= now) {
+                RF_NETWORK_DEBUG("Fragmented message {} timed out with {}/{} pieces",
+                    it->first, it->second.received, it->second.count);
+                Erase(it);
+            }
+            it = next;
+        }
+    }
+
+    std::chrono::steady_clock::time_point FragmentReassembler::GetNextExpiry() const {
+        auto next = std::chrono::steady_clock::time_point::max();
+        for (const auto& [id, message] : m_messages) {
+            if (message.deadline < next) next = message.deadline;
+        }
+        return next;
+    }
+
+    size_t FragmentReassembler::BookkeepingBytes(uint16_t count) {
+        // The map node (entry plus next pointer and cached hash), a vector per piece and the bitmap
+        constexpr size_t node = sizeof(std::pair<const uint16_t, PartialMessage>) + 2 * sizeof(void*);
+        return node + count * sizeof(std::vector<uint8_t>) + (count + 7u) / 8u;
+    }
+
+    void FragmentReassembler::Erase(std::unordered_map<uint16_t, PartialMessage>::iterator it) {
+        m_bufferedBytes -= it->second.bytes + it->second.overhead;
+        m_messages.erase(it);
+    }
+
+    bool FragmentReassembler::EvictOldestUnreliable() {
+        auto oldest = m_messages.end();
+        for (auto it = m_messages.begin(); it != m_messages.end(); ++it) {
+            if (!it->second.reliable && (oldest == m_messages.end() || it->second.deadline < oldest->second.deadline)) {
+                oldest = it;
+            }
+        }
+        if (oldest == m_messages.end()) {
+            return false;
+        }
+        RF_NETWORK_DEBUG("Reassembly limit reached; evicting unreliable message {}", oldest->first);
+        Erase(oldest);
+        return true;
+    }
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "../Packet/Packet.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace RiftNet::Protocol {
+
+    // How long a partly received message is kept. Reliable pieces are resent until they arrive,
+    // so they get much longer than unreliable ones, whose missing pieces never will.
+    constexpr auto RELIABLE_REASSEMBLY_TIMEOUT = std::chrono::seconds(10);
+    constexpr auto UNRELIABLE_REASSEMBLY_TIMEOUT = std::chrono::seconds(1);
+
+    // Bytes one connection may hold in pieces and the bookkeeping of each incomplete message
+    // (a slot per piece, sized by its fragment count). Above a full 128-packet reliable window of
+    // maximum-size datagrams, so reliable reassembly never hits it with a well-behaved peer.
+    constexpr size_t DEFAULT_REASSEMBLY_MEMORY_CAP = 1024 * 1024;
+
+    // Incomplete messages one connection may hold at once. Each reliable one has a piece in the
+    // 128-packet send window, so this leaves as many again for unreliable ones.
+    constexpr size_t DEFAULT_MAX_PARTIAL_MESSAGES = 256;
+
+    /**
+     * @class FragmentReassembler
+     * @brief Collects the pieces of fragmented messages, keyed by message id, until each is complete.
+     * Incomplete messages are dropped after their timeout, and when the memory cap or the message
+     * limit is reached the oldest unreliable ones make room first. Not thread-safe.
+     */
+    class FragmentReassembler {
+    public:
+        explicit FragmentReassembler(size_t memoryCap = DEFAULT_REASSEMBLY_MEMORY_CAP,
+            size_t maxMessages = DEFAULT_MAX_PARTIAL_MESSAGES);
+
+        /**
+         * @brief Adds one piece (as validated by PacketFactory::ParseFragmentHeader).
+         * @param reliable True for Data_Reliable_Fragment pieces.
+         * @param outType Set to the message's inner packet type once complete.
+         * @param outMessage Receives the whole message body once complete.
+         * @return True if this piece completed its message.
+         */
+        bool AddFragment(const FragmentHeader& header, std::span<const uint8_t> piece, bool reliable,
+            std::chrono::steady_clock::time_point now, PacketType& outType, std::vector<uint8_t>& outMessage);
+
+        // Drops incomplete messages whose timeout has passed.
+        void ExpireStale(std::chrono::steady_clock::time_point now);
+
+        // When ExpireStale next has something to drop, or time_point::max() if nothing is buffered.
+        std::chrono::steady_clock::time_point GetNextExpiry() const;
+
+        size_t GetBufferedBytes() const { return m_bufferedBytes; }
+
+    private:
+        struct PartialMessage {
+            PacketType innerType{ PacketType::Data_Unreliable };
+            uint16_t count{ 0 };
+            uint16_t received{ 0 };
+            bool reliable{ false };
+            size_t bytes{ 0 };    // of pieces received
+            size_t overhead{ 0 }; // bookkeeping charged to the cap
+            std::chrono::steady_clock::time_point deadline;
+            std::vector<std::vector<uint8_t>> pieces; // empty until that piece arrives
+            std::vector<bool> present;
+        };
+
+        // Bytes charged for a message of `count` pieces before any of them arrive
+        static size_t BookkeepingBytes(uint16_t count);
+
+        void Erase(std::unordered_map<uint16_t, PartialMessage>::iterator it);
+        // Evicts the unreliable message with the earliest deadline; false if there is none.
+        bool EvictOldestUnreliable();
+
+        std::unordered_map<uint16_t, PartialMessage> m_messages;
+        size_t m_bufferedBytes{ 0 };
+        size_t m_memoryCap;
+        size_t m_maxMessages;
+    };
+
+} // namespace RiftNet::Protocol
@@ -38,9 +38,83 @@ namespace RiftNet::Protocol {
         // --- Keep-alive ---
         // Used to maintain the connection and detect timeouts.
         Heartbeat,                  // Either -> Either: "Are you still there?"
-        Heartbeat_Ack,              // Either -> Either: "Yes, I'm here."
+        Heartbeat_Ack,              // Either -> Either: "Yes, I'm here." Ack-only: a ReliabilityPacketHeader, no payload.
+
+        // --- Coalesced Data ---
+        // Several application messages packed into one datagram (see COALESCED_LENGTH_PREFIX_SIZE).
+        Data_Unreliable_Coalesced,
+        Data_Reliable_Coalesced,
+
+        // --- Channel Data ---
+        // One message on a logical channel; a ChannelHeader precedes the compressed payload.
+        Data_Channel_Ordered,       // Reliable, delivered in channel order.
+        Data_Channel_Unordered,     // Reliable, delivered on arrival.
+        Data_Channel_Sequenced,     // Unreliable, anything older than the newest delivered is dropped.
+
+        // --- Fragmented Data ---
+        // One piece of a message too large for a datagram; a FragmentHeader precedes the piece.
+        Data_Reliable_Fragment,
+        Data_Unreliable_Fragment,
+
+        // --- Path MTU discovery ---
+        Mtu_Probe,                  // Either -> Either: padded to the size being probed; [u16 size][padding]
+        Mtu_Probe_Ack,              // Either -> Either: "a probe of this size arrived"; [u16 size]
+
+        // --- Stream compression ---
+        Compression_Stream_Reset,   // Either -> Either: "resend this ordered channel from a keyframe"; [u8 channel]
+
+        // --- Session resumption ---
+        Session_Ticket,             // S->C: a ticket for the next connect; [ticket][32-byte resumption secret]
+
+        // --- Snapshot replication ---
+        Data_Snapshot,              // Either -> Either: unreliable; a SnapshotHeader precedes the compressed delta
+        Snapshot_Ack,               // Either -> Either: "this snapshot decoded, use it as the baseline"; [u32 id]
     };
 
+    // True for sequenced data packets (they carry a ReliabilityPacketHeader).
+    constexpr bool IsReliableDataType(PacketType type) {
+        return type == PacketType::Data_Reliable || type == PacketType::Data_Reliable_Coalesced ||
+            type == PacketType::Data_Channel_Ordered || type == PacketType::Data_Channel_Unordered ||
+            type == PacketType::Data_Reliable_Fragment;
+    }
+
+    constexpr bool IsChannelDataType(PacketType type) {
+        return type == PacketType::Data_Channel_Ordered || type == PacketType::Data_Channel_Unordered ||
+            type == PacketType::Data_Channel_Sequenced;
+    }
+
+    // True for every packet type that carries a ReliabilityPacketHeader, including ack-only packets.
+    constexpr bool HasReliabilityHeader(PacketType type) {
+        return IsReliableDataType(type) || type == PacketType::Heartbeat_Ack;
+    }
+
+    constexpr bool IsCoalescedDataType(PacketType type) {
+        return type == PacketType::Data_Unreliable_Coalesced || type == PacketType::Data_Reliable_Coalesced;
+    }
+
+    constexpr bool IsFragmentDataType(PacketType type) {
+        return type == PacketType::Data_Reliable_Fragment || type == PacketType::Data_Unreliable_Fragment;
+    }
+
+    // True for the packet types a fragmented message may reassemble into.
+    constexpr bool IsFragmentableDataType(PacketType type) {
+        return type == PacketType::Data_Unreliable || type == PacketType::Data_Reliable ||
+            IsCoalescedDataType(type) || IsChannelDataType(type) || type == PacketType::Data_Snapshot;
+    }
+
+
+    // =========================
+    // Coalescing Constants
+    // =========================
+    // A coalesced payload (after decompression) is a sequence of
+    // [u16 little-endian length][message bytes] sub-messages.
+    constexpr uint32_t COALESCED_LENGTH_PREFIX_SIZE = 2;
+    constexpr uint32_t COALESCED_MAX_MESSAGE_SIZE = 0xFFFF;
+
+    // Upper bound for a connection's coalescing budget, so a full batch plus headers,
+    // the compression frame header, nonce and tag stays under a typical 1500-byte path MTU.
+    constexpr uint32_t MAX_COALESCE_BUDGET = 1400;
+
 
     // =========================
     // Packet Header Structures
@@ -51,14 +125,83 @@ namespace RiftNet::Protocol {
         PacketType Type;
     };
 
-    // The header that ONLY follows a GeneralPacketHeader if the type is Data_Reliable.
+    // The header that ONLY follows a GeneralPacketHeader if HasReliabilityHeader(type): reliable data
+    // types (see IsReliableDataType), or Heartbeat_Ack (whose sequence is unused).
     // This structure contains all the necessary information for the UDPReliabilityProtocol.
     struct ReliabilityPacketHeader {
         uint16_t sequence;          // Sequence number of this packet.
         uint16_t ack;               // The most recent sequence number received from the other side.
-        uint32_t ack_bitfield;      // A bitfield representing acks for the 32 packets prior to `ack`.
+        uint32_t ack_bitfield;      // Bit d acknowledges sequence (ack - d); bit 0 is `ack` itself.
+    };
+
+    // Same fields with full 32-bit sequence numbers and a 128-bit ack window, for connections
+    // that agreed on ReliabilityHeaderFormat::Extended in the HELLO exchange.
+    struct ExtendedReliabilityPacketHeader {
+        uint32_t sequence;
+        uint32_t ack;
+        uint64_t ack_bitfield[2];   // Bit d of the 128 (low word first) acknowledges sequence (ack - d).
+    };
+
+    // Follows the reliability header (or the general header for Data_Channel_Sequenced) on
+    // channel packets. Each channel numbers its own messages, independently of the connection.
+    struct ChannelHeader {
+        uint8_t  channel;           // 0 .. MAX_CHANNELS - 1
+        uint16_t sequence;          // Per-channel message number, wrapping.
+    };
+
+    // Follows the general header on Data_Snapshot packets; the compressed payload is a
+    // SnapshotDelta against snapshot baselineId, or the whole snapshot when it is 0.
+    struct SnapshotHeader {
+        uint32_t id;                // Per-connection snapshot number, from 1.
+        uint32_t baselineId;
+    };
+
+    // Follows the reliability header (or the general header for Data_Unreliable_Fragment) on
+    // fragment packets. The reassembled pieces form the body of one innerType packet: its
+    // ChannelHeader, if any, then the compressed payload.
+    struct FragmentHeader {
+        PacketType innerType;
+        uint16_t   messageId;       // Per-connection, wrapping; shared by all pieces of a message.
+        uint16_t   index;           // 0 .. count - 1
+        uint16_t   count;
     };
 
+    // Logical channels per connection, and the id reported for data sent outside any channel.
+    constexpr uint32_t MAX_CHANNELS = 32;
+    constexpr uint8_t  DEFAULT_CHANNEL = 0xFF;
+    constexpr uint8_t  SNAPSHOT_CHANNEL = 0xFE; // reported for snapshots (see Connection::SendSnapshot)
+
+    // =========================
+    // Datagram Size Constants
+    // =========================
+    // Sizes are whole UDP payloads: wire nonce + encrypted packet + auth tag.
+    constexpr uint32_t DATAGRAM_OVERHEAD = 8 + 16;
+    constexpr uint32_t DEFAULT_MAX_DATAGRAM_SIZE = 1200;  // fits any IPv4/IPv6 path with room for tunnels
+    constexpr uint32_t MIN_DATAGRAM_SIZE = 576;
+    constexpr uint32_t MAX_DATAGRAM_SIZE = 1472;          // a 1500-byte Ethernet MTU minus IPv4 and UDP headers
+    constexpr uint32_t MAX_FRAGMENTS_PER_MESSAGE = 256;
+    // Prefix on client datagrams of connections that negotiated Hello::kCapConnectionId: the
+    // server-assigned u32 routing id (little-endian), ahead of the wire nonce.
+    constexpr uint32_t ROUTING_ID_SIZE = 4;
+
+    // Reliability header layout used by a connection; both peers must use the same one.
+    enum class ReliabilityHeaderFormat : uint8_t {
+        Compact,    // ReliabilityPacketHeader: 16-bit sequence numbers, 32 packets per ack
+        Extended,   // ExtendedReliabilityPacketHeader: 32-bit sequence numbers, 128 packets per ack
+    };
+
+    constexpr uint32_t ReliabilityHeaderSize(ReliabilityHeaderFormat format) {
+        return format == ReliabilityHeaderFormat::Extended
+            ? static_cast<uint32_t>(sizeof(ExtendedReliabilityPacketHeader))
+            : static_cast<uint32_t>(sizeof(ReliabilityPacketHeader));
+    }
+
+    // How many sequences one ack header covers, and so how far behind the newest packet a
+    // late arrival is still accepted.
+    constexpr uint32_t AckWindowSize(ReliabilityHeaderFormat format) {
+        return format == ReliabilityHeaderFormat::Extended ? 128u : 32u;
+    }
+
 } // namespace RiftNet::Protocol
 
 #pragma pack(pop)
@@ -1,6 +1,7 @@
 #include "pch.h"
 
 #include "PacketFactory.hpp"
+#include <algorithm> // For std::min
 #include <cstring>
 
 namespace RiftNet::Protocol {
@@ -9,9 +10,10 @@ namespace RiftNet::Protocol {
         const uint8_t* buffer,
         uint32_t size,
         GeneralPacketHeader& outGeneralHeader,
-        ReliabilityPacketHeader& outReliabilityHeader,
+        ExtendedReliabilityPacketHeader& outReliabilityHeader,
         const uint8_t*& outPayload,
-        uint32_t& outPayloadSize)
+        uint32_t& outPayloadSize,
+        ReliabilityHeaderFormat format)
     {
         if (size < sizeof(GeneralPacketHeader)) {
             return false; // Buffer is too small for even the general header.
@@ -23,17 +25,25 @@ namespace RiftNet::Protocol {
         uint32_t remainingSize = size - sizeof(GeneralPacketHeader);
 
         // 2. Check for and Read the Reliability Header
-        if (outGeneralHeader.Type == PacketType::Data_Reliable) {
-            if (remainingSize < sizeof(ReliabilityPacketHeader)) {
+        memset(&outReliabilityHeader, 0, sizeof(outReliabilityHeader)); // zeroed for unreliable packets
+        if (HasReliabilityHeader(outGeneralHeader.Type)) {
+            const uint32_t headerSize = ReliabilityHeaderSize(format);
+            if (remainingSize < headerSize) {
                 return false; // Not enough data for the required reliability header.
             }
-            memcpy(&outReliabilityHeader, currentPtr, sizeof(ReliabilityPacketHeader));
-            currentPtr += sizeof(ReliabilityPacketHeader);
-            remainingSize -= sizeof(ReliabilityPacketHeader);
-        }
-        else {
-            // Not a reliable packet, so zero out the reliability header for safety.
-            memset(&outReliabilityHeader, 0, sizeof(ReliabilityPacketHeader));
+
+            if (format == ReliabilityHeaderFormat::Extended) {
+                memcpy(&outReliabilityHeader, currentPtr, sizeof(outReliabilityHeader));
+            }
+            else {
+                ReliabilityPacketHeader compact{};
+                memcpy(&compact, currentPtr, sizeof(compact));
+                outReliabilityHeader.sequence = compact.sequence;
+                outReliabilityHeader.ack = compact.ack;
+                outReliabilityHeader.ack_bitfield[0] = compact.ack_bitfield;
+            }
+            currentPtr += headerSize;
+            remainingSize -= headerSize;
         }
 
         // 3. The rest of the data is the payload.
@@ -43,6 +53,91 @@ namespace RiftNet::Protocol {
         return true;
     }
 
+    bool PacketFactory::ParseChannelHeader(
+        const uint8_t*& payload,
+        uint32_t& payloadSize,
+        ChannelHeader& outChannelHeader)
+    {
+        if (payloadSize < sizeof(ChannelHeader)) {
+            return false;
+        }
+        memcpy(&outChannelHeader, payload, sizeof(ChannelHeader));
+        payload += sizeof(ChannelHeader);
+        payloadSize -= sizeof(ChannelHeader);
+        return true;
+    }
+
+    bool PacketFactory::ParseSnapshotHeader(
+        const uint8_t*& payload,
+        uint32_t& payloadSize,
+        SnapshotHeader& outSnapshotHeader)
+    {
+        if (payloadSize < sizeof(SnapshotHeader)) {
+            return false;
+        }
+        memcpy(&outSnapshotHeader, payload, sizeof(SnapshotHeader));
+        if (outSnapshotHeader.id == 0 || outSnapshotHeader.baselineId >= outSnapshotHeader.id) {
+            return false;
+        }
+        payload += sizeof(SnapshotHeader);
+        payloadSize -= sizeof(SnapshotHeader);
+        return true;
+    }
+
+    bool PacketFactory::ParseFragmentHeader(
+        const uint8_t*& payload,
+        uint32_t& payloadSize,
+        FragmentHeader& outFragmentHeader)
+    {
+        if (payloadSize < sizeof(FragmentHeader)) {
+            return false;
+        }
+        memcpy(&outFragmentHeader, payload, sizeof(FragmentHeader));
+        if (outFragmentHeader.count == 0 || outFragmentHeader.count > MAX_FRAGMENTS_PER_MESSAGE ||
+            outFragmentHeader.index >= outFragmentHeader.count ||
+            !IsFragmentableDataType(outFragmentHeader.innerType)) {
+            return false;
+        }
+        payload += sizeof(FragmentHeader);
+        payloadSize -= sizeof(FragmentHeader);
+        return true;
+    }
+
+    std::vector<Networking::PacketBufferPtr> PacketFactory::CreateFragments(
+        std::span<const uint8_t> message,
+        PacketType innerType,
+        uint16_t messageId,
+        uint32_t pieceSize)
+    {
+        std::vector<Networking::PacketBufferPtr> fragments;
+        if (pieceSize == 0 || message.empty()) {
+            return fragments;
+        }
+        const size_t count = (message.size() + pieceSize - 1) / pieceSize;
+        if (count > MAX_FRAGMENTS_PER_MESSAGE) {
+            return fragments;
+        }
+
+        fragments.reserve(count);
+        for (size_t index = 0; index < count; ++index) {
+            const std::span<const uint8_t> piece = message.subspan(index * pieceSize,
+                (std::min)(static_cast<size_t>(pieceSize), message.size() - index * pieceSize));
+
+            auto fragment = Networking::PacketBuffer::Create(piece.size());
+            std::memcpy(fragment->Append(piece.size()), piece.data(), piece.size());
+
+            FragmentHeader header{};
+            header.innerType = innerType;
+            header.messageId = messageId;
+            header.index = static_cast<uint16_t>(index);
+            header.count = static_cast<uint16_t>(count);
+            std::memcpy(fragment->Prepend(sizeof(header)), &header, sizeof(header));
+
+            fragments.push_back(std::move(fragment));
+        }
+        return fragments;
+    }
+
     std::vector<uint8_t> PacketFactory::CreateSimplePacket(PacketType type)
     {
         std::vector<uint8_t> packet(sizeof(GeneralPacketHeader));
@@ -51,31 +146,26 @@ namespace RiftNet::Protocol {
         return packet;
     }
 
-    std::vector<uint8_t> PacketFactory::CreateReliableDataPacket(
+    bool PacketFactory::CreateReliableDataPacket(
         ReliableConnectionState& reliabilityState,
-        const uint8_t* payload,
-        uint32_t payloadSize)
+        const Networking::PacketBufferPtr& packet,
+        PacketType type)
     {
         // The UDPReliabilityProtocol already has the logic to build the full packet
         // including the general and reliability headers. We can just call it directly.
-        return UDPReliabilityProtocol::PrepareOutgoingPacket(reliabilityState, payload, payloadSize);
+        return UDPReliabilityProtocol::PrepareOutgoingPacket(reliabilityState, packet, type);
     }
 
-    std::vector<uint8_t> PacketFactory::CreateUnreliableDataPacket(
-        const uint8_t* payload,
-        uint32_t payloadSize)
+    bool PacketFactory::CreateUnreliableDataPacket(Networking::PacketBuffer& packet, PacketType type)
     {
-        size_t totalSize = sizeof(GeneralPacketHeader) + payloadSize;
-        std::vector<uint8_t> packet(totalSize);
-
-        GeneralPacketHeader* header = reinterpret_cast<GeneralPacketHeader*>(packet.data());
-        header->Type = PacketType::Data_Unreliable;
-
-        if (payloadSize > 0) {
-            memcpy(packet.data() + sizeof(GeneralPacketHeader), payload, payloadSize);
+        uint8_t* headerPtr = packet.Prepend(sizeof(GeneralPacketHeader));
+        if (!headerPtr) {
+            return false;
         }
 
-        return packet;
+        GeneralPacketHeader* header = reinterpret_cast<GeneralPacketHeader*>(headerPtr);
+        header->Type = type;
+        return true;
     }
 
 } // namespace RiftNet::Protocol
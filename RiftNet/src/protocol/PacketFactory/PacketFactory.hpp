@@ -1,9 +1,10 @@
 #pragma once
 
-#include "../packet/Packet.hpp"
+#include "../Packet/Packet.hpp"
 #include "../UDPReliabilityProtocol/UDPReliabilityProtocol.hpp"
 #include <vector>
 #include <cstdint>
+#include <span>
 
 namespace RiftNet::Protocol {
 
@@ -19,18 +20,70 @@ namespace RiftNet::Protocol {
          * @param buffer The raw data received from the socket.
          * @param size The size of the raw data buffer.
          * @param outGeneralHeader The parsed GeneralPacketHeader.
-         * @param outReliabilityHeader The parsed ReliabilityPacketHeader (if present).
+         * @param outReliabilityHeader The parsed reliability header (if present). Compact headers are
+         *        copied into the extended layout as-is; UDPReliabilityProtocol widens their sequence numbers.
          * @param outPayload A pointer to the start of the payload data within the buffer.
          * @param outPayloadSize The size of the payload data.
+         * @param format The reliability header layout the connection agreed on.
          * @return True if parsing was successful, false otherwise.
          */
         static bool ParsePacket(
             const uint8_t* buffer,
             uint32_t size,
             GeneralPacketHeader& outGeneralHeader,
-            ReliabilityPacketHeader& outReliabilityHeader,
+            ExtendedReliabilityPacketHeader& outReliabilityHeader,
             const uint8_t*& outPayload,
-            uint32_t& outPayloadSize
+            uint32_t& outPayloadSize,
+            ReliabilityHeaderFormat format = ReliabilityHeaderFormat::Compact
+        );
+
+        /**
+         * @brief Strips the ChannelHeader from the front of a channel packet's payload.
+         * @param payload In: the payload returned by ParsePacket. Out: the bytes after the channel header.
+         * @param payloadSize Updated to match payload.
+         * @return False if the payload is too short.
+         */
+        static bool ParseChannelHeader(
+            const uint8_t*& payload,
+            uint32_t& payloadSize,
+            ChannelHeader& outChannelHeader
+        );
+
+        /**
+         * @brief Strips the SnapshotHeader from the front of a Data_Snapshot payload, like ParseChannelHeader.
+         * @return False if the payload is too short or the baseline is not older than the snapshot.
+         */
+        static bool ParseSnapshotHeader(
+            const uint8_t*& payload,
+            uint32_t& payloadSize,
+            SnapshotHeader& outSnapshotHeader
+        );
+
+        /**
+         * @brief Strips the FragmentHeader from the front of a fragment packet's payload.
+         * @param payload In: the payload returned by ParsePacket. Out: the fragment's piece of the message.
+         * @param payloadSize Updated to match payload.
+         * @return False if the payload is too short or the header is inconsistent
+         *         (index out of range, too many pieces, or an inner type that cannot be fragmented).
+         */
+        static bool ParseFragmentHeader(
+            const uint8_t*& payload,
+            uint32_t& payloadSize,
+            FragmentHeader& outFragmentHeader
+        );
+
+        /**
+         * @brief Splits a message body into fragment buffers of at most pieceSize bytes each.
+         * Every buffer holds a FragmentHeader and its piece, with headroom left for the general
+         * and reliability headers; packetize each as Data_Reliable_Fragment or Data_Unreliable_Fragment.
+         * @param message The body of one innerType packet (its ChannelHeader, if any, then the compressed payload).
+         * @return The fragments in index order, or an empty vector if more than MAX_FRAGMENTS_PER_MESSAGE are needed.
+         */
+        static std::vector<Networking::PacketBufferPtr> CreateFragments(
+            std::span<const uint8_t> message,
+            PacketType innerType,
+            uint16_t messageId,
+            uint32_t pieceSize
         );
 
         /**
@@ -41,28 +94,26 @@ namespace RiftNet::Protocol {
         static std::vector<uint8_t> CreateSimplePacket(PacketType type);
 
         /**
-         * @brief Creates a reliable data packet.
+         * @brief Turns a payload buffer into a reliable data packet in place.
          * @param reliabilityState The state of the connection to generate sequence/ack numbers.
-         * @param payload The application data to send.
-         * @param payloadSize The size of the application data.
-         * @return A byte vector containing the serialized packet.
+         * @param packet A buffer holding the application data; headers are prepended into its headroom.
+         * @param type Data_Reliable, or Data_Reliable_Coalesced for a batch of framed messages.
+         * @return True on success, false if the buffer lacks headroom.
          */
-        static std::vector<uint8_t> CreateReliableDataPacket(
+        static bool CreateReliableDataPacket(
             ReliableConnectionState& reliabilityState,
-            const uint8_t* payload,
-            uint32_t payloadSize
+            const Networking::PacketBufferPtr& packet,
+            PacketType type = PacketType::Data_Reliable
         );
 
         /**
-         * @brief Creates an unreliable data packet.
-         * @param payload The application data to send.
-         * @param payloadSize The size of the application data.
-         * @return A byte vector containing the serialized packet.
+         * @brief Turns a payload buffer into an unreliable data packet in place.
+         * @param packet A buffer holding the application data; the header is prepended into its headroom.
+         * @param type Data_Unreliable, or Data_Unreliable_Coalesced for a batch of framed messages.
+         * @return True on success, false if the buffer lacks headroom.
          */
-        static std::vector<uint8_t> CreateUnreliableDataPacket(
-            const uint8_t* payload,
-            uint32_t payloadSize
-        );
+        static bool CreateUnreliableDataPacket(Networking::PacketBuffer& packet,
+            PacketType type = PacketType::Data_Unreliable);
     };
 
 } // namespace RiftNet::Protocol
@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "PathMtuProber.hpp"
+
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <iterator>
+
+namespace RiftNet::Protocol {
+
+    PathMtuProber::PathMtuProber(uint32_t baseSize)
+        : m_datagramSize(baseSize) {
+        Advance();
+    }
+
+    uint32_t PathMtuProber::PollProbe(std::chrono::steady_clock::time_point now, std::chrono::milliseconds timeout) {
+        if (!IsSearching() || now < m_nextProbe) {
+            return 0;
+        }
+        if (m_attempts >= PMTU_PROBE_ATTEMPTS) {
+            RF_NETWORK_DEBUG("Path MTU probe of {} bytes unanswered; keeping {} byte datagrams",
+                PMTU_PROBE_SIZES[m_candidate], m_datagramSize);
+            m_candidate = std::size(PMTU_PROBE_SIZES);
+            return 0;
+        }
+        ++m_attempts;
+        m_nextProbe = now + timeout;
+        return PMTU_PROBE_SIZES[m_candidate];
+    }
+
+    bool PathMtuProber::OnProbeAck(uint32_t size) {
+        if (!IsSearching() || size != PMTU_PROBE_SIZES[m_candidate]) {
+            return false; // late ack of an earlier candidate, or a forged size
+        }
+        m_datagramSize = size;
+        RF_NETWORK_DEBUG("Path MTU probe of {} bytes acknowledged", size);
+        ++m_candidate;
+        Advance();
+        m_nextProbe = {}; // try the next candidate straight away
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point PathMtuProber::GetNextProbeTime() const {
+        return IsSearching() ? m_nextProbe : std::chrono::steady_clock::time_point::max();
+    }
+
+    void PathMtuProber::Advance() {
+        // Skip candidates no larger than what already works
+        while (IsSearching() && PMTU_PROBE_SIZES[m_candidate] <= m_datagramSize) {
+            ++m_candidate;
+        }
+        m_attempts = 0;
+    }
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace RiftNet::Protocol {
+
+    // Datagram sizes (UDP payload bytes) tried in turn above the configured size: the IPv6
+    // minimum MTU, a common tunnelled Ethernet path, and a full 1500-byte Ethernet MTU over IPv4.
+    constexpr uint32_t PMTU_PROBE_SIZES[] = { 1280, 1400, 1472 };
+    constexpr uint32_t PMTU_PROBE_ATTEMPTS = 3;
+
+    /**
+     * @class PathMtuProber
+     * @brief Searches upward for the largest datagram the path delivers, DPLPMTUD-style (RFC 8899).
+     * Sends padded probes of each candidate size in turn; an acknowledged probe raises the datagram
+     * size and moves to the next candidate, and a candidate unacknowledged after
+     * PMTU_PROBE_ATTEMPTS tries ends the search. Never lowers the size. Not thread-safe.
+     */
+    class PathMtuProber {
+    public:
+        // @param baseSize The size known to work; only larger candidates are probed.
+        explicit PathMtuProber(uint32_t baseSize);
+
+        /**
+         * @brief Called periodically once the connection is secure.
+         * @param timeout How long to wait for a probe's ack before trying again.
+         * @return The size of probe to send now, or 0 if none is due.
+         */
+        uint32_t PollProbe(std::chrono::steady_clock::time_point now, std::chrono::milliseconds timeout);
+
+        // @return True if the probe raised the datagram size.
+        bool OnProbeAck(uint32_t size);
+
+        uint32_t GetDatagramSize() const { return m_datagramSize; }
+        bool IsSearching() const { return m_candidate < std::size(PMTU_PROBE_SIZES); }
+
+        // When PollProbe next returns a size, or time_point::max() once the search is over.
+        std::chrono::steady_clock::time_point GetNextProbeTime() const;
+
+    private:
+        void Advance();
+
+        uint32_t m_datagramSize;
+        size_t   m_candidate{ 0 };
+        uint32_t m_attempts{ 0 };
+        std::chrono::steady_clock::time_point m_nextProbe{}; // epoch: probe on the first poll
+    };
+
+} // namespace RiftNet::Protocol
@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "PendingSendQueue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace RiftNet::Protocol {
+
+    namespace {
+        size_t ClampCapacity(size_t capacity) {
+            return (std::min)((std::max)(capacity, MIN_PENDING_SEND_CAPACITY), MAX_PENDING_SEND_CAPACITY);
+        }
+    }
+
+    PendingSendQueue::PendingSendQueue(size_t capacity, PendingOverflowPolicy policy)
+        : m_capacity(ClampCapacity(capacity)), m_policy(policy) {
+    }
+
+    PendingSendQueue::PendingSendQueue(PendingSendQueue&& other) noexcept
+        : m_storage(std::move(other.m_storage)), m_capacity(other.m_capacity), m_head(other.m_head),
+          m_used(other.m_used), m_count(other.m_count), m_removed(other.m_removed), m_policy(other.m_policy) {
+        other.Clear();
+    }
+
+    PendingSendQueue& PendingSendQueue::operator=(PendingSendQueue&& other) noexcept {
+        if (this != &other) {
+            m_storage = std::move(other.m_storage);
+            m_capacity = other.m_capacity;
+            m_head = other.m_head;
+            m_used = other.m_used;
+            m_count = other.m_count;
+            m_removed = other.m_removed;
+            m_policy = other.m_policy;
+            other.Clear();
+        }
+        return *this;
+    }
+
+    void PendingSendQueue::Configure(size_t capacity, PendingOverflowPolicy policy) {
+        capacity = ClampCapacity(capacity);
+        if (capacity != m_capacity) {
+            m_storage.reset();
+            m_capacity = capacity;
+        }
+        m_policy = policy;
+        Clear();
+    }
+
+    PendingSendQueue::PushResult PendingSendQueue::Push(std::span<const uint8_t> data, bool reliable, uint8_t channel,
+        size_t& outEvicted) {
+        outEvicted = 0;
+        const size_t needed = HEADER_SIZE + data.size();
+        const PushResult refused = m_policy == PendingOverflowPolicy::Reject ? PushResult::Rejected : PushResult::Dropped;
+        if (needed > m_capacity) {
+            return refused; // would not fit even in an empty ring
+        }
+
+        if (m_used + needed > m_capacity) {
+            if (m_policy != PendingOverflowPolicy::DropOldest) {
+                return refused;
+            }
+            while (m_used + needed > m_capacity) {
+                PopFront();
+                ++outEvicted;
+            }
+        }
+
+        if (!m_storage) {
+            m_storage = std::make_unique<uint8_t[]>(m_capacity);
+        }
+
+        const uint32_t size = static_cast<uint32_t>(data.size());
+        const uint8_t header[HEADER_SIZE] = {
+            static_cast<uint8_t>(size), static_cast<uint8_t>(size >> 8),
+            static_cast<uint8_t>(size >> 16), static_cast<uint8_t>(size >> 24),
+            static_cast<uint8_t>(reliable ? 1 : 0), channel };
+
+        const size_t tail = (m_head + m_used) % m_capacity;
+        WriteAt(tail, header, HEADER_SIZE);
+        WriteAt((tail + HEADER_SIZE) % m_capacity, data.data(), data.size());
+        m_used += needed;
+        ++m_count;
+        return PushResult::Queued;
+    }
+
+    PendingSendQueue PendingSendQueue::Take() {
+        return PendingSendQueue(std::move(*this)); // keeps m_capacity and m_policy here
+    }
+
+    void PendingSendQueue::DropBefore(uint64_t sequence) {
+        while (m_count != 0 && m_removed < sequence) {
+            PopFront();
+        }
+    }
+
+    void PendingSendQueue::Clear() {
+        m_removed += m_count;
+        m_head = 0;
+        m_used = 0;
+        m_count = 0;
+    }
+
+    uint32_t PendingSendQueue::DecodeSize(const uint8_t* header) {
+        return static_cast<uint32_t>(header[0]) | (static_cast<uint32_t>(header[1]) << 8) |
+            (static_cast<uint32_t>(header[2]) << 16) | (static_cast<uint32_t>(header[3]) << 24);
+    }
+
+    void PendingSendQueue::WriteAt(size_t offset, const uint8_t* src, size_t size) {
+        if (size == 0) return;
+        const size_t first = (std::min)(size, m_capacity - offset);
+        std::memcpy(m_storage.get() + offset, src, first);
+        std::memcpy(m_storage.get(), src + first, size - first);
+    }
+
+    void PendingSendQueue::ReadAt(size_t offset, uint8_t* dst, size_t size) const {
+        const size_t first = (std::min)(size, m_capacity - offset);
+        std::memcpy(dst, m_storage.get() + offset, first);
+        std::memcpy(dst + first, m_storage.get(), size - first);
+    }
+
+    void PendingSendQueue::PopFront() {
+        uint8_t header[HEADER_SIZE];
+        ReadAt(m_head, header, HEADER_SIZE);
+        const size_t record = HEADER_SIZE + DecodeSize(header);
+        m_head = (m_head + record) % m_capacity;
+        m_used -= record;
+        --m_count;
+        ++m_removed;
+        if (m_count == 0) {
+            m_head = 0;
+        }
+    }
+
+    void PendingSendQueue::Linearize() {
+        if (m_head + m_used > m_capacity) {
+            std::rotate(m_storage.get(), m_storage.get() + m_head, m_storage.get() + m_capacity);
+            m_head = 0;
+        }
+    }
+
+} // namespace RiftNet::Protocol
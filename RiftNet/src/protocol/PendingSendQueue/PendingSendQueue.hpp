@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+
+namespace RiftNet::Protocol {
+
+    // Bytes of messages (plus a small header each) one connection holds until it is secure.
+    constexpr size_t DEFAULT_PENDING_SEND_CAPACITY = 512 * 1024;
+    constexpr size_t MIN_PENDING_SEND_CAPACITY = 4 * 1024;
+    constexpr size_t MAX_PENDING_SEND_CAPACITY = 16 * 1024 * 1024;
+
+    // What PendingSendQueue::Push does with a message that does not fit.
+    enum class PendingOverflowPolicy : uint8_t {
+        DropOldest = 0, // evict queued messages, oldest first, until it fits
+        DropNewest,     // drop the new message; the send still reports success
+        Reject,         // drop the new message and report the send as failed
+    };
+
+    /**
+     * @class PendingSendQueue
+     * @brief Messages sent before the handshake completes, held in order in one ring buffer.
+     * The buffer is allocated on the first push and each message is copied once, as
+     * [u32 size][u8 reliable][u8 channel][bytes]. Messages are numbered in push order, so a
+     * caller can refer to a prefix of the queue across later pushes and evictions. Not thread-safe.
+     */
+    class PendingSendQueue {
+    public:
+        enum class PushResult { Queued, Dropped, Rejected };
+
+        explicit PendingSendQueue(size_t capacity = DEFAULT_PENDING_SEND_CAPACITY,
+            PendingOverflowPolicy policy = PendingOverflowPolicy::DropOldest);
+
+        PendingSendQueue(PendingSendQueue&& other) noexcept;
+        PendingSendQueue& operator=(PendingSendQueue&& other) noexcept;
+        PendingSendQueue(const PendingSendQueue&) = delete;
+        PendingSendQueue& operator=(const PendingSendQueue&) = delete;
+
+        // Sets the capacity (clamped to [MIN_PENDING_SEND_CAPACITY, MAX_PENDING_SEND_CAPACITY]) and
+        // overflow policy. Drops anything queued.
+        void Configure(size_t capacity, PendingOverflowPolicy policy);
+
+        /**
+         * @brief Appends a message, applying the overflow policy if it does not fit.
+         * @param outEvicted Set to the number of older messages DropOldest evicted to make room.
+         */
+        PushResult Push(std::span<const uint8_t> data, bool reliable, uint8_t channel, size_t& outEvicted);
+
+        /**
+         * @brief Moves the queued messages, and the buffer, into a new queue and leaves this one
+         * empty with the same settings, so they can be drained without holding the owner's lock.
+         */
+        PendingSendQueue Take();
+
+        /**
+         * @brief Calls fn(std::span<const uint8_t> data, bool reliable, uint8_t channel) for each
+         * message in order, then empties the queue. The spans point into the ring buffer.
+         */
+        template <typename Fn>
+        void Drain(Fn&& fn) {
+            Linearize();
+            size_t offset = m_head;
+            for (size_t i = 0; i < m_count; ++i) {
+                uint8_t header[HEADER_SIZE];
+                std::memcpy(header, m_storage.get() + offset, HEADER_SIZE);
+                const uint32_t size = DecodeSize(header);
+                fn(std::span<const uint8_t>(m_storage.get() + offset + HEADER_SIZE, size), header[4] != 0, header[5]);
+                offset += HEADER_SIZE + size;
+            }
+            Clear();
+        }
+
+        /**
+         * @brief Calls fn(data, reliable, channel) for each message in order, stopping at the first
+         * call that returns false. The queue is left as it was; the spans point into the ring buffer.
+         */
+        template <typename Fn>
+        void ForEach(Fn&& fn) {
+            Linearize();
+            size_t offset = m_head;
+            for (size_t i = 0; i < m_count; ++i) {
+                uint8_t header[HEADER_SIZE];
+                std::memcpy(header, m_storage.get() + offset, HEADER_SIZE);
+                const uint32_t size = DecodeSize(header);
+                if (!fn(std::span<const uint8_t>(m_storage.get() + offset + HEADER_SIZE, size), header[4] != 0, header[5])) {
+                    return;
+                }
+                offset += HEADER_SIZE + size;
+            }
+        }
+
+        // Number of the oldest queued message (or of the next push, if empty).
+        uint64_t GetFrontSequence() const { return m_removed; }
+        // Removes the queued messages numbered below sequence.
+        void DropBefore(uint64_t sequence);
+
+        void Clear();
+        bool Empty() const { return m_count == 0; }
+        size_t GetCount() const { return m_count; }
+        size_t GetUsedBytes() const { return m_used; }
+        size_t GetCapacity() const { return m_capacity; }
+        PendingOverflowPolicy GetPolicy() const { return m_policy; }
+
+    private:
+        static constexpr size_t HEADER_SIZE = 6;
+
+        static uint32_t DecodeSize(const uint8_t* header);
+
+        // Copies between the ring and a flat buffer, wrapping at the end of the ring
+        void WriteAt(size_t offset, const uint8_t* src, size_t size);
+        void ReadAt(size_t offset, uint8_t* dst, size_t size) const;
+
+        void PopFront();
+        // Rotates the ring so the queued messages are contiguous from m_head
+        void Linearize();
+
+        std::unique_ptr<uint8_t[]> m_storage; // null until the first push
+        size_t m_capacity;
+        size_t m_head{ 0 };  // offset of the oldest message
+        size_t m_used{ 0 };  // bytes queued, headers included
+        size_t m_count{ 0 };
+        uint64_t m_removed{ 0 }; // messages ever removed: the number of the one at m_head
+        PendingOverflowPolicy m_policy;
+    };
+
+} // namespace RiftNet::Protocol
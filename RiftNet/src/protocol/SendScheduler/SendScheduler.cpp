@@ -0,0 +1,107 @@
+#include "pch.h"
+#include "SendScheduler.hpp"
+
+#include <algorithm>
+
+namespace RiftNet::Protocol {
+
+    // ---------------- SendBudget ----------------
+
+    void SendBudget::Configure(uint32_t bytesPerTick, std::chrono::steady_clock::duration tick) {
+        m_bytesPerTick = bytesPerTick;
+        m_tick = tick > std::chrono::steady_clock::duration::zero() ? tick
+            : std::chrono::duration_cast<std::chrono::steady_clock::duration>(DEFAULT_SEND_BUDGET_TICK);
+        m_started = false;
+    }
+
+    void SendBudget::Refill(std::chrono::steady_clock::time_point now) {
+        if (!m_started) {
+            m_started = true;
+            m_credit = m_bytesPerTick;
+            m_tickStart = now;
+            return;
+        }
+        if (now < m_tickStart + m_tick) return;
+
+        const auto ticks = (now - m_tickStart) / m_tick;
+        m_tickStart += ticks * m_tick;
+        // An overdraft is paid off tick by tick; unused credit is lost
+        m_credit = (std::min)(m_credit + static_cast<int64_t>(ticks) * m_bytesPerTick, static_cast<int64_t>(m_bytesPerTick));
+    }
+
+    bool SendBudget::CanSend(std::chrono::steady_clock::time_point now) {
+        if (m_bytesPerTick == 0) return true;
+        Refill(now);
+        return m_credit > 0;
+    }
+
+    void SendBudget::OnSent(uint32_t bytes) {
+        if (m_bytesPerTick != 0) {
+            m_credit -= bytes;
+        }
+    }
+
+    std::chrono::steady_clock::time_point SendBudget::NextSendTime(std::chrono::steady_clock::time_point now) {
+        if (CanSend(now)) {
+            return now;
+        }
+        const int64_t ticks = -m_credit / m_bytesPerTick + 1; // credit turns positive after this many refills
+        return m_tickStart + ticks * m_tick;
+    }
+
+    // ---------------- SendScheduler ----------------
+
+    uint64_t SendScheduler::Supersede(uint64_t key) {
+        Latest& latest = m_latest[key];
+        latest.generation = m_nextGeneration++;
+        latest.queued = 0;
+        return latest.generation;
+    }
+
+    void SendScheduler::Push(SendPriority priority, const RiftNet::Networking::PacketBufferPtr& packet, PacketType type,
+        bool reliable, uint64_t key, uint64_t generation) {
+        m_queues[static_cast<size_t>(priority)].push_back(Entry{ packet, type, reliable, packet->Size(), key, generation });
+        ++m_count;
+        if (!reliable) {
+            m_unreliableBytes += packet->Size();
+        }
+        if (key != 0) {
+            ++m_latest[key].queued;
+        }
+    }
+
+    bool SendScheduler::IsCurrent(const Entry& entry) const {
+        if (entry.key == 0) return true;
+        const auto it = m_latest.find(entry.key);
+        return it != m_latest.end() && it->second.generation == entry.generation;
+    }
+
+    SendScheduler::Entry* SendScheduler::Front(size_t priority) {
+        auto& queue = m_queues[priority];
+        while (!queue.empty() && !IsCurrent(queue.front())) {
+            Remove(priority);
+        }
+        return queue.empty() ? nullptr : &queue.front();
+    }
+
+    void SendScheduler::PopFront(size_t priority) {
+        const Entry& entry = m_queues[priority].front();
+        if (entry.key != 0) {
+            const auto it = m_latest.find(entry.key);
+            if (it != m_latest.end() && it->second.generation == entry.generation && --it->second.queued == 0) {
+                m_latest.erase(it); // nothing left to supersede
+            }
+        }
+        Remove(priority);
+    }
+
+    void SendScheduler::Remove(size_t priority) {
+        auto& queue = m_queues[priority];
+        if (!queue.front().reliable) {
+            m_unreliableBytes -= queue.front().bytes;
+        }
+        queue.pop_front();
+        --m_count;
+    }
+
+} // namespace RiftNet::Protocol
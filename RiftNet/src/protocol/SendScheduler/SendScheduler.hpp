@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../Packet/Packet.hpp"
+#include "../../core/buffer/PacketBuffer.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace RiftNet::Protocol {
+
+    // How urgently a queued data packet goes out; lower values first.
+    enum class SendPriority : uint8_t {
+        Critical = 0, // inputs, hit confirmations
+        High,
+        Normal,       // everything sent without options, coalesced batches included
+        Low,          // bulk state
+    };
+    constexpr size_t SEND_PRIORITY_COUNT = 4;
+
+    // The tick a SendBudget applies to when none is given: one frame at 60 Hz, give or take.
+    constexpr auto DEFAULT_SEND_BUDGET_TICK = std::chrono::milliseconds(16);
+
+    // Per-message send options. They only matter while a connection queues its data packets,
+    // i.e. with a congestion controller or a send budget; otherwise every send goes out at once.
+    struct SendOptions {
+        SendPriority priority{ SendPriority::Normal };
+        // 0 = none. Else, for unreliable messages only: a message still queued with the same key
+        // (and packet type) is dropped when this one is queued, so only the newest version goes out.
+        uint32_t latestKey{ 0 };
+
+        bool IsDefault() const { return priority == SendPriority::Normal && latestKey == 0; }
+    };
+
+    /**
+     * @class SendBudget
+     * @brief Caps the payload bytes a connection sends per tick. Credit is reset to the budget at
+     * the start of each tick; a datagram may go out whenever credit is left and may take it negative,
+     * so datagrams larger than the budget never stall, and the overdraft is paid from later ticks.
+     * Unused credit does not carry over. Not thread-safe.
+     */
+    class SendBudget {
+    public:
+        // 0 bytes disables the budget (CanSend is always true); a zero tick is DEFAULT_SEND_BUDGET_TICK.
+        void Configure(uint32_t bytesPerTick, std::chrono::steady_clock::duration tick);
+        bool IsEnabled() const { return m_bytesPerTick != 0; }
+
+        bool CanSend(std::chrono::steady_clock::time_point now);
+        void OnSent(uint32_t bytes);
+
+        // When CanSend next becomes true (now if it already is).
+        std::chrono::steady_clock::time_point NextSendTime(std::chrono::steady_clock::time_point now);
+
+    private:
+        void Refill(std::chrono::steady_clock::time_point now);
+
+        uint32_t m_bytesPerTick{ 0 };
+        std::chrono::steady_clock::duration m_tick{ std::chrono::milliseconds(1) };
+        int64_t  m_credit{ 0 };
+        bool     m_started{ false };
+        std::chrono::steady_clock::time_point m_tickStart;
+    };
+
+    /**
+     * @class SendScheduler
+     * @brief A connection's queued data packets: one FIFO per SendPriority, so urgent traffic
+     * overtakes bulk traffic while each priority keeps its send order (channel order and fragment
+     * order survive within a priority). Unreliable packets may carry a latest-only key; queuing a
+     * new message with a key supersedes the queued packets of older ones, which are then skipped
+     * without being sent. Not thread-safe.
+     */
+    class SendScheduler {
+    public:
+        struct Entry {
+            RiftNet::Networking::PacketBufferPtr packet;
+            PacketType type;
+            bool       reliable;
+            uint32_t   bytes;      // packet size when queued, before headers are added
+            uint64_t   key;        // 0 = none
+            uint64_t   generation; // which message with this key the packet belongs to
+        };
+
+        /**
+         * @brief Starts a new message with a latest-only key, superseding the queued packets of
+         * earlier messages with the same key.
+         * @return The generation to push the message's packets with.
+         */
+        uint64_t Supersede(uint64_t key);
+
+        // Appends a packet; key 0 for none, else key and generation from Supersede.
+        void Push(SendPriority priority, const RiftNet::Networking::PacketBufferPtr& packet, PacketType type,
+            bool reliable, uint64_t key = 0, uint64_t generation = 0);
+
+        // The oldest current packet of a priority, after dropping superseded ones ahead of it; nullptr if none.
+        Entry* Front(size_t priority);
+        // Removes the packet Front returned.
+        void PopFront(size_t priority);
+
+        bool Empty() const { return m_count == 0; }
+        size_t GetUnreliableBytes() const { return m_unreliableBytes; }
+
+    private:
+        struct Latest {
+            uint64_t generation{ 0 };
+            uint32_t queued{ 0 }; // packets of that generation still queued
+        };
+
+        bool IsCurrent(const Entry& entry) const;
+        void Remove(size_t priority);
+
+        std::array<std::deque<Entry>, SEND_PRIORITY_COUNT> m_queues;
+        std::unordered_map<uint64_t, Latest> m_latest; // keys with packets queued
+        uint64_t m_nextGeneration{ 1 };
+        size_t   m_count{ 0 };
+        size_t   m_unreliableBytes{ 0 };
+    };
+
+} // namespace RiftNet::Protocol
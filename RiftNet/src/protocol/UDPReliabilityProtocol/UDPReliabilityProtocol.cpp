@@ -1,7 +1,11 @@
 ﻿#include "pch.h"
 #include "UDPReliabilityProtocol.hpp"
 #include <algorithm> // For std::clamp
+#include <bit>       // For std::countr_zero
 #include <cmath>     // For std::abs
+#include <cstring>
+#include <limits>
+#include <thread>
 
 namespace RiftNet::Protocol {
 
@@ -12,181 +16,749 @@ namespace RiftNet::Protocol {
     namespace { // Anonymous namespace for internal linkage
 
         // Helper to check if sequence number s1 is more recent than s2.
-        // This correctly handles wrapping around the 16-bit sequence number space.
-        bool IsSequenceMoreRecent(uint16_t s1, uint16_t s2) {
-            constexpr uint16_t halfRange = (UINT16_MAX / 2) + 1;
-            return ((s1 > s2) && (s1 - s2 < halfRange)) || ((s2 > s1) && (s2 - s1 > halfRange));
+        // This correctly handles wrapping around the 32-bit sequence number space.
+        bool IsSequenceMoreRecent(uint32_t s1, uint32_t s2) {
+            return static_cast<int32_t>(s1 - s2) > 0;
+        }
+
+        // Recovers the full sequence number of a 16-bit Compact wire value: the 32-bit value
+        // with those low bits that lies closest to reference.
+        uint32_t WidenSequence(uint32_t wire, uint32_t reference) {
+            const uint32_t candidate = (reference & 0xFFFF0000u) | (wire & 0xFFFFu);
+            const int32_t delta = static_cast<int32_t>(candidate - reference);
+            if (delta > 0x8000) return candidate - 0x10000u;
+            if (delta < -0x8000) return candidate + 0x10000u;
+            return candidate;
+        }
+
+        // --- 128-bit ack bitmaps (bit d of word d / 64) ---
+        using AckBits = std::array<uint64_t, 2>;
+
+        bool TestBit(const AckBits& bits, uint32_t d) {
+            return ((bits[d >> 6] >> (d & 63)) & 1) != 0;
+        }
+
+        void SetBit(AckBits& bits, uint32_t d) {
+            bits[d >> 6] |= uint64_t{ 1 } << (d & 63);
+        }
+
+        using TimeTicks = ReliableConnectionState::TimeTicks;
+        constexpr TimeTicks NEVER = (std::numeric_limits<TimeTicks>::max)();
+
+        TimeTicks ToTicks(std::chrono::steady_clock::time_point t) {
+            return t.time_since_epoch().count();
+        }
+
+        std::chrono::steady_clock::time_point FromTicks(TimeTicks ticks) {
+            return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(ticks));
+        }
+
+        std::chrono::steady_clock::time_point RetransmitDue(const ReliableConnectionState::SentPacket& packet) {
+            return packet.timeSent + std::chrono::microseconds(static_cast<int64_t>(packet.retransmitTimeout_ms * 1000.0f));
         }
 
         // Updates the RTT (Round-Trip Time) and RTO (Retransmission Timeout) using a standard algorithm.
+        // Owner only; other threads read the results.
         void ApplyRTTSample(ReliableConnectionState& state, float sampleRTT_ms) {
             constexpr float RTT_ALPHA = 0.125f;
             constexpr float RTT_BETA = 0.250f;
             constexpr float RTO_K = 4.0f;
-            constexpr float MIN_RTO_MS = 100.0f;
-            constexpr float MAX_RTO_MS = 3000.0f;
 
+            state.rttSamples.RecordMicros(static_cast<uint64_t>((std::max)(sampleRTT_ms, 0.0f) * 1000.0f));
+
+            float smoothed = state.smoothedRTT_ms.load(std::memory_order_relaxed);
+            float variance = state.rttVariance_ms.load(std::memory_order_relaxed);
             if (state.isFirstRTTSample) {
-                state.smoothedRTT_ms = sampleRTT_ms;
-                state.rttVariance_ms = sampleRTT_ms / 2.0f;
+                smoothed = sampleRTT_ms;
+                variance = sampleRTT_ms / 2.0f;
                 state.isFirstRTTSample = false;
             }
             else {
-                const float delta = sampleRTT_ms - state.smoothedRTT_ms;
-                state.smoothedRTT_ms += RTT_ALPHA * delta;
-                state.rttVariance_ms += RTT_BETA * (std::abs(delta) - state.rttVariance_ms);
+                const float delta = sampleRTT_ms - smoothed;
+                smoothed += RTT_ALPHA * delta;
+                variance += RTT_BETA * (std::abs(delta) - variance);
             }
+            state.smoothedRTT_ms.store(smoothed, std::memory_order_relaxed);
+            state.rttVariance_ms.store(variance, std::memory_order_relaxed);
             // FIX: Wrap std::clamp in parentheses to prevent macro expansion on Windows.
-            state.retransmissionTimeout_ms = (std::clamp)(
-                state.smoothedRTT_ms + RTO_K * state.rttVariance_ms,
-                MIN_RTO_MS, MAX_RTO_MS);
+            state.retransmissionTimeout_ms.store((std::clamp)(smoothed + RTO_K * variance,
+                state.minRto_ms.load(std::memory_order_relaxed), state.maxRto_ms.load(std::memory_order_relaxed)),
+                std::memory_order_relaxed);
         }
 
-    } // end anonymous namespace
+        constexpr uint32_t WINDOW_MASK = RELIABLE_SEND_WINDOW_SIZE - 1;
+        constexpr uint32_t RECEIVE_MASK = RECEIVE_WINDOW_SLOTS - 1;
 
+        ReliableConnectionState::SentPacket& WindowSlot(ReliableConnectionState& state, uint32_t sequence) {
+            return state.sendWindow[sequence & WINDOW_MASK];
+        }
 
-    // =========================
-    // Public API Implementation
-    // =========================
+        std::atomic<TimeTicks>& RetransmitDueSlot(ReliableConnectionState& state, uint32_t sequence) {
+            return state.retransmitDue[sequence & WINDOW_MASK];
+        }
 
-    bool UDPReliabilityProtocol::ProcessIncomingHeader(
-        ReliableConnectionState& state,
-        const ReliabilityPacketHeader& header)
-    {
-        std::lock_guard<std::mutex> lock(state.stateMutex);
-        state.lastPacketReceivedTime = std::chrono::steady_clock::now();
+        // Owner only: the slot holding `sequence` if that packet is still unacknowledged. Slots of
+        // sequences before the window start may already be refilled by a sender, so they are never touched.
+        ReliableConnectionState::SentPacket* FindInFlight(ReliableConnectionState& state, uint32_t sequence) {
+            if (IsSequenceMoreRecent(state.oldestUnackedSequence.load(std::memory_order_relaxed), sequence)) {
+                return nullptr;
+            }
+            auto& slot = WindowSlot(state, sequence);
+            if (slot.published.load(std::memory_order_acquire) != sequence || !slot.inUse) {
+                return nullptr;
+            }
+            return &slot;
+        }
 
-        // --- 1. Process Acks and Update RTT ---
-        // Iterate through our list of sent packets that are waiting for an ack.
-        for (auto it = state.unacknowledgedPackets.begin(); it != state.unacknowledgedPackets.end(); ) {
-            bool isAcked = false;
-            if (it->sequence == header.ack) {
-                isAcked = true;
-            }
-            else if (IsSequenceMoreRecent(header.ack, it->sequence)) {
-                const uint16_t diff = header.ack - it->sequence;
-                if (diff > 0 && diff <= 32) {
-                    if ((header.ack_bitfield >> (diff - 1)) & 1) {
-                        isAcked = true;
+        // Publishes what senders read of the congestion controller. Owner only, after it fed the controller.
+        void PublishCongestion(ReliableConnectionState& state) {
+            if (state.congestion) {
+                state.congestionWindow.store(state.congestion->GetCongestionWindow(), std::memory_order_relaxed);
+                state.pacingRate.store(state.congestion->GetPacingRate(state.smoothedRTT_ms.load(std::memory_order_relaxed)),
+                    std::memory_order_relaxed);
+            }
+            else {
+                state.congestionWindow.store((std::numeric_limits<uint32_t>::max)(), std::memory_order_relaxed);
+                state.pacingRate.store(0.0, std::memory_order_relaxed);
+            }
+        }
+
+        // Releases the slot for sequence if it still holds that packet. Karn's rule: only packets
+        // that were never resent give an RTT sample, since an ack of a resent one is ambiguous.
+        void AcknowledgeSequence(ReliableConnectionState& state, uint32_t sequence, std::chrono::steady_clock::time_point now) {
+            auto* slot = FindInFlight(state, sequence);
+            if (!slot) return;
+
+            float rtt_ms = -1.0f;
+            if (slot->retries == 0) {
+                auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(now - slot->timeSent).count();
+                rtt_ms = static_cast<float>(rtt) / 1000.0f;
+                ApplyRTTSample(state, rtt_ms);
+            }
+
+            const uint32_t inFlightBefore = state.bytesInFlight.fetch_sub(slot->size, std::memory_order_relaxed);
+            const uint64_t delivered = state.deliveredBytes.load(std::memory_order_relaxed) + slot->size;
+            state.deliveredBytes.store(delivered, std::memory_order_relaxed);
+            state.deliveredTime.store(ToTicks(now), std::memory_order_relaxed);
+
+            if (state.congestion) {
+                // Delivery rate: bytes acked between this packet's send and its ack, over that time
+                CongestionAckSample sample;
+                sample.bytes = slot->size;
+                sample.bytesInFlight = inFlightBefore;
+                sample.rtt_ms = rtt_ms;
+                sample.delivered = delivered;
+                sample.deliveredAtSend = slot->deliveredAtSend;
+                sample.now = now;
+                const double interval = std::chrono::duration<double>(now - slot->deliveredTimeAtSend).count();
+                if (interval > 0.0) {
+                    sample.deliveryRate = static_cast<double>(delivered - slot->deliveredAtSend) / interval;
+                }
+                state.congestion->OnPacketAcked(sample);
+            }
+            if (slot->fastRetransmitPending) {
+                state.fastRetransmitsPending.fetch_sub(1, std::memory_order_relaxed);
+            }
+            slot->inUse = false;
+            slot->fastRetransmitPending = false;
+            slot->data.reset();
+            RetransmitDueSlot(state, sequence).store(NEVER, std::memory_order_relaxed);
+            state.unackedCount.fetch_sub(1, std::memory_order_release);
+        }
+
+        // Counts one more ack that skipped this packet; queues a fast retransmit at the threshold.
+        // Only acks for packets sent after this one's latest transmission count, so acks that
+        // were already in flight when it was resent do not trigger a second, spurious resend.
+        void NoteMissing(ReliableConnectionState& state, uint32_t sequence, std::chrono::steady_clock::time_point ackedSentAt,
+            std::chrono::steady_clock::time_point now) {
+            auto* slot = FindInFlight(state, sequence);
+            if (!slot || slot->fastRetransmitPending) return;
+            if (slot->timeSent >= ackedSentAt) return;
+
+            if (++slot->nackCount >= FAST_RETRANSMIT_THRESHOLD) {
+                slot->fastRetransmitPending = true;
+                state.fastRetransmitsPending.fetch_add(1, std::memory_order_release);
+                if (state.congestion) {
+                    state.congestion->OnPacketLost(slot->size, slot->timeSent, now, /*timeout=*/false);
+                }
+            }
+        }
+
+        void Resend(ReliableConnectionState::SentPacket& packet, std::chrono::steady_clock::time_point now,
+            const std::function<void(const Networking::PacketBufferPtr&)>& sendFunc) {
+            sendFunc(packet.data);
+            packet.timeSent = now;
+            packet.retries++;
+            packet.nackCount = 0;
+        }
+
+        // Applies the acks in an incoming header (ack already widened) to the send window. Owner only.
+        void ProcessAcks(ReliableConnectionState& state, const AckQueue::Entry& entry) {
+            if (state.unackedCount.load(std::memory_order_acquire) == 0) return;
+            const uint32_t ack = entry.ack;
+            const AckBits& ackBits = entry.bits;
+
+            // Bit d of the peer's bitmap covers sequence (ack - d); bit 0 is `ack` itself and is
+            // clear until the peer has received anything. One direct slot lookup per set bit.
+            for (uint32_t word = 0; word < ackBits.size(); ++word) {
+                for (uint64_t bits = ackBits[word]; bits != 0; bits &= bits - 1) {
+                    const uint32_t d = word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+                    AcknowledgeSequence(state, ack - d, entry.now);
+                }
+            }
+
+            // Holes below a received `ack` are packets the peer has not seen although a later one arrived.
+            // The acked slot keeps its last send time until it is reused. Only holes at or after
+            // the window start can still be in flight.
+            uint32_t oldest = state.oldestUnackedSequence.load(std::memory_order_relaxed);
+            const auto& acked = WindowSlot(state, ack);
+            if (TestBit(ackBits, 0) && !IsSequenceMoreRecent(oldest, ack) &&
+                acked.published.load(std::memory_order_acquire) == ack) {
+                const uint32_t holes = (std::min)(AckWindowSize(state.headerFormat.load(std::memory_order_relaxed)),
+                    ack - oldest + 1);
+                for (uint32_t d = 1; d < holes; ++d) {
+                    if (!TestBit(ackBits, d)) {
+                        NoteMissing(state, ack - d, acked.timeSent, entry.now);
                     }
                 }
             }
 
-            if (isAcked) {
-                // This packet has been acknowledged. Calculate RTT if it wasn't a retransmission.
-                if (it->retries == 0) {
-                    auto rtt = std::chrono::duration_cast<std::chrono::microseconds>(state.lastPacketReceivedTime - it->timeSent).count();
-                    ApplyRTTSample(state, static_cast<float>(rtt) / 1000.0f);
+            // Slide the window start past everything acknowledged; a slot still being filled by its sender stops it
+            const uint32_t next = state.nextOutgoingSequence.load(std::memory_order_acquire);
+            while (oldest != next) {
+                const auto& slot = WindowSlot(state, oldest);
+                if (slot.published.load(std::memory_order_acquire) != oldest || slot.inUse) break;
+                ++oldest;
+            }
+            state.oldestUnackedSequence.store(oldest, std::memory_order_release); // senders may now refill these slots
+        }
+
+        // --- Send state ownership ---
+        // The ack queue and `owned` use seq_cst so that a receive thread that queues an ack and
+        // finds the state owned can rely on the owner seeing that ack when it lets go.
+
+        bool TryAcquireOwnership(ReliableConnectionState& state) {
+            return !state.owned.exchange(true, std::memory_order_seq_cst);
+        }
+
+        void DrainAcks(ReliableConnectionState& state) {
+            AckQueue::Entry entry;
+            bool any = false;
+            while (state.acks.Pop(entry)) {
+                ProcessAcks(state, entry);
+                any = true;
+            }
+            if (any) PublishCongestion(state);
+        }
+
+        // Applies queued acks unless another thread owns the state, in which case that owner
+        // applies them before (or just after) it lets go.
+        void DrainAcksIfUnowned(ReliableConnectionState& state) {
+            do {
+                if (!TryAcquireOwnership(state)) return;
+                DrainAcks(state);
+                state.owned.store(false, std::memory_order_seq_cst);
+            } while (!state.acks.Empty());
+        }
+
+        // For owner work that cannot be handed over: waits out the current owner, whose drain is short.
+        void AcquireOwnership(ReliableConnectionState& state) {
+            while (!TryAcquireOwnership(state)) {
+                std::this_thread::yield();
+            }
+            DrainAcks(state);
+        }
+
+        void ReleaseOwnership(ReliableConnectionState& state) {
+            state.owned.store(false, std::memory_order_seq_cst);
+            if (!state.acks.Empty()) DrainAcksIfUnowned(state);
+        }
+
+        void QueueAcks(ReliableConnectionState& state, uint32_t ack, const AckBits& ackBits,
+            std::chrono::steady_clock::time_point now) {
+            if (state.unackedCount.load(std::memory_order_acquire) == 0) return; // nothing they could acknowledge
+
+            AckQueue::Entry entry;
+            entry.ack = ack;
+            entry.bits = ackBits;
+            entry.now = now;
+            if (state.acks.Push(entry)) DrainAcksIfUnowned(state);
+        }
+
+        // Splits a parsed header into widened sequence/ack values and a 128-bit ack bitmap.
+        void DecodeHeader(const ReliableConnectionState& state, ReliabilityHeaderFormat format,
+            const ExtendedReliabilityPacketHeader& header, uint32_t& sequence, uint32_t& ack, AckBits& ackBits) {
+            if (format == ReliabilityHeaderFormat::Extended) {
+                sequence = header.sequence;
+                ack = header.ack;
+                ackBits = { header.ack_bitfield[0], header.ack_bitfield[1] };
+                return;
+            }
+            // Incoming sequences are near the newest one received; acks are near our newest sent
+            sequence = WidenSequence(header.sequence, state.highestReceivedSequence.load(std::memory_order_relaxed));
+            ack = WidenSequence(header.ack, state.nextOutgoingSequence.load(std::memory_order_relaxed) - 1);
+            ackBits = { header.ack_bitfield[0] & 0xFFFFFFFFull, 0 };
+        }
+
+        // --- Receive window ---
+
+        // The newest sequence received and which of the `window` before it arrived too.
+        void SnapshotReceived(const ReliableConnectionState& state, uint32_t window, uint32_t& highest, AckBits& bits) {
+            highest = state.highestReceivedSequence.load(std::memory_order_acquire);
+            bits = {};
+            for (uint32_t d = 0; d < window; ++d) {
+                if (state.receivedSequences[(highest - d) & RECEIVE_MASK].load(std::memory_order_acquire) == highest - d) {
+                    SetBit(bits, d);
                 }
-                it = state.unacknowledgedPackets.erase(it);
+            }
+        }
+
+        bool HasPendingAck(const ReliableConnectionState& state) {
+            return state.receivedCount.load(std::memory_order_acquire) != state.ackedCount.load(std::memory_order_acquire);
+        }
+
+        // Records that an ack is owed by `due`. The first packet after an ack starts a new deadline;
+        // later ones can only bring it forward.
+        void NoteAckOwed(ReliableConnectionState& state, std::chrono::steady_clock::time_point due) {
+            const TimeTicks ticks = ToTicks(due);
+            const uint32_t before = state.receivedCount.fetch_add(1, std::memory_order_acq_rel);
+            if (before == state.ackedCount.load(std::memory_order_acquire)) {
+                state.ackDeadline.store(ticks, std::memory_order_release);
+                return;
+            }
+            TimeTicks current = state.ackDeadline.load(std::memory_order_relaxed);
+            while (ticks < current && !state.ackDeadline.compare_exchange_weak(current, ticks, std::memory_order_acq_rel)) {
+            }
+        }
+
+        // Marks every packet counted in `covered` as acknowledged by a header just written.
+        void NoteAckSent(ReliableConnectionState& state, uint32_t covered) {
+            uint32_t acked = state.ackedCount.load(std::memory_order_relaxed);
+            while (IsSequenceMoreRecent(covered, acked) &&
+                !state.ackedCount.compare_exchange_weak(acked, covered, std::memory_order_acq_rel)) {
+            }
+        }
+
+        // Prepends the reliability header in the connection's format, then the general header.
+        // The caller has checked the headroom.
+        void WriteHeaders(const ReliableConnectionState& state, ReliabilityHeaderFormat format,
+            Networking::PacketBuffer& packet, PacketType type, uint32_t sequence) {
+            uint32_t highest = 0;
+            AckBits received{};
+            SnapshotReceived(state, AckWindowSize(format), highest, received);
+
+            if (format == ReliabilityHeaderFormat::Extended) {
+                ExtendedReliabilityPacketHeader header{};
+                header.sequence = sequence;
+                header.ack = highest;
+                header.ack_bitfield[0] = received[0];
+                header.ack_bitfield[1] = received[1];
+                memcpy(packet.Prepend(sizeof(header)), &header, sizeof(header));
             }
             else {
-                ++it;
+                ReliabilityPacketHeader header{};
+                header.sequence = static_cast<uint16_t>(sequence);
+                header.ack = static_cast<uint16_t>(highest);
+                header.ack_bitfield = static_cast<uint32_t>(received[0]);
+                memcpy(packet.Prepend(sizeof(header)), &header, sizeof(header));
             }
+
+            GeneralPacketHeader generalHeader{};
+            generalHeader.Type = type;
+            memcpy(packet.Prepend(sizeof(generalHeader)), &generalHeader, sizeof(generalHeader));
         }
 
-        // --- 2. Update Our Receive Window ---
-        // Check if the incoming packet is new or a duplicate.
-        if (IsSequenceMoreRecent(header.sequence, state.highestReceivedSequence)) {
-            uint16_t diff = header.sequence - state.highestReceivedSequence;
-            state.receivedSequenceBitfield <<= diff;
-            state.receivedSequenceBitfield |= 1; // Set the bit for the new sequence
-            state.highestReceivedSequence = header.sequence;
-        }
-        else {
-            uint16_t diff = state.highestReceivedSequence - header.sequence;
-            if (diff > 0 && diff <= 32) {
-                // Check if this is a duplicate packet we've already seen.
-                if ((state.receivedSequenceBitfield >> diff) & 1) {
-                    return false; // It's a duplicate, ignore its payload.
+        bool HasHeaderRoom(const Networking::PacketBuffer& packet, ReliabilityHeaderFormat format) {
+            return packet.Headroom() >= sizeof(GeneralPacketHeader) + ReliabilityHeaderSize(format);
+        }
+
+        uint32_t SendWindowLimit(ReliabilityHeaderFormat format) {
+            return (std::min)(RELIABLE_SEND_WINDOW_SIZE, AckWindowSize(format));
+        }
+
+    } // end anonymous namespace
+
+
+    // =========================
+    // AckQueue
+    // =========================
+
+    AckQueue::AckQueue() {
+        for (uint32_t i = 0; i < ACK_QUEUE_CAPACITY; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool AckQueue::Push(const Entry& entry) {
+        uint32_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & (ACK_QUEUE_CAPACITY - 1)];
+            const uint32_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const int32_t diff = static_cast<int32_t>(sequence - pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.entry = entry;
+                    cell.sequence.store(pos + 1, std::memory_order_seq_cst);
+                    return true;
                 }
-                // It's an old packet that arrived out of order, mark it as received.
-                state.receivedSequenceBitfield |= (1 << diff);
+            }
+            else if (diff < 0) {
+                return false; // full
             }
             else {
-                return false; // Packet is too old, ignore.
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
             }
         }
+    }
+
+    bool AckQueue::Pop(Entry& entry) {
+        const uint32_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell& cell = m_cells[pos & (ACK_QUEUE_CAPACITY - 1)];
+        if (cell.sequence.load(std::memory_order_seq_cst) != pos + 1) {
+            return false; // empty, or the next entry is still being written
+        }
+        entry = cell.entry;
+        cell.sequence.store(pos + ACK_QUEUE_CAPACITY, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    bool AckQueue::Empty() const {
+        const uint32_t pos = m_dequeuePos.load(std::memory_order_seq_cst);
+        return m_cells[pos & (ACK_QUEUE_CAPACITY - 1)].sequence.load(std::memory_order_seq_cst) != pos + 1;
+    }
+
+    // Each slot starts out holding the sequence one lap before its first real one, which never
+    // matches a sequence that can still arrive or be sent.
+    ReliableConnectionState::ReliableConnectionState() {
+        for (uint32_t i = 0; i < RECEIVE_WINDOW_SLOTS; ++i) {
+            receivedSequences[i].store(i - RECEIVE_WINDOW_SLOTS, std::memory_order_relaxed);
+        }
+        for (uint32_t i = 0; i < RELIABLE_SEND_WINDOW_SIZE; ++i) {
+            sendWindow[i].published.store(i - RELIABLE_SEND_WINDOW_SIZE, std::memory_order_relaxed);
+            retransmitDue[i].store(NEVER, std::memory_order_relaxed);
+        }
+    }
+
+
+    // =========================
+    // Public API Implementation
+    // =========================
+
+    bool UDPReliabilityProtocol::SetHeaderFormat(ReliableConnectionState& state, ReliabilityHeaderFormat format)
+    {
+        if (state.nextOutgoingSequence.load(std::memory_order_acquire) != 1 ||
+            state.highestReceivedSequence.load(std::memory_order_acquire) != 0) {
+            return state.headerFormat.load(std::memory_order_relaxed) == format; // too late to switch layouts
+        }
+        state.headerFormat.store(format, std::memory_order_release);
+        return true;
+    }
+
+    ReliabilityHeaderFormat UDPReliabilityProtocol::GetHeaderFormat(const ReliableConnectionState& state)
+    {
+        return state.headerFormat.load(std::memory_order_acquire);
+    }
+
+    void UDPReliabilityProtocol::SetCongestionController(ReliableConnectionState& state,
+        std::unique_ptr<ICongestionController> controller)
+    {
+        AcquireOwnership(state);
+        state.congestion = std::move(controller);
+        state.algorithm.store(state.congestion ? state.congestion->GetAlgorithm() : CongestionAlgorithm::None,
+            std::memory_order_relaxed);
+        PublishCongestion(state);
+        ReleaseOwnership(state);
+    }
+
+    void UDPReliabilityProtocol::SetRetransmitTimeoutBounds(ReliableConnectionState& state, float minRto_ms, float maxRto_ms)
+    {
+        state.minRto_ms.store(minRto_ms, std::memory_order_relaxed);
+        state.maxRto_ms.store(maxRto_ms, std::memory_order_relaxed);
+        state.retransmissionTimeout_ms.store((std::clamp)(state.retransmissionTimeout_ms.load(std::memory_order_relaxed),
+            minRto_ms, maxRto_ms), std::memory_order_relaxed);
+    }
+
+    bool UDPReliabilityProtocol::HasCongestionWindowSpace(const ReliableConnectionState& state, uint32_t bytes)
+    {
+        const uint32_t inFlight = state.bytesInFlight.load(std::memory_order_relaxed);
+        if (inFlight == 0) {
+            return true;
+        }
+        return static_cast<uint64_t>(inFlight) + bytes <= state.congestionWindow.load(std::memory_order_relaxed);
+    }
+
+    double UDPReliabilityProtocol::GetPacingRate(const ReliableConnectionState& state)
+    {
+        return state.pacingRate.load(std::memory_order_relaxed);
+    }
 
-        state.hasPendingAckToSend = true;
-        return true; // The packet is new and should be processed by the application.
+    CongestionStats UDPReliabilityProtocol::GetCongestionStats(const ReliableConnectionState& state)
+    {
+        CongestionStats stats;
+        stats.algorithm = state.algorithm.load(std::memory_order_relaxed);
+        stats.congestionWindow = state.congestionWindow.load(std::memory_order_relaxed);
+        stats.pacingRate = state.pacingRate.load(std::memory_order_relaxed);
+        stats.bytesInFlight = state.bytesInFlight.load(std::memory_order_relaxed);
+        stats.smoothedRTT_ms = state.smoothedRTT_ms.load(std::memory_order_relaxed);
+        stats.rttVariance_ms = state.rttVariance_ms.load(std::memory_order_relaxed);
+        stats.retransmissionTimeout_ms = state.retransmissionTimeout_ms.load(std::memory_order_relaxed);
+        return stats;
     }
 
-    std::vector<uint8_t> UDPReliabilityProtocol::PrepareOutgoingPacket(
+    bool UDPReliabilityProtocol::ProcessIncomingHeader(
         ReliableConnectionState& state,
-        const uint8_t* payload,
-        uint32_t payloadSize)
+        const ExtendedReliabilityPacketHeader& header,
+        std::chrono::steady_clock::time_point now)
     {
-        std::lock_guard<std::mutex> lock(state.stateMutex);
+        state.lastPacketReceivedTime.store(ToTicks(now), std::memory_order_relaxed);
 
-        // --- 1. Construct Headers ---
-        GeneralPacketHeader generalHeader{};
-        generalHeader.Type = PacketType::Data_Reliable;
+        const ReliabilityHeaderFormat format = state.headerFormat.load(std::memory_order_relaxed);
+        uint32_t sequence = 0, ack = 0;
+        AckBits ackBits{};
+        DecodeHeader(state, format, header, sequence, ack, ackBits);
 
-        ReliabilityPacketHeader reliableHeader{};
-        reliableHeader.sequence = state.nextOutgoingSequence++;
-        reliableHeader.ack = state.highestReceivedSequence;
-        reliableHeader.ack_bitfield = state.receivedSequenceBitfield;
+        // --- 1. Process Acks and Update RTT ---
+        QueueAcks(state, ack, ackBits, now);
 
-        // --- 2. Assemble the Packet ---
-        size_t totalSize = sizeof(generalHeader) + sizeof(reliableHeader) + payloadSize;
-        std::vector<uint8_t> packetData(totalSize);
+        // --- 2. Update Our Receive Window ---
+        const uint32_t highest = state.highestReceivedSequence.load(std::memory_order_acquire);
+        if (!IsSequenceMoreRecent(sequence, highest) && highest - sequence >= AckWindowSize(format)) {
+            return false; // Older than an ack can express, ignore.
+        }
 
-        uint8_t* writePtr = packetData.data();
-        memcpy(writePtr, &generalHeader, sizeof(generalHeader));
-        writePtr += sizeof(generalHeader);
-        memcpy(writePtr, &reliableHeader, sizeof(reliableHeader));
-        writePtr += sizeof(reliableHeader);
-        if (payloadSize > 0) {
-            memcpy(writePtr, payload, payloadSize);
+        // Claim the sequence's slot; finding it there already means a duplicate
+        bool duplicate = false; // the peer resent it, so our ack was probably lost: ack again
+        auto& slot = state.receivedSequences[sequence & RECEIVE_MASK];
+        uint32_t previous = slot.load(std::memory_order_relaxed);
+        do {
+            if (previous == sequence) {
+                duplicate = true;
+                break;
+            }
+            if (IsSequenceMoreRecent(previous, sequence)) {
+                return false; // a newer lap already passed it, ignore.
+            }
+        } while (!slot.compare_exchange_weak(previous, sequence, std::memory_order_acq_rel));
+
+        if (!duplicate) {
+            // Receives on other threads may have raised it in the meantime
+            uint32_t current = state.highestReceivedSequence.load(std::memory_order_relaxed);
+            while (IsSequenceMoreRecent(sequence, current) &&
+                !state.highestReceivedSequence.compare_exchange_weak(current, sequence, std::memory_order_acq_rel)) {
+            }
         }
 
+        // Gaps, fills and duplicates are acked at once so the sender can detect loss quickly; in-order
+        // packets wait DELAYED_ACK_TIMEOUT for outgoing data to carry the ack.
+        const bool outOfOrder = sequence != highest + 1;
+        NoteAckOwed(state, outOfOrder ? now : now + DELAYED_ACK_TIMEOUT);
+        return !duplicate; // A new packet should be processed by the application.
+    }
+
+    void UDPReliabilityProtocol::ProcessIncomingAck(
+        ReliableConnectionState& state,
+        const ExtendedReliabilityPacketHeader& header,
+        std::chrono::steady_clock::time_point now)
+    {
+        state.lastPacketReceivedTime.store(ToTicks(now), std::memory_order_relaxed);
+
+        uint32_t sequence = 0, ack = 0;
+        AckBits ackBits{};
+        DecodeHeader(state, state.headerFormat.load(std::memory_order_relaxed), header, sequence, ack, ackBits);
+        QueueAcks(state, ack, ackBits, now);
+    }
+
+    bool UDPReliabilityProtocol::PrepareOutgoingPacket(
+        ReliableConnectionState& state,
+        const Networking::PacketBufferPtr& packet,
+        PacketType type,
+        std::chrono::steady_clock::time_point now)
+    {
+        if (!packet) {
+            return false;
+        }
+        const ReliabilityHeaderFormat format = state.headerFormat.load(std::memory_order_relaxed);
+        if (!HasHeaderRoom(*packet, format)) {
+            return false;
+        }
+
+        // --- 1. Reserve a sequence number ---
+        // Refused when the window is full: one more packet would put the oldest unacked one out of ack range
+        const uint32_t limit = SendWindowLimit(format);
+        uint32_t sequence = state.nextOutgoingSequence.load(std::memory_order_relaxed);
+        do {
+            if (sequence - state.oldestUnackedSequence.load(std::memory_order_acquire) >= limit) {
+                return false;
+            }
+        } while (!state.nextOutgoingSequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acq_rel,
+            std::memory_order_relaxed));
+
+        // --- 2. Assemble the Packet (headers prepended in front of the payload) ---
+        const uint32_t covered = state.receivedCount.load(std::memory_order_acquire);
+        WriteHeaders(state, format, *packet, type, sequence);
+
         // --- 3. Track for Retransmission ---
-        state.unacknowledgedPackets.push_back({
-            reliableHeader.sequence,
-            std::chrono::steady_clock::now(),
-            packetData, // Store the full packet data for easy retransmission
-            0
-            });
+        if (state.unackedCount.fetch_add(1, std::memory_order_acq_rel) == 0) {
+            state.deliveredTime.store(ToTicks(now), std::memory_order_relaxed); // idle until now: don't count the gap in delivery rates
+        }
+        auto& slot = WindowSlot(state, sequence);
+        slot.sequence = sequence;
+        slot.timeSent = now;
+        slot.data = packet; // Share the packet buffer; retransmits re-encrypt from it
+        slot.retries = 0;
+        slot.retransmitTimeout_ms = state.retransmissionTimeout_ms.load(std::memory_order_relaxed);
+        slot.nackCount = 0;
+        slot.fastRetransmitPending = false;
+        slot.inUse = true;
+        slot.size = packet->Size();
+        slot.deliveredAtSend = state.deliveredBytes.load(std::memory_order_relaxed);
+        slot.deliveredTimeAtSend = FromTicks(state.deliveredTime.load(std::memory_order_relaxed));
+        RetransmitDueSlot(state, sequence).store(ToTicks(RetransmitDue(slot)), std::memory_order_relaxed);
+        state.bytesInFlight.fetch_add(slot.size, std::memory_order_relaxed);
+        slot.published.store(sequence, std::memory_order_release); // acks and the retransmit sweep may use it now
 
         // We sent an ack, so we don't have one pending anymore.
-        state.hasPendingAckToSend = false;
+        NoteAckSent(state, covered);
+        return true;
+    }
+
+    bool UDPReliabilityProtocol::PrepareAckPacket(
+        ReliableConnectionState& state,
+        const Networking::PacketBufferPtr& packet)
+    {
+        if (!packet) {
+            return false;
+        }
+        if (!HasPendingAck(state)) {
+            return false; // data already carried it
+        }
+        const ReliabilityHeaderFormat format = state.headerFormat.load(std::memory_order_relaxed);
+        if (!HasHeaderRoom(*packet, format)) {
+            return false;
+        }
 
-        return packetData;
+        // Ack-only packets are not sequenced
+        const uint32_t covered = state.receivedCount.load(std::memory_order_acquire);
+        WriteHeaders(state, format, *packet, PacketType::Heartbeat_Ack, 0);
+        NoteAckSent(state, covered);
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point UDPReliabilityProtocol::GetAckDeadline(const ReliableConnectionState& state)
+    {
+        return HasPendingAck(state) ? FromTicks(state.ackDeadline.load(std::memory_order_acquire))
+                                    : std::chrono::steady_clock::time_point::max();
     }
 
     void UDPReliabilityProtocol::ProcessRetransmissions(
         ReliableConnectionState& state,
         std::chrono::steady_clock::time_point now,
-        const std::function<void(const std::vector<uint8_t>&)>& sendFunc)
+        const std::function<void(const Networking::PacketBufferPtr&)>& sendFunc)
     {
-        std::lock_guard<std::mutex> lock(state.stateMutex);
+        AcquireOwnership(state);
 
-        for (auto& packet : state.unacknowledgedPackets) {
-            auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - packet.timeSent).count();
+        // Only the owner queues fast retransmits, so without any queued a slot whose due time has
+        // not come needs nothing, and its SentPacket is never touched
+        const bool fastRetransmits = state.fastRetransmitsPending.load(std::memory_order_relaxed) != 0;
+        const TimeTicks nowTicks = ToTicks(now);
 
-            if (elapsed_ms >= state.retransmissionTimeout_ms) {
-                // Timeout detected, retransmit the packet.
-                sendFunc(packet.data);
+        const uint32_t next = state.nextOutgoingSequence.load(std::memory_order_acquire);
+        for (uint32_t sequence = state.oldestUnackedSequence.load(std::memory_order_relaxed); sequence != next; ++sequence) {
+            if (!fastRetransmits && RetransmitDueSlot(state, sequence).load(std::memory_order_relaxed) > nowTicks) continue;
+
+            auto* packet = FindInFlight(state, sequence);
+            if (!packet) continue;
+
+            if (packet->fastRetransmitPending) {
+                // The peer has acked later packets three times without this one: resend now,
+                // keeping its RTO since a timeout did not fire.
+                packet->fastRetransmitPending = false;
+                state.fastRetransmitsPending.fetch_sub(1, std::memory_order_relaxed);
+                Resend(*packet, now, sendFunc);
+                RetransmitDueSlot(state, sequence).store(ToTicks(RetransmitDue(*packet)), std::memory_order_relaxed);
+                continue;
+            }
 
-                // Update state for this packet
-                packet.timeSent = now;
-                packet.retries++;
+            auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - packet->timeSent).count();
 
-                // Apply exponential backoff to the RTO for this connection
+            if (elapsed_ms >= packet->retransmitTimeout_ms) {
+                // Timeout detected, retransmit the packet.
+                if (state.congestion) {
+                    state.congestion->OnPacketLost(packet->size, packet->timeSent, now, /*timeout=*/true);
+                }
+                Resend(*packet, now, sendFunc);
+
+                // Back off this packet only; the connection RTO keeps tracking measured RTT.
                 // FIX: Wrap std::min in parentheses to prevent macro expansion on Windows.
-                state.retransmissionTimeout_ms = (std::min)(state.retransmissionTimeout_ms * 2.0f, 3000.0f);
+                packet->retransmitTimeout_ms = (std::min)(packet->retransmitTimeout_ms * 2.0f,
+                    state.maxRto_ms.load(std::memory_order_relaxed));
+                RetransmitDueSlot(state, sequence).store(ToTicks(RetransmitDue(*packet)), std::memory_order_relaxed);
             }
         }
+
+        PublishCongestion(state);
+        ReleaseOwnership(state);
+    }
+
+    bool UDPReliabilityProtocol::HasFastRetransmitPending(const ReliableConnectionState& state)
+    {
+        return state.fastRetransmitsPending.load(std::memory_order_acquire) != 0;
+    }
+
+    std::chrono::steady_clock::time_point UDPReliabilityProtocol::GetNextRetransmitTime(
+        const ReliableConnectionState& state)
+    {
+        if (state.unackedCount.load(std::memory_order_acquire) == 0) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+        if (state.fastRetransmitsPending.load(std::memory_order_acquire) != 0) {
+            return std::chrono::steady_clock::time_point::min();
+        }
+
+        // Acked slots read as never due, so a momentarily stale window start only costs extra reads
+        TimeTicks next = NEVER;
+        const uint32_t end = state.nextOutgoingSequence.load(std::memory_order_acquire);
+        for (uint32_t sequence = state.oldestUnackedSequence.load(std::memory_order_acquire); sequence != end; ++sequence) {
+            const TimeTicks due = state.retransmitDue[sequence & WINDOW_MASK].load(std::memory_order_relaxed);
+            next = (std::min)(next, due);
+        }
+        return next == NEVER ? std::chrono::steady_clock::time_point::max() : FromTicks(next);
+    }
+
+    bool UDPReliabilityProtocol::HasSendWindowSpace(const ReliableConnectionState& state, uint32_t slots)
+    {
+        const uint32_t inFlight = state.nextOutgoingSequence.load(std::memory_order_relaxed) -
+            state.oldestUnackedSequence.load(std::memory_order_acquire);
+        return inFlight + slots <= SendWindowLimit(state.headerFormat.load(std::memory_order_relaxed));
+    }
+
+    uint32_t UDPReliabilityProtocol::GetSendWindowSize(const ReliableConnectionState& state)
+    {
+        return SendWindowLimit(state.headerFormat.load(std::memory_order_relaxed));
+    }
+
+    std::chrono::steady_clock::duration UDPReliabilityProtocol::GetRetransmissionTimeout(
+        const ReliableConnectionState& state)
+    {
+        return std::chrono::microseconds(static_cast<int64_t>(state.retransmissionTimeout_ms.load(std::memory_order_relaxed) * 1000.0f));
+    }
+
+    std::chrono::steady_clock::time_point UDPReliabilityProtocol::GetTimeoutDeadline(
+        const ReliableConnectionState& state,
+        std::chrono::milliseconds timeout)
+    {
+        // IsConnectionTimedOut compares whole milliseconds with '>', so it trips one millisecond past the timeout
+        return FromTicks(state.lastPacketReceivedTime.load(std::memory_order_relaxed)) + timeout + std::chrono::milliseconds(1);
     }
 
     bool UDPReliabilityProtocol::IsConnectionTimedOut(
         const ReliableConnectionState& state,
         std::chrono::steady_clock::time_point now,
-        std::chrono::seconds timeout)
+        std::chrono::milliseconds timeout)
     {
-        std::lock_guard<std::mutex> lock(state.stateMutex);
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - state.lastPacketReceivedTime);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - FromTicks(state.lastPacketReceivedTime.load(std::memory_order_relaxed)));
         return elapsed > timeout;
     }
 
@@ -1,12 +1,17 @@
 #pragma once
 
-#include "../packet/Packet.hpp"
+#include "../Packet/Packet.hpp"
+#include "../CongestionControl/CongestionControl.hpp"
+#include "../../core/buffer/PacketBuffer.hpp"
+#include "../../../utilities/metrics/Metrics.hpp"
 #include <cstdint>
+#include <memory>
 #include <vector>
 #include <functional>
 #include <chrono>
-#include <mutex>
-#include <list>
+#include <array>
+#include <atomic>
+#include <limits>
 
 namespace RiftNet::Protocol {
 
@@ -14,37 +19,147 @@ namespace RiftNet::Protocol {
     // Reliability State & Constants
     // =========================
 
+    // Capacity of the per-connection ring of unacknowledged reliable packets.
+    // Must be a power of two; a packet lives in slot (sequence % RELIABLE_SEND_WINDOW_SIZE).
+    // The usable window is also capped at the header format's AckWindowSize: a packet further
+    // behind the newest one could arrive "too old" for the receiver to ever acknowledge it.
+    constexpr uint32_t RELIABLE_SEND_WINDOW_SIZE = 256;
+    static_assert((RELIABLE_SEND_WINDOW_SIZE & (RELIABLE_SEND_WINDOW_SIZE - 1)) == 0, "window size must be a power of two");
+
+    // Number of incoming ack headers that must report a packet missing while acknowledging a
+    // later one before it is resent without waiting for its RTO (cf. TCP's three duplicate acks).
+    constexpr uint8_t FAST_RETRANSMIT_THRESHOLD = 3;
+
+    // How long a received reliable packet may wait for outgoing reliable data to carry its ack
+    // before a standalone Heartbeat_Ack is sent. Out-of-order arrivals are acked at once.
+    constexpr auto DELAYED_ACK_TIMEOUT = std::chrono::milliseconds(10);
+
+    // Slots in the receive window ring: a sequence is recorded in slot (sequence % RECEIVE_WINDOW_SLOTS).
+    // Twice the widest ack bitmap, so a slot is only overwritten once its old sequence is out of ack range.
+    constexpr uint32_t RECEIVE_WINDOW_SLOTS = 256;
+    static_assert((RECEIVE_WINDOW_SLOTS & (RECEIVE_WINDOW_SLOTS - 1)) == 0, "receive window must be a power of two");
+
+    // Incoming ack headers waiting for the send-state owner. An ack that finds the queue full is
+    // dropped like an ack lost on the wire; the next one repeats its bits.
+    constexpr uint32_t ACK_QUEUE_CAPACITY = 64;
+    static_assert((ACK_QUEUE_CAPACITY & (ACK_QUEUE_CAPACITY - 1)) == 0, "ack queue capacity must be a power of two");
+
+    /**
+     * @class AckQueue
+     * @brief Bounded multi-producer, single-consumer FIFO (Vyukov's array queue) that hands the
+     * acks decoded by receive threads to whichever thread owns the connection's send state.
+     */
+    class AckQueue {
+    public:
+        struct Entry {
+            uint32_t ack{ 0 };                  // widened
+            std::array<uint64_t, 2> bits{};     // bit d acknowledges ack - d
+            std::chrono::steady_clock::time_point now;
+        };
+
+        AckQueue();
+
+        bool Push(const Entry& entry); // any thread; false when full
+        bool Pop(Entry& entry);        // the owner only
+        bool Empty() const;
+
+    private:
+        struct Cell {
+            std::atomic<uint32_t> sequence{ 0 };
+            Entry entry;
+        };
+        std::array<Cell, ACK_QUEUE_CAPACITY> m_cells;
+        alignas(64) std::atomic<uint32_t> m_enqueuePos{ 0 };
+        alignas(64) std::atomic<uint32_t> m_dequeuePos{ 0 };
+    };
+
     // State for a single reliable connection. Each connected client will have one of these.
+    // Sequence numbers are tracked as 32-bit values whatever the header format; Compact headers
+    // carry their low 16 bits and are widened on receipt.
+    //
+    // No lock guards it:
+    //  - Receives record their sequence in the receive window with atomics, from any thread.
+    //  - Sends reserve a sequence number with a CAS and fill their send window slot before publishing it.
+    //  - Everything else about sent packets (acks, RTT, loss detection, retransmits, the congestion
+    //    controller) belongs to one owner thread at a time. Receive threads queue their acks in
+    //    `acks`; whichever thread finds the state unowned takes it and drains them.
     struct ReliableConnectionState {
-        // --- Sequence management ---
-        uint16_t nextOutgoingSequence{ 1 };
-        uint16_t highestReceivedSequence{ 0 };
-        uint32_t  receivedSequenceBitfield{ 0 };
+        using TimeTicks = std::chrono::steady_clock::rep; // time_point::time_since_epoch().count()
+
+        ReliableConnectionState();
+
+        std::atomic<ReliabilityHeaderFormat> headerFormat{ ReliabilityHeaderFormat::Compact };
+
+        // --- Receive window (any thread) ---
+        std::atomic<uint32_t> highestReceivedSequence{ 0 };
+        std::array<std::atomic<uint32_t>, RECEIVE_WINDOW_SLOTS> receivedSequences; // newest sequence seen per slot
+        std::atomic<uint32_t> receivedCount{ 0 };  // reliable packets recorded so far
+        std::atomic<uint32_t> ackedCount{ 0 };     // receivedCount covered by the last ack we sent; an ack is pending while they differ
+        std::atomic<TimeTicks> ackDeadline{ (std::numeric_limits<TimeTicks>::max)() };
+        std::atomic<TimeTicks> lastPacketReceivedTime{ std::chrono::steady_clock::now().time_since_epoch().count() };
 
-        // --- RTT / RTO estimation ---
-        float smoothedRTT_ms{ 100.0f };
-        float rttVariance_ms{ 500.0f };
-        float retransmissionTimeout_ms{ 250.0f };
-        bool  isFirstRTTSample{ true };
+        // --- RTT / RTO estimation (written by the owner) ---
+        std::atomic<float> smoothedRTT_ms{ 100.0f };
+        std::atomic<float> rttVariance_ms{ 500.0f };
+        std::atomic<float> retransmissionTimeout_ms{ 250.0f };
+        std::atomic<float> minRto_ms{ 100.0f }; // clamp for the RTO and per-packet backoff; see SetRetransmitTimeoutBounds
+        std::atomic<float> maxRto_ms{ 3000.0f };
+        bool isFirstRTTSample{ true }; // owner only
+        RiftNet::Metrics::LatencyHistogram rttSamples; // every sample, for the stats API
 
         // --- Reliability tracking ---
         struct SentPacket {
-            uint16_t sequence;
+            std::atomic<uint32_t> published{ 0 }; // == sequence once its sender has filled the slot
+
+            // Written by the sender before publishing, and from then on by the owner only
+            uint32_t sequence{ 0 };
             std::chrono::steady_clock::time_point timeSent;
-            std::vector<uint8_t> data; // The fully constructed packet data
+            Networking::PacketBufferPtr data; // The fully constructed plaintext packet, shared with the send path
             int retries{ 0 };
+            float retransmitTimeout_ms{ 0.0f }; // this packet's RTO; backs off on its own timeouts only
+            uint8_t nackCount{ 0 };             // acks that showed this packet missing behind a later one
+            bool fastRetransmitPending{ false };
+            bool inUse{ false };                // cleared when acked
+            uint32_t size{ 0 };                 // plaintext bytes, counted in bytesInFlight
+            uint64_t deliveredAtSend{ 0 };      // deliveredBytes / deliveredTime when first sent,
+            std::chrono::steady_clock::time_point deliveredTimeAtSend; // for delivery-rate samples
         };
-        std::list<SentPacket> unacknowledgedPackets;
+        // Fixed ring of in-flight packets; acks index it directly instead of searching.
+        std::array<SentPacket, RELIABLE_SEND_WINDOW_SIZE> sendWindow;
+        // When each slot's packet is due for retransmission (max once acked). Kept apart from
+        // sendWindow so the retransmit checks read 8 dense bytes per slot, not a whole SentPacket.
+        std::array<std::atomic<TimeTicks>, RELIABLE_SEND_WINDOW_SIZE> retransmitDue;
+        std::atomic<uint32_t> nextOutgoingSequence{ 1 };
+        std::atomic<uint32_t> oldestUnackedSequence{ 1 }; // advanced by the owner; == nextOutgoingSequence when nothing is in flight
+        std::atomic<uint32_t> unackedCount{ 0 };
+        std::atomic<uint32_t> fastRetransmitsPending{ 0 };
 
-        // --- Timing & Status ---
-        std::chrono::steady_clock::time_point lastPacketReceivedTime{ std::chrono::steady_clock::now() };
-        bool hasPendingAckToSend{ false };
+        // --- Congestion control (no controller = no window, no pacing) ---
+        std::unique_ptr<ICongestionController> congestion; // owner only
+        std::atomic<CongestionAlgorithm> algorithm{ CongestionAlgorithm::None };
+        std::atomic<uint32_t> congestionWindow{ (std::numeric_limits<uint32_t>::max)() }; // published by the owner
+        std::atomic<double> pacingRate{ 0.0 };            // published by the owner
+        std::atomic<uint32_t> bytesInFlight{ 0 };         // plaintext bytes of unacked reliable packets
+        std::atomic<uint64_t> deliveredBytes{ 0 };        // reliable bytes acked over the connection's life
+        std::atomic<TimeTicks> deliveredTime{ 0 };        // when deliveredBytes last grew
 
-        // --- Thread safety ---
-        mutable std::mutex stateMutex;
+        // --- Send state ownership ---
+        AckQueue acks;
+        std::atomic<bool> owned{ false };
     };
 
 
+    // Snapshot of a connection's RTT estimate and congestion state.
+    struct CongestionStats {
+        CongestionAlgorithm algorithm{ CongestionAlgorithm::None };
+        uint32_t congestionWindow{ 0 }; // bytes; UINT32_MAX when unlimited
+        uint32_t bytesInFlight{ 0 };
+        double   pacingRate{ 0.0 };     // bytes/s; 0 when unpaced
+        float    smoothedRTT_ms{ 0.0f };
+        float    rttVariance_ms{ 0.0f };
+        float    retransmissionTimeout_ms{ 0.0f };
+    };
+
     /**
      * @class UDPReliabilityProtocol
      * @brief A stateless utility class providing functions to manage a reliable connection.
@@ -52,30 +167,126 @@ namespace RiftNet::Protocol {
      */
     class UDPReliabilityProtocol {
     public:
+        /**
+         * @brief Selects the reliability header layout; call once the HELLO exchange agreed on it.
+         * @return False (and no change) if a reliable packet has already been sent or received.
+         */
+        static bool SetHeaderFormat(ReliableConnectionState& state, ReliabilityHeaderFormat format);
+
+        static ReliabilityHeaderFormat GetHeaderFormat(const ReliableConnectionState& state);
+
+        /**
+         * @brief Installs the congestion controller fed by this connection's acks and losses.
+         * @param controller nullptr removes congestion control.
+         */
+        static void SetCongestionController(ReliableConnectionState& state, std::unique_ptr<ICongestionController> controller);
+
+        /**
+         * @brief Sets the range the computed RTO is clamped to; per-packet backoff also stops at maxRto_ms.
+         * The current RTO is clamped into the new range at once. Expects 0 < minRto_ms <= maxRto_ms.
+         */
+        static void SetRetransmitTimeoutBounds(ReliableConnectionState& state, float minRto_ms, float maxRto_ms);
+
+        /**
+         * @brief Checks whether `bytes` more reliable data fits in the congestion window.
+         * Always true without a controller or with nothing in flight, so a packet larger than the
+         * window still goes out alone.
+         */
+        static bool HasCongestionWindowSpace(const ReliableConnectionState& state, uint32_t bytes);
+
+        /**
+         * @brief Returns the controller's pacing rate in bytes/s, or 0 if sends are not paced.
+         */
+        static double GetPacingRate(const ReliableConnectionState& state);
+
+        static CongestionStats GetCongestionStats(const ReliableConnectionState& state);
+
         /**
          * @brief Processes an incoming reliable header, updating the connection state.
          * @param state The connection state to modify.
-         * @param header The reliability header from an incoming packet.
-         * @return True if the packet is new and should be processed, false if it's a duplicate or out of order.
+         * Packets the peer reports missing behind later acknowledged ones are queued for fast
+         * retransmit once FAST_RETRANSMIT_THRESHOLD acks have done so; see HasFastRetransmitPending.
+         * @param header The reliability header as decoded by PacketFactory::ParsePacket for the
+         *        connection's format (Compact sequence/ack values are widened here).
+         * @param now Arrival time, used for RTT sampling and the idle timeout.
+         * Lock-free: the receive window is updated in place and the acks are handed to the thread
+         * that owns the send state (this one, unless another thread is applying acks right now).
+         * @return True if the packet is new and should be processed, false if it's a duplicate or
+         *         older than the ack window.
          */
         static bool ProcessIncomingHeader(
             ReliableConnectionState& state,
-            const ReliabilityPacketHeader& header);
+            const ExtendedReliabilityPacketHeader& header,
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
 
         /**
-         * @brief Prepares a fully formed, reliable packet for sending.
+         * @brief Processes the acks of an incoming ack-only (Heartbeat_Ack) header.
+         * Same as the ack half of ProcessIncomingHeader; header.sequence is ignored and the
+         * receive window is left untouched, so nothing new needs acknowledging in return.
+         */
+        static void ProcessIncomingAck(
+            ReliableConnectionState& state,
+            const ExtendedReliabilityPacketHeader& header,
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+        /**
+         * @brief Turns a payload buffer into a fully formed, reliable packet for sending.
+         * The GeneralHeader + ReliabilityHeader are prepended in place and the buffer is
+         * queued for retransmission; it must not be modified afterwards. Lock-free, so sends
+         * from several threads do not wait for each other or for ack processing.
          * @param state The connection state to use for sequence numbers and acks.
-         * @param payload The application data to send.
-         * @param payloadSize The size of the application data.
-         * @return A byte vector containing the fully constructed packet (GeneralHeader + ReliabilityHeader + Payload).
+         * @param packet A buffer holding the application data, with headroom for the general header
+         *        and the connection's reliability header.
+         * @param type The reliable packet type to stamp into the general header.
+         * @param now Send time; the packet's RTO runs from here.
+         * @return True on success, false if the buffer lacks headroom or the send window is full.
+         */
+        static bool PrepareOutgoingPacket(
+            ReliableConnectionState& state,
+            const Networking::PacketBufferPtr& packet,
+            PacketType type = PacketType::Data_Reliable,
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+        /**
+         * @brief Writes a Heartbeat_Ack packet carrying the current acks into an empty buffer.
+         * The packet is not tracked for retransmission; a lost ack is covered by the next one.
+         * @param state The connection state whose receive window is acknowledged.
+         * @param packet An empty buffer with headroom for the general and reliability headers.
+         * @return True if an ack was pending and has been written, false otherwise.
          */
-        static std::vector<uint8_t> PrepareOutgoingPacket(
+        static bool PrepareAckPacket(
             ReliableConnectionState& state,
-            const uint8_t* payload,
-            uint32_t payloadSize);
+            const Networking::PacketBufferPtr& packet);
 
         /**
-         * @brief Checks for and handles any packets that need to be retransmitted.
+         * @brief Returns when a standalone ack must be sent if no reliable data carries it first,
+         *        or time_point::max() if no ack is pending.
+         */
+        static std::chrono::steady_clock::time_point GetAckDeadline(const ReliableConnectionState& state);
+
+        /**
+         * @brief Checks whether the send window can take `slots` more reliable packets.
+         */
+        static bool HasSendWindowSpace(const ReliableConnectionState& state, uint32_t slots = 1);
+
+        /**
+         * @brief Returns how many reliable packets may be in flight: RELIABLE_SEND_WINDOW_SIZE
+         *        or the header format's AckWindowSize, whichever is smaller.
+         */
+        static uint32_t GetSendWindowSize(const ReliableConnectionState& state);
+
+        /**
+         * @brief True if ProcessIncomingHeader queued packets for fast retransmit.
+         */
+        static bool HasFastRetransmitPending(const ReliableConnectionState& state);
+
+        /**
+         * @brief Resends packets queued for fast retransmit and packets whose own RTO expired.
+         * A timeout doubles only that packet's RTO (capped), so a burst of losses does not
+         * slow down the rest of the connection. Fast retransmits and timeouts are reported to
+         * the congestion controller as losses. Retransmissions are neither windowed nor paced.
+         * Takes ownership of the send state, waiting for a thread that is applying acks to finish;
+         * sendFunc must not call back into the reliability state.
          * @param state The connection state to check.
          * @param now The current time.
          * @param sendFunc A callback function to send the retransmitted packet data.
@@ -83,7 +294,31 @@ namespace RiftNet::Protocol {
         static void ProcessRetransmissions(
             ReliableConnectionState& state,
             std::chrono::steady_clock::time_point now,
-            const std::function<void(const std::vector<uint8_t>&)>& sendFunc);
+            const std::function<void(const Networking::PacketBufferPtr&)>& sendFunc);
+
+        /**
+         * @brief Returns when ProcessRetransmissions will next have work to do.
+         * @param state The connection state.
+         * @return The earliest retransmission deadline (time_point::min() if a fast retransmit is
+         *         pending), or time_point::max() if nothing is unacknowledged.
+         */
+        static std::chrono::steady_clock::time_point GetNextRetransmitTime(
+            const ReliableConnectionState& state);
+
+        /**
+         * @brief Returns the current retransmission timeout.
+         */
+        static std::chrono::steady_clock::duration GetRetransmissionTimeout(
+            const ReliableConnectionState& state);
+
+        /**
+         * @brief Returns the earliest time at which IsConnectionTimedOut can become true.
+         * @param state The connection state.
+         * @param timeout The duration after which a connection is considered timed out.
+         */
+        static std::chrono::steady_clock::time_point GetTimeoutDeadline(
+            const ReliableConnectionState& state,
+            std::chrono::milliseconds timeout);
 
         /**
          * @brief Checks if the connection has timed out.
@@ -95,7 +330,7 @@ namespace RiftNet::Protocol {
         static bool IsConnectionTimedOut(
             const ReliableConnectionState& state,
             std::chrono::steady_clock::time_point now,
-            std::chrono::seconds timeout);
+            std::chrono::milliseconds timeout);
     };
 
 } // namespace RiftNet::Protocol
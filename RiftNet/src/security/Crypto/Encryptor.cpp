@@ -2,6 +2,8 @@
 #include "Encryptor.hpp"
 #include "../../../utilities/logger/Logger.hpp"
 
+#include <sodium.h>
+
 #include <cstring>     // std::memcpy
 #include <vector>
 #include <string>
@@ -43,23 +45,55 @@ namespace {
 namespace RiftNet::Security {
 
     Encryptor::Encryptor(bool isServerRole)
+        : Encryptor(isServerRole, nullptr) {
+    }
+
+    Encryptor::Encryptor(bool isServerRole, std::unique_ptr<KeyExchangeX25519> keyExchange)
         : m_isServer(isServerRole) {
+        if (sodium_init() < 0) {
+            RF_NETWORK_CRITICAL("Encryptor::Encryptor: libsodium initialization failed");
+        }
+        SetKeypair(std::move(keyExchange));
+    }
+
+    Encryptor::~Encryptor() {
+        sodium_memzero(m_rxKey.data(), m_rxKey.size());
+        sodium_memzero(m_txKey.data(), m_txKey.size());
+    }
+
+    void Encryptor::Clear() {
+        sodium_memzero(m_rxKey.data(), m_rxKey.size());
+        sodium_memzero(m_txKey.data(), m_txKey.size());
+        m_keyExchange.reset();
+        m_isInitialized = false;
+    }
+
+    void Encryptor::Reset(bool isServerRole, std::unique_ptr<KeyExchangeX25519> keyExchange) {
+        Clear();
+        m_isServer = isServerRole;
+        SetKeypair(std::move(keyExchange));
+    }
+
+    void Encryptor::SetKeypair(std::unique_ptr<KeyExchangeX25519> keyExchange) {
+        m_keyExchange = std::move(keyExchange);
+        if (m_keyExchange) {
+            RF_NETWORK_DEBUG("Encryptor set up (role: {}) with a pooled keypair", m_isServer ? "server" : "client");
+            return;
+        }
         try {
             m_keyExchange = KeyExchangeX25519::generate_keypair();
-            RF_NETWORK_DEBUG("Encryptor constructed (role: {}) and keypair generated", m_isServer ? "server" : "client");
+            RF_NETWORK_DEBUG("Encryptor set up (role: {}) and keypair generated", m_isServer ? "server" : "client");
         }
         catch (const std::exception& e) {
-            RF_NETWORK_CRITICAL("Encryptor::Encryptor keypair generation failed: {}", e.what());
+            RF_NETWORK_CRITICAL("Encryptor keypair generation failed: {}", e.what());
             m_keyExchange = nullptr;
         }
         catch (...) {
-            RF_NETWORK_CRITICAL("Encryptor::Encryptor keypair generation failed: unknown exception");
+            RF_NETWORK_CRITICAL("Encryptor keypair generation failed: unknown exception");
             m_keyExchange = nullptr;
         }
     }
 
-    Encryptor::~Encryptor() = default;
-
     bool Encryptor::InitializeSession(const byte_vec& remotePublicKey) {
         if (!m_keyExchange) {
             RF_NETWORK_ERROR("Encryptor::InitializeSession: no local keypair; cannot derive session keys");
@@ -77,20 +111,22 @@ namespace RiftNet::Security {
             }
 
             // sessionKeys.first = RX key, sessionKeys.second = TX key.
-            auto rx_algo = std::make_unique<ChaCha20Poly1305Algorithm>(sessionKeys.first);
-            auto tx_algo = std::make_unique<ChaCha20Poly1305Algorithm>(sessionKeys.second);
-
-            m_rxEncryptor = std::make_unique<::Encryptor>(std::move(rx_algo));
-            m_txEncryptor = std::make_unique<::Encryptor>(std::move(tx_algo));
+            const bool ok = (sessionKeys.first.size() == m_rxKey.size() && sessionKeys.second.size() == m_txKey.size());
+            if (ok) {
+                std::memcpy(m_rxKey.data(), sessionKeys.first.data(), m_rxKey.size());
+                std::memcpy(m_txKey.data(), sessionKeys.second.data(), m_txKey.size());
+            }
+            sodium_memzero(sessionKeys.first.data(), sessionKeys.first.size());
+            sodium_memzero(sessionKeys.second.data(), sessionKeys.second.size());
+            m_isInitialized.store(ok, std::memory_order_release); // receive threads may decrypt from here on
 
-            m_isInitialized = (m_rxEncryptor && m_txEncryptor);
-            if (!m_isInitialized) {
-                RF_NETWORK_ERROR("Encryptor::InitializeSession: failed to construct rx/tx encryptors");
+            if (!ok) {
+                RF_NETWORK_ERROR("Encryptor::InitializeSession: derived session keys have unexpected size");
             }
             else {
-                RF_NETWORK_INFO("Encryptor session initialized (role: {})", m_isServer ? "server" : "client");
+                RF_NETWORK_DEBUG("Encryptor session initialized (role: {})", m_isServer ? "server" : "client");
             }
-            return m_isInitialized;
+            return ok;
         }
         catch (const std::exception& e) {
             RF_NETWORK_ERROR("Encryptor::InitializeSession: session key derivation failed: {}", e.what());
@@ -105,7 +141,7 @@ namespace RiftNet::Security {
     }
 
     bool Encryptor::IsInitialized() const {
-        return m_isInitialized;
+        return m_isInitialized.load(std::memory_order_acquire);
     }
 
     const byte_vec& Encryptor::GetPublicKey() const {
@@ -117,66 +153,113 @@ namespace RiftNet::Security {
         return empty_key;
     }
 
-    std::vector<uint8_t> Encryptor::Encrypt(const std::vector<uint8_t>& plainData, uint64_t nonce) {
-        if (!m_isInitialized || !m_txEncryptor) {
-            RF_NETWORK_ERROR("Encryptor::Encrypt: not initialized; dropping encrypt request ({} bytes)", plainData.size());
-            return {};
+    size_t Encryptor::EncryptInto(std::span<const uint8_t> plainData, std::span<uint8_t> out, uint64_t nonce) {
+        if (!m_isInitialized) {
+            RF_NETWORK_ERROR("Encryptor::EncryptInto: not initialized; dropping encrypt request ({} bytes)", plainData.size());
+            return 0;
         }
-        try {
-            NonceBuffer expandedNonce = ExpandNonce(nonce);
-            byte_vec nonce_vec(expandedNonce.begin(), expandedNonce.end());
-            auto out = m_txEncryptor->encrypt_with_nonce(plainData, nonce_vec);
-            RF_NETWORK_TRACE("Encrypt ok: in={} bytes, out={} bytes", plainData.size(), out.size());
-            return out;
+        if (out.size() < plainData.size() + kTagSize) {
+            RF_NETWORK_ERROR("Encryptor::EncryptInto: output too small ({} < {} bytes)", out.size(), plainData.size() + kTagSize);
+            return 0;
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Encryptor::Encrypt threw: {}", e.what());
-            return {};
+
+        return Seal(plainData, out.data(), nonce);
+    }
+
+    size_t Encryptor::EncryptBatch(std::span<SealJob> jobs) {
+        if (!m_isInitialized) {
+            RF_NETWORK_ERROR("Encryptor::EncryptBatch: not initialized; dropping {} packets", jobs.size());
+            for (SealJob& job : jobs) job.sealed = 0;
+            return 0;
         }
-        catch (...) {
-            RF_NETWORK_ERROR("Encryptor::Encrypt threw: unknown exception");
-            return {};
+
+        size_t sealed = 0;
+        for (SealJob& job : jobs) {
+            if (job.out.size() < job.plain.size() + kTagSize) {
+                RF_NETWORK_ERROR("Encryptor::EncryptBatch: output too small ({} < {} bytes)", job.out.size(), job.plain.size() + kTagSize);
+                job.sealed = 0;
+                continue;
+            }
+            job.sealed = Seal(job.plain, job.out.data(), job.nonce);
+            sealed += job.sealed != 0 ? 1 : 0;
+        }
+        return sealed;
+    }
+
+    size_t Encryptor::Seal(std::span<const uint8_t> plainData, uint8_t* out, uint64_t nonce) const {
+        const NonceBuffer expandedNonce = ExpandNonce(nonce);
+        unsigned long long written = 0;
+        if (crypto_aead_chacha20poly1305_ietf_encrypt(
+                out, &written,
+                plainData.data(), plainData.size(),
+                nullptr, 0, nullptr,
+                expandedNonce.data(), m_txKey.data()) != 0) {
+            RF_NETWORK_ERROR("Encryptor: AEAD encryption failed ({} bytes)", plainData.size());
+            return 0;
         }
+        return static_cast<size_t>(written);
+    }
+
+    std::vector<uint8_t> Encryptor::Encrypt(const std::vector<uint8_t>& plainData, uint64_t nonce) {
+        std::vector<uint8_t> out(plainData.size() + kTagSize);
+        const size_t written = EncryptInto(plainData, out, nonce);
+        out.resize(written);
+        return out;
     }
 
     bool Encryptor::Decrypt(const std::vector<uint8_t>& encryptedData,
         std::vector<uint8_t>& outPlainData,
         uint64_t nonce) {
-        outPlainData.clear();
+        outPlainData.resize(encryptedData.size() >= kTagSize ? encryptedData.size() - kTagSize : 0);
 
-        if (!m_isInitialized || !m_rxEncryptor) {
-            RF_NETWORK_ERROR("Encryptor::Decrypt: not initialized; dropping decrypt request ({} bytes)", encryptedData.size());
+        size_t written = 0;
+        if (!Decrypt(encryptedData, outPlainData, nonce, written)) {
+            outPlainData.clear();
             return false;
         }
-        try {
-            NonceBuffer expandedNonce = ExpandNonce(nonce);
-            byte_vec nonce_vec(expandedNonce.begin(), expandedNonce.end());
 
-            outPlainData = m_rxEncryptor->decrypt_with_nonce(encryptedData, nonce_vec);
-            if (outPlainData.empty()) {
-                RF_NETWORK_WARN("Encryptor::Decrypt returned empty (possible auth failure / bad nonce)");
-                return false;
-            }
-            RF_NETWORK_TRACE("Decrypt ok: in={} bytes, out={} bytes", encryptedData.size(), outPlainData.size());
-            return true;
+        outPlainData.resize(written);
+        return true;
+    }
+
+    bool Encryptor::Decrypt(std::span<const uint8_t> encryptedData,
+        std::span<uint8_t> outPlainData,
+        uint64_t nonce,
+        size_t& outPlainSize) {
+        outPlainSize = 0;
+
+        if (!m_isInitialized) {
+            RF_NETWORK_ERROR("Encryptor::Decrypt: not initialized; dropping decrypt request ({} bytes)", encryptedData.size());
+            return false;
         }
-        catch (const std::exception& e) {
-            RF_NETWORK_ERROR("Encryptor::Decrypt threw: {}", e.what());
-            outPlainData.clear();
+        if (encryptedData.size() < kTagSize) {
+            RF_NETWORK_WARN_LIMITED("Encryptor::Decrypt: ciphertext shorter than tag ({} bytes)", encryptedData.size());
             return false;
         }
-        catch (...) {
-            RF_NETWORK_ERROR("Encryptor::Decrypt threw: unknown exception");
-            outPlainData.clear();
+        if (outPlainData.size() < encryptedData.size() - kTagSize) {
+            RF_NETWORK_ERROR("Encryptor::Decrypt: output too small ({} < {} bytes)", outPlainData.size(), encryptedData.size() - kTagSize);
+            return false;
+        }
+
+        const NonceBuffer expandedNonce = ExpandNonce(nonce);
+        unsigned long long written = 0;
+        if (crypto_aead_chacha20poly1305_ietf_decrypt(
+                outPlainData.data(), &written, nullptr,
+                encryptedData.data(), encryptedData.size(),
+                nullptr, 0,
+                expandedNonce.data(), m_rxKey.data()) != 0) {
+            RF_NETWORK_WARN_LIMITED("Encryptor::Decrypt failed (auth failure / bad nonce)");
             return false;
         }
+
+        outPlainSize = static_cast<size_t>(written);
+        return true;
     }
 
-    NonceBuffer Encryptor::ExpandNonce(uint64_t nonce) const {
-        NonceBuffer expanded_nonce{}; // zero-init 12 bytes (IETF ChaCha20-Poly1305)
+    NonceBuffer Encryptor::ExpandNonce(uint64_t nonce) noexcept {
+        NonceBuffer expanded_nonce{}; // zero-init 12 bytes (IETF ChaCha20-Poly1305), on the stack
         const uint64_t nonce_be = host_to_be64(nonce);
         std::memcpy(expanded_nonce.data() + 4, &nonce_be, sizeof(nonce_be));
-        RF_NETWORK_TRACE("ExpandNonce: packed 64-bit nonce into 12-byte buffer");
         return expanded_nonce;
     }
 
@@ -2,12 +2,13 @@
 
 #include "riftencrypt.hpp"
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <vector>
 
 // Forward declare classes from the global namespace
-class Encryptor;
 class KeyExchangeX25519;
 
 namespace RiftNet::Security {
@@ -17,22 +18,55 @@ namespace RiftNet::Security {
     // 12-byte nonce (ChaCha20-Poly1305 IETF standard, AES-GCM standard)
     using NonceBuffer = std::array<uint8_t, 12>;
 
+    /**
+     * @struct SealJob
+     * @brief One packet for Encryptor::EncryptBatch. The buffers follow the rules of EncryptInto.
+     */
+    struct SealJob {
+        std::span<const uint8_t> plain;
+        std::span<uint8_t>       out;
+        uint64_t                 nonce{ 0 };
+        size_t                   sealed{ 0 }; // set by EncryptBatch: bytes written to out, 0 on failure
+    };
+
     /**
      * @class Encryptor
      * @brief Manages a secure, encrypted communication channel between two peers.
-     * This class handles the X25519 key exchange and the subsequent symmetric
-     * encryption/decryption of data.
+     * This class handles the X25519 key exchange (RiftEncrypt) and the subsequent
+     * ChaCha20-Poly1305 IETF encryption/decryption of data (libsodium), which can
+     * operate directly on caller-owned buffers.
      */
     class Encryptor {
     public:
+        // Size of the Poly1305 authentication tag appended to every ciphertext.
+        static constexpr size_t kTagSize = 16;
+
         /**
          * @brief Constructs the Encryptor.
          * @param isServerRole True if this instance is on the server, false for a client.
          * This determines which key derivation function to use.
          */
         explicit Encryptor(bool isServerRole);
+
+        /**
+         * @brief Constructs the Encryptor around an already generated keypair (see KeyPool).
+         * @param keyExchange The local keypair; nullptr generates one as the other constructor does.
+         */
+        Encryptor(bool isServerRole, std::unique_ptr<KeyExchangeX25519> keyExchange);
         ~Encryptor(); // Required for unique_ptr to incomplete type
 
+        /**
+         * @brief Wipes the session keys and drops the local keypair, leaving the Encryptor
+         * uninitialized, e.g. before a ConnectionPool keeps it for the next connection.
+         */
+        void Clear();
+
+        /**
+         * @brief Clears the Encryptor and sets it up as a freshly constructed one.
+         * @param keyExchange The local keypair; nullptr generates one.
+         */
+        void Reset(bool isServerRole, std::unique_ptr<KeyExchangeX25519> keyExchange);
+
         /**
          * @brief Computes the shared session keys and initializes the symmetric ciphers.
          * @param remotePublicKey The public key received from the remote peer.
@@ -41,7 +75,8 @@ namespace RiftNet::Security {
         bool InitializeSession(const byte_vec& remotePublicKey);
 
         /**
-         * @brief Checks if the session has been successfully initialized.
+         * @brief Checks if the session has been successfully initialized. Safe while another
+         * thread runs InitializeSession: it turns true only once the keys are in place.
          */
         bool IsInitialized() const;
 
@@ -52,6 +87,24 @@ namespace RiftNet::Security {
          */
         const byte_vec& GetPublicKey() const;
 
+        /**
+         * @brief Encrypts into a caller-provided buffer without allocating.
+         * @param plainData The data to encrypt.
+         * @param out Destination for ciphertext + tag; at least plainData.size() + kTagSize bytes.
+         *        May alias plainData exactly, for in-place encryption.
+         * @param nonce A unique, 64-bit nonce for this specific message.
+         * @return The number of bytes written to out, or 0 on failure.
+         */
+        size_t EncryptInto(std::span<const uint8_t> plainData, std::span<uint8_t> out, uint64_t nonce);
+
+        /**
+         * @brief Encrypts several packets for this session in one call, without allocating.
+         * The session checks run once for the batch, so a connection sealing a burst (fragments,
+         * retransmissions) pays them once; each job's sealed field reports its own result.
+         * @return The number of jobs sealed.
+         */
+        size_t EncryptBatch(std::span<SealJob> jobs);
+
         /**
          * @brief Encrypts a block of data using the derived session key.
          * @param plainData The data to encrypt.
@@ -69,21 +122,38 @@ namespace RiftNet::Security {
          */
         bool Decrypt(const std::vector<uint8_t>& encryptedData, std::vector<uint8_t>& outPlainData, uint64_t nonce);
 
+        /**
+         * @brief Decrypts into a caller-provided buffer without allocating.
+         * @param encryptedData The ciphertext + tag.
+         * @param outPlainData Destination; at least encryptedData.size() - kTagSize bytes.
+         *        May alias encryptedData exactly, for in-place decryption of a receive buffer.
+         * @param nonce The 64-bit nonce used for encryption.
+         * @param outPlainSize Receives the number of plaintext bytes written.
+         * @return True on successful decryption and authentication, false otherwise.
+         */
+        bool Decrypt(std::span<const uint8_t> encryptedData, std::span<uint8_t> outPlainData, uint64_t nonce, size_t& outPlainSize);
+
     private:
         /**
          * @brief Expands a 64-bit nonce into a 12-byte nonce suitable for the cipher.
          */
-        NonceBuffer ExpandNonce(uint64_t nonce) const;
+        static NonceBuffer ExpandNonce(uint64_t nonce) noexcept;
+
+        // Installs keyExchange as the local keypair, or generates one if it is nullptr
+        void SetKeypair(std::unique_ptr<KeyExchangeX25519> keyExchange);
+
+        // Seals one packet; the caller has checked the session and buffer sizes
+        size_t Seal(std::span<const uint8_t> plainData, uint8_t* out, uint64_t nonce) const;
 
         // Asymmetric key exchange object
         std::unique_ptr<KeyExchangeX25519> m_keyExchange;
 
-        // Symmetric ciphers for data transfer, initialized after key exchange
-        std::unique_ptr<::Encryptor> m_rxEncryptor;
-        std::unique_ptr<::Encryptor> m_txEncryptor;
+        // Symmetric session keys for data transfer, derived after key exchange
+        KeyBuffer m_rxKey{};
+        KeyBuffer m_txKey{};
 
         bool m_isServer;
-        bool m_isInitialized = false;
+        std::atomic<bool> m_isInitialized{ false }; // published after the keys are written
     };
 
 } // namespace RiftNet::Security
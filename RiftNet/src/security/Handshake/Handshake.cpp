@@ -6,29 +6,169 @@
 
 namespace {
     constexpr std::array<uint8_t, 4> kMagic = { 'R','F','N','T' };
+
+    bool HasHeader(const uint8_t* data, uint8_t type) {
+        using RiftNet::Protocol::Handshake::Hello;
+        return std::equal(kMagic.begin(), kMagic.end(), data) && data[4] == Hello::kVersion && data[5] == type;
+    }
 }
 
 namespace RiftNet::Protocol::Handshake {
 
-    std::vector<uint8_t> BuildHello(const byte_vec& pub32) {
+    namespace {
+        // keepCaps: write the caps byte even when zero, for frames where more data follows the HELLO fields
+        std::vector<uint8_t> BuildHelloFrame(uint8_t type, const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+            uint32_t routingId, bool keepCaps = false);
+        bool ParseHelloFrame(uint8_t type, const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+            uint32_t& outDictionaryId, uint32_t& outRoutingId, bool keepCaps = false);
+        // Size of the HELLO frame at the start of data, from its caps byte; 0 if too short to tell
+        uint32_t HelloFrameSize(const uint8_t* data, uint32_t size, bool keepCaps);
+    }
+
+    bool IsHandshakeFrame(const uint8_t* data, uint32_t size) {
+        return data && size >= 6 && std::equal(kMagic.begin(), kMagic.end(), data) && data[4] == Hello::kVersion;
+    }
+
+    std::vector<uint8_t> BuildHello(const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId, uint32_t routingId) {
+        return BuildHelloFrame(Hello::kTypeHello, pub32, caps, dictionaryId, routingId);
+    }
+
+    bool TryParseHello(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId) {
+        return ParseHelloFrame(Hello::kTypeHello, data, size, outPubKey, outCaps, outDictionaryId, outRoutingId);
+    }
+
+    std::vector<uint8_t> BuildChallenge(const Security::Cookie& cookie) {
+        std::vector<uint8_t> buf;
+        buf.reserve(Hello::kChallengeSize);
+        buf.insert(buf.end(), kMagic.begin(), kMagic.end());
+        buf.push_back(Hello::kVersion);
+        buf.push_back(Hello::kTypeChallenge);
+        buf.insert(buf.end(), cookie.begin(), cookie.end());
+        return buf;
+    }
+
+    bool TryParseChallenge(const uint8_t* data, uint32_t size, Security::Cookie& outCookie) {
+        if (!data || size != Hello::kChallengeSize || !HasHeader(data, Hello::kTypeChallenge)) return false;
+        std::copy(data + 6, data + Hello::kChallengeSize, outCookie.begin());
+        return true;
+    }
+
+    std::vector<uint8_t> BuildResponse(const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+        uint32_t routingId, const Security::Cookie& cookie) {
+        std::vector<uint8_t> buf = BuildHelloFrame(Hello::kTypeResponse, pub32, caps, dictionaryId, routingId);
+        if (!buf.empty()) {
+            buf.insert(buf.end(), cookie.begin(), cookie.end());
+        }
+        return buf;
+    }
+
+    bool TryParseResponse(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId, Security::Cookie& outCookie) {
+        if (!data || size < Security::COOKIE_SIZE) return false;
+        const uint32_t helloSize = size - static_cast<uint32_t>(Security::COOKIE_SIZE);
+        if (!ParseHelloFrame(Hello::kTypeResponse, data, helloSize, outPubKey, outCaps, outDictionaryId, outRoutingId)) return false;
+        std::copy(data + helloSize, data + size, outCookie.begin());
+        return true;
+    }
+
+    std::vector<uint8_t> BuildResume(const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+        uint32_t routingId, std::span<const uint8_t> ticket, std::span<const uint8_t> sealedEarlyData) {
+        if (ticket.size() > 0xFFFF) return {};
+        std::vector<uint8_t> buf = BuildHelloFrame(Hello::kTypeResume, pub32, caps, dictionaryId, routingId, /*keepCaps=*/true);
+        if (buf.empty()) return buf;
+
+        buf.reserve(buf.size() + sizeof(uint16_t) + ticket.size() + sealedEarlyData.size());
+        buf.push_back(static_cast<uint8_t>(ticket.size() & 0xFF));
+        buf.push_back(static_cast<uint8_t>(ticket.size() >> 8));
+        buf.insert(buf.end(), ticket.begin(), ticket.end());
+        buf.insert(buf.end(), sealedEarlyData.begin(), sealedEarlyData.end());
+        return buf;
+    }
+
+    bool TryParseResume(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId, std::span<const uint8_t>& outTicket,
+        std::span<const uint8_t>& outSealedEarlyData) {
+        if (!data || size < Hello::kSizeWithCaps || !HasHeader(data, Hello::kTypeResume)) return false;
+        const uint32_t helloSize = HelloFrameSize(data, size, /*keepCaps=*/true);
+        if (helloSize == 0 || size < helloSize + sizeof(uint16_t)) return false;
+        if (!ParseHelloFrame(Hello::kTypeResume, data, helloSize, outPubKey, outCaps, outDictionaryId, outRoutingId,
+            /*keepCaps=*/true)) return false;
+
+        const uint32_t ticketSize = static_cast<uint32_t>(data[helloSize]) | (static_cast<uint32_t>(data[helloSize + 1]) << 8);
+        const uint32_t ticketOffset = helloSize + static_cast<uint32_t>(sizeof(uint16_t));
+        if (ticketSize == 0 || ticketSize > size - ticketOffset) return false;
+
+        outTicket = { data + ticketOffset, ticketSize };
+        outSealedEarlyData = { data + ticketOffset + ticketSize, size - ticketOffset - ticketSize };
+        return true;
+    }
+
+    namespace {
+
+    std::vector<uint8_t> BuildHelloFrame(uint8_t type, const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+        uint32_t routingId, bool keepCaps) {
         if (pub32.size() != 32) return {};
         std::vector<uint8_t> buf;
-        buf.reserve(Hello::kSize);
+        buf.reserve(Hello::kMaxSize + Security::COOKIE_SIZE);
         buf.insert(buf.end(), kMagic.begin(), kMagic.end());
         buf.push_back(Hello::kVersion);
-        buf.push_back(Hello::kTypeHello);
+        buf.push_back(type);
         buf.insert(buf.end(), pub32.begin(), pub32.end());
+        if (caps != 0 || keepCaps) {
+            buf.push_back(caps); // omitted otherwise, so plain HELLOs stay byte-identical
+        }
+        if ((caps & Hello::kCapDictionary) != 0) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                buf.push_back(static_cast<uint8_t>(dictionaryId >> shift));
+            }
+        }
+        if ((caps & Hello::kCapConnectionId) != 0) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                buf.push_back(static_cast<uint8_t>(routingId >> shift));
+            }
+        }
         return buf;
     }
 
-    bool TryParseHello(const uint8_t* data, uint32_t size, byte_vec& outPubKey) {
-        if (!data || size != Hello::kSize) return false;
-        if (!std::equal(kMagic.begin(), kMagic.end(), data)) return false;
-        if (data[4] != Hello::kVersion) return false;
-        if (data[5] != Hello::kTypeHello) return false;
+    uint32_t HelloFrameSize(const uint8_t* data, uint32_t size, bool keepCaps) {
+        if (size < Hello::kSize || (keepCaps && size == Hello::kSize)) return 0;
+        if (size == Hello::kSize) return Hello::kSize;
+        const uint8_t caps = data[Hello::kSize];
+        if (caps == 0) return keepCaps ? Hello::kSizeWithCaps : Hello::kSize; // a plain HELLO omits a zero caps byte
+        return Hello::kSizeWithCaps + ((caps & Hello::kCapDictionary) != 0 ? 4u : 0u) +
+            ((caps & Hello::kCapConnectionId) != 0 ? 4u : 0u);
+    }
+
+    bool ParseHelloFrame(uint8_t type, const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId, bool keepCaps) {
+        if (!data || size < Hello::kSize || size > Hello::kMaxSize) return false;
+        if (!HasHeader(data, type)) return false;
+
+        // The ids are present exactly when their flags are
+        outCaps = (size > Hello::kSize) ? data[Hello::kSize] : 0;
+        if ((!keepCaps && size > Hello::kSize && outCaps == 0) || HelloFrameSize(data, size, keepCaps) != size) return false;
 
         outPubKey.assign(data + 6, data + 6 + 32);
+        uint32_t offset = Hello::kSizeWithCaps;
+        auto readU32 = [&](uint32_t& out) {
+            out = 0;
+            for (int i = 0; i < 4; ++i) {
+                out |= static_cast<uint32_t>(data[offset + i]) << (8 * i);
+            }
+            offset += 4;
+        };
+        outDictionaryId = 0;
+        outRoutingId = 0;
+        if ((outCaps & Hello::kCapDictionary) != 0) {
+            readU32(outDictionaryId);
+        }
+        if ((outCaps & Hello::kCapConnectionId) != 0) {
+            readU32(outRoutingId);
+        }
         return true;
     }
 
+    } // namespace
+
 } // namespace RiftNet::Protocol::Handshake
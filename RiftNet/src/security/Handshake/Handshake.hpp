@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <vector>
 #include "riftencrypt.hpp"  // for byte_vec alias
+#include "../HandshakeCookie/HandshakeCookie.hpp"
 
 namespace RiftNet::Protocol::Handshake {
 
@@ -12,18 +14,72 @@ namespace RiftNet::Protocol::Handshake {
     // [4]     = version (1)
     // [5]     = msg type (0x01 = HELLO)
     // [6..37] = 32-byte X25519 public key
+    // [38]    = capability flags (optional; only sent when non-zero)
+    // then      compression dictionary id, u32 LE (only with kCapDictionary)
+    // then      routing id, u32 LE (only with kCapConnectionId; 0 in a client's offer)
     //
-    // Total size = 38 bytes
+    // Total size = 38 bytes, or 39 with capability flags plus 4 per id present
+    //
+    // A server answers a HELLO from an unknown endpoint with a CHALLENGE instead, and only sets up
+    // the connection once the client echoes its cookie in a RESPONSE (the cleartext forms of
+    // PacketType::Handshake_Challenge / Handshake_Response, which name sealed packets and so cannot
+    // be used before the session exists):
+    //
+    // CHALLENGE = [0..5] as above with msg type 0x02, [6..25] = cookie (Security::COOKIE_SIZE bytes)
+    // RESPONSE  = a HELLO with msg type 0x03, followed by the cookie
+    //
+    // A client holding a session ticket sends a RESUME instead of its first HELLO; a server that
+    // redeems the ticket skips the challenge and answers with its HELLO right away:
+    //
+    // RESUME    = a HELLO with msg type 0x04 that always has its caps byte, followed by [u16 LE ticket size][ticket]
+    //             [0-RTT data sealed under DeriveEarlyDataKey, may be empty]
     struct Hello {
         static constexpr uint8_t  kVersion = 1;
         static constexpr uint8_t  kTypeHello = 0x01;
+        static constexpr uint8_t  kTypeChallenge = 0x02;
+        static constexpr uint8_t  kTypeResponse = 0x03;
+        static constexpr uint8_t  kTypeResume = 0x04;
+        static constexpr uint32_t kChallengeSize = 6 + Security::COOKIE_SIZE;
         static constexpr uint32_t kSize = 38;
+        static constexpr uint32_t kSizeWithCaps = 39;
+        static constexpr uint32_t kSizeWithDictionary = 43;
+        static constexpr uint32_t kMaxSize = 47; // caps, dictionary id and routing id
+
+        // Capability flags; a feature is used only if both HELLOs carry its flag.
+        static constexpr uint8_t  kCapExtendedAcks = 0x01; // ReliabilityHeaderFormat::Extended
+        static constexpr uint8_t  kCapDictionary = 0x02;   // Compression dictionary loaded; its id follows
+        static constexpr uint8_t  kCapConnectionId = 0x04; // Client datagrams carry a routing id (server's HELLO assigns it)
+        static constexpr uint8_t  kCapEarlyData = 0x08;    // Server's HELLO only: the RESUME's 0-RTT data was accepted
     };
 
-    // Build a HELLO frame with our 32-byte public key.
-    std::vector<uint8_t> BuildHello(const byte_vec& pub32);
+    // True if the buffer starts like a cleartext handshake frame (magic and version).
+    bool IsHandshakeFrame(const uint8_t* data, uint32_t size);
+
+    // Build a HELLO frame with our 32-byte public key and capability flags; dictionaryId and
+    // routingId are only written when caps has kCapDictionary / kCapConnectionId.
+    std::vector<uint8_t> BuildHello(const byte_vec& pub32, uint8_t caps = 0, uint32_t dictionaryId = 0,
+        uint32_t routingId = 0);
+
+    // If the buffer is a valid HELLO, fill outPubKey (32 bytes), outCaps (0 if absent),
+    // outDictionaryId and outRoutingId (0 without their flags) and return true.
+    bool TryParseHello(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId);
+
+    std::vector<uint8_t> BuildChallenge(const Security::Cookie& cookie);
+    bool TryParseChallenge(const uint8_t* data, uint32_t size, Security::Cookie& outCookie);
+
+    // A HELLO with the RESPONSE type and the server's cookie appended.
+    std::vector<uint8_t> BuildResponse(const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+        uint32_t routingId, const Security::Cookie& cookie);
+    bool TryParseResponse(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId, Security::Cookie& outCookie);
 
-    // If the buffer is a valid HELLO, fill outPubKey (32 bytes) and return true.
-    bool TryParseHello(const uint8_t* data, uint32_t size, byte_vec& outPubKey);
+    // A HELLO with the RESUME type, the client's session ticket and its sealed 0-RTT data.
+    std::vector<uint8_t> BuildResume(const byte_vec& pub32, uint8_t caps, uint32_t dictionaryId,
+        uint32_t routingId, std::span<const uint8_t> ticket, std::span<const uint8_t> sealedEarlyData);
+    // outTicket and outSealedEarlyData point into data.
+    bool TryParseResume(const uint8_t* data, uint32_t size, byte_vec& outPubKey, uint8_t& outCaps,
+        uint32_t& outDictionaryId, uint32_t& outRoutingId, std::span<const uint8_t>& outTicket,
+        std::span<const uint8_t>& outSealedEarlyData);
 
 } // namespace RiftNet::Protocol::Handshake
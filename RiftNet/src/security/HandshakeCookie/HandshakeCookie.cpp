@@ -0,0 +1,95 @@
+#include "pch.h"
+#include "HandshakeCookie.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <sodium.h>
+
+#include <algorithm> // For std::min
+#include <cstring>
+
+namespace RiftNet::Security {
+
+    namespace {
+        constexpr size_t TIME_SIZE = sizeof(uint32_t);
+        constexpr size_t MAC_SIZE = COOKIE_SIZE - TIME_SIZE;
+        constexpr size_t MAX_PEER_KEY_SIZE = 32;
+
+        // [u32 issued][16-byte address][u16 port][u16 family][peer key]
+        constexpr size_t MAC_INPUT_SIZE = TIME_SIZE + 16 + 2 + 2 + MAX_PEER_KEY_SIZE;
+    }
+
+    HandshakeCookie::HandshakeCookie()
+        : m_epoch(std::chrono::steady_clock::now()) {
+        if (sodium_init() < 0) {
+            RF_NETWORK_CRITICAL("HandshakeCookie: libsodium initialization failed");
+        }
+        randombytes_buf(m_secret.data(), m_secret.size());
+    }
+
+    HandshakeCookie::~HandshakeCookie() {
+        sodium_memzero(m_secret.data(), m_secret.size());
+    }
+
+    Cookie HandshakeCookie::Issue(const RiftNet::Networking::NetworkEndpoint& peer, std::span<const uint8_t> peerKey,
+        std::chrono::steady_clock::time_point now) const {
+        Cookie cookie{};
+        const uint32_t issued = SecondsSinceEpoch(now);
+        for (size_t i = 0; i < TIME_SIZE; ++i) {
+            cookie[i] = static_cast<uint8_t>(issued >> (8 * i));
+        }
+        ComputeMac(issued, peer, peerKey, cookie.data() + TIME_SIZE);
+        return cookie;
+    }
+
+    bool HandshakeCookie::Verify(const RiftNet::Networking::NetworkEndpoint& peer, std::span<const uint8_t> peerKey,
+        const Cookie& cookie, std::chrono::steady_clock::time_point now) const {
+        uint32_t issued = 0;
+        for (size_t i = 0; i < TIME_SIZE; ++i) {
+            issued |= static_cast<uint32_t>(cookie[i]) << (8 * i);
+        }
+
+        const uint32_t current = SecondsSinceEpoch(now);
+        if (issued > current || current - issued > static_cast<uint32_t>(COOKIE_LIFETIME.count())) {
+            RF_NETWORK_DEBUG("HandshakeCookie: expired cookie from {}", peer);
+            return false;
+        }
+
+        uint8_t expected[MAC_SIZE];
+        ComputeMac(issued, peer, peerKey, expected);
+        if (sodium_memcmp(expected, cookie.data() + TIME_SIZE, MAC_SIZE) != 0) {
+            RF_NETWORK_DEBUG("HandshakeCookie: forged cookie from {}", peer);
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t HandshakeCookie::SecondsSinceEpoch(std::chrono::steady_clock::time_point now) const {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now - m_epoch).count());
+    }
+
+    void HandshakeCookie::ComputeMac(uint32_t issued, const RiftNet::Networking::NetworkEndpoint& peer,
+        std::span<const uint8_t> peerKey, uint8_t* out) const {
+        uint8_t input[MAC_INPUT_SIZE] = {};
+        size_t offset = 0;
+        for (size_t i = 0; i < TIME_SIZE; ++i) {
+            input[offset++] = static_cast<uint8_t>(issued >> (8 * i));
+        }
+        std::memcpy(input + offset, peer.address, sizeof(peer.address));
+        offset += sizeof(peer.address);
+        input[offset++] = static_cast<uint8_t>(peer.port);
+        input[offset++] = static_cast<uint8_t>(peer.port >> 8);
+        input[offset++] = static_cast<uint8_t>(peer.family);
+        input[offset++] = static_cast<uint8_t>(peer.family >> 8);
+        const size_t keySize = (std::min)(peerKey.size(), MAX_PEER_KEY_SIZE);
+        if (keySize != 0) {
+            std::memcpy(input + offset, peerKey.data(), keySize);
+        }
+        offset += keySize;
+
+        uint8_t mac[crypto_auth_hmacsha256_BYTES];
+        crypto_auth_hmacsha256(mac, input, offset, m_secret.data());
+        std::memcpy(out, mac, MAC_SIZE);
+        sodium_memzero(mac, sizeof(mac));
+    }
+
+} // namespace RiftNet::Security
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../Crypto/Encryptor.hpp"
+#include "../../core/networkio/NetworkEndpoint.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+namespace RiftNet::Security {
+
+    // [u32 issue time, seconds since the issuer started][16-byte truncated HMAC-SHA256]
+    constexpr size_t COOKIE_SIZE = 20;
+    // How long a client has to echo a cookie back
+    constexpr std::chrono::seconds COOKIE_LIFETIME{ 10 };
+
+    using Cookie = std::array<uint8_t, COOKIE_SIZE>;
+
+    /**
+     * @class HandshakeCookie
+     * @brief Issues and checks stateless handshake cookies, so a server only commits memory and
+     * key material to a peer that has proven it receives datagrams at its source address.
+     * A cookie is a MAC over the issue time, the peer's endpoint and its public key under a
+     * secret only this instance knows; nothing is stored per cookie. Thread-safe once constructed.
+     */
+    class HandshakeCookie {
+    public:
+        HandshakeCookie(); // draws a random secret
+        ~HandshakeCookie();
+
+        HandshakeCookie(const HandshakeCookie&) = delete;
+        HandshakeCookie& operator=(const HandshakeCookie&) = delete;
+
+        Cookie Issue(const RiftNet::Networking::NetworkEndpoint& peer, std::span<const uint8_t> peerKey,
+            std::chrono::steady_clock::time_point now) const;
+
+        // @return True if cookie was issued by this instance to peer and peerKey within COOKIE_LIFETIME.
+        bool Verify(const RiftNet::Networking::NetworkEndpoint& peer, std::span<const uint8_t> peerKey,
+            const Cookie& cookie, std::chrono::steady_clock::time_point now) const;
+
+    private:
+        uint32_t SecondsSinceEpoch(std::chrono::steady_clock::time_point now) const;
+        void ComputeMac(uint32_t issued, const RiftNet::Networking::NetworkEndpoint& peer,
+            std::span<const uint8_t> peerKey, uint8_t* out) const;
+
+        KeyBuffer m_secret{};
+        std::chrono::steady_clock::time_point m_epoch;
+    };
+
+} // namespace RiftNet::Security
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "KeyPool.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <algorithm> // For std::min
+#include <exception>
+
+namespace RiftNet::Security {
+
+    KeyPool::KeyPool(size_t capacity)
+        : m_capacity(capacity) {
+        m_keys.reserve(capacity);
+    }
+
+    std::unique_ptr<KeyExchangeX25519> KeyPool::Take() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_keys.empty()) {
+                std::unique_ptr<KeyExchangeX25519> key = std::move(m_keys.back());
+                m_keys.pop_back();
+                return key;
+            }
+        }
+        RF_NETWORK_DEBUG("KeyPool: empty; generating a keypair inline");
+        return Generate();
+    }
+
+    void KeyPool::Refill(size_t maxKeys) {
+        size_t missing = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            missing = m_capacity > m_keys.size() ? m_capacity - m_keys.size() : 0;
+        }
+
+        for (size_t i = 0; i < (std::min)(missing, maxKeys); ++i) {
+            std::unique_ptr<KeyExchangeX25519> key = Generate();
+            if (!key) return;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_keys.size() >= m_capacity) return;
+            m_keys.push_back(std::move(key));
+        }
+    }
+
+    size_t KeyPool::Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_keys.size();
+    }
+
+    std::unique_ptr<KeyExchangeX25519> KeyPool::Generate() {
+        try {
+            return KeyExchangeX25519::generate_keypair();
+        }
+        catch (const std::exception& e) {
+            RF_NETWORK_ERROR("KeyPool: keypair generation failed: {}", e.what());
+        }
+        catch (...) {
+            RF_NETWORK_ERROR("KeyPool: keypair generation failed: unknown exception");
+        }
+        return nullptr;
+    }
+
+} // namespace RiftNet::Security
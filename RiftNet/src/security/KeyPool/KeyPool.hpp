@@ -0,0 +1,43 @@
+#pragma once
+
+#include "riftencrypt.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace RiftNet::Security {
+
+    /**
+     * @class KeyPool
+     * @brief Pre-generated X25519 keypairs, so accepting a connection does not pay for key
+     * generation on the receive path. Each keypair is handed out once. Thread-safe.
+     */
+    class KeyPool {
+    public:
+        explicit KeyPool(size_t capacity);
+
+        /**
+         * @brief Takes a keypair from the pool, or generates one inline if the pool is empty.
+         * @return nullptr only if generation failed.
+         */
+        std::unique_ptr<KeyExchangeX25519> Take();
+
+        /**
+         * @brief Generates up to maxKeys keypairs towards capacity. Call from a background or
+         * timer thread; generation runs outside the pool's lock.
+         */
+        void Refill(size_t maxKeys);
+
+        size_t Size() const;
+
+    private:
+        static std::unique_ptr<KeyExchangeX25519> Generate();
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<KeyExchangeX25519>> m_keys;
+        size_t m_capacity;
+    };
+
+} // namespace RiftNet::Security
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "ReplayWindow.hpp"
+
+#include <algorithm>
+
+namespace RiftNet::Security {
+
+    namespace {
+        constexpr size_t WordIndex(uint64_t counter) {
+            return static_cast<size_t>((counter >> 6) % ReplayWindow::WORD_COUNT);
+        }
+
+        constexpr uint64_t BitMask(uint64_t counter) {
+            return uint64_t{ 1 } << (counter & 63);
+        }
+    }
+
+    bool ReplayWindow::IsFresh(uint64_t counter) const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return IsFreshLocked(counter);
+    }
+
+    bool ReplayWindow::IsFreshLocked(uint64_t counter) const {
+        if (!m_any || counter > m_highest) {
+            return true;
+        }
+        if (m_highest - counter >= REPLAY_WINDOW_SIZE) {
+            return false;
+        }
+        return (m_bitmap[WordIndex(counter)] & BitMask(counter)) == 0;
+    }
+
+    ReplayWindow::Result ReplayWindow::Record(uint64_t counter) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!IsFreshLocked(counter)) {
+            return Result::Replayed;
+        }
+
+        if (m_any && counter <= m_highest) {
+            m_bitmap[WordIndex(counter)] |= BitMask(counter);
+            return Result::Accepted;
+        }
+
+        // Slide forward: the words between the old and the new highest hold counters never seen
+        if (!m_any) {
+            m_bitmap.fill(0);
+        }
+        else if ((counter >> 6) > (m_highest >> 6)) {
+            const uint64_t from = (m_highest >> 6) + 1;
+            const uint64_t stale = (std::min)((counter >> 6) - from + 1, static_cast<uint64_t>(WORD_COUNT));
+            for (uint64_t i = 0; i < stale; ++i) {
+                m_bitmap[WordIndex((from + i) << 6)] = 0;
+            }
+        }
+        m_highest = counter;
+        m_any = true;
+        m_bitmap[WordIndex(counter)] |= BitMask(counter);
+        return Result::Advanced;
+    }
+
+    uint64_t ReplayWindow::GetHighest() const {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_highest;
+    }
+
+    void ReplayWindow::Reset() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_bitmap.fill(0);
+        m_highest = 0;
+        m_any = false;
+    }
+
+} // namespace RiftNet::Security
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace RiftNet::Security {
+
+    /**
+     * @class ReplayWindow
+     * @brief Sliding-window anti-replay filter over a peer's packet counters (RFC 6479 style).
+     * A counter is accepted once, and only while it is within REPLAY_WINDOW_SIZE of the highest seen.
+     * The bitmap is a ring of words, so sliding forward clears whole words instead of shifting bits.
+     * Thread-safe: receive threads may check and record concurrently.
+     */
+    class ReplayWindow {
+    public:
+        static constexpr size_t WORD_COUNT = 32;
+        // The word holding the highest counter is partly ahead of it, so one word is not usable history
+        static constexpr uint64_t REPLAY_WINDOW_SIZE = (WORD_COUNT - 1) * 64;
+
+        enum class Result : uint8_t {
+            Replayed, // seen before, or too old to tell
+            Accepted, // new, within the window
+            Advanced  // new and the highest so far
+        };
+
+        /**
+         * @brief Cheap pre-check before authenticating: false if counter is certainly a replay.
+         * Changes nothing, so a forged packet cannot move the window; call Record once it authenticates.
+         */
+        bool IsFresh(uint64_t counter) const;
+
+        // Marks an authenticated counter as seen. Replayed if a concurrent duplicate got there first.
+        Result Record(uint64_t counter);
+
+        // Highest recorded counter; 0 before any.
+        uint64_t GetHighest() const;
+        void Reset();
+
+    private:
+        bool IsFreshLocked(uint64_t counter) const;
+
+        mutable std::mutex m_mtx;
+        std::array<uint64_t, WORD_COUNT> m_bitmap{};
+        uint64_t m_highest{ 0 };
+        bool     m_any{ false };
+    };
+
+} // namespace RiftNet::Security
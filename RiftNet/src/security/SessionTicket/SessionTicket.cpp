@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "SessionTicket.hpp"
+#include "../../../utilities/logger/Logger.hpp"
+
+#include <sodium.h>
+
+#include <cstring>
+
+namespace RiftNet::Security {
+
+    namespace {
+        constexpr size_t NONCE_SIZE = crypto_aead_chacha20poly1305_ietf_NPUBBYTES;
+        constexpr size_t TIME_SIZE = sizeof(uint32_t);
+        constexpr size_t PLAIN_SIZE = TIME_SIZE + sizeof(KeyBuffer);
+        constexpr size_t TAG_SIZE = crypto_aead_chacha20poly1305_ietf_ABYTES;
+        static_assert(SESSION_TICKET_SIZE == NONCE_SIZE + PLAIN_SIZE + TAG_SIZE, "ticket layout");
+
+        constexpr char EARLY_DATA_LABEL[] = "RiftNet 0-RTT data";
+
+        uint64_t TicketId(const uint8_t* nonce) {
+            uint64_t id = 0;
+            std::memcpy(&id, nonce, sizeof(id));
+            return id;
+        }
+    }
+
+    SessionTicketIssuer::SessionTicketIssuer()
+        : m_epoch(std::chrono::steady_clock::now()) {
+        if (sodium_init() < 0) {
+            RF_NETWORK_CRITICAL("SessionTicketIssuer: libsodium initialization failed");
+        }
+        randombytes_buf(m_key.data(), m_key.size());
+    }
+
+    SessionTicketIssuer::~SessionTicketIssuer() {
+        sodium_memzero(m_key.data(), m_key.size());
+    }
+
+    ResumptionTicket SessionTicketIssuer::Issue(std::chrono::steady_clock::time_point now) const {
+        ResumptionTicket out;
+        randombytes_buf(out.secret.data(), out.secret.size());
+
+        uint8_t plain[PLAIN_SIZE];
+        const uint32_t issued = SecondsSinceEpoch(now);
+        for (size_t i = 0; i < TIME_SIZE; ++i) {
+            plain[i] = static_cast<uint8_t>(issued >> (8 * i));
+        }
+        std::memcpy(plain + TIME_SIZE, out.secret.data(), out.secret.size());
+
+        // A random nonce per ticket: the key lives as long as the server, and tickets are few
+        out.ticket.resize(SESSION_TICKET_SIZE);
+        randombytes_buf(out.ticket.data(), NONCE_SIZE);
+        unsigned long long written = 0;
+        if (crypto_aead_chacha20poly1305_ietf_encrypt(out.ticket.data() + NONCE_SIZE, &written,
+                plain, sizeof(plain), nullptr, 0, nullptr, out.ticket.data(), m_key.data()) != 0) {
+            RF_NETWORK_ERROR("SessionTicketIssuer: sealing a ticket failed");
+            out.ticket.clear();
+        }
+        sodium_memzero(plain, sizeof(plain));
+        return out;
+    }
+
+    bool SessionTicketIssuer::Redeem(std::span<const uint8_t> ticket, std::chrono::steady_clock::time_point now,
+        KeyBuffer& outSecret) {
+        if (ticket.size() != SESSION_TICKET_SIZE) {
+            return false;
+        }
+
+        uint8_t plain[PLAIN_SIZE];
+        unsigned long long opened = 0;
+        if (crypto_aead_chacha20poly1305_ietf_decrypt(plain, &opened, nullptr,
+                ticket.data() + NONCE_SIZE, ticket.size() - NONCE_SIZE, nullptr, 0, ticket.data(), m_key.data()) != 0 ||
+            opened != PLAIN_SIZE) {
+            RF_NETWORK_DEBUG("SessionTicketIssuer: forged or foreign ticket");
+            return false;
+        }
+
+        uint32_t issued = 0;
+        for (size_t i = 0; i < TIME_SIZE; ++i) {
+            issued |= static_cast<uint32_t>(plain[i]) << (8 * i);
+        }
+        const uint32_t current = SecondsSinceEpoch(now);
+        if (issued > current || current - issued > static_cast<uint32_t>(SESSION_TICKET_LIFETIME.count())) {
+            RF_NETWORK_DEBUG("SessionTicketIssuer: expired ticket");
+            sodium_memzero(plain, sizeof(plain));
+            return false;
+        }
+
+        {
+            // A captured resume replayed later would repeat its 0-RTT data, so each ticket works once
+            std::lock_guard<std::mutex> lock(m_redeemedMtx);
+            ForgetExpired(current);
+            const uint64_t id = TicketId(ticket.data());
+            if (m_redeemed.size() >= MAX_REDEEMED_TICKETS || !m_redeemed.insert(id).second) {
+                RF_NETWORK_DEBUG("SessionTicketIssuer: ticket already redeemed (or replay cache full)");
+                sodium_memzero(plain, sizeof(plain));
+                return false;
+            }
+            m_redeemedOrder.emplace_back(current, id);
+        }
+
+        std::memcpy(outSecret.data(), plain + TIME_SIZE, outSecret.size());
+        sodium_memzero(plain, sizeof(plain));
+        return true;
+    }
+
+    uint32_t SessionTicketIssuer::SecondsSinceEpoch(std::chrono::steady_clock::time_point now) const {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now - m_epoch).count());
+    }
+
+    void SessionTicketIssuer::ForgetExpired(uint32_t current) {
+        // A ticket redeemed more than a lifetime ago has expired, so nothing can replay it any more
+        const uint32_t lifetime = static_cast<uint32_t>(SESSION_TICKET_LIFETIME.count());
+        while (!m_redeemedOrder.empty() && current - m_redeemedOrder.front().first > lifetime) {
+            m_redeemed.erase(m_redeemedOrder.front().second);
+            m_redeemedOrder.pop_front();
+        }
+    }
+
+    KeyBuffer DeriveEarlyDataKey(const KeyBuffer& secret, std::span<const uint8_t> clientPublicKey) {
+        uint8_t input[sizeof(EARLY_DATA_LABEL) + 32] = {};
+        std::memcpy(input, EARLY_DATA_LABEL, sizeof(EARLY_DATA_LABEL));
+        const size_t keySize = clientPublicKey.size() < 32 ? clientPublicKey.size() : 32;
+        if (keySize != 0) {
+            std::memcpy(input + sizeof(EARLY_DATA_LABEL), clientPublicKey.data(), keySize);
+        }
+
+        KeyBuffer key{};
+        crypto_generichash(key.data(), key.size(), input, sizeof(EARLY_DATA_LABEL) + keySize, secret.data(), secret.size());
+        return key;
+    }
+
+    std::vector<uint8_t> SealEarlyData(const KeyBuffer& key, std::span<const uint8_t> plain) {
+        const uint8_t nonce[NONCE_SIZE] = {};
+        std::vector<uint8_t> sealed(plain.size() + TAG_SIZE);
+        unsigned long long written = 0;
+        if (crypto_aead_chacha20poly1305_ietf_encrypt(sealed.data(), &written, plain.data(), plain.size(),
+                nullptr, 0, nullptr, nonce, key.data()) != 0) {
+            RF_NETWORK_ERROR("SealEarlyData: AEAD encryption failed ({} bytes)", plain.size());
+            return {};
+        }
+        sealed.resize(static_cast<size_t>(written));
+        return sealed;
+    }
+
+    bool OpenEarlyData(const KeyBuffer& key, std::span<const uint8_t> sealed, std::vector<uint8_t>& outPlain) {
+        outPlain.clear();
+        if (sealed.size() < TAG_SIZE) {
+            return false;
+        }
+        const uint8_t nonce[NONCE_SIZE] = {};
+        outPlain.resize(sealed.size() - TAG_SIZE);
+        unsigned long long written = 0;
+        if (crypto_aead_chacha20poly1305_ietf_decrypt(outPlain.data(), &written, nullptr, sealed.data(), sealed.size(),
+                nullptr, 0, nonce, key.data()) != 0) {
+            outPlain.clear();
+            return false;
+        }
+        outPlain.resize(static_cast<size_t>(written));
+        return true;
+    }
+
+} // namespace RiftNet::Security
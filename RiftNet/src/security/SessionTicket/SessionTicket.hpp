@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../Crypto/Encryptor.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace RiftNet::Security {
+
+    // [12-byte nonce][sealed: u32 issue time, seconds since the issuer started][32-byte secret][16-byte tag]
+    constexpr size_t SESSION_TICKET_SIZE = 12 + 4 + 32 + 16;
+    // How long after issue a ticket can be redeemed
+    constexpr std::chrono::seconds SESSION_TICKET_LIFETIME{ 30 * 60 };
+    // Redeemed tickets remembered for replay protection; while full, resumes fall back to a full handshake
+    constexpr size_t MAX_REDEEMED_TICKETS = 128 * 1024;
+
+    /**
+     * @struct ResumptionTicket
+     * @brief What a client keeps to resume a session: the server's opaque ticket and the secret
+     * sealed inside it, which the server sent over the secure channel. The secret keys 0-RTT data.
+     */
+    struct ResumptionTicket {
+        std::vector<uint8_t> ticket; // SESSION_TICKET_SIZE bytes; empty = none
+        KeyBuffer            secret{};
+    };
+
+    /**
+     * @class SessionTicketIssuer
+     * @brief Issues and redeems session resumption tickets. A ticket is a fresh secret and its issue
+     * time sealed under a key only this instance knows, so the server stores nothing per ticket
+     * until it is redeemed; each ticket can then be redeemed once. Thread-safe once constructed.
+     */
+    class SessionTicketIssuer {
+    public:
+        SessionTicketIssuer(); // draws a random ticket key
+        ~SessionTicketIssuer();
+
+        SessionTicketIssuer(const SessionTicketIssuer&) = delete;
+        SessionTicketIssuer& operator=(const SessionTicketIssuer&) = delete;
+
+        ResumptionTicket Issue(std::chrono::steady_clock::time_point now) const;
+
+        /**
+         * @brief Opens a ticket this instance issued within SESSION_TICKET_LIFETIME and marks it used.
+         * @return False if the ticket is forged, expired or already redeemed, or the replay cache is full.
+         */
+        bool Redeem(std::span<const uint8_t> ticket, std::chrono::steady_clock::time_point now, KeyBuffer& outSecret);
+
+    private:
+        uint32_t SecondsSinceEpoch(std::chrono::steady_clock::time_point now) const;
+        void ForgetExpired(uint32_t current); // caller holds m_redeemedMtx
+
+        KeyBuffer m_key{};
+        std::chrono::steady_clock::time_point m_epoch;
+
+        std::mutex m_redeemedMtx;
+        std::unordered_set<uint64_t> m_redeemed;                   // leading nonce bytes of redeemed tickets
+        std::deque<std::pair<uint32_t, uint64_t>> m_redeemedOrder; // (redeem time, id), oldest first
+    };
+
+    // Key for a resuming client's 0-RTT data, bound to the new handshake key so each attempt gets its own.
+    KeyBuffer DeriveEarlyDataKey(const KeyBuffer& secret, std::span<const uint8_t> clientPublicKey);
+
+    // Seals or opens 0-RTT data; each derived key seals exactly one payload, so the nonce is fixed.
+    std::vector<uint8_t> SealEarlyData(const KeyBuffer& key, std::span<const uint8_t> plain);
+    bool OpenEarlyData(const KeyBuffer& key, std::span<const uint8_t> sealed, std::vector<uint8_t>& outPlain);
+
+} // namespace RiftNet::Security
@@ -0,0 +1,168 @@
+// ConnectionDeadlineTest: races Connection::GetNextDeadline, as the timer thread calls it, against a
+// reliable send that arms an earlier retransmission deadline through ArmTimer. Whatever the
+// interleaving, the retransmission must be reported: by the timer callback, or by the deadline
+// GetNextDeadline returns. Before the fix, a stale armed deadline made ArmTimer skip the callback
+// and GetNextDeadline then published its later one, leaving the retransmission unscheduled.
+//
+// Usage: ConnectionDeadlineTest [iterations]
+
+#include "../src/core/connection/Connection.hpp"
+#include "../src/core/buffer/PacketBuffer.hpp"
+#include "../src/core/networkio/NetworkEndpoint.hpp"
+#include "../src/security/Handshake/Handshake.hpp"
+#include "../src/security/HandshakeCookie/HandshakeCookie.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using namespace RiftNet;
+    using Clock = std::chrono::steady_clock;
+
+    // A client and server Connection joined in memory and brought to secure, as in MicroBench.
+    class Loopback {
+    public:
+        Loopback()
+            : m_client(m_serverEndpoint, false)
+            , m_server(m_clientEndpoint, true) {
+            m_client.SetSendCallback([this](const Networking::NetworkEndpoint&, const Networking::PacketBufferPtr& p) {
+                m_toServer.emplace_back(p->Data(), p->Data() + p->Size());
+            });
+            m_server.SetSendCallback([this](const Networking::NetworkEndpoint&, const Networking::PacketBufferPtr& p) {
+                m_toClient.emplace_back(p->Data(), p->Data() + p->Size());
+            });
+            m_client.SetAppDataCallback([](const uint8_t*, uint32_t, uint8_t) {});
+            m_server.SetAppDataCallback([](const uint8_t*, uint32_t, uint8_t) {});
+
+            m_client.BeginHandshake();
+            for (int round = 0; round < 8 && !IsSecure(); ++round) {
+                auto toServer = std::move(m_toServer);
+                m_toServer.clear();
+                for (auto& datagram : toServer) ToServer(datagram);
+                auto toClient = std::move(m_toClient);
+                m_toClient.clear();
+                for (auto& datagram : toClient) m_client.ProcessIncomingRawPacket(datagram.data(), static_cast<uint32_t>(datagram.size()));
+            }
+            m_toServer.clear(); // the race below only needs the client's side
+        }
+
+        bool IsSecure() const { return m_client.IsSecure() && m_server.IsSecure(); }
+        Protocol::Connection& Client() { return m_client; }
+
+    private:
+        void ToServer(std::vector<uint8_t>& datagram) {
+            uint8_t* data = datagram.data();
+            const uint32_t size = static_cast<uint32_t>(datagram.size());
+            if (m_server.IsSecure()) {
+                m_server.ProcessIncomingRawPacket(data, size);
+                return;
+            }
+            byte_vec peerKey;
+            uint8_t caps = 0;
+            uint32_t dictionaryId = 0, routingId = 0;
+            Security::Cookie cookie{};
+            if (Protocol::Handshake::TryParseHello(data, size, peerKey, caps, dictionaryId, routingId)) {
+                const auto challenge = Protocol::Handshake::BuildChallenge(m_cookies.Issue(m_clientEndpoint, peerKey, Clock::now()));
+                m_toClient.push_back(challenge);
+            }
+            else if (Protocol::Handshake::TryParseResponse(data, size, peerKey, caps, dictionaryId, routingId, cookie) &&
+                m_cookies.Verify(m_clientEndpoint, peerKey, cookie, Clock::now())) {
+                m_server.ProcessIncomingRawPacket(data, size);
+            }
+        }
+
+        const Networking::NetworkEndpoint m_clientEndpoint{ "127.0.0.1", 50001 };
+        const Networking::NetworkEndpoint m_serverEndpoint{ "127.0.0.1", 7777 };
+        Security::HandshakeCookie m_cookies;
+        Protocol::Connection m_client;
+        Protocol::Connection m_server;
+        std::vector<std::vector<uint8_t>> m_toServer;
+        std::vector<std::vector<uint8_t>> m_toClient;
+    };
+
+    void LowerTo(std::atomic<Clock::rep>& target, Clock::time_point value) {
+        const auto ticks = value.time_since_epoch().count();
+        auto current = target.load(std::memory_order_relaxed);
+        while (ticks < current && !target.compare_exchange_weak(current, ticks, std::memory_order_relaxed)) {
+        }
+    }
+
+    // One race on a fresh connection. Returns false if the retransmission deadline was lost.
+    //
+    // The interleaving is forced rather than hoped for: with a send budget, queued packets are sent
+    // from DrainSendQueue under the send queue lock, which GetNextDeadline takes after it has read
+    // the retransmission state. The drain sends an unreliable packet and then a reliable one; the
+    // first send starts the timer side, which reads "nothing in flight" and blocks on that lock
+    // while the reliable packet is numbered and its retransmission armed.
+    bool RunOnce() {
+        Loopback loopback;
+        if (!loopback.IsSecure()) {
+            std::fprintf(stderr, "handshake did not complete\n");
+            std::exit(2);
+        }
+        Protocol::Connection& connection = loopback.Client();
+
+        std::atomic<Clock::rep> reported{ Clock::time_point::max().time_since_epoch().count() };
+        connection.SetTimerCallback([&](Clock::time_point deadline) { LowerTo(reported, deadline); });
+
+        constexpr auto tick = std::chrono::milliseconds(20);
+        connection.SetSendBudget(1000, tick);
+
+        // The armed deadline is now an early one, and it has passed by the time the queue drains,
+        // as happens when the timer thread has not come round to it yet
+        connection.GetNextDeadline(std::chrono::milliseconds(1));
+
+        // Overdraw this tick, so the next two messages wait for the next one
+        std::vector<uint8_t> filler(1100);
+        uint32_t seed = 0x9E3779B9u;
+        for (uint8_t& b : filler) {
+            seed = seed * 1664525u + 1013904223u;
+            b = static_cast<uint8_t>(seed >> 24); // incompressible
+        }
+        connection.SendApplicationData(filler.data(), static_cast<uint32_t>(filler.size()), false);
+        const uint8_t message[16] = {};
+        connection.SendApplicationData(message, sizeof(message), false);
+        connection.SendApplicationData(message, sizeof(message), true);
+
+        std::thread timer;
+        connection.SetSendCallback([&](const Networking::NetworkEndpoint&, const Networking::PacketBufferPtr&) {
+            if (timer.joinable()) return;
+            timer = std::thread([&] { LowerTo(reported, connection.GetNextDeadline(std::chrono::hours(1))); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(20)); // until it waits on the queue lock
+        });
+
+        std::this_thread::sleep_for(tick + std::chrono::milliseconds(5));
+        connection.Update(Clock::now());
+        if (!timer.joinable()) {
+            std::fprintf(stderr, "the queued messages were not sent\n");
+            std::exit(2);
+        }
+        timer.join();
+
+        // Once both are done, the connection needs attention at its retransmission deadline.
+        // ArmTimer takes its deadline a moment after the reliability layer does, hence the slack;
+        // a lost one shows up as the hour-long idle deadline.
+        const auto due = connection.GetNextDeadline(std::chrono::hours(1));
+        return Clock::time_point(Clock::duration(reported.load())) <= due + std::chrono::seconds(1);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? std::atoi(argv[1]) : 20;
+    int lost = 0;
+    for (int i = 0; i < iterations; ++i) {
+        if (!RunOnce()) ++lost;
+    }
+    if (lost > 0) {
+        std::fprintf(stderr, "FAIL: retransmission deadline lost in %d of %d races\n", lost, iterations);
+        return 1;
+    }
+    std::printf("OK: %d races\n", iterations);
+    return 0;
+}
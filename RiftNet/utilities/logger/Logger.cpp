@@ -2,6 +2,7 @@
 #include "pch.h"
 #include "Logger.hpp"
 
+#include <chrono>
 #include <memory>
 #include <vector>
 
@@ -9,6 +10,7 @@ namespace RiftNet {
     namespace Logging {
 
         std::shared_ptr<spdlog::logger> Logger::coreLogger;
+        std::shared_ptr<spdlog::details::thread_pool> Logger::threadPool;
 
         void Logger::Init() {
             // Create sinks
@@ -33,13 +35,46 @@ namespace RiftNet {
             console_sink->set_pattern("[%H:%M:%S] [%^%l%$] %v");
             file_sink->set_pattern("[%Y-%m-%d %H:%M:%S] [%l] %v");
 
+            // Network threads only format and enqueue; one background thread does the console and file
+            // writes. A full queue overwrites its oldest message rather than blocking the caller.
             std::vector<spdlog::sink_ptr> sinks{ console_sink, file_sink };
-            coreLogger = std::make_shared<spdlog::logger>("RiftNet", sinks.begin(), sinks.end());
+            threadPool = std::make_shared<spdlog::details::thread_pool>(RIFTNET_LOG_QUEUE_SIZE, 1);
+            coreLogger = std::make_shared<spdlog::async_logger>("RiftNet", sinks.begin(), sinks.end(),
+                threadPool, spdlog::async_overflow_policy::overrun_oldest);
 
             coreLogger->set_level(spdlog::level::debug); // Tweak per build type
             coreLogger->flush_on(spdlog::level::warn);
             spdlog::register_logger(coreLogger);
         }
 
+        void Logger::Shutdown() {
+            if (!coreLogger) return;
+            coreLogger->flush();
+            spdlog::drop(coreLogger->name());
+            coreLogger.reset();
+            threadPool.reset(); // joins the logging thread once it has written what is queued
+        }
+
+        void Logger::LogSuppressed(spdlog::level::level_enum level, uint64_t suppressed, const std::string& message) {
+            if (suppressed == 0) {
+                coreLogger->log(level, "{}", message);
+            }
+            else {
+                coreLogger->log(level, "{} ({} similar messages suppressed)", message, suppressed);
+            }
+        }
+
+        bool RateLimiter::Allow(uint64_t& suppressed) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t next = m_nextAllowedNs.load(std::memory_order_relaxed);
+            if (now < next || !m_nextAllowedNs.compare_exchange_strong(next, now + m_intervalNs, std::memory_order_relaxed)) {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
     } // namespace Logging
 } // namespace RiftNet
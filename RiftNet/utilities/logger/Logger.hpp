@@ -2,30 +2,149 @@
 #pragma once
 
 #include <spdlog/spdlog.h>
+#include <spdlog/async.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <atomic>
+#include <cstdint>
+
+// Levels for RIFTNET_ACTIVE_LOG_LEVEL, numbered like spdlog::level::level_enum.
+#define RIFTNET_LOG_LEVEL_TRACE    0
+#define RIFTNET_LOG_LEVEL_DEBUG    1
+#define RIFTNET_LOG_LEVEL_INFO     2
+#define RIFTNET_LOG_LEVEL_WARN     3
+#define RIFTNET_LOG_LEVEL_ERROR    4
+#define RIFTNET_LOG_LEVEL_CRITICAL 5
+#define RIFTNET_LOG_LEVEL_OFF      6
+
+// Log calls below this level are compiled out, arguments and all. Release builds keep INFO and up.
+#ifndef RIFTNET_ACTIVE_LOG_LEVEL
+#ifdef NDEBUG
+#define RIFTNET_ACTIVE_LOG_LEVEL RIFTNET_LOG_LEVEL_INFO
+#else
+#define RIFTNET_ACTIVE_LOG_LEVEL RIFTNET_LOG_LEVEL_TRACE
+#endif
+#endif
+
+// Messages the async logger can hold before the oldest are overwritten.
+#ifndef RIFTNET_LOG_QUEUE_SIZE
+#define RIFTNET_LOG_QUEUE_SIZE 8192
+#endif
+
 namespace RiftNet{
     namespace Logging{
 
 class Logger {
 public:
+    /** @brief Creates the core logger: console and file sinks behind a bounded async queue. */
     static void Init();
 
+    /** @brief Drains the queue and stops the logging thread; call once servers and clients are stopped. */
+    static void Shutdown();
+
     static std::shared_ptr<spdlog::logger>& GetCoreLogger() { return coreLogger; }
 
+    /** @brief True if a message at `level` would be written; false before Init. */
+    static bool ShouldLog(spdlog::level::level_enum level) { return coreLogger && coreLogger->should_log(level); }
+
+    /** @brief Writes a rate-limited message, noting how many were suppressed since the last one. */
+    static void LogSuppressed(spdlog::level::level_enum level, uint64_t suppressed, const std::string& message);
+
 private:
     static std::shared_ptr<spdlog::logger> coreLogger;
+    static std::shared_ptr<spdlog::details::thread_pool> threadPool;
+};
+
+/**
+ * @brief Lets a log call site through at most once per interval, counting the calls it holds back.
+ * Lock-free; one instance is shared by every thread reaching the call site.
+ */
+class RateLimiter {
+public:
+    explicit RateLimiter(uint32_t intervalMs) : m_intervalNs(static_cast<int64_t>(intervalMs) * 1000000) {}
+
+    /** @brief True if the caller may log now; `suppressed` gets the number of calls held back before it. */
+    bool Allow(uint64_t& suppressed);
+
+private:
+    const int64_t        m_intervalNs;
+    std::atomic<int64_t>  m_nextAllowedNs{ 0 };
+    std::atomic<uint64_t> m_suppressed{ 0 };
 };
 
-    // Convenience macros
-#define RF_NETWORK_TRACE(...)    ::RiftNet::Logging::Logger::GetCoreLogger()->trace(__VA_ARGS__)
-#define RF_NETWORK_DEBUG(...)    ::RiftNet::Logging::Logger::GetCoreLogger()->debug(__VA_ARGS__)
-#define RF_NETWORK_INFO(...)     ::RiftNet::Logging::Logger::GetCoreLogger()->info(__VA_ARGS__)
-#define RF_NETWORK_WARN(...)     ::RiftNet::Logging::Logger::GetCoreLogger()->warn(__VA_ARGS__)
-#define RF_NETWORK_ERROR(...)    ::RiftNet::Logging::Logger::GetCoreLogger()->error(__VA_ARGS__)
-#define RF_NETWORK_CRITICAL(...) ::RiftNet::Logging::Logger::GetCoreLogger()->critical(__VA_ARGS__)
+    // Convenience macros. The level is checked before the arguments are evaluated, so a filtered
+    // call never formats or allocates; calls below RIFTNET_ACTIVE_LOG_LEVEL are not compiled in.
+#define RF_NETWORK_LOG_AT(level, ...) \
+    do { \
+        if (::RiftNet::Logging::Logger::ShouldLog(level)) \
+            ::RiftNet::Logging::Logger::GetCoreLogger()->log(level, __VA_ARGS__); \
+    } while (0)
+
+    // At most one message per `intervalMs` from this call site, across all threads and connections.
+#define RF_NETWORK_LOG_EVERY(level, intervalMs, ...) \
+    do { \
+        if (::RiftNet::Logging::Logger::ShouldLog(level)) { \
+            static ::RiftNet::Logging::RateLimiter rfLimiter_(intervalMs); \
+            uint64_t rfSuppressed_ = 0; \
+            if (rfLimiter_.Allow(rfSuppressed_)) \
+                ::RiftNet::Logging::Logger::LogSuppressed(level, rfSuppressed_, fmt::format(__VA_ARGS__)); \
+        } \
+    } while (0)
+
+    // Still type-checks the format and arguments, but evaluates nothing.
+#define RF_NETWORK_LOG_DISABLED(...) \
+    do { \
+        if (false) ::RiftNet::Logging::Logger::GetCoreLogger()->log(::spdlog::level::off, __VA_ARGS__); \
+    } while (0)
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_TRACE
+#define RF_NETWORK_TRACE(...)    RF_NETWORK_LOG_AT(::spdlog::level::trace, __VA_ARGS__)
+#else
+#define RF_NETWORK_TRACE(...)    RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_DEBUG
+#define RF_NETWORK_DEBUG(...)    RF_NETWORK_LOG_AT(::spdlog::level::debug, __VA_ARGS__)
+#define RF_NETWORK_DEBUG_EVERY(intervalMs, ...) RF_NETWORK_LOG_EVERY(::spdlog::level::debug, intervalMs, __VA_ARGS__)
+#else
+#define RF_NETWORK_DEBUG(...)    RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#define RF_NETWORK_DEBUG_EVERY(intervalMs, ...) RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_INFO
+#define RF_NETWORK_INFO(...)     RF_NETWORK_LOG_AT(::spdlog::level::info, __VA_ARGS__)
+#else
+#define RF_NETWORK_INFO(...)     RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_WARN
+#define RF_NETWORK_WARN(...)     RF_NETWORK_LOG_AT(::spdlog::level::warn, __VA_ARGS__)
+#define RF_NETWORK_WARN_EVERY(intervalMs, ...) RF_NETWORK_LOG_EVERY(::spdlog::level::warn, intervalMs, __VA_ARGS__)
+#else
+#define RF_NETWORK_WARN(...)     RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#define RF_NETWORK_WARN_EVERY(intervalMs, ...) RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_ERROR
+#define RF_NETWORK_ERROR(...)    RF_NETWORK_LOG_AT(::spdlog::level::err, __VA_ARGS__)
+#define RF_NETWORK_ERROR_EVERY(intervalMs, ...) RF_NETWORK_LOG_EVERY(::spdlog::level::err, intervalMs, __VA_ARGS__)
+#else
+#define RF_NETWORK_ERROR(...)    RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#define RF_NETWORK_ERROR_EVERY(intervalMs, ...) RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#if RIFTNET_ACTIVE_LOG_LEVEL <= RIFTNET_LOG_LEVEL_CRITICAL
+#define RF_NETWORK_CRITICAL(...) RF_NETWORK_LOG_AT(::spdlog::level::critical, __VA_ARGS__)
+#else
+#define RF_NETWORK_CRITICAL(...) RF_NETWORK_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+    // For warnings a peer can trigger once per packet: one message per second per call site is enough to
+    // see the problem without letting a flood of bad datagrams flood the log.
+#define RF_NETWORK_LOG_LIMIT_INTERVAL_MS 1000
+#define RF_NETWORK_WARN_LIMITED(...) RF_NETWORK_WARN_EVERY(RF_NETWORK_LOG_LIMIT_INTERVAL_MS, __VA_ARGS__)
 
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,56 @@
+#include "pch.h"
+#include "Metrics.hpp"
+
+namespace RiftNet::Metrics {
+
+    HistogramSnapshot& HistogramSnapshot::operator+=(const HistogramSnapshot& other) {
+        count += other.count;
+        sumMicros += other.sumMicros;
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        return *this;
+    }
+
+    HistogramSnapshot LatencyHistogram::Snapshot() const {
+        HistogramSnapshot out;
+        out.count = m_count.load(std::memory_order_relaxed);
+        out.sumMicros = m_sumMicros.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            out.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        return out;
+    }
+
+    ConnectionMetricsSnapshot& ConnectionMetricsSnapshot::operator+=(const ConnectionMetricsSnapshot& other) {
+        packetsSent += other.packetsSent;
+        bytesSent += other.bytesSent;
+        packetsReceived += other.packetsReceived;
+        bytesReceived += other.bytesReceived;
+        retransmits += other.retransmits;
+        duplicatesDropped += other.duplicatesDropped;
+        replaysDropped += other.replaysDropped;
+        decryptFailures += other.decryptFailures;
+        compressInputBytes += other.compressInputBytes;
+        compressOutputBytes += other.compressOutputBytes;
+        rtt += other.rtt;
+        return *this;
+    }
+
+    ConnectionMetricsSnapshot ConnectionMetrics::Snapshot(const LatencyHistogram& rtt) const {
+        ConnectionMetricsSnapshot out;
+        out.packetsSent = packetsSent.load(std::memory_order_relaxed);
+        out.bytesSent = bytesSent.load(std::memory_order_relaxed);
+        out.packetsReceived = packetsReceived.load(std::memory_order_relaxed);
+        out.bytesReceived = bytesReceived.load(std::memory_order_relaxed);
+        out.retransmits = retransmits.load(std::memory_order_relaxed);
+        out.duplicatesDropped = duplicatesDropped.load(std::memory_order_relaxed);
+        out.replaysDropped = replaysDropped.load(std::memory_order_relaxed);
+        out.decryptFailures = decryptFailures.load(std::memory_order_relaxed);
+        out.compressInputBytes = compressInputBytes.load(std::memory_order_relaxed);
+        out.compressOutputBytes = compressOutputBytes.load(std::memory_order_relaxed);
+        out.rtt = rtt.Snapshot();
+        return out;
+    }
+
+} // namespace RiftNet::Metrics
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+namespace RiftNet::Metrics {
+
+    // Bucket 0 counts samples under 1 us, bucket i those from 2^(i-1) up to 2^i us, and the last
+    // bucket everything from 2^(LATENCY_BUCKET_COUNT - 2) us (about 4 s) up. Matches RIFT_LATENCY_BUCKETS.
+    constexpr size_t LATENCY_BUCKET_COUNT = 24;
+
+    struct HistogramSnapshot {
+        uint64_t count{ 0 };
+        uint64_t sumMicros{ 0 };
+        std::array<uint64_t, LATENCY_BUCKET_COUNT> buckets{};
+
+        HistogramSnapshot& operator+=(const HistogramSnapshot& other);
+    };
+
+    /**
+     * @class LatencyHistogram
+     * @brief Lock-free histogram of durations in power-of-two microsecond buckets. Record is three
+     * relaxed atomic adds, so any thread can call it on a hot path; a snapshot taken meanwhile may
+     * count a sample in one field and not yet in another.
+     */
+    class LatencyHistogram {
+    public:
+        void Record(std::chrono::nanoseconds duration) {
+            RecordMicros(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) / 1000 : 0);
+        }
+
+        void RecordMicros(uint64_t micros) {
+            const size_t bucket = (std::min)(static_cast<size_t>(std::bit_width(micros)), LATENCY_BUCKET_COUNT - 1);
+            m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            m_sumMicros.fetch_add(micros, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        HistogramSnapshot Snapshot() const;
+
+    private:
+        std::atomic<uint64_t> m_count{ 0 };
+        std::atomic<uint64_t> m_sumMicros{ 0 };
+        std::array<std::atomic<uint64_t>, LATENCY_BUCKET_COUNT> m_buckets{};
+    };
+
+    // ConnectionMetrics as plain numbers; sums of several connections add up field by field.
+    struct ConnectionMetricsSnapshot {
+        uint64_t packetsSent{ 0 };
+        uint64_t bytesSent{ 0 };
+        uint64_t packetsReceived{ 0 };
+        uint64_t bytesReceived{ 0 };
+        uint64_t retransmits{ 0 };
+        uint64_t duplicatesDropped{ 0 };
+        uint64_t replaysDropped{ 0 };
+        uint64_t decryptFailures{ 0 };
+        uint64_t compressInputBytes{ 0 };
+        uint64_t compressOutputBytes{ 0 };
+        HistogramSnapshot rtt;
+
+        ConnectionMetricsSnapshot& operator+=(const ConnectionMetricsSnapshot& other);
+    };
+
+    /**
+     * @struct ConnectionMetrics
+     * @brief A connection's traffic counters since it was created. Each is bumped with a relaxed
+     * atomic add by whichever thread sees the event; nothing on the data path takes a lock.
+     */
+    struct ConnectionMetrics {
+        std::atomic<uint64_t> packetsSent{ 0 };     // datagrams handed to the socket layer
+        std::atomic<uint64_t> bytesSent{ 0 };       // their UDP payload bytes
+        std::atomic<uint64_t> packetsReceived{ 0 }; // datagrams handed to the connection, dropped or not
+        std::atomic<uint64_t> bytesReceived{ 0 };
+        std::atomic<uint64_t> retransmits{ 0 };       // reliable packets sent again (timeout or fast retransmit)
+        std::atomic<uint64_t> duplicatesDropped{ 0 }; // reliable packets received again after delivery
+        std::atomic<uint64_t> replaysDropped{ 0 };    // datagrams the anti-replay window refused
+        std::atomic<uint64_t> decryptFailures{ 0 };   // datagrams that did not authenticate
+        std::atomic<uint64_t> compressInputBytes{ 0 };  // payload bytes given to compression
+        std::atomic<uint64_t> compressOutputBytes{ 0 }; // and the bytes that came out
+
+        ConnectionMetricsSnapshot Snapshot(const LatencyHistogram& rtt) const;
+    };
+
+    inline void Add(std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+} // namespace RiftNet::Metrics